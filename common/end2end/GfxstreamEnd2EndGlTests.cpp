@@ -1686,6 +1686,12 @@ INSTANTIATE_TEST_CASE_P(GfxstreamEnd2EndTests, GfxstreamEnd2EndGlTest,
                                 .with_vk = true,
                                 .with_features = {"GlProgramBinaryLinkStatus"},
                             },
+                            TestParams{
+                                .with_gl = true,
+                                .with_vk = false,
+                                .with_features = {"GlProgramBinaryLinkStatus"},
+                                .with_transport = GfxstreamTransport::kVirtioGpuAsgGles,
+                            },
                         }),
                         &GetTestName);
 
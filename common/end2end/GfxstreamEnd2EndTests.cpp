@@ -66,6 +66,9 @@ std::string GfxstreamTransportToEnvVar(GfxstreamTransport transport) {
         case GfxstreamTransport::kVirtioGpuAsg: {
             return "virtio-gpu-asg";
         }
+        case GfxstreamTransport::kVirtioGpuAsgGles: {
+            return "virtio-gpu-asg-gles";
+        }
         case GfxstreamTransport::kVirtioGpuPipe: {
             return "virtio-gpu-pipe";
         }
@@ -77,6 +80,9 @@ std::string GfxstreamTransportToString(GfxstreamTransport transport) {
         case GfxstreamTransport::kVirtioGpuAsg: {
             return "VirtioGpuAsg";
         }
+        case GfxstreamTransport::kVirtioGpuAsgGles: {
+            return "VirtioGpuAsgGles";
+        }
         case GfxstreamTransport::kVirtioGpuPipe: {
             return "VirtioGpuPipe";
         }
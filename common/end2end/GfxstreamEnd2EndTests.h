@@ -474,6 +474,7 @@ Image ImageFromColor(uint32_t w, uint32_t h, const PixelR8G8B8A8& pixel);
 
 enum class GfxstreamTransport {
   kVirtioGpuAsg,
+  kVirtioGpuAsgGles,
   kVirtioGpuPipe,
 };
 
@@ -2453,6 +2453,114 @@ TEST_P(GfxstreamEnd2EndVkTest, GetFenceStatusOnExternalFence) {
 INSTANTIATE_TEST_CASE_P(GfxstreamEnd2EndTests, GfxstreamEnd2EndVkTest,
                         ::testing::ValuesIn(GenerateTestCases()), &GetTestName);
 
+// Only run with and without the parallel sub-decode instead of adding it to every case above.
+class GfxstreamEnd2EndVkSubDecodeTest : public GfxstreamEnd2EndVkTest {};
+
+TEST_P(GfxstreamEnd2EndVkSubDecodeTest, RecordManyCommandBuffersFromSeparatePools) {
+    auto vk = GFXSTREAM_ASSERT(SetUpTypicalVkTestEnvironment());
+    auto& [instance, physicalDevice, device, queue, queueFamilyIndex] = vk;
+
+    constexpr const uint32_t kNumCommandBuffers = 16;
+    constexpr const uint32_t kNumFillsPerCommandBuffer = 4096;
+    constexpr const uint32_t kNumIterations = 8;
+    constexpr const vkhpp::DeviceSize kRegionSize = 256;
+
+    auto buffer = GFXSTREAM_ASSERT(CreateBuffer(
+        vk, kRegionSize * kNumCommandBuffers, vkhpp::BufferUsageFlagBits::eTransferDst,
+        vkhpp::MemoryPropertyFlagBits::eHostVisible |
+            vkhpp::MemoryPropertyFlagBits::eHostCoherent));
+
+    // One pool per command buffer so that the host is free to sub-decode them in parallel.
+    std::vector<vkhpp::UniqueCommandPool> commandPools;
+    std::vector<vkhpp::UniqueCommandBuffer> commandBuffers;
+    for (uint32_t i = 0; i < kNumCommandBuffers; i++) {
+        const vkhpp::CommandPoolCreateInfo commandPoolCreateInfo = {
+            .flags = vkhpp::CommandPoolCreateFlagBits::eResetCommandBuffer,
+            .queueFamilyIndex = queueFamilyIndex,
+        };
+        auto commandPool = device->createCommandPoolUnique(commandPoolCreateInfo).value;
+        ASSERT_THAT(commandPool, IsValidHandle());
+
+        const vkhpp::CommandBufferAllocateInfo commandBufferAllocateInfo = {
+            .commandPool = *commandPool,
+            .level = vkhpp::CommandBufferLevel::ePrimary,
+            .commandBufferCount = 1,
+        };
+        auto allocated = device->allocateCommandBuffersUnique(commandBufferAllocateInfo).value;
+        ASSERT_THAT(allocated, Not(IsEmpty()));
+
+        commandPools.push_back(std::move(commandPool));
+        commandBuffers.push_back(std::move(allocated[0]));
+    }
+
+    std::vector<vkhpp::CommandBuffer> commandBufferHandles;
+    for (const auto& commandBuffer : commandBuffers) {
+        commandBufferHandles.push_back(*commandBuffer);
+    }
+
+    auto fence = device->createFenceUnique(vkhpp::FenceCreateInfo()).value;
+    ASSERT_THAT(fence, IsValidHandle());
+
+    auto fillValue = [](uint32_t iteration, uint32_t commandBufferIndex) {
+        return (iteration << 16) | commandBufferIndex;
+    };
+
+    const auto begin = std::chrono::steady_clock::now();
+    for (uint32_t iteration = 0; iteration < kNumIterations; iteration++) {
+        for (uint32_t i = 0; i < kNumCommandBuffers; i++) {
+            auto& commandBuffer = commandBuffers[i];
+            const vkhpp::CommandBufferBeginInfo commandBufferBeginInfo = {
+                .flags = vkhpp::CommandBufferUsageFlagBits::eOneTimeSubmit,
+            };
+            commandBuffer->begin(commandBufferBeginInfo);
+            for (uint32_t fill = 0; fill < kNumFillsPerCommandBuffer; fill++) {
+                commandBuffer->fillBuffer(*buffer.buffer, i * kRegionSize, kRegionSize,
+                                          fillValue(iteration, i));
+            }
+            commandBuffer->end();
+        }
+
+        const vkhpp::SubmitInfo submitInfo = {
+            .commandBufferCount = static_cast<uint32_t>(commandBufferHandles.size()),
+            .pCommandBuffers = commandBufferHandles.data(),
+        };
+        queue.submit(submitInfo, *fence);
+        auto waitResult = device->waitForFences(*fence, VK_TRUE, AsVkTimeout(10s));
+        ASSERT_THAT(waitResult, IsVkSuccess());
+        device->resetFences(*fence);
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - begin);
+    RecordProperty("record_and_submit_ms", static_cast<int>(elapsed.count()));
+
+    void* mapped = nullptr;
+    auto mapResult = device->mapMemory(*buffer.bufferMemory, 0, VK_WHOLE_SIZE,
+                                       vkhpp::MemoryMapFlags{}, &mapped);
+    ASSERT_THAT(mapResult, IsVkSuccess());
+    ASSERT_THAT(mapped, NotNull());
+
+    const auto* words = reinterpret_cast<const uint32_t*>(mapped);
+    for (uint32_t i = 0; i < kNumCommandBuffers; i++) {
+        const uint32_t expected = fillValue(kNumIterations - 1, i);
+        for (uint32_t j = 0; j < kRegionSize / sizeof(uint32_t); j++) {
+            ASSERT_THAT(words[i * kRegionSize / sizeof(uint32_t) + j], Eq(expected));
+        }
+    }
+    device->unmapMemory(*buffer.bufferMemory);
+}
+
+std::vector<TestParams> GenerateSubDecodeTestCases() {
+    std::vector<TestParams> cases = {TestParams{
+        .with_gl = false,
+        .with_vk = true,
+        .with_transport = GfxstreamTransport::kVirtioGpuAsg,
+    }};
+    return WithAndWithoutFeatures(cases, {"VulkanParallelSubDecode"});
+}
+
+INSTANTIATE_TEST_CASE_P(GfxstreamEnd2EndTests, GfxstreamEnd2EndVkSubDecodeTest,
+                        ::testing::ValuesIn(GenerateSubDecodeTestCases()), &GetTestName);
+
 }  // namespace
 }  // namespace tests
 }  // namespace gfxstream
@@ -87,6 +87,7 @@ GL2Encoder::GL2Encoder(IOStream *stream, ChecksumCalculator *protocol)
     m_currMinorVersion = 0;
     m_hasAsyncUnmapBuffer = false;
     m_hasSyncBufferData = false;
+    m_hasClientArrayCache = false;
     m_initialized = false;
     m_noHostError = false;
     m_state = NULL;
@@ -775,6 +776,7 @@ void GL2Encoder::s_glVertexAttribPointer(void *self, GLuint indx, GLint size, GL
 
     if (ctx->m_state->currentArrayVbo() != 0) {
         ctx->glVertexAttribPointerOffset(ctx, indx, size, type, normalized, stride, (uintptr_t)ptr);
+        ctx->unbindCachedClientArray(indx);
     } else {
         SET_ERROR_IF(ctx->m_state->currentVertexArrayObject() != 0 && ptr, GL_INVALID_OPERATION);
         // wait for client-array handler
@@ -1383,8 +1385,9 @@ void GL2Encoder::sendVertexAttributes(GLint first, GLsizei count, bool hasClient
 
                 if (state.isInt) {
                     this->glVertexAttribIPointerDataAEMU(this, i, state.size, state.type, stride, data, datalen);
+                    unbindCachedClientArray(i);
                 } else {
-                    this->glVertexAttribPointerData(this, i, state.size, state.type, state.normalized, stride, data, datalen);
+                    sendClientArray(i, state.size, state.type, state.normalized, stride, data, datalen);
                 }
             } else {
                 const BufferData* buf = m_shared->getBufferData(bufferObject);
@@ -1405,6 +1408,7 @@ void GL2Encoder::sendVertexAttributes(GLint first, GLsizei count, bool hasClient
                             } else {
                                 this->glVertexAttribPointerOffset(this, i, state.size, state.type, state.normalized, stride, offset + firstIndex);
                             }
+                            unbindCachedClientArray(i);
                         }
                     }
                 } else {
@@ -1432,6 +1436,37 @@ void GL2Encoder::sendVertexAttributes(GLint first, GLsizei count, bool hasClient
     }
 }
 
+void GL2Encoder::sendClientArray(GLuint attrib, GLint size, GLenum type, GLboolean normalized,
+                                 GLsizei stride, unsigned char* data, GLuint datalen)
+{
+    // Client arrays are only allowed with the default vertex array object, which is the only
+    // one whose attributes can point at the cache slots of the host.
+    if (!m_hasClientArrayCache || !ClientArrayCache::isCacheable(attrib, datalen) ||
+        m_state->currentVertexArrayObject() != 0) {
+        this->glVertexAttribPointerData(this, attrib, size, type, normalized, stride, data, datalen);
+        unbindCachedClientArray(attrib);
+        return;
+    }
+
+    const uint64_t hash = ClientArrayCache::hashPointerData(data, size, type, stride, datalen);
+    uint32_t slot = 0;
+    if (m_state->clientArrayCache().bindAttrib(attrib, hash, data, size, type, stride, datalen,
+                                               &slot)) {
+        this->glVertexAttribPointerCachedAEMU(this, attrib, size, type, normalized, stride, slot,
+                                              datalen);
+    } else {
+        this->glVertexAttribPointerDataCachedAEMU(this, attrib, size, type, normalized, stride,
+                                                  slot, data, datalen);
+    }
+}
+
+void GL2Encoder::unbindCachedClientArray(GLuint attrib)
+{
+    if (m_state->currentVertexArrayObject() == 0) {
+        m_state->clientArrayCache().unbindAttrib(attrib);
+    }
+}
+
 void GL2Encoder::flushDrawCall() {
     if (m_drawCallFlushCount % m_drawCallFlushInterval == 0) {
         m_stream->flush();
@@ -4154,6 +4189,7 @@ void GL2Encoder::s_glVertexAttribIPointer(void* self, GLuint index, GLint size,
 
     if (ctx->m_state->currentArrayVbo() != 0) {
         ctx->glVertexAttribIPointerOffsetAEMU(ctx, index, size, type, stride, (uintptr_t)pointer);
+        ctx->unbindCachedClientArray(index);
     } else {
         SET_ERROR_IF(ctx->m_state->currentVertexArrayObject() != 0 && pointer, GL_INVALID_OPERATION);
         // wait for client-array handler
@@ -51,6 +51,7 @@ public:
  void setDrawCallFlushInterval(uint32_t interval) { m_drawCallFlushInterval = interval; }
  void setHasAsyncUnmapBuffer(int version) { m_hasAsyncUnmapBuffer = version; }
  void setHasSyncBufferData(bool value) { m_hasSyncBufferData = value; }
+ void setHasClientArrayCache(bool value) { m_hasClientArrayCache = value; }
  void setNoHostError(bool noHostError) { m_noHostError = noHostError; }
  void setClientState(gfxstream::guest::GLClientState* state) { m_state = state; }
  void setVersion(int major, int minor, int deviceMajor, int deviceMinor) {
@@ -135,6 +136,7 @@ public:
 
     bool    m_hasAsyncUnmapBuffer;
     bool    m_hasSyncBufferData;
+    bool    m_hasClientArrayCache;
     bool    m_initialized;
     bool    m_noHostError;
     gfxstream::guest::GLClientState *m_state;
@@ -189,6 +191,9 @@ public:
                              int* minIndex_out, int* maxIndex_out);
     void getVBOUsage(bool* hasClientArrays, bool* hasVBOs) const;
     void sendVertexAttributes(GLint first, GLsizei count, bool hasClientArrays, GLsizei primcount = 0);
+    void sendClientArray(GLuint attrib, GLint size, GLenum type, GLboolean normalized, GLsizei stride,
+                         unsigned char* data, GLuint datalen);
+    void unbindCachedClientArray(GLuint attrib);
     void flushDrawCall();
 
     bool updateHostTexture2DBinding(GLenum texUnit, GLenum newTarget);
@@ -463,6 +463,8 @@ int gl2_client_context_t::initDispatchByName(void *(*getProc)(const char *, void
 	glBlendFuncSeparateiEXT = (glBlendFuncSeparateiEXT_client_proc_t) getProc("glBlendFuncSeparateiEXT", userData);
 	glColorMaskiEXT = (glColorMaskiEXT_client_proc_t) getProc("glColorMaskiEXT", userData);
 	glIsEnablediEXT = (glIsEnablediEXT_client_proc_t) getProc("glIsEnablediEXT", userData);
+	glVertexAttribPointerDataCachedAEMU = (glVertexAttribPointerDataCachedAEMU_client_proc_t) getProc("glVertexAttribPointerDataCachedAEMU", userData);
+	glVertexAttribPointerCachedAEMU = (glVertexAttribPointerCachedAEMU_client_proc_t) getProc("glVertexAttribPointerCachedAEMU", userData);
 	return 0;
 }
 
@@ -463,6 +463,8 @@ struct gl2_client_context_t {
 	glBlendFuncSeparateiEXT_client_proc_t glBlendFuncSeparateiEXT;
 	glColorMaskiEXT_client_proc_t glColorMaskiEXT;
 	glIsEnablediEXT_client_proc_t glIsEnablediEXT;
+	glVertexAttribPointerDataCachedAEMU_client_proc_t glVertexAttribPointerDataCachedAEMU;
+	glVertexAttribPointerCachedAEMU_client_proc_t glVertexAttribPointerCachedAEMU;
 	virtual ~gl2_client_context_t() {}
 
 	typedef gl2_client_context_t *CONTEXT_ACCESSOR_TYPE(void);
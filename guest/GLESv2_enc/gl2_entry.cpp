@@ -458,6 +458,8 @@ extern "C" {
 	void glBlendFuncSeparateiEXT(GLuint index, GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha);
 	void glColorMaskiEXT(GLuint index, GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha);
 	GLboolean glIsEnablediEXT(GLenum cap, GLuint index);
+	void glVertexAttribPointerDataCachedAEMU(GLuint indx, GLint size, GLenum type, GLboolean normalized, GLsizei stride, GLuint slot, void* data, GLuint datalen);
+	void glVertexAttribPointerCachedAEMU(GLuint indx, GLint size, GLenum type, GLboolean normalized, GLsizei stride, GLuint slot, GLuint datalen);
 };
 
 #ifndef GET_CONTEXT
@@ -3137,3 +3139,15 @@ GLboolean glIsEnablediEXT(GLenum cap, GLuint index)
 	return ctx->glIsEnablediEXT(ctx, cap, index);
 }
 
+void glVertexAttribPointerDataCachedAEMU(GLuint indx, GLint size, GLenum type, GLboolean normalized, GLsizei stride, GLuint slot, void* data, GLuint datalen)
+{
+	GET_CONTEXT;
+	ctx->glVertexAttribPointerDataCachedAEMU(ctx, indx, size, type, normalized, stride, slot, data, datalen);
+}
+
+void glVertexAttribPointerCachedAEMU(GLuint indx, GLint size, GLenum type, GLboolean normalized, GLsizei stride, GLuint slot, GLuint datalen)
+{
+	GET_CONTEXT;
+	ctx->glVertexAttribPointerCachedAEMU(ctx, indx, size, type, normalized, stride, slot, datalen);
+}
+
@@ -456,7 +456,9 @@
 #define OP_glBlendFuncSeparateiEXT 					2484
 #define OP_glColorMaskiEXT 					2485
 #define OP_glIsEnablediEXT 					2486
-#define OP_last 					2487
+#define OP_glVertexAttribPointerDataCachedAEMU 					2487
+#define OP_glVertexAttribPointerCachedAEMU 					2488
+#define OP_last 					2489
 
 
 #endif
@@ -0,0 +1,196 @@
+// Copyright (C) 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ClientArrayCache.h"
+
+#include <GLES3/gl3.h>
+#include <string.h>
+
+#include "glUtils.h"
+
+namespace {
+
+constexpr uint64_t kHashSeed = 0xcbf29ce484222325ULL;
+constexpr uint64_t kHashMultiplier = 0x9e3779b97f4a7c15ULL;
+
+uint64_t mix(uint64_t hash, uint64_t word) {
+    hash = (hash ^ word) * kHashMultiplier;
+    return hash ^ (hash >> 29);
+}
+
+// Hashes a byte stream in 8 byte words, independently of how the stream is
+// split into update() calls, so strided data hashes like its packed copy.
+class StreamHasher {
+public:
+    void update(const unsigned char* data, size_t size) {
+        if (m_pendingSize) {
+            size_t fill = sizeof(m_pending) - m_pendingSize;
+            if (fill > size) fill = size;
+            memcpy(m_pending + m_pendingSize, data, fill);
+            m_pendingSize += fill;
+            data += fill;
+            size -= fill;
+            if (m_pendingSize < sizeof(m_pending)) {
+                return;
+            }
+            m_hash = mix(m_hash, loadWord(m_pending, sizeof(m_pending)));
+            m_pendingSize = 0;
+        }
+        while (size >= sizeof(uint64_t)) {
+            m_hash = mix(m_hash, loadWord(data, sizeof(uint64_t)));
+            data += sizeof(uint64_t);
+            size -= sizeof(uint64_t);
+        }
+        memcpy(m_pending, data, size);
+        m_pendingSize = size;
+    }
+
+    uint64_t finish() const {
+        if (!m_pendingSize) {
+            return m_hash;
+        }
+        return mix(m_hash, loadWord(m_pending, m_pendingSize) ^
+                               (static_cast<uint64_t>(m_pendingSize) << 56));
+    }
+
+private:
+    static uint64_t loadWord(const unsigned char* data, size_t size) {
+        uint64_t word = 0;
+        memcpy(&word, data, size);
+        return word;
+    }
+
+    uint64_t m_hash = kHashSeed;
+    unsigned char m_pending[sizeof(uint64_t)];
+    size_t m_pendingSize = 0;
+};
+
+// Size of a vertex once packed by glUtilsPackPointerData().
+unsigned int packedVertexSize(int size, GLenum type) {
+    unsigned int vsize = size * glSizeof(type);
+    switch (type) {
+        case GL_INT_2_10_10_10_REV:
+        case GL_UNSIGNED_INT_2_10_10_10_REV:
+            vsize = vsize / 4;
+            break;
+        default:
+            break;
+    }
+    return vsize;
+}
+
+// Compares |packed| with the data that glUtilsPackPointerData() would pack from |src|.
+bool packedDataEquals(const std::vector<unsigned char>& packed, const unsigned char* src,
+                      int size, GLenum type, unsigned int stride, unsigned int datalen) {
+    if (packed.size() != datalen) {
+        return false;
+    }
+
+    const unsigned int vsize = packedVertexSize(size, type);
+    if (stride == 0) stride = vsize;
+
+    if (stride == vsize) {
+        return memcmp(packed.data(), src, datalen) == 0;
+    }
+    for (unsigned int i = 0; i < datalen; i += vsize) {
+        const unsigned int compareSize = vsize < datalen - i ? vsize : datalen - i;
+        if (memcmp(packed.data() + i, src, compareSize) != 0) {
+            return false;
+        }
+        src += stride;
+    }
+    return true;
+}
+
+}  // namespace
+
+ClientArrayCache::ClientArrayCache() { m_attribSlots.fill(kNoSlot); }
+
+uint64_t ClientArrayCache::hashPointerData(const unsigned char* src, int size, GLenum type,
+                                           unsigned int stride, unsigned int datalen) {
+    const unsigned int vsize = packedVertexSize(size, type);
+    if (stride == 0) stride = vsize;
+
+    StreamHasher hasher;
+    if (stride == vsize) {
+        hasher.update(src, datalen);
+    } else {
+        for (unsigned int i = 0; i < datalen; i += vsize) {
+            hasher.update(src, vsize);
+            src += stride;
+        }
+    }
+    return hasher.finish();
+}
+
+bool ClientArrayCache::isSlotBound(uint32_t slot) const {
+    for (int32_t attribSlot : m_attribSlots) {
+        if (attribSlot == static_cast<int32_t>(slot)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ClientArrayCache::bindAttrib(GLuint attrib, uint64_t hash, const unsigned char* src,
+                                  int size, GLenum type, unsigned int stride,
+                                  unsigned int datalen, uint32_t* slotOut) {
+    ++m_useCounter;
+
+    for (uint32_t i = 0; i < kSlotCount; i++) {
+        Slot& slot = m_slots[i];
+        if (slot.valid && slot.hash == hash &&
+            packedDataEquals(slot.data, src, size, type, stride, datalen)) {
+            slot.lastUse = m_useCounter;
+            m_attribSlots[attrib] = static_cast<int32_t>(i);
+            *slotOut = i;
+            return true;
+        }
+    }
+
+    // The previous data of the attribute is no longer pinned by it.
+    m_attribSlots[attrib] = kNoSlot;
+
+    uint32_t victim = kSlotCount;
+    for (uint32_t i = 0; i < kSlotCount; i++) {
+        if (isSlotBound(i)) {
+            continue;
+        }
+        if (!m_slots[i].valid) {
+            victim = i;
+            break;
+        }
+        if (victim == kSlotCount || m_slots[i].lastUse < m_slots[victim].lastUse) {
+            victim = i;
+        }
+    }
+
+    // There are more slots than attributes so at least one slot is not bound.
+    Slot& slot = m_slots[victim];
+    slot.valid = true;
+    slot.hash = hash;
+    slot.data.resize(datalen);
+    glUtilsPackPointerData(slot.data.data(), const_cast<unsigned char*>(src), size, type, stride,
+                           datalen);
+    slot.lastUse = m_useCounter;
+    m_attribSlots[attrib] = static_cast<int32_t>(victim);
+    *slotOut = victim;
+    return false;
+}
+
+void ClientArrayCache::unbindAttrib(GLuint attrib) {
+    if (attrib < kMaxAttribCount) {
+        m_attribSlots[attrib] = kNoSlot;
+    }
+}
@@ -0,0 +1,87 @@
+// Copyright (C) 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <GLES2/gl2.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <vector>
+
+// Tracks which client vertex array data of a context the host still has in
+// the cache slots of its GLDecoderContextData, so that draws that use the same
+// data again can send glVertexAttribPointerCachedAEMU() instead of the data.
+//
+// The host never evicts anything: each upload names the slot that it goes to
+// and the host overwrites that slot. A slot that an attribute may still point
+// at on the host is never picked, as the host would free the old data under
+// it.
+//
+// The hash only finds the slot that may hold the data. Each slot keeps a copy
+// of what was uploaded to it, which is compared with the data before the
+// upload is skipped, so that a hash collision can not make the host draw
+// stale data.
+class ClientArrayCache {
+public:
+    // Must match GLDecoderContextData::kMaxCachedPointerData on the host.
+    static constexpr uint32_t kSlotCount = 32;
+    // Must be at most GLDecoderContextData::kMaxVertexAttributes on the host.
+    // Also leaves half of the slots unpinned at any time.
+    static constexpr uint32_t kMaxAttribCount = 16;
+    // Smaller arrays are cheaper to send than to hash and look up.
+    static constexpr size_t kMinDataSize = 64;
+    // Bounds the memory that the host keeps for each context.
+    static constexpr size_t kMaxDataSize = 256 * 1024;
+
+    ClientArrayCache();
+
+    static bool isCacheable(GLuint attrib, size_t datalen) {
+        return attrib < kMaxAttribCount && datalen >= kMinDataSize && datalen <= kMaxDataSize;
+    }
+
+    // Hashes the data exactly as glUtilsPackPointerData() would pack it.
+    static uint64_t hashPointerData(const unsigned char* src, int size, GLenum type,
+                                    unsigned int stride, unsigned int datalen);
+
+    // Points |attrib| at the data that glUtilsPackPointerData() would pack from
+    // |src|, whose hashPointerData() is |hash|. Returns true and the slot in
+    // |slotOut| if the host already has the data. Otherwise, returns false and
+    // the slot in |slotOut| that the data must be uploaded to.
+    bool bindAttrib(GLuint attrib, uint64_t hash, const unsigned char* src, int size, GLenum type,
+                    unsigned int stride, unsigned int datalen, uint32_t* slotOut);
+
+    // Called when |attrib| is pointed at anything other than a cache slot on
+    // the host.
+    void unbindAttrib(GLuint attrib);
+
+private:
+    struct Slot {
+        bool valid = false;
+        uint64_t hash = 0;
+        // The packed data that was uploaded to the slot.
+        std::vector<unsigned char> data;
+        uint64_t lastUse = 0;
+    };
+
+    static constexpr int32_t kNoSlot = -1;
+
+    bool isSlotBound(uint32_t slot) const;
+
+    std::array<Slot, kSlotCount> m_slots;
+    // The slot that each attribute points at on the host, or kNoSlot.
+    std::array<int32_t, kMaxAttribCount> m_attribSlots;
+    uint64_t m_useCounter = 0;
+};
@@ -0,0 +1,202 @@
+// Copyright (C) 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ClientArrayCache.h"
+
+#include <GLES3/gl3.h>
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include <vector>
+
+#include "glUtils.h"
+
+namespace {
+
+constexpr size_t kDataSize = 128;
+
+// Binds |attrib| to packed data whose contents and hash are derived from |value|.
+bool bindValue(ClientArrayCache& cache, GLuint attrib, uint64_t value, size_t datalen,
+               uint32_t* slot) {
+    std::vector<unsigned char> data(datalen, 0);
+    memcpy(data.data(), &value, sizeof(value));
+    return cache.bindAttrib(attrib, value, data.data(), 1, GL_UNSIGNED_BYTE, 0, datalen, slot);
+}
+
+TEST(ClientArrayCacheTest, MissThenHit) {
+    ClientArrayCache cache;
+
+    uint32_t slot = 0;
+    EXPECT_FALSE(bindValue(cache, 0, 1, kDataSize, &slot));
+    const uint32_t uploadedSlot = slot;
+
+    EXPECT_TRUE(bindValue(cache, 1, 1, kDataSize, &slot));
+    EXPECT_EQ(slot, uploadedSlot);
+
+    // Same hash and prefix but a different size is different data.
+    EXPECT_FALSE(bindValue(cache, 2, 1, kDataSize * 2, &slot));
+    EXPECT_NE(slot, uploadedSlot);
+
+    EXPECT_FALSE(bindValue(cache, 3, 2, kDataSize, &slot));
+    EXPECT_NE(slot, uploadedSlot);
+}
+
+TEST(ClientArrayCacheTest, EvictsLeastRecentlyUsedSlot) {
+    ClientArrayCache cache;
+
+    std::vector<uint32_t> slots(ClientArrayCache::kSlotCount);
+    for (uint32_t i = 0; i < ClientArrayCache::kSlotCount; i++) {
+        EXPECT_FALSE(bindValue(cache, 0, i, kDataSize, &slots[i]));
+    }
+    cache.unbindAttrib(0);
+
+    // Uses the first hash again so that the second one is the oldest.
+    uint32_t slot = 0;
+    EXPECT_TRUE(bindValue(cache, 0, 0, kDataSize, &slot));
+    EXPECT_EQ(slot, slots[0]);
+    cache.unbindAttrib(0);
+
+    EXPECT_FALSE(bindValue(cache, 0, ClientArrayCache::kSlotCount, kDataSize, &slot));
+    EXPECT_EQ(slot, slots[1]);
+
+    EXPECT_TRUE(bindValue(cache, 1, 0, kDataSize, &slot));
+    EXPECT_FALSE(bindValue(cache, 2, 1, kDataSize, &slot));
+    EXPECT_EQ(slot, slots[2]);
+}
+
+TEST(ClientArrayCacheTest, NeverEvictsBoundSlots) {
+    ClientArrayCache cache;
+
+    // Binds every attribute to the oldest data.
+    std::vector<uint32_t> boundSlots(ClientArrayCache::kMaxAttribCount);
+    for (uint32_t attrib = 0; attrib < ClientArrayCache::kMaxAttribCount; attrib++) {
+        EXPECT_FALSE(bindValue(cache, attrib, attrib, kDataSize, &boundSlots[attrib]));
+    }
+
+    // Churns through many more uploads than there are slots through a single
+    // attribute, which never gets to take a slot of another attribute.
+    const GLuint churnAttrib = ClientArrayCache::kMaxAttribCount - 1;
+    for (uint64_t hash = 1000; hash < 1000 + 4 * ClientArrayCache::kSlotCount; hash++) {
+        uint32_t slot = 0;
+        EXPECT_FALSE(bindValue(cache, churnAttrib, hash, kDataSize, &slot));
+        for (uint32_t attrib = 0; attrib < churnAttrib; attrib++) {
+            EXPECT_NE(slot, boundSlots[attrib]);
+        }
+    }
+
+    for (uint32_t attrib = 0; attrib < churnAttrib; attrib++) {
+        uint32_t slot = 0;
+        EXPECT_TRUE(bindValue(cache, attrib, attrib, kDataSize, &slot));
+        EXPECT_EQ(slot, boundSlots[attrib]);
+    }
+}
+
+TEST(ClientArrayCacheTest, HashCollisionIsAMiss) {
+    ClientArrayCache cache;
+
+    std::vector<unsigned char> data(kDataSize, 1);
+    uint32_t slot = 0;
+    EXPECT_FALSE(cache.bindAttrib(0, 1, data.data(), 1, GL_UNSIGNED_BYTE, 0, kDataSize, &slot));
+    const uint32_t uploadedSlot = slot;
+
+    // Different data with the same hash must be uploaded again.
+    data[kDataSize - 1] = 2;
+    EXPECT_FALSE(cache.bindAttrib(1, 1, data.data(), 1, GL_UNSIGNED_BYTE, 0, kDataSize, &slot));
+    EXPECT_NE(slot, uploadedSlot);
+    const uint32_t collidingSlot = slot;
+
+    data[kDataSize - 1] = 1;
+    EXPECT_TRUE(cache.bindAttrib(2, 1, data.data(), 1, GL_UNSIGNED_BYTE, 0, kDataSize, &slot));
+    EXPECT_EQ(slot, uploadedSlot);
+    data[kDataSize - 1] = 2;
+    EXPECT_TRUE(cache.bindAttrib(3, 1, data.data(), 1, GL_UNSIGNED_BYTE, 0, kDataSize, &slot));
+    EXPECT_EQ(slot, collidingSlot);
+}
+
+TEST(ClientArrayCacheTest, ComparesStridedDataWithItsPackedCopy) {
+    ClientArrayCache cache;
+
+    constexpr unsigned int kVertexSize = 12;
+    constexpr unsigned int kStride = 16;
+    constexpr unsigned int kVertexCount = 32;
+    constexpr unsigned int kDataLen = kVertexSize * kVertexCount;
+    std::vector<unsigned char> strided(kStride * kVertexCount);
+    for (size_t i = 0; i < strided.size(); i++) {
+        strided[i] = static_cast<unsigned char>(i * 7 + 3);
+    }
+    std::vector<unsigned char> packed(kDataLen);
+    glUtilsPackPointerData(packed.data(), strided.data(), 3, GL_FLOAT, kStride, kDataLen);
+
+    uint32_t slot = 0;
+    EXPECT_FALSE(cache.bindAttrib(0, 1, packed.data(), 3, GL_FLOAT, 0, kDataLen, &slot));
+    EXPECT_TRUE(cache.bindAttrib(1, 1, strided.data(), 3, GL_FLOAT, kStride, kDataLen, &slot));
+
+    // The padding between the vertices is not part of the data.
+    strided[kVertexSize] ^= 0xff;
+    EXPECT_TRUE(cache.bindAttrib(1, 1, strided.data(), 3, GL_FLOAT, kStride, kDataLen, &slot));
+
+    strided[kStride * (kVertexCount - 1)] ^= 0xff;
+    EXPECT_FALSE(cache.bindAttrib(1, 1, strided.data(), 3, GL_FLOAT, kStride, kDataLen, &slot));
+}
+
+TEST(ClientArrayCacheTest, HashesStridedDataLikeItsPackedCopy) {
+    struct Format {
+        int size;
+        GLenum type;
+    };
+    // Vertex sizes of 3, 6, 12 and 4 bytes do not line up with the hash words.
+    const Format formats[] = {
+        {3, GL_UNSIGNED_BYTE},
+        {3, GL_SHORT},
+        {3, GL_FLOAT},
+        {4, GL_INT_2_10_10_10_REV},
+    };
+    constexpr unsigned int kVertexCount = 37;
+    constexpr unsigned int kPadding = 5;
+
+    for (const Format& format : formats) {
+        unsigned int vsize = format.size * glSizeof(format.type);
+        if (format.type == GL_INT_2_10_10_10_REV) {
+            vsize /= 4;
+        }
+        const unsigned int stride = vsize + kPadding;
+        const unsigned int datalen = vsize * kVertexCount;
+
+        std::vector<unsigned char> strided(stride * kVertexCount);
+        for (size_t i = 0; i < strided.size(); i++) {
+            strided[i] = static_cast<unsigned char>(i * 7 + 3);
+        }
+        std::vector<unsigned char> packed(datalen);
+        glUtilsPackPointerData(packed.data(), strided.data(), format.size, format.type, stride,
+                               datalen);
+
+        const uint64_t stridedHash = ClientArrayCache::hashPointerData(
+            strided.data(), format.size, format.type, stride, datalen);
+        EXPECT_EQ(stridedHash, ClientArrayCache::hashPointerData(packed.data(), format.size,
+                                                                 format.type, 0, datalen));
+
+        // Only the packed bytes are hashed, not the padding between vertices.
+        for (unsigned int v = 0; v < kVertexCount; v++) {
+            strided[v * stride + vsize] ^= 0xff;
+        }
+        EXPECT_EQ(stridedHash, ClientArrayCache::hashPointerData(strided.data(), format.size,
+                                                                 format.type, stride, datalen));
+
+        strided[stride * (kVertexCount - 1)] ^= 0xff;
+        EXPECT_NE(stridedHash, ClientArrayCache::hashPointerData(strided.data(), format.size,
+                                                                 format.type, stride, datalen));
+    }
+}
+
+}  // namespace
@@ -29,6 +29,7 @@
 #include <string>
 #include <vector>
 
+#include "ClientArrayCache.h"
 #include "StateTrackingSupport.h"
 #include "TextureSharedData.h"
 #include "codec_defs.h"
@@ -270,6 +271,8 @@ public:
     const VertexAttribState& getStateAndEnableDirty(int location, bool *enableChanged);
     void updateEnableDirtyArrayForDraw();
     VAOState& currentVaoState();
+    // Client arrays of the context that the host still has.
+    ClientArrayCache& clientArrayCache() { return m_clientArrayCache; }
     int getLocation(GLenum loc);
     void setActiveTexture(int texUnit) {m_activeTexture = texUnit; };
     int getActiveTexture() const { return m_activeTexture; }
@@ -614,6 +617,8 @@ private:
     uint16_t m_vaoAttribBindingHasVboCache;
     uint8_t m_noClientArraysCache;
 
+    ClientArrayCache m_clientArrayCache;
+
     // Other buffer id's, other targets
     GLuint m_copyReadBuffer;
     GLuint m_copyWriteBuffer;
@@ -47,6 +47,7 @@ public:
     void setDrawCallFlushInterval(uint32_t) { }
     void setHasAsyncUnmapBuffer(int) { }
     void setHasSyncBufferData(int) { }
+    void setHasClientArrayCache(int) { }
 };
 #else
 #include "GLEncoder.h"
@@ -95,28 +96,11 @@ static HostConnectionType getConnectionTypeFromProperty(enum VirtGpuCapset capse
 #endif
     }
 
-    if (transport == "asg") {
-        return HOST_CONNECTION_ADDRESS_SPACE;
-    }
-    if (transport == "pipe") {
-        return HOST_CONNECTION_QEMU_PIPE;
-    }
-
-    if (transport == "virtio-gpu-asg" || transport == "virtio-gpu-pipe") {
-        std::string egl;
+    std::string egl;
 #if defined(__ANDROID__)
-        egl = android::base::GetProperty(kEglProp, "");
+    egl = android::base::GetProperty(kEglProp, "");
 #endif
-        // ANGLE doesn't work well without ASG, particularly if HostComposer uses a pipe
-        // transport and VK uses ASG.
-        if (capset == kCapsetGfxStreamVulkan || egl == "angle") {
-            return HOST_CONNECTION_VIRTIO_GPU_ADDRESS_SPACE;
-        } else {
-            return HOST_CONNECTION_VIRTIO_GPU_PIPE;
-        }
-    }
-
-    return HOST_CONNECTION_QEMU_PIPE;
+    return getConnectionTypeForTransport(transport, capset, egl);
 #endif
 }
 
@@ -318,6 +302,7 @@ GL2Encoder *HostConnection::gl2Encoder()
             getDrawCallFlushIntervalFromProperty());
         m_gl2Enc->setHasAsyncUnmapBuffer(m_rcEnc->hasAsyncUnmapBuffer());
         m_gl2Enc->setHasSyncBufferData(m_rcEnc->hasSyncBufferData());
+        m_gl2Enc->setHasClientArrayCache(m_rcEnc->hasClientArrayCache());
     }
     return m_gl2Enc.get();
 }
@@ -357,6 +342,7 @@ ExtendedRCEncoderContext *HostConnection::rcEncoder()
         rcEnc->queryAndSetReadColorBufferDma();
         rcEnc->queryAndSetHWCMultiConfigs();
         rcEnc->queryAndSetVulkanAuxCommandBufferMemory();
+        rcEnc->queryAndSetClientArrayCache();
         rcEnc->queryVersion();
 
         rcEnc->rcSetPuid(rcEnc, getPuid());
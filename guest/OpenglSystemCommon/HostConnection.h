@@ -28,6 +28,7 @@
 #include <string>
 
 #include "ExtendedRenderControl.h"
+#include "HostConnectionType.h"
 #include "Sync.h"
 #include "VirtGpu.h"
 
@@ -38,13 +39,6 @@ struct gl2_client_context_t;
 
 struct EGLThreadInfo;
 
-enum HostConnectionType {
-    HOST_CONNECTION_QEMU_PIPE = 1,
-    HOST_CONNECTION_ADDRESS_SPACE = 2,
-    HOST_CONNECTION_VIRTIO_GPU_PIPE = 3,
-    HOST_CONNECTION_VIRTIO_GPU_ADDRESS_SPACE = 4,
-};
-
 class HostConnection
 {
 public:
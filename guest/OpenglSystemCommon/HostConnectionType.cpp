@@ -0,0 +1,43 @@
+//
+// Copyright (C) 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "HostConnectionType.h"
+
+HostConnectionType getConnectionTypeForTransport(const std::string& transport,
+                                                 enum VirtGpuCapset capset,
+                                                 const std::string& egl) {
+    if (transport == "asg") {
+        return HOST_CONNECTION_ADDRESS_SPACE;
+    }
+    if (transport == "pipe") {
+        return HOST_CONNECTION_QEMU_PIPE;
+    }
+
+    if (transport == "virtio-gpu-asg-gles") {
+        return HOST_CONNECTION_VIRTIO_GPU_ADDRESS_SPACE;
+    }
+
+    if (transport == "virtio-gpu-asg" || transport == "virtio-gpu-pipe") {
+        // ANGLE doesn't work well without ASG, particularly if HostComposer uses a pipe
+        // transport and VK uses ASG.
+        if (capset == kCapsetGfxStreamVulkan || egl == "angle") {
+            return HOST_CONNECTION_VIRTIO_GPU_ADDRESS_SPACE;
+        } else {
+            return HOST_CONNECTION_VIRTIO_GPU_PIPE;
+        }
+    }
+
+    return HOST_CONNECTION_QEMU_PIPE;
+}
@@ -0,0 +1,38 @@
+//
+// Copyright (C) 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#pragma once
+
+#include <string>
+
+#include "VirtGpu.h"
+
+enum HostConnectionType {
+    HOST_CONNECTION_QEMU_PIPE = 1,
+    HOST_CONNECTION_ADDRESS_SPACE = 2,
+    HOST_CONNECTION_VIRTIO_GPU_PIPE = 3,
+    HOST_CONNECTION_VIRTIO_GPU_ADDRESS_SPACE = 4,
+};
+
+// Returns the connection type for a non empty "ro.boot.hardware.gltransport"
+// (or GFXSTREAM_TRANSPORT) value. |egl| is the "ro.hardware.egl" value.
+//
+// "virtio-gpu-asg" and "virtio-gpu-pipe" only use the address space graphics
+// ring for Vulkan and ANGLE. "virtio-gpu-asg-gles" also uses it for GLES, so
+// that the encoders write straight into the ring blob instead of copying each
+// flush into a transfer.
+HostConnectionType getConnectionTypeForTransport(const std::string& transport,
+                                                 enum VirtGpuCapset capset,
+                                                 const std::string& egl);
@@ -0,0 +1,59 @@
+// Copyright (C) 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "HostConnectionType.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+TEST(HostConnectionTypeTest, VirtioGpuTransportsKeepGlesOnPipe) {
+    for (const char* transport : {"virtio-gpu-asg", "virtio-gpu-pipe"}) {
+        EXPECT_EQ(HOST_CONNECTION_VIRTIO_GPU_PIPE,
+                  getConnectionTypeForTransport(transport, kCapsetNone, ""))
+            << transport;
+        EXPECT_EQ(HOST_CONNECTION_VIRTIO_GPU_PIPE,
+                  getConnectionTypeForTransport(transport, kCapsetGfxStreamGles, "emulation"))
+            << transport;
+    }
+}
+
+TEST(HostConnectionTypeTest, VirtioGpuTransportsUseAsgForVulkanAndAngle) {
+    for (const char* transport : {"virtio-gpu-asg", "virtio-gpu-pipe"}) {
+        EXPECT_EQ(HOST_CONNECTION_VIRTIO_GPU_ADDRESS_SPACE,
+                  getConnectionTypeForTransport(transport, kCapsetGfxStreamVulkan, ""))
+            << transport;
+        EXPECT_EQ(HOST_CONNECTION_VIRTIO_GPU_ADDRESS_SPACE,
+                  getConnectionTypeForTransport(transport, kCapsetNone, "angle"))
+            << transport;
+    }
+}
+
+TEST(HostConnectionTypeTest, VirtioGpuAsgGlesUsesAsgForGles) {
+    EXPECT_EQ(HOST_CONNECTION_VIRTIO_GPU_ADDRESS_SPACE,
+              getConnectionTypeForTransport("virtio-gpu-asg-gles", kCapsetNone, ""));
+    EXPECT_EQ(HOST_CONNECTION_VIRTIO_GPU_ADDRESS_SPACE,
+              getConnectionTypeForTransport("virtio-gpu-asg-gles", kCapsetGfxStreamGles, ""));
+    EXPECT_EQ(HOST_CONNECTION_VIRTIO_GPU_ADDRESS_SPACE,
+              getConnectionTypeForTransport("virtio-gpu-asg-gles", kCapsetGfxStreamVulkan, ""));
+}
+
+TEST(HostConnectionTypeTest, GoldfishTransports) {
+    EXPECT_EQ(HOST_CONNECTION_ADDRESS_SPACE, getConnectionTypeForTransport("asg", kCapsetNone, ""));
+    EXPECT_EQ(HOST_CONNECTION_QEMU_PIPE, getConnectionTypeForTransport("pipe", kCapsetNone, ""));
+    EXPECT_EQ(HOST_CONNECTION_QEMU_PIPE,
+              getConnectionTypeForTransport("unknown", kCapsetGfxStreamVulkan, ""));
+}
+
+}  // namespace
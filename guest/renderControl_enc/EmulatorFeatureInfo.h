@@ -144,6 +144,9 @@ static const char kHWCMultiConfigs[] = "ANDROID_EMU_hwc_multi_configs";
 // Vulkan auxiliary command memory
 static const char kVulkanAuxCommandMemory[] = "ANDROID_EMU_vulkan_aux_command_memory";
 
+// Client vertex arrays cached by the host
+static const char kClientArrayCache[] = "ANDROID_EMU_client_array_cache";
+
 // Struct describing available emulator features
 struct EmulatorFeatureInfo {
 
@@ -174,7 +177,8 @@ struct EmulatorFeatureInfo {
         hasVulkanAsyncQsri(false),
         hasReadColorBufferDma(false),
         hasHWCMultiConfigs(false),
-        hasVulkanAuxCommandMemory(false)
+        hasVulkanAuxCommandMemory(false),
+        hasClientArrayCache(false)
     { }
 
     SyncImpl syncImpl;
@@ -204,6 +208,7 @@ struct EmulatorFeatureInfo {
     bool hasReadColorBufferDma;
     bool hasHWCMultiConfigs;
     bool hasVulkanAuxCommandMemory; // This feature tracks if vulkan command buffers should be stored in an auxiliary shared memory
+    bool hasClientArrayCache;
 };
 
 // This should be ABI identical with the variant in ResourceTracker.h
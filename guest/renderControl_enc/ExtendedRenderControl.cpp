@@ -291,6 +291,13 @@ void ExtendedRCEncoderContext::queryAndSetVulkanAuxCommandBufferMemory() {
         hostExtensions.find(kVulkanAuxCommandMemory) != std::string::npos;
 }
 
+void ExtendedRCEncoderContext::queryAndSetClientArrayCache() {
+    std::string hostExtensions = queryHostExtensions();
+    if (hostExtensions.find(kClientArrayCache) != std::string::npos) {
+        this->featureInfo()->hasClientArrayCache = true;
+    }
+}
+
 GLint ExtendedRCEncoderContext::queryVersion() {
     GLint version = this->rcGetRendererVersion(this);
     return version;
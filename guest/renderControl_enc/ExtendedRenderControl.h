@@ -52,6 +52,7 @@ class ExtendedRCEncoderContext : public renderControl_encoder_context_t {
     bool hasAsyncFrameCommands() const { return m_featureInfo.hasAsyncFrameCommands; }
     bool hasSyncBufferData() const { return m_featureInfo.hasSyncBufferData; }
     bool hasHWCMultiConfigs() const { return m_featureInfo.hasHWCMultiConfigs; }
+    bool hasClientArrayCache() const { return m_featureInfo.hasClientArrayCache; }
     void bindDmaDirectly(void* dmaPtr, uint64_t dmaPhysAddr) {
         m_dmaPtr = dmaPtr;
         m_dmaPhysAddr = dmaPhysAddr;
@@ -96,6 +97,7 @@ class ExtendedRCEncoderContext : public renderControl_encoder_context_t {
     void queryAndSetReadColorBufferDma();
     void queryAndSetHWCMultiConfigs();
     void queryAndSetVulkanAuxCommandBufferMemory();
+    void queryAndSetClientArrayCache();
     GLint queryVersion();
     void setVulkanFeatureInfo(void* info);
 
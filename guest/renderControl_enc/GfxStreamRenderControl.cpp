@@ -52,7 +52,8 @@ GfxStreamTransportType renderControlGetTransport() {
         return GFXSTREAM_TRANSPORT_QEMU_PIPE;
     }
 
-    if (transport == "virtio-gpu-asg" || transport == "virtio-gpu-pipe") {
+    if (transport == "virtio-gpu-asg" || transport == "virtio-gpu-asg-gles" ||
+        transport == "virtio-gpu-pipe") {
         std::string egl;
 #if defined(__ANDROID__)
         egl = android::base::GetProperty(kEglProp, "");
@@ -117,6 +118,7 @@ int32_t renderControlInit(GfxStreamConnectionManager* mgr, void* vkInfo) {
         rcEnc->queryAndSetReadColorBufferDma();
         rcEnc->queryAndSetHWCMultiConfigs();
         rcEnc->queryAndSetVulkanAuxCommandBufferMemory();
+        rcEnc->queryAndSetClientArrayCache();
         rcEnc->queryVersion();
 
         rcEnc->rcSetPuid(rcEnc, puid);
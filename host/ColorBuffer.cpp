@@ -14,11 +14,16 @@
 
 #include "ColorBuffer.h"
 
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
 #if GFXSTREAM_ENABLE_HOST_GLES
 #include "EmulationGl.h"
 #endif
 #include "FrameBuffer.h"
 #include "gfxstream/common/logging.h"
+#include "gfxstream/system/System.h"
 #include "vulkan/ColorBufferVk.h"
 #include "vulkan/VkCommonOperations.h"
 
@@ -51,6 +56,12 @@ class ColorBuffer::Impl : public LazySnapshotObj<ColorBuffer::Impl> {
 
     void onSave(gfxstream::Stream* stream);
     void restore();
+    bool onEvict(uint64_t minIdleUs);
+
+    uint64_t getLastUseUs() const { return mLastUseUs; }
+    uint64_t getSize() const { return mSize; }
+    bool isEvicted() const { return mEvicted; }
+    bool isEvictable() const { return mEvicted || (mEvictableBacking && !mMayBeShared); }
 
     HandleType getHndl() const { return mHandle; }
     uint32_t getWidth() const { return mWidth; }
@@ -72,10 +83,21 @@ class ColorBuffer::Impl : public LazySnapshotObj<ColorBuffer::Impl> {
                          void* metadata = nullptr);
     bool updateGlFromBytes(const void* bytes, std::size_t bytesSize);
 
+    std::optional<AsyncReadback> startReadToBytesAsync(int x, int y, int width, int height,
+                                                       GLenum pixelsFormat, GLenum pixelsType);
+    std::optional<AsyncReadback> startReadYuvToBytesAsync(int x, int y, int width, int height);
+    bool waitReadToBytesAsync(const AsyncReadback& readback);
+    bool finishReadToBytesAsync(const AsyncReadback& readback, void* outPixels,
+                                uint64_t outPixelsSize);
+    void cancelReadToBytesAsync(const AsyncReadback& readback);
+    std::optional<AsyncReadback> startReadVkToBytesAsync(int x, int y, int width, int height);
+
     std::unique_ptr<BorrowedImageInfo> borrowForComposition(UsedApi api, bool isTarget);
     std::unique_ptr<BorrowedImageInfo> borrowForDisplay(UsedApi api);
 
     bool flushFromGl();
+    // Like flushFromGl() but only the given region of the GL backing changed.
+    bool flushFromGl(int x, int y, int width, int height);
     bool flushFromVk();
     bool flushFromVkBytes(const void* bytes, size_t bytesSize);
     bool invalidateForGl();
@@ -95,7 +117,7 @@ class ColorBuffer::Impl : public LazySnapshotObj<ColorBuffer::Impl> {
     void glOpSwapYuvTexturesAndUpdate(GLenum format, GLenum type, FrameworkFormat frameworkFormat,
                                       GLuint* textures);
     bool glOpReadContents(size_t* outNumBytes, void* outContents);
-    bool glOpIsFastBlitSupported() const;
+    bool glOpIsFastBlitSupported();
     void glOpPostLayer(const ComposeLayer& l, int frameWidth, int frameHeight);
     void glOpPostViewportScaledWithOverlay(float rotation, float dx, float dy);
 #endif
@@ -104,6 +126,12 @@ class ColorBuffer::Impl : public LazySnapshotObj<ColorBuffer::Impl> {
     Impl(HandleType, uint32_t width, uint32_t height, GLenum format,
          FrameworkFormat frameworkFormat);
 
+    // Restores the ColorBuffer if it was evicted and marks it as used.
+    void use();
+    // Like use() but for operations that let the guest or another API alias the
+    // backing, after which it can no longer be evicted.
+    void useShared();
+
     const HandleType mHandle;
     const uint32_t mWidth;
     const uint32_t mHeight;
@@ -119,7 +147,25 @@ class ColorBuffer::Impl : public LazySnapshotObj<ColorBuffer::Impl> {
     std::unique_ptr<ColorBufferVk> mColorBufferVk;
 
     bool mGlAndVkAreSharingExternalMemory = false;
-    bool mGlTexDirty = false;
+
+    // Bounding box of the GL backing changes that the VK backing has not seen yet.
+    std::optional<Rect> mGlDirtyRect;
+
+    // Reused across syncs between the GL and VK backings so that they do not allocate.
+    std::vector<uint8_t> mSyncBytes;
+
+#if GFXSTREAM_ENABLE_HOST_GLES
+    gl::EmulationGl* mEmulationGl = nullptr;
+#endif
+    uint64_t mSize = 0;
+    // Only GL backings that nothing else can alias are released. EGLImage siblings and VK
+    // imports would keep the memory alive, and YUV formats do not read back losslessly.
+    bool mEvictableBacking = false;
+    std::atomic<uint64_t> mLastUseUs{0};
+    std::atomic<bool> mMayBeShared{false};
+    std::atomic<bool> mEvicted{false};
+    // The contents of the GL backing while it is released by onEvict().
+    std::vector<uint8_t> mEvictedContents;
 };
 
 ColorBuffer::Impl::Impl(HandleType handle, uint32_t width, uint32_t height, GLenum format,
@@ -128,7 +174,8 @@ ColorBuffer::Impl::Impl(HandleType handle, uint32_t width, uint32_t height, GLen
       mWidth(width),
       mHeight(height),
       mFormat(format),
-      mFrameworkFormat(frameworkFormat) {}
+      mFrameworkFormat(frameworkFormat),
+      mLastUseUs(gfxstream::base::getUnixTimeUs()) {}
 
 /*static*/
 std::unique_ptr<ColorBuffer::Impl> ColorBuffer::Impl::create(
@@ -143,6 +190,7 @@ std::unique_ptr<ColorBuffer::Impl> ColorBuffer::Impl::create(
 
 #if GFXSTREAM_ENABLE_HOST_GLES
     if (emulationGl) {
+        colorBuffer->mEmulationGl = emulationGl;
         if (stream) {
             colorBuffer->mColorBufferGl = emulationGl->loadColorBuffer(stream);
             assert(width == colorBuffer->mColorBufferGl->getWidth());
@@ -156,6 +204,10 @@ std::unique_ptr<ColorBuffer::Impl> ColorBuffer::Impl::create(
             GFXSTREAM_ERROR("Failed to initialize ColorBufferGl.");
             return nullptr;
         }
+        size_t contentsSize = 0;
+        if (colorBuffer->mColorBufferGl->readContents(&contentsSize, nullptr)) {
+            colorBuffer->mSize = contentsSize;
+        }
     }
 #endif
 
@@ -196,6 +248,12 @@ std::unique_ptr<ColorBuffer::Impl> ColorBuffer::Impl::create(
     }
 #endif
 
+#if GFXSTREAM_ENABLE_HOST_GLES
+    colorBuffer->mEvictableBacking =
+        colorBuffer->mColorBufferGl && !colorBuffer->mColorBufferVk && colorBuffer->mSize &&
+        frameworkFormat == FrameworkFormat::FRAMEWORK_FORMAT_GL_COMPATIBLE;
+#endif
+
     return colorBuffer;
 }
 
@@ -216,6 +274,13 @@ std::unique_ptr<ColorBuffer::Impl> ColorBuffer::Impl::onLoad(gl::EmulationGl* em
 }
 
 void ColorBuffer::Impl::onSave(gfxstream::Stream* stream) {
+    if (mEvicted) {
+        touch();
+        if (mEvicted) {
+            GFXSTREAM_FATAL("Failed to restore evicted ColorBuffer:%d to save it", mHandle);
+        }
+    }
+
     stream->putBe32(getHndl());
     stream->putBe32(mWidth);
     stream->putBe32(mHeight);
@@ -234,15 +299,74 @@ void ColorBuffer::Impl::onSave(gfxstream::Stream* stream) {
 
 void ColorBuffer::Impl::restore() {
 #if GFXSTREAM_ENABLE_HOST_GLES
+    if (mEvicted) {
+        mColorBufferGl = mEmulationGl->createColorBuffer(mWidth, mHeight, mFormat,
+                                                         mFrameworkFormat, mHandle);
+        if (!mColorBufferGl) {
+            // Keeps the contents so that the next use tries again.
+            GFXSTREAM_ERROR("Failed to recreate evicted ColorBuffer:%d", mHandle);
+            mNeedRestore = true;
+            return;
+        }
+        if (!mColorBufferGl->replaceContents(mEvictedContents.data(), mEvictedContents.size())) {
+            GFXSTREAM_ERROR("Failed to restore contents of evicted ColorBuffer:%d", mHandle);
+        }
+        std::vector<uint8_t>().swap(mEvictedContents);
+        mEvicted = false;
+        return;
+    }
     if (mColorBufferGl) {
         mColorBufferGl->restore();
     }
 #endif
 }
 
+bool ColorBuffer::Impl::onEvict(uint64_t minIdleUs) {
+#if GFXSTREAM_ENABLE_HOST_GLES
+    if (!mEvictableBacking || mMayBeShared || !mColorBufferGl) {
+        return false;
+    }
+
+    // Checked under the lock of touch() so that a concurrent use() either sees the
+    // ColorBuffer evicted and restores it, or stops the eviction.
+    const uint64_t lastUseUs = mLastUseUs;
+    if (gfxstream::base::getUnixTimeUs() < lastUseUs + minIdleUs) {
+        return false;
+    }
+
+    size_t contentsSize = 0;
+    if (!mColorBufferGl->readContents(&contentsSize, nullptr)) {
+        return false;
+    }
+    mEvictedContents.resize(contentsSize);
+    if (!mColorBufferGl->readContents(&contentsSize, mEvictedContents.data())) {
+        GFXSTREAM_ERROR("Failed to read contents to evict ColorBuffer:%d", mHandle);
+        std::vector<uint8_t>().swap(mEvictedContents);
+        return false;
+    }
+
+    mColorBufferGl.reset();
+    mEvicted = true;
+    return true;
+#else
+    (void)minIdleUs;
+    return false;
+#endif
+}
+
+void ColorBuffer::Impl::use() {
+    mLastUseUs = gfxstream::base::getUnixTimeUs();
+    touch();
+}
+
+void ColorBuffer::Impl::useShared() {
+    mMayBeShared = true;
+    use();
+}
+
 void ColorBuffer::Impl::readToBytes(int x, int y, int width, int height, GLenum pixelsFormat,
                                     GLenum pixelsType, void* outPixels, uint64_t outPixelsSize) {
-    touch();
+    use();
 
 #if GFXSTREAM_ENABLE_HOST_GLES
     if (mColorBufferGl) {
@@ -259,10 +383,67 @@ void ColorBuffer::Impl::readToBytes(int x, int y, int width, int height, GLenum
     GFXSTREAM_FATAL("No ColorBuffer impl");
 }
 
+std::optional<ColorBuffer::AsyncReadback> ColorBuffer::Impl::startReadToBytesAsync(
+    int x, int y, int width, int height, GLenum pixelsFormat, GLenum pixelsType) {
+    (void)pixelsFormat;
+    (void)pixelsType;
+    return startReadVkToBytesAsync(x, y, width, height);
+}
+
+std::optional<ColorBuffer::AsyncReadback> ColorBuffer::Impl::startReadYuvToBytesAsync(
+    int x, int y, int width, int height) {
+    return startReadVkToBytesAsync(x, y, width, height);
+}
+
+std::optional<ColorBuffer::AsyncReadback> ColorBuffer::Impl::startReadVkToBytesAsync(int x, int y,
+                                                                                     int width,
+                                                                                     int height) {
+    use();
+
+#if GFXSTREAM_ENABLE_HOST_GLES
+    if (mColorBufferGl) {
+        // The GL backing is read back synchronously: the translator holds its
+        // global lock while waiting on a fence, so an asynchronous GL readback
+        // would not let other render threads run any sooner.
+        return std::nullopt;
+    }
+#endif
+
+    if (!mColorBufferVk) {
+        return std::nullopt;
+    }
+
+    AsyncReadback readback;
+    if (!mColorBufferVk->startReadToBytes(x, y, width, height, &readback.slot, &readback.size)) {
+        return std::nullopt;
+    }
+    return readback;
+}
+
+bool ColorBuffer::Impl::waitReadToBytesAsync(const AsyncReadback& readback) {
+    use();
+
+    return mColorBufferVk->waitReadToBytes(readback.slot, readback.size);
+}
+
+bool ColorBuffer::Impl::finishReadToBytesAsync(const AsyncReadback& readback, void* outPixels,
+                                               uint64_t outPixelsSize) {
+    use();
+
+    return mColorBufferVk->finishReadToBytes(readback.slot, readback.size, outPixels,
+                                             outPixelsSize);
+}
+
+void ColorBuffer::Impl::cancelReadToBytesAsync(const AsyncReadback& readback) {
+    use();
+
+    mColorBufferVk->cancelReadToBytes(readback.slot, readback.size);
+}
+
 void ColorBuffer::Impl::readToBytesScaled(int pixelsWidth, int pixelsHeight, GLenum pixelsFormat,
                                           GLenum pixelsType, int pixelsRotation, Rect rect,
                                           void* outPixels) {
-    touch();
+    use();
 
 #if GFXSTREAM_ENABLE_HOST_GLES
     if (mColorBufferGl) {
@@ -277,7 +458,7 @@ void ColorBuffer::Impl::readToBytesScaled(int pixelsWidth, int pixelsHeight, GLe
 
 void ColorBuffer::Impl::readYuvToBytes(int x, int y, int width, int height, void* outPixels,
                                        uint32_t outPixelsSize) {
-    touch();
+    use();
 
 #if GFXSTREAM_ENABLE_HOST_GLES
     if (mColorBufferGl) {
@@ -297,13 +478,13 @@ void ColorBuffer::Impl::readYuvToBytes(int x, int y, int width, int height, void
 bool ColorBuffer::Impl::updateFromBytes(int x, int y, int width, int height,
                                         FrameworkFormat frameworkFormat, GLenum pixelsFormat,
                                         GLenum pixelsType, const void* pixels, void* metadata) {
-    touch();
+    use();
 
 #if GFXSTREAM_ENABLE_HOST_GLES
     if (mColorBufferGl) {
         mColorBufferGl->subUpdateFromFrameworkFormat(x, y, width, height, frameworkFormat,
                                                      pixelsFormat, pixelsType, pixels, metadata);
-        flushFromGl();
+        flushFromGl(x, y, width, height);
         return true;
     }
 #endif
@@ -321,13 +502,13 @@ bool ColorBuffer::Impl::updateFromBytes(int x, int y, int width, int height,
 
 bool ColorBuffer::Impl::updateFromBytes(int x, int y, int width, int height, GLenum pixelsFormat,
                                         GLenum pixelsType, const void* pixels) {
-    touch();
+    use();
 
 #if GFXSTREAM_ENABLE_HOST_GLES
     if (mColorBufferGl) {
         bool res = mColorBufferGl->subUpdate(x, y, width, height, pixelsFormat, pixelsType, pixels);
         if (res) {
-            flushFromGl();
+            flushFromGl(x, y, width, height);
         }
         return res;
     }
@@ -342,10 +523,10 @@ bool ColorBuffer::Impl::updateFromBytes(int x, int y, int width, int height, GLe
 }
 
 bool ColorBuffer::Impl::updateGlFromBytes(const void* bytes, std::size_t bytesSize) {
+    use();
+
 #if GFXSTREAM_ENABLE_HOST_GLES
     if (mColorBufferGl) {
-        touch();
-
         return mColorBufferGl->replaceContents(bytes, bytesSize);
     }
 #endif
@@ -355,6 +536,8 @@ bool ColorBuffer::Impl::updateGlFromBytes(const void* bytes, std::size_t bytesSi
 
 std::unique_ptr<BorrowedImageInfo> ColorBuffer::Impl::borrowForComposition(UsedApi api,
                                                                            bool isTarget) {
+    use();
+
     switch (api) {
         case UsedApi::kGl: {
 #if GFXSTREAM_ENABLE_HOST_GLES
@@ -376,6 +559,8 @@ std::unique_ptr<BorrowedImageInfo> ColorBuffer::Impl::borrowForComposition(UsedA
 }
 
 std::unique_ptr<BorrowedImageInfo> ColorBuffer::Impl::borrowForDisplay(UsedApi api) {
+    use();
+
     switch (api) {
         case UsedApi::kGl: {
 #if GFXSTREAM_ENABLE_HOST_GLES
@@ -397,6 +582,12 @@ std::unique_ptr<BorrowedImageInfo> ColorBuffer::Impl::borrowForDisplay(UsedApi a
 }
 
 bool ColorBuffer::Impl::flushFromGl() {
+    return flushFromGl(0, 0, static_cast<int>(mWidth), static_cast<int>(mHeight));
+}
+
+bool ColorBuffer::Impl::flushFromGl(int x, int y, int width, int height) {
+    use();
+
     if (!(mColorBufferGl && mColorBufferVk)) {
         return true;
     }
@@ -407,11 +598,26 @@ bool ColorBuffer::Impl::flushFromGl() {
 
     // ColorBufferGl is currently considered the "main" backing. If this changes,
     // the "main"  should be updated from the current contents of the GL backing.
-    mGlTexDirty = true;
+    x = std::clamp(x, 0, static_cast<int>(mWidth));
+    y = std::clamp(y, 0, static_cast<int>(mHeight));
+    int right = std::clamp(x + width, x, static_cast<int>(mWidth));
+    int bottom = std::clamp(y + height, y, static_cast<int>(mHeight));
+    if (right == x || bottom == y) {
+        return true;
+    }
+    if (mGlDirtyRect) {
+        right = std::max(right, mGlDirtyRect->pos.x + mGlDirtyRect->size.w);
+        bottom = std::max(bottom, mGlDirtyRect->pos.y + mGlDirtyRect->size.h);
+        x = std::min(x, mGlDirtyRect->pos.x);
+        y = std::min(y, mGlDirtyRect->pos.y);
+    }
+    mGlDirtyRect = Rect{{x, y}, {right - x, bottom - y}};
     return true;
 }
 
 bool ColorBuffer::Impl::flushFromVk() {
+    use();
+
     if (!(mColorBufferGl && mColorBufferVk)) {
         return true;
     }
@@ -419,27 +625,28 @@ bool ColorBuffer::Impl::flushFromVk() {
     if (mGlAndVkAreSharingExternalMemory) {
         return true;
     }
-    std::vector<uint8_t> contents;
-    if (!mColorBufferVk->readToBytes(&contents)) {
+    if (!mColorBufferVk->readToBytes(&mSyncBytes)) {
         GFXSTREAM_ERROR("Failed to get VK contents for ColorBuffer:%d", mHandle);
         return false;
     }
 
-    if (contents.empty()) {
+    if (mSyncBytes.empty()) {
         return false;
     }
 
 #if GFXSTREAM_ENABLE_HOST_GLES
-    if (!mColorBufferGl->replaceContents(contents.data(), contents.size())) {
+    if (!mColorBufferGl->replaceContents(mSyncBytes.data(), mSyncBytes.size())) {
         GFXSTREAM_ERROR("Failed to set GL contents for ColorBuffer:%d", mHandle);
         return false;
     }
 #endif
-    mGlTexDirty = false;
+    mGlDirtyRect.reset();
     return true;
 }
 
 bool ColorBuffer::Impl::flushFromVkBytes(const void* bytes, size_t bytesSize) {
+    use();
+
     if (!(mColorBufferGl && mColorBufferVk)) {
         return true;
     }
@@ -456,11 +663,13 @@ bool ColorBuffer::Impl::flushFromVkBytes(const void* bytes, size_t bytesSize) {
         }
     }
 #endif
-    mGlTexDirty = false;
+    mGlDirtyRect.reset();
     return true;
 }
 
 bool ColorBuffer::Impl::invalidateForGl() {
+    use();
+
     if (!(mColorBufferGl && mColorBufferVk)) {
         return true;
     }
@@ -475,6 +684,8 @@ bool ColorBuffer::Impl::invalidateForGl() {
 }
 
 bool ColorBuffer::Impl::invalidateForVk() {
+    use();
+
     if (!(mColorBufferGl && mColorBufferVk)) {
         return true;
     }
@@ -483,34 +694,53 @@ bool ColorBuffer::Impl::invalidateForVk() {
         return true;
     }
 
-    if (!mGlTexDirty) {
+    if (!mGlDirtyRect) {
         return true;
     }
 
 #if GFXSTREAM_ENABLE_HOST_GLES
+    // Only move the changed region when possible. The VK side rejects the subrect if its
+    // format or layout can not take one, in which case the whole image is synced instead.
+    const Rect dirty = *mGlDirtyRect;
+    const bool isSubrect = dirty.size.w != static_cast<int>(mWidth) ||
+                           dirty.size.h != static_cast<int>(mHeight);
     std::size_t contentsSize = 0;
+    if (isSubrect && mColorBufferGl->readContents(dirty.pos.x, dirty.pos.y, dirty.size.w,
+                                                  dirty.size.h, &contentsSize, nullptr)) {
+        mSyncBytes.resize(contentsSize);
+        if (mColorBufferGl->readContents(dirty.pos.x, dirty.pos.y, dirty.size.w, dirty.size.h,
+                                         &contentsSize, mSyncBytes.data()) &&
+            mColorBufferVk->updateFromBytes(dirty.pos.x, dirty.pos.y, dirty.size.w, dirty.size.h,
+                                            mSyncBytes.data())) {
+            mGlDirtyRect.reset();
+            return true;
+        }
+    }
+
     if (!mColorBufferGl->readContents(&contentsSize, nullptr)) {
         GFXSTREAM_ERROR("Failed to get GL contents size for ColorBuffer:%d", mHandle);
         return false;
     }
 
-    std::vector<uint8_t> contents(contentsSize, 0);
+    mSyncBytes.resize(contentsSize);
 
-    if (!mColorBufferGl->readContents(&contentsSize, contents.data())) {
+    if (!mColorBufferGl->readContents(&contentsSize, mSyncBytes.data())) {
         GFXSTREAM_ERROR("Failed to get GL contents for ColorBuffer:%d", mHandle);
         return false;
     }
 
-    if (!mColorBufferVk->updateFromBytes(contents)) {
+    if (!mColorBufferVk->updateFromBytes(mSyncBytes)) {
         GFXSTREAM_ERROR("Failed to set VK contents for ColorBuffer:%d", mHandle);
         return false;
     }
 #endif
-    mGlTexDirty = false;
+    mGlDirtyRect.reset();
     return true;
 }
 
 std::optional<BlobDescriptorInfo> ColorBuffer::Impl::exportBlob() {
+    useShared();
+
     if (!mColorBufferVk) {
         return std::nullopt;
     }
@@ -520,26 +750,28 @@ std::optional<BlobDescriptorInfo> ColorBuffer::Impl::exportBlob() {
 
 #if GFXSTREAM_ENABLE_HOST_GLES
 bool ColorBuffer::Impl::glOpBlitFromCurrentReadBuffer() {
+    use();
+
     if (!mColorBufferGl) {
         GFXSTREAM_FATAL("ColorBufferGl not available");
     }
 
-    touch();
-
     return mColorBufferGl->blitFromCurrentReadBuffer();
 }
 
 bool ColorBuffer::Impl::glOpBindToTexture() {
+    useShared();
+
     if (!mColorBufferGl) {
         GFXSTREAM_FATAL("ColorBufferGl not available");
     }
 
-    touch();
-
     return mColorBufferGl->bindToTexture();
 }
 
 bool ColorBuffer::Impl::glOpBindToTexture2() {
+    useShared();
+
     if (!mColorBufferGl) {
         GFXSTREAM_FATAL("ColorBufferGl not available");
     }
@@ -548,46 +780,48 @@ bool ColorBuffer::Impl::glOpBindToTexture2() {
 }
 
 bool ColorBuffer::Impl::glOpBindToRenderbuffer() {
+    useShared();
+
     if (!mColorBufferGl) {
         GFXSTREAM_FATAL("ColorBufferGl not available");
     }
 
-    touch();
-
     return mColorBufferGl->bindToRenderbuffer();
 }
 
 GLuint ColorBuffer::Impl::glOpGetTexture() {
+    useShared();
+
     if (!mColorBufferGl) {
         GFXSTREAM_FATAL("ColorBufferGl not available");
     }
 
-    touch();
-
     return mColorBufferGl->getTexture();
 }
 
 void ColorBuffer::Impl::glOpReadback(unsigned char* img, bool readbackBgra) {
+    use();
+
     if (!mColorBufferGl) {
         GFXSTREAM_FATAL("ColorBufferGl not available");
     }
 
-    touch();
-
     return mColorBufferGl->readback(img, readbackBgra);
 }
 
 void ColorBuffer::Impl::glOpReadbackAsync(GLuint buffer, bool readbackBgra) {
+    use();
+
     if (!mColorBufferGl) {
         GFXSTREAM_FATAL("ColorBufferGl not available");
     }
 
-    touch();
-
     mColorBufferGl->readbackAsync(buffer, readbackBgra);
 }
 
 bool ColorBuffer::Impl::glOpImportEglNativePixmap(void* pixmap, bool preserveContent) {
+    useShared();
+
     if (!mColorBufferGl) {
         GFXSTREAM_FATAL("ColorBufferGl not available");
     }
@@ -598,6 +832,8 @@ bool ColorBuffer::Impl::glOpImportEglNativePixmap(void* pixmap, bool preserveCon
 void ColorBuffer::Impl::glOpSwapYuvTexturesAndUpdate(GLenum format, GLenum type,
                                                      FrameworkFormat frameworkFormat,
                                                      GLuint* textures) {
+    useShared();
+
     if (!mColorBufferGl) {
         GFXSTREAM_FATAL("ColorBufferGl not available");
     }
@@ -612,6 +848,8 @@ void ColorBuffer::Impl::glOpSwapYuvTexturesAndUpdate(GLenum format, GLenum type,
 }
 
 bool ColorBuffer::Impl::glOpReadContents(size_t* outNumBytes, void* outContents) {
+    use();
+
     if (!mColorBufferGl) {
         GFXSTREAM_FATAL("ColorBufferGl not available");
     }
@@ -619,7 +857,9 @@ bool ColorBuffer::Impl::glOpReadContents(size_t* outNumBytes, void* outContents)
     return mColorBufferGl->readContents(outNumBytes, outContents);
 }
 
-bool ColorBuffer::Impl::glOpIsFastBlitSupported() const {
+bool ColorBuffer::Impl::glOpIsFastBlitSupported() {
+    use();
+
     if (!mColorBufferGl) {
         GFXSTREAM_FATAL("ColorBufferGl not available");
     }
@@ -628,6 +868,8 @@ bool ColorBuffer::Impl::glOpIsFastBlitSupported() const {
 }
 
 void ColorBuffer::Impl::glOpPostLayer(const ComposeLayer& l, int frameWidth, int frameHeight) {
+    use();
+
     if (!mColorBufferGl) {
         GFXSTREAM_FATAL("ColorBufferGl not available");
     }
@@ -636,6 +878,8 @@ void ColorBuffer::Impl::glOpPostLayer(const ComposeLayer& l, int frameWidth, int
 }
 
 void ColorBuffer::Impl::glOpPostViewportScaledWithOverlay(float rotation, float dx, float dy) {
+    use();
+
     if (!mColorBufferGl) {
         GFXSTREAM_FATAL("ColorBufferGl not available");
     }
@@ -697,6 +941,30 @@ void ColorBuffer::readToBytes(int x, int y, int width, int height, GLenum pixels
     mImpl->readToBytes(x, y, width, height, pixelsFormat, pixelsType, outPixels, outPixelsSize);
 }
 
+std::optional<ColorBuffer::AsyncReadback> ColorBuffer::startReadToBytesAsync(
+    int x, int y, int width, int height, GLenum pixelsFormat, GLenum pixelsType) {
+    return mImpl->startReadToBytesAsync(x, y, width, height, pixelsFormat, pixelsType);
+}
+
+std::optional<ColorBuffer::AsyncReadback> ColorBuffer::startReadYuvToBytesAsync(int x, int y,
+                                                                                int width,
+                                                                                int height) {
+    return mImpl->startReadYuvToBytesAsync(x, y, width, height);
+}
+
+bool ColorBuffer::waitReadToBytesAsync(const AsyncReadback& readback) {
+    return mImpl->waitReadToBytesAsync(readback);
+}
+
+bool ColorBuffer::finishReadToBytesAsync(const AsyncReadback& readback, void* outPixels,
+                                         uint64_t outPixelsSize) {
+    return mImpl->finishReadToBytesAsync(readback, outPixels, outPixelsSize);
+}
+
+void ColorBuffer::cancelReadToBytesAsync(const AsyncReadback& readback) {
+    mImpl->cancelReadToBytesAsync(readback);
+}
+
 void ColorBuffer::readToBytesScaled(int pixelsWidth, int pixelsHeight, GLenum pixelsFormat,
                                     GLenum pixelsType, int pixelsRotation, Rect rect,
                                     void* outPixels) {
@@ -747,6 +1015,16 @@ bool ColorBuffer::invalidateForVk() { return mImpl->invalidateForVk(); }
 
 std::optional<BlobDescriptorInfo> ColorBuffer::exportBlob() { return mImpl->exportBlob(); }
 
+uint64_t ColorBuffer::getLastUseUs() const { return mImpl->getLastUseUs(); }
+
+uint64_t ColorBuffer::getSize() const { return mImpl->getSize(); }
+
+bool ColorBuffer::isEvicted() const { return mImpl->isEvicted(); }
+
+bool ColorBuffer::isEvictable() const { return mImpl->isEvictable(); }
+
+bool ColorBuffer::evict(uint64_t minIdleUs) { return mImpl->evict(minIdleUs); }
+
 #if GFXSTREAM_ENABLE_HOST_GLES
 GLuint ColorBuffer::glOpGetTexture() { return mImpl->glOpGetTexture(); }
 
@@ -17,6 +17,7 @@
 #include <GLES3/gl3.h>
 
 #include <memory>
+#include <optional>
 
 #include "FrameworkFormats.h"
 #include "Handle.h"
@@ -78,6 +79,27 @@ class ColorBuffer : public LazySnapshotObj<ColorBuffer> {
         kGl,
         kVk,
     };
+
+    // Asynchronous readback of Vulkan only ColorBuffers. startReadToBytesAsync()
+    // issues the readback into a staging buffer and returns without waiting for
+    // the GPU. waitReadToBytesAsync() blocks until the pixels have landed and
+    // does not need to be serialized with other ColorBuffer operations.
+    // finishReadToBytesAsync() copies the pixels out and releases the staging
+    // buffer. Returns std::nullopt if the ColorBuffer can not be read
+    // asynchronously, in which case readToBytes() should be used instead.
+    struct AsyncReadback {
+        uint32_t slot = 0;
+        uint64_t size = 0;
+    };
+    std::optional<AsyncReadback> startReadToBytesAsync(int x, int y, int width, int height,
+                                                       GLenum pixelsFormat, GLenum pixelsType);
+    std::optional<AsyncReadback> startReadYuvToBytesAsync(int x, int y, int width, int height);
+    bool waitReadToBytesAsync(const AsyncReadback& readback);
+    bool finishReadToBytesAsync(const AsyncReadback& readback, void* outPixels,
+                                uint64_t outPixelsSize);
+    // Releases the readback without copying it out, e.g. if waiting for it failed.
+    void cancelReadToBytesAsync(const AsyncReadback& readback);
+
     std::unique_ptr<BorrowedImageInfo> borrowForComposition(UsedApi api, bool isTarget);
     std::unique_ptr<BorrowedImageInfo> borrowForDisplay(UsedApi api);
 
@@ -89,6 +111,20 @@ class ColorBuffer : public LazySnapshotObj<ColorBuffer> {
 
     std::optional<BlobDescriptorInfo> exportBlob();
 
+    // Under VRAM pressure, idle ColorBuffers may move their contents to system
+    // memory and release their GPU backing. The next use restores them.
+    uint64_t getLastUseUs() const;
+    // Size of the contents of the GL backing, which is what it holds in GPU
+    // memory, or takes in system memory while evicted. 0 if unknown.
+    uint64_t getSize() const;
+    bool isEvicted() const;
+    // Whether the ColorBuffer is evicted, or its backing could be. Only these
+    // count towards the budget of the evictions.
+    bool isEvictable() const;
+    // Returns false if the ColorBuffer was used in the last |minIdleUs| or can
+    // not be evicted, e.g. because its backing may be shared with the guest.
+    bool evict(uint64_t minIdleUs);
+
 #if GFXSTREAM_ENABLE_HOST_GLES
     GLuint glOpGetTexture();
     bool glOpBlitFromCurrentReadBuffer();
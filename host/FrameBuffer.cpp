@@ -69,6 +69,7 @@ namespace {
 using gfxstream::Stream;
 using gfxstream::base::AutoLock;
 using gfxstream::base::CreateMetricsLogger;
+using gfxstream::base::MetricEventColorBufferEviction;
 using gfxstream::base::MetricEventVulkanOutOfMemory;
 using gfxstream::base::SharedLibrary;
 using gfxstream::base::WorkerProcessingResult;
@@ -112,6 +113,10 @@ bool postOnlyOnMainThread() {
 
 static FrameBuffer* sFrameBuffer = NULL;
 
+// Defaults for the renderer parameters of the ColorBuffer eviction.
+constexpr uint64_t kDefaultColorBufferBudgetBytes = 2048ull * 1024 * 1024;
+constexpr uint64_t kDefaultColorBufferEvictionMinIdleUs = 30 * 1000 * 1000;
+
 // A condition variable needed to wait for framebuffer initialization.
 struct InitializedGlobals {
     gfxstream::base::Lock lock;
@@ -359,6 +364,9 @@ class FrameBuffer::Impl : public gfxstream::base::EventNotificationSupport<Frame
     void getCombinedDisplaySize(int* w, int* h);
 
     HandleType getLastPostedColorBuffer() { return m_lastPostedColorBuffer; }
+    FrameBuffer::ColorBufferResidency getColorBufferResidency();
+    void setColorBufferEvictionParams(std::optional<uint64_t> budgetBytes,
+                                      std::optional<uint64_t> minIdleUs);
     void asyncWaitForGpuVulkanWithCb(uint64_t deviceHandle, uint64_t fenceHandle,
                                      FenceCompletionCallback cb);
     void asyncWaitForGpuVulkanQsriWithCb(uint64_t image, FenceCompletionCallback cb);
@@ -625,6 +633,10 @@ class FrameBuffer::Impl : public gfxstream::base::EventNotificationSupport<Frame
     void recomputeLayout();
     void setDisplayPoseInSkinUI(int totalHeight);
     void sweepColorBuffersLocked();
+    // Evicts the least recently used idle ColorBuffers while the resident ones
+    // take more than |m_colorBufferBudgetBytes|.
+    void evictIdleColorBuffersLocked();
+    FrameBuffer::ColorBufferResidency getColorBufferResidencyLocked();
 
     std::future<void> blockPostWorker(std::future<void> continueSignal);
 
@@ -744,6 +756,13 @@ class FrameBuffer::Impl : public gfxstream::base::EventNotificationSupport<Frame
     // buffer is already tied to a file descriptor in the guest kernel.
     bool m_noDelayCloseColorBufferEnabled = false;
 
+    // GPU memory budget of the ColorBuffers, or 0 if ColorBuffers are never
+    // evicted.
+    uint64_t m_colorBufferBudgetBytes = 0;
+    // ColorBuffers used more recently than this are never evicted.
+    uint64_t m_colorBufferEvictionMinIdleUs = kDefaultColorBufferEvictionMinIdleUs;
+    uint64_t m_colorBufferEvictions = 0;
+
     std::unique_ptr<PostWorker> m_postWorker = {};
     std::atomic_bool m_postThreadStarted = false;
     gfxstream::base::WorkerThread<Post> m_postThread;
@@ -1187,6 +1206,10 @@ FrameBuffer::Impl::Impl(int p_width, int p_height, const gfxstream::host::Featur
       m_postThread([this](Post&& post) { return postWorkerFunc(post); }),
       m_logger(CreateMetricsLogger()),
       m_healthMonitor(CreateHealthMonitor(*m_logger)) {
+    if (features.ColorBufferEviction.enabled) {
+        m_colorBufferBudgetBytes = kDefaultColorBufferBudgetBytes;
+    }
+
     mDisplayActiveConfigId = 0;
     mDisplayConfigs[0] = {p_width, p_height, 160, 160};
     uint32_t displayId = 0;
@@ -1781,6 +1804,8 @@ HandleType FrameBuffer::Impl::createColorBufferWithResourceHandleLocked(
         }
     }
 
+    evictIdleColorBuffersLocked();
+
     return handle;
 }
 
@@ -2177,7 +2202,30 @@ void FrameBuffer::Impl::readColorBuffer(HandleType p_colorbuffer, int x, int y,
         return;
     }
 
-    colorBuffer->readToBytes(x, y, width, height, format, type, outPixels, outPixelsSize);
+    // Only issuing the readback and copying it out needs to be serialized with
+    // other ColorBuffer operations. Waiting for the GPU happens without m_lock so
+    // that other render threads are not blocked behind this readback.
+    std::optional<ColorBuffer::AsyncReadback> readback;
+    if (m_features.AsyncColorBufferReadback.enabled) {
+        readback = colorBuffer->startReadToBytesAsync(x, y, width, height, format, type);
+    }
+    if (!readback) {
+        colorBuffer->readToBytes(x, y, width, height, format, type, outPixels, outPixelsSize);
+        return;
+    }
+
+    mutex.unlock();
+    const bool waited = colorBuffer->waitReadToBytesAsync(*readback);
+    mutex.lock();
+
+    if (!waited) {
+        GFXSTREAM_ERROR("Failed to wait for the readback of ColorBuffer:%d", p_colorbuffer);
+        colorBuffer->cancelReadToBytesAsync(*readback);
+        return;
+    }
+    if (!colorBuffer->finishReadToBytesAsync(*readback, outPixels, outPixelsSize)) {
+        colorBuffer->readToBytes(x, y, width, height, format, type, outPixels, outPixelsSize);
+    }
 }
 
 void FrameBuffer::Impl::readColorBufferYUV(HandleType p_colorbuffer, int x, int y, int width,
@@ -2190,7 +2238,27 @@ void FrameBuffer::Impl::readColorBufferYUV(HandleType p_colorbuffer, int x, int
         return;
     }
 
-    colorBuffer->readYuvToBytes(x, y, width, height, outPixels, outPixelsSize);
+    std::optional<ColorBuffer::AsyncReadback> readback;
+    if (m_features.AsyncColorBufferReadback.enabled) {
+        readback = colorBuffer->startReadYuvToBytesAsync(x, y, width, height);
+    }
+    if (!readback) {
+        colorBuffer->readYuvToBytes(x, y, width, height, outPixels, outPixelsSize);
+        return;
+    }
+
+    mutex.unlock();
+    const bool waited = colorBuffer->waitReadToBytesAsync(*readback);
+    mutex.lock();
+
+    if (!waited) {
+        GFXSTREAM_ERROR("Failed to wait for the YUV readback of ColorBuffer:%d", p_colorbuffer);
+        colorBuffer->cancelReadToBytesAsync(*readback);
+        return;
+    }
+    if (!colorBuffer->finishReadToBytesAsync(*readback, outPixels, outPixelsSize)) {
+        colorBuffer->readYuvToBytes(x, y, width, height, outPixels, outPixelsSize);
+    }
 }
 
 bool FrameBuffer::Impl::updateBuffer(HandleType p_buffer, uint64_t offset, uint64_t size,
@@ -2821,6 +2889,17 @@ void FrameBuffer::Impl::onSave(Stream* stream, const ITextureSaverPtr& textureSa
             GFXSTREAM_ERROR("Failed to make context current for saving snapshot.");
         }
 
+        // The textures of evicted ColorBuffers must exist again before the
+        // EGLImages are saved below.
+        {
+            AutoLock colorBufferMapLock(m_colorBufferMapLock);
+            for (const auto& [handle, ref] : m_colorbuffers) {
+                if (ref.cb->isEvicted()) {
+                    ref.cb->restore();
+                }
+            }
+        }
+
         // eglPreSaveContext labels all guest context textures to be saved
         // (textures created by the host are not saved!)
         // eglSaveAllImages labels all EGLImages (both host and guest) to be saved
@@ -2863,9 +2942,11 @@ void FrameBuffer::Impl::onSave(Stream* stream, const ITextureSaverPtr& textureSa
     // objects).
     // TODO: skip reading from GPU even for texture objects.
 #if GFXSTREAM_ENABLE_HOST_GLES
-    saveCollection(
-        stream, m_contexts,
-        [](Stream* s, const EmulatedEglContextMap::value_type& pair) { pair.second->onSave(s); });
+    saveCollection(stream, m_contexts,
+                   [clientArrayCache = m_features.GlClientArrayCache.enabled](
+                       Stream* s, const EmulatedEglContextMap::value_type& pair) {
+                       pair.second->onSave(s, clientArrayCache);
+                   });
 #endif
 
     // We don't need to save |m_colorBufferCloseTsMap| here - there's enough
@@ -3311,6 +3392,98 @@ void FrameBuffer::Impl::sweepColorBuffersLocked() {
     }
 }
 
+void FrameBuffer::Impl::evictIdleColorBuffersLocked() {
+    if (!m_colorBufferBudgetBytes) {
+        return;
+    }
+
+    const uint64_t now = gfxstream::base::getUnixTimeUs();
+    uint64_t residentBytes = 0;
+    std::vector<ColorBuffer*> candidates;
+    for (const auto& [handle, ref] : m_colorbuffers) {
+        if (ref.cb->isEvicted() || !ref.cb->isEvictable()) {
+            continue;
+        }
+        residentBytes += ref.cb->getSize();
+        if (handle != m_lastPostedColorBuffer &&
+            ref.cb->getLastUseUs() + m_colorBufferEvictionMinIdleUs <= now) {
+            candidates.push_back(ref.cb.get());
+        }
+    }
+    if (residentBytes <= m_colorBufferBudgetBytes) {
+        return;
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](ColorBuffer* a, ColorBuffer* b) {
+        return a->getLastUseUs() < b->getLastUseUs();
+    });
+
+    uint32_t evictedCount = 0;
+    uint64_t evictedBytes = 0;
+    for (ColorBuffer* cb : candidates) {
+        if (residentBytes <= m_colorBufferBudgetBytes) {
+            break;
+        }
+        if (!cb->evict(m_colorBufferEvictionMinIdleUs)) {
+            continue;
+        }
+        residentBytes -= cb->getSize();
+        evictedBytes += cb->getSize();
+        ++evictedCount;
+    }
+    m_colorBufferEvictions += evictedCount;
+
+    if (evictedCount) {
+        GFXSTREAM_DEBUG("Evicted %u idle ColorBuffers (%" PRIu64 " bytes), %" PRIu64
+                        " bytes still resident with a budget of %" PRIu64 " bytes.",
+                        evictedCount, evictedBytes, residentBytes, m_colorBufferBudgetBytes);
+
+        const FrameBuffer::ColorBufferResidency residency = getColorBufferResidencyLocked();
+        m_logger->logMetricEvent(MetricEventColorBufferEviction{
+            .residentBytes = static_cast<int64_t>(residency.residentBytes),
+            .evictedBytes = static_cast<int64_t>(residency.evictedBytes),
+        });
+    }
+}
+
+void FrameBuffer::Impl::setColorBufferEvictionParams(std::optional<uint64_t> budgetBytes,
+                                                     std::optional<uint64_t> minIdleUs) {
+    AutoLock mutex(m_lock);
+    if (!m_features.ColorBufferEviction.enabled) {
+        return;
+    }
+    if (budgetBytes) {
+        m_colorBufferBudgetBytes = *budgetBytes;
+    }
+    if (minIdleUs) {
+        m_colorBufferEvictionMinIdleUs = *minIdleUs;
+    }
+}
+
+FrameBuffer::ColorBufferResidency FrameBuffer::Impl::getColorBufferResidency() {
+    AutoLock mutex(m_lock);
+    AutoLock colorBufferMapLock(m_colorBufferMapLock);
+    return getColorBufferResidencyLocked();
+}
+
+FrameBuffer::ColorBufferResidency FrameBuffer::Impl::getColorBufferResidencyLocked() {
+    FrameBuffer::ColorBufferResidency residency;
+    for (const auto& [handle, ref] : m_colorbuffers) {
+        if (!ref.cb->isEvictable()) {
+            continue;
+        }
+        if (ref.cb->isEvicted()) {
+            residency.evictedBytes += ref.cb->getSize();
+            ++residency.evictedCount;
+        } else {
+            residency.residentBytes += ref.cb->getSize();
+            ++residency.residentCount;
+        }
+    }
+    residency.evictions = m_colorBufferEvictions;
+    return residency;
+}
+
 std::future<void> FrameBuffer::Impl::blockPostWorker(std::future<void> continueSignal) {
     std::promise<void> scheduled;
     std::future<void> scheduledFuture = scheduled.get_future();
@@ -4872,6 +5045,15 @@ int FrameBuffer::setDisplayPose(uint32_t displayId, int32_t x, int32_t y, uint32
 
 HandleType FrameBuffer::getLastPostedColorBuffer() { return mImpl->getLastPostedColorBuffer(); }
 
+FrameBuffer::ColorBufferResidency FrameBuffer::getColorBufferResidency() {
+    return mImpl->getColorBufferResidency();
+}
+
+void FrameBuffer::setColorBufferEvictionParams(std::optional<uint64_t> budgetBytes,
+                                               std::optional<uint64_t> minIdleUs) {
+    mImpl->setColorBufferEvictionParams(budgetBytes, minIdleUs);
+}
+
 void FrameBuffer::asyncWaitForGpuVulkanWithCb(uint64_t deviceHandle, uint64_t fenceHandle,
                                               FenceCompletionCallback cb) {
     mImpl->asyncWaitForGpuVulkanWithCb(deviceHandle, fenceHandle, cb);
@@ -19,6 +19,7 @@
 #include <stdint.h>
 
 #include <memory>
+#include <optional>
 
 #if GFXSTREAM_ENABLE_HOST_GLES
 #include <EGL/egl.h>
@@ -402,6 +403,22 @@ class FrameBuffer : public gfxstream::base::EventNotificationSupport<FrameBuffer
     static const uint32_t s_maxNumMultiDisplay = 11;
 
     HandleType getLastPostedColorBuffer();
+
+    struct ColorBufferResidency {
+        uint64_t residentBytes = 0;
+        uint32_t residentCount = 0;
+        uint64_t evictedBytes = 0;
+        uint32_t evictedCount = 0;
+        // Number of evictions since the FrameBuffer was created.
+        uint64_t evictions = 0;
+    };
+    // Only counts the ColorBuffers that can be evicted.
+    ColorBufferResidency getColorBufferResidency();
+    // Overrides the defaults of 2048 MiB and 30 s when ColorBuffer eviction is enabled. A budget
+    // of 0 disables the evictions.
+    void setColorBufferEvictionParams(std::optional<uint64_t> budgetBytes,
+                                      std::optional<uint64_t> minIdleUs);
+
     void asyncWaitForGpuVulkanWithCb(uint64_t deviceHandle, uint64_t fenceHandle, FenceCompletionCallback cb);
     void asyncWaitForGpuVulkanQsriWithCb(uint64_t image, FenceCompletionCallback cb);
 
@@ -14,11 +14,14 @@
 
 
 #include <memory>
+#include <vector>
+#include <utility>
 
 #include <gtest/gtest.h>
 
 #include "FrameBuffer.h"
 #include "RenderThreadInfo.h"
+#include "gfxstream/Metrics.h"
 #include "gfxstream/files/PathUtils.h"
 #include "gfxstream/host/display_operations.h"
 #include "gfxstream/host/file_stream.h"
@@ -30,6 +33,7 @@
 #include "gfxstream/host/testing/OSWindow.h"
 #include "gfxstream/host/testing/SampleApplication.h"
 #include "gfxstream/host/testing/ShaderUtils.h"
+#include "vulkan/VulkanDispatch.h"
 
 #ifdef _MSC_VER
 #include "gfxstream/msvc.h"
@@ -66,7 +70,7 @@ class FrameBufferTest : public ::testing::Test {
 
             EXPECT_TRUE(
                 FrameBuffer::initialize(
-                    mWidth, mHeight, {},
+                    mWidth, mHeight, mFeatures,
                     mUseSubWindow,
                     !useHostGpu /* egl2egl */));
             mFb = FrameBuffer::getFB();
@@ -82,7 +86,7 @@ class FrameBufferTest : public ::testing::Test {
         } else {
             EXPECT_TRUE(
                 FrameBuffer::initialize(
-                    mWidth, mHeight, {},
+                    mWidth, mHeight, mFeatures,
                     mUseSubWindow,
                     !useHostGpu /* egl2egl */));
             mFb = FrameBuffer::getFB();
@@ -119,6 +123,7 @@ class FrameBufferTest : public ::testing::Test {
 
     }
 
+    gfxstream::host::FeatureSet mFeatures;
     bool mUseSubWindow = false;
     OSWindow* mWindow = nullptr;
     FrameBuffer* mFb = nullptr;
@@ -342,6 +347,216 @@ TEST_F(FrameBufferTest, CreateOpenUpdateCloseColorBuffer_FormatChange) {
     mFb->closeColorBuffer(handle);
 }
 
+class FrameBufferEvictionTest : public FrameBufferTest {
+  protected:
+    FrameBufferEvictionTest() { mFeatures.ColorBufferEviction.enabled = true; }
+};
+
+// Tests that an evicted color buffer is restored with its contents on its next
+// use.
+TEST_F(FrameBufferEvictionTest, EvictedColorBufferKeepsContents) {
+    HandleType handle =
+        mFb->createColorBuffer(mWidth, mHeight, GL_RGBA, FRAMEWORK_FORMAT_GL_COMPATIBLE);
+    EXPECT_NE((HandleType)0, handle);
+
+    TestTexture forUpdate = createTestPatternRGBA8888(mWidth, mHeight);
+    mFb->updateColorBuffer(handle, 0, 0, mWidth, mHeight, GL_RGBA, GL_UNSIGNED_BYTE, forUpdate.data());
+
+    ColorBufferPtr colorBuffer = mFb->findColorBuffer(handle);
+    ASSERT_NE(nullptr, colorBuffer);
+    ASSERT_TRUE(colorBuffer->evict(0));
+    EXPECT_TRUE(colorBuffer->isEvicted());
+    EXPECT_EQ(1u, mFb->getColorBufferResidency().evictedCount);
+
+    TestTexture forRead =
+        createTestTextureRGBA8888SingleColor(mWidth, mHeight, 0.0f, 0.0f, 0.0f, 0.0f);
+    mFb->readColorBuffer(handle, 0, 0, mWidth, mHeight, GL_RGBA, GL_UNSIGNED_BYTE, forRead.data(),
+                         forRead.size());
+    EXPECT_FALSE(colorBuffer->isEvicted());
+    EXPECT_TRUE(ImageMatches(mWidth, mHeight, 4, mWidth, forUpdate.data(), forRead.data()));
+
+    // Evicting again works from the restored backing.
+    ASSERT_TRUE(colorBuffer->evict(0));
+    mFb->readColorBuffer(handle, 0, 0, mWidth, mHeight, GL_RGBA, GL_UNSIGNED_BYTE, forRead.data(),
+                         forRead.size());
+    EXPECT_TRUE(ImageMatches(mWidth, mHeight, 4, mWidth, forUpdate.data(), forRead.data()));
+
+    mFb->closeColorBuffer(handle);
+}
+
+// Tests that an evicted color buffer is saved with its contents.
+TEST_F(FrameBufferEvictionTest, SnapshotEvictedColorBuffer) {
+    HandleType handle =
+        mFb->createColorBuffer(mWidth, mHeight, GL_RGBA, FRAMEWORK_FORMAT_GL_COMPATIBLE);
+
+    TestTexture forUpdate = createTestPatternRGBA8888(mWidth, mHeight);
+    mFb->updateColorBuffer(handle, 0, 0, mWidth, mHeight, GL_RGBA, GL_UNSIGNED_BYTE, forUpdate.data());
+    ASSERT_TRUE(mFb->findColorBuffer(handle)->evict(0));
+
+    saveSnapshot();
+    loadSnapshot();
+
+    TestTexture forRead =
+        createTestTextureRGBA8888SingleColor(mWidth, mHeight, 0.0f, 0.0f, 0.0f, 0.0f);
+    mFb->readColorBuffer(handle, 0, 0, mWidth, mHeight, GL_RGBA, GL_UNSIGNED_BYTE, forRead.data(),
+                         forRead.size());
+
+    EXPECT_TRUE(ImageMatches(mWidth, mHeight, 4, mWidth, forUpdate.data(), forRead.data()));
+
+    mFb->closeColorBuffer(handle);
+}
+
+// Tests that a color buffer whose backing may be aliased is never evicted.
+TEST_F(FrameBufferEvictionTest, SharedColorBufferIsNotEvicted) {
+    HandleType handle =
+        mFb->createColorBuffer(mWidth, mHeight, GL_RGBA, FRAMEWORK_FORMAT_GL_COMPATIBLE);
+    ColorBufferPtr colorBuffer = mFb->findColorBuffer(handle);
+    ASSERT_NE(nullptr, colorBuffer);
+
+    EXPECT_NE(0u, colorBuffer->glOpGetTexture());
+    EXPECT_FALSE(colorBuffer->evict(0));
+    EXPECT_FALSE(colorBuffer->isEvicted());
+
+    mFb->closeColorBuffer(handle);
+}
+
+// Tests that a color buffer that is not a plain GL color buffer is never
+// evicted.
+TEST_F(FrameBufferEvictionTest, YuvColorBufferIsNotEvicted) {
+    HandleType handle =
+        mFb->createColorBuffer(mWidth, mHeight, GL_RGBA, FRAMEWORK_FORMAT_YUV_420_888);
+    ColorBufferPtr colorBuffer = mFb->findColorBuffer(handle);
+    ASSERT_NE(nullptr, colorBuffer);
+
+    EXPECT_FALSE(colorBuffer->evict(0));
+    EXPECT_FALSE(colorBuffer->isEvicted());
+
+    mFb->closeColorBuffer(handle);
+}
+
+// Tests that a recent use of a color buffer stops its eviction.
+TEST_F(FrameBufferEvictionTest, RecentlyUsedColorBufferIsNotEvicted) {
+    HandleType handle =
+        mFb->createColorBuffer(mWidth, mHeight, GL_RGBA, FRAMEWORK_FORMAT_GL_COMPATIBLE);
+    ColorBufferPtr colorBuffer = mFb->findColorBuffer(handle);
+    ASSERT_NE(nullptr, colorBuffer);
+
+    TestTexture forUpdate = createTestPatternRGBA8888(mWidth, mHeight);
+    mFb->updateColorBuffer(handle, 0, 0, mWidth, mHeight, GL_RGBA, GL_UNSIGNED_BYTE, forUpdate.data());
+
+    constexpr uint64_t kMinIdleUs = 60 * 1000 * 1000;
+    EXPECT_FALSE(colorBuffer->evict(kMinIdleUs));
+    EXPECT_FALSE(colorBuffer->isEvicted());
+    EXPECT_GE(gfxstream::base::getUnixTimeUs(), colorBuffer->getLastUseUs());
+
+    EXPECT_TRUE(colorBuffer->evict(0));
+    EXPECT_TRUE(colorBuffer->isEvicted());
+
+    mFb->closeColorBuffer(handle);
+}
+
+// Tests that creating color buffers evicts idle ones over the budget, that only
+// the color buffers that can be evicted count towards it, and that the
+// residency is logged.
+TEST_F(FrameBufferEvictionTest, EvictsIdleColorBuffersOverBudget) {
+    static std::vector<std::pair<int64_t, int64_t>> sMetricEvents;
+    sMetricEvents.clear();
+    gfxstream::base::MetricsLogger::add_instant_event_with_metric_callback =
+        [](int64_t eventCode, int64_t metricValue) {
+            sMetricEvents.emplace_back(eventCode, metricValue);
+        };
+
+    HandleType yuv = mFb->createColorBuffer(mWidth, mHeight, GL_RGBA, FRAMEWORK_FORMAT_YUV_420_888);
+    HandleType first =
+        mFb->createColorBuffer(mWidth, mHeight, GL_RGBA, FRAMEWORK_FORMAT_GL_COMPATIBLE);
+    const uint64_t size = mFb->findColorBuffer(first)->getSize();
+    ASSERT_NE(0u, size);
+    FrameBuffer::ColorBufferResidency residency = mFb->getColorBufferResidency();
+    EXPECT_EQ(1u, residency.residentCount);
+    EXPECT_EQ(size, residency.residentBytes);
+
+    mFb->setColorBufferEvictionParams(size, 0);
+    HandleType second =
+        mFb->createColorBuffer(mWidth, mHeight, GL_RGBA, FRAMEWORK_FORMAT_GL_COMPATIBLE);
+
+    residency = mFb->getColorBufferResidency();
+    EXPECT_EQ(1u, residency.residentCount);
+    EXPECT_EQ(1u, residency.evictedCount);
+    EXPECT_EQ(1u, residency.evictions);
+    EXPECT_FALSE(mFb->findColorBuffer(yuv)->isEvicted());
+    EXPECT_EQ(2u, sMetricEvents.size());
+
+    gfxstream::base::MetricsLogger::add_instant_event_with_metric_callback = nullptr;
+    mFb->closeColorBuffer(second);
+    mFb->closeColorBuffer(first);
+    mFb->closeColorBuffer(yuv);
+}
+
+class FrameBufferVkTest : public FrameBufferTest {
+  protected:
+    FrameBufferVkTest() {
+        mFeatures.Vulkan.enabled = true;
+        mFeatures.GuestVulkanOnly.enabled = true;
+        mFeatures.AsyncColorBufferReadback.enabled = true;
+    }
+
+    void SetUp() override {
+        // Without GL emulation to fall back to, FrameBuffer can not be created
+        // if Vulkan fails to load.
+        if (!vk::vkDispatchValid(vk::vkDispatch(false))) {
+            GTEST_SKIP() << "Vulkan is not available.";
+        }
+        FrameBufferTest::SetUp();
+    }
+};
+
+// Tests that an asynchronous readback through the Vulkan staging ring returns
+// the contents of the color buffer.
+TEST_F(FrameBufferVkTest, AsyncReadColorBufferVk) {
+    if (!mFb->hasEmulationVk()) {
+        GTEST_SKIP() << "Vulkan emulation is not available.";
+    }
+
+    HandleType handle =
+        mFb->createColorBuffer(mWidth, mHeight, GL_RGBA, FRAMEWORK_FORMAT_GL_COMPATIBLE);
+    EXPECT_NE((HandleType)0, handle);
+    EXPECT_EQ(0, mFb->openColorBuffer(handle));
+
+    TestTexture forUpdate = createTestPatternRGBA8888(mWidth, mHeight);
+    mFb->updateColorBuffer(handle, 0, 0, mWidth, mHeight, GL_RGBA, GL_UNSIGNED_BYTE, forUpdate.data());
+
+    ColorBufferPtr colorBuffer = mFb->findColorBuffer(handle);
+    ASSERT_NE(nullptr, colorBuffer);
+
+    auto readback =
+        colorBuffer->startReadToBytesAsync(0, 0, mWidth, mHeight, GL_RGBA, GL_UNSIGNED_BYTE);
+    ASSERT_TRUE(readback.has_value());
+    EXPECT_TRUE(colorBuffer->waitReadToBytesAsync(*readback));
+
+    TestTexture forRead =
+        createTestTextureRGBA8888SingleColor(mWidth, mHeight, 0.0f, 0.0f, 0.0f, 0.0f);
+    EXPECT_TRUE(colorBuffer->finishReadToBytesAsync(*readback, forRead.data(), forRead.size()));
+
+    EXPECT_TRUE(ImageMatches(mWidth, mHeight, 4, mWidth, forUpdate.data(), forRead.data()));
+
+    // Cancelled readbacks give their slot back, so there are always free slots.
+    for (int i = 0; i < 16; i++) {
+        readback =
+            colorBuffer->startReadToBytesAsync(0, 0, mWidth, mHeight, GL_RGBA, GL_UNSIGNED_BYTE);
+        ASSERT_TRUE(readback.has_value());
+        colorBuffer->cancelReadToBytesAsync(*readback);
+    }
+
+    // The same readback through FrameBuffer, which waits without its lock.
+    TestTexture forFbRead =
+        createTestTextureRGBA8888SingleColor(mWidth, mHeight, 0.0f, 0.0f, 0.0f, 0.0f);
+    mFb->readColorBuffer(handle, 0, 0, mWidth, mHeight, GL_RGBA, GL_UNSIGNED_BYTE,
+                         forFbRead.data(), forFbRead.size());
+    EXPECT_TRUE(ImageMatches(mWidth, mHeight, 4, mWidth, forUpdate.data(), forFbRead.data()));
+
+    mFb->closeColorBuffer(handle);
+}
+
 // Tests obtaining EGL configs from FrameBuffer.
 TEST_F(FrameBufferTest, Configs) {
     EGLint numConfigs = 0;
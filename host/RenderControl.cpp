@@ -256,6 +256,9 @@ static const char* kReadColorBufferDma = "ANDROID_EMU_read_color_buffer_dma";
 // Multiple display configs
 static const char* kHWCMultiConfigs= "ANDROID_EMU_hwc_multi_configs";
 
+// Client vertex arrays cached by the host
+static const char* kClientArrayCache = "ANDROID_EMU_client_array_cache";
+
 static constexpr const uint64_t kInvalidPUID = std::numeric_limits<uint64_t>::max();
 
 static void rcTriggerWait(uint64_t glsync_ptr,
@@ -466,6 +469,7 @@ static EGLint rcGetGLString(EGLenum name, void* buffer, EGLint bufferSize) {
     bool vulkanAsyncQsri = shouldEnableVulkanAsyncQsri(features);
     bool readColorBufferDma = directMemEnabled && hasSharedSlotsHostMemoryAllocatorEnabled;
     bool hwcMultiConfigs = features.HwcMultiConfigs.enabled;
+    bool clientArrayCache = features.GlClientArrayCache.enabled;
 
     if (isChecksumEnabled && name == GL_EXTENSIONS) {
         glStr += ChecksumCalculatorThreadInfo::getMaxVersionString();
@@ -609,6 +613,11 @@ static EGLint rcGetGLString(EGLenum name, void* buffer, EGLint bufferSize) {
         glStr += " ";
     }
 
+    if (clientArrayCache && name == GL_EXTENSIONS) {
+        glStr += kClientArrayCache;
+        glStr += " ";
+    }
+
     if (name == GL_EXTENSIONS) {
         GLESDispatchMaxVersion guestExtVer = GLES_DISPATCH_MAX_VERSION_2;
         if (features.GlesDynamicVersion.enabled) {
@@ -28,6 +28,7 @@
 #include "ReadBuffer.h"
 #include "RenderChannelImpl.h"
 #if GFXSTREAM_ENABLE_HOST_GLES
+#include "OpenGLESDispatch/DispatchTables.h"
 #include "RenderControl.h"
 #endif
 #include "RenderThreadInfo.h"
@@ -557,6 +558,13 @@ intptr_t RenderThread::main() {
                         readBuf.consume(last);
                     }
                 }
+
+                // Draws that the translator coalesced must not wait for the
+                // next GL command, which may come after a renderControl
+                // command that reads the results or after a long wait.
+                if (tInfo->m_glInfo->currContext && gl::s_gles2.glFlushPendingDrawsHOST) {
+                    gl::s_gles2.glFlushPendingDrawsHOST();
+                }
             }
 #endif
 
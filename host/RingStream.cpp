@@ -17,9 +17,13 @@
 #include <assert.h>
 #include <memory.h>
 
+#include <algorithm>
+#include <atomic>
+
 #include "gfxstream/host/dma_device.h"
 #include "gfxstream/common/logging.h"
 #include "gfxstream/host/stream_utils.h"
+#include "gfxstream/Tracing.h"
 #include "gfxstream/system/System.h"
 #include "render-utils/dma_device.h"
 #include "render-utils/stream.h"
@@ -61,6 +65,18 @@ void LoadRingConfig(Stream* stream, struct asg_ring_config* config) {
     config->in_error = stream->getBe32();
 }
 
+std::atomic<uint64_t> sType1XferCount{0};
+std::atomic<uint64_t> sType1XferBytes{0};
+std::atomic<uint64_t> sSplitType1XferCount{0};
+std::atomic<uint64_t> sLargeXferBytes{0};
+
+void CountType1Xfer(uint32_t size) {
+    const uint64_t count = ++sType1XferCount;
+    const uint64_t bytes = sType1XferBytes += size;
+    gfxstream::base::traceCounter("gfxstreamAsgType1Xfers", static_cast<int64_t>(count));
+    gfxstream::base::traceCounter("gfxstreamAsgType1XferBytes", static_cast<int64_t>(bytes));
+}
+
 }  // namespace
 
 RingStream::RingStream(const AsgConsumerCreateInfo& info, size_t bufsize) :
@@ -71,6 +87,16 @@ RingStream::RingStream(const AsgConsumerCreateInfo& info, size_t bufsize) :
 
 RingStream::~RingStream() = default;
 
+// static
+RingStream::TrafficStats RingStream::getTrafficStats() {
+    TrafficStats stats;
+    stats.type1XferCount = sType1XferCount.load();
+    stats.type1XferBytes = sType1XferBytes.load();
+    stats.splitType1XferCount = sSplitType1XferCount.load();
+    stats.largeXferBytes = sLargeXferBytes.load();
+    return stats;
+}
+
 void RingStream::reloadRingConfig() {
     *mContext.ring_config = mSavedRingConfig;
 }
@@ -200,8 +226,14 @@ const unsigned char* RingStream::readRaw(void* buf, size_t* inout_len) {
                     break;
             }
         } else if (ringLargeXferAvailable) {
-            type3Read(ringLargeXferAvailable,
-                      &count, &current, ptrEnd);
+            // Keep reading the large transfer straight into |buf| for as long
+            // as the guest keeps up instead of returning after each chunk.
+            do {
+                type3Read(ringLargeXferAvailable, &count, &current, ptrEnd);
+                ringLargeXferAvailable = ring_buffer_available_read(
+                    mContext.to_host_large_xfer.ring, &mContext.to_host_large_xfer.view);
+            } while (ringLargeXferAvailable && current < ptrEnd &&
+                     0 != __atomic_load_n(&mContext.ring_config->transfer_size, __ATOMIC_ACQUIRE));
             inLargeXfer = true;
             if (0 == __atomic_load_n(&mContext.ring_config->transfer_size, __ATOMIC_ACQUIRE)) {
                 inLargeXfer = false;
@@ -295,26 +327,35 @@ void RingStream::type1Read(
 #pragma clang diagnostic ignored "-Wunreachable-code-loop-increment"
 #endif // __clang__
     for (uint32_t i = 0; i < xferTotal; ++i) {
-        if (*current + xfersPtr[i].size > ptrEnd) {
-            // Save in a temp buffer or we'll get stuck
-            if (begin == *current && i == 0) {
-                const char* src = mContext.buffer + xfersPtr[i].offset;
-                mReadBuffer.resize_noinit(xfersPtr[i].size);
-                memcpy(mReadBuffer.data(), src, xfersPtr[i].size);
-                mReadBufferLeft = xfersPtr[i].size;
-                ring_buffer_advance_read(
-                        mContext.to_host, sizeof(struct asg_type1_xfer), 1);
-                __atomic_fetch_add(&mContext.ring_config->host_consumed_pos, xfersPtr[i].size, __ATOMIC_RELEASE);
+        const uint32_t left = xfersPtr[i].size - mType1XferReadSize;
+        const uint32_t todo = std::min<size_t>(left, ptrEnd - *current);
+        if (todo < left) {
+            // Return what was read so far or we'll get stuck. Otherwise, read
+            // the transfer straight from the shared buffer over several calls.
+            // It stays in the ring until it is fully read so that the guest
+            // does not reuse its part of the buffer.
+            if (begin != *current || i != 0) {
+                return;
+            }
+            if (!mType1XferReadSize) {
+                gfxstream::base::traceCounter("gfxstreamAsgSplitType1Xfers",
+                                              static_cast<int64_t>(++sSplitType1XferCount));
             }
+        }
+        const char* src = mContext.buffer + xfersPtr[i].offset + mType1XferReadSize;
+        memcpy(*current, src, todo);
+        *current += todo;
+        *count += todo;
+
+        if (todo < left) {
+            mType1XferReadSize += todo;
             return;
         }
-        const char* src = mContext.buffer + xfersPtr[i].offset;
-        memcpy(*current, src, xfersPtr[i].size);
+        mType1XferReadSize = 0;
         ring_buffer_advance_read(
                 mContext.to_host, sizeof(struct asg_type1_xfer), 1);
         __atomic_fetch_add(&mContext.ring_config->host_consumed_pos, xfersPtr[i].size, __ATOMIC_RELEASE);
-        *current += xfersPtr[i].size;
-        *count += xfersPtr[i].size;
+        CountType1Xfer(xfersPtr[i].size);
 
         // TODO: Figure out why running multiple xfers here can result in data
         // corruption and remove clang diagnostic block.
@@ -380,6 +421,27 @@ void RingStream::type3Read(
 
     *current += actuallyRead;
     *count += actuallyRead;
+    gfxstream::base::traceCounter("gfxstreamAsgLargeXferBytes",
+                                  static_cast<int64_t>(sLargeXferBytes += actuallyRead));
+}
+
+void RingStream::finishPartialType1Read() {
+    if (!mType1XferReadSize) {
+        return;
+    }
+
+    // |mReadBuffer| is always drained before the ring is read again.
+    struct asg_type1_xfer xfer;
+    ring_buffer_copy_contents(mContext.to_host, 0, sizeof(xfer), (uint8_t*)&xfer);
+    const uint32_t left = xfer.size - mType1XferReadSize;
+    mReadBuffer.resize_noinit(left);
+    memcpy(mReadBuffer.data(), mContext.buffer + xfer.offset + mType1XferReadSize, left);
+    mReadBufferLeft = left;
+    mType1XferReadSize = 0;
+
+    ring_buffer_advance_read(mContext.to_host, sizeof(struct asg_type1_xfer), 1);
+    __atomic_fetch_add(&mContext.ring_config->host_consumed_pos, xfer.size, __ATOMIC_RELEASE);
+    CountType1Xfer(xfer.size);
 }
 
 void* RingStream::getDmaForReading(uint64_t guest_paddr) {
@@ -401,6 +463,8 @@ const unsigned char *RingStream::readFully( void *buf, size_t len) {
 }
 
 void RingStream::onSave(gfxstream::Stream* stream) {
+    finishPartialType1Read();
+
     stream->putBe32(mReadBufferLeft);
     stream->write(mReadBuffer.data() + mReadBuffer.size() - mReadBufferLeft,
                   mReadBufferLeft);
@@ -422,6 +486,8 @@ unsigned char* RingStream::onLoad(gfxstream::Stream* stream) {
 
     LoadRingConfig(stream, &mSavedRingConfig);
 
+    mType1XferReadSize = 0;
+
     return reinterpret_cast<unsigned char*>(mWriteBuffer.data());
 }
 
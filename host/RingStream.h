@@ -46,6 +46,17 @@ class RingStream final : public IOStream {
 
     void reloadRingConfig();
 
+    // The shape of the guest traffic received by all RingStreams, to help tune
+    // the ASG buffer sizes. Also published as trace counters.
+    struct TrafficStats {
+        uint64_t type1XferCount = 0;
+        uint64_t type1XferBytes = 0;
+        // Type 1 transfers that did not fit into the reader's buffer.
+        uint64_t splitType1XferCount = 0;
+        uint64_t largeXferBytes = 0;
+    };
+    static TrafficStats getTrafficStats();
+
   protected:
     virtual void* allocBuffer(size_t minSize) override final;
     virtual int commitBuffer(size_t size) override final;
@@ -59,6 +70,7 @@ class RingStream final : public IOStream {
     void type1Read(uint32_t available, char* begin, size_t* count, char** current, const char* ptrEnd);
     void type2Read(uint32_t available, size_t* count, char** current, const char* ptrEnd);
     void type3Read(uint32_t available, size_t* count, char** current, const char* ptrEnd);
+    void finishPartialType1Read();
 
     struct asg_context mContext;
     struct asg_ring_config mSavedRingConfig;
@@ -71,6 +83,11 @@ class RingStream final : public IOStream {
     RenderChannel::Buffer mWriteBuffer;
     size_t mReadBufferLeft = 0;
 
+    // How much of the type 1 transfer at the front of the ring was already
+    // read, if it did not fit into the caller's buffer. Not saved: snapshots
+    // move the rest of the transfer into |mReadBuffer| instead.
+    uint32_t mType1XferReadSize = 0;
+
     // The number of times this RingStream should attempt reading
     // before going to sleep.
     static const uint32_t kMaxUnavailableReads = 8;
@@ -0,0 +1,137 @@
+// Copyright (C) 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "RingStream.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "gfxstream/host/mem_stream.h"
+#include "gfxstream/host/ring_buffer.h"
+
+namespace gfxstream {
+namespace {
+
+constexpr uint32_t kBufferSize = 4096;
+
+// Plays the guest side of an ASG context.
+class FakeGuest {
+  public:
+    FakeGuest() : mRingStorage(kAsgConsumerRingStorageSize), mBuffer(kBufferSize) {
+        mInfo.ring_storage = mRingStorage.data();
+        mInfo.buffer = mBuffer.data();
+        mInfo.buffer_size = kBufferSize;
+        mInfo.buffer_flush_interval = kBufferSize;
+        mInfo.callbacks.onUnavailableRead = [] { return AsgOnUnavailableReadStatus::kExit; };
+        mInfo.callbacks.getPtr = [](uint64_t) -> char* { return nullptr; };
+    }
+
+    std::unique_ptr<RingStream> createStream() {
+        auto stream = std::make_unique<RingStream>(mInfo, 512);
+        mContext = asg_context_create(mInfo.ring_storage, mInfo.buffer, mInfo.buffer_size);
+        return stream;
+    }
+
+    void sendType1(const std::vector<char>& data) {
+        struct asg_type1_xfer xfer = {mWritePos, static_cast<uint32_t>(data.size())};
+        memcpy(mBuffer.data() + mWritePos, data.data(), data.size());
+        mWritePos += data.size();
+        ASSERT_EQ(1, ring_buffer_write(mContext.to_host, &xfer, sizeof(xfer), 1));
+    }
+
+    uint32_t pendingXferBytes() const { return ring_buffer_available_read(mContext.to_host, 0); }
+
+    uint32_t hostConsumedPos() const { return mContext.ring_config->host_consumed_pos; }
+
+  private:
+    std::vector<char> mRingStorage;
+    std::vector<char> mBuffer;
+    AsgConsumerCreateInfo mInfo;
+    struct asg_context mContext;
+    uint32_t mWritePos = 0;
+};
+
+std::vector<char> MakeData(size_t size, char first) {
+    std::vector<char> data(size);
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<char>(first + i);
+    }
+    return data;
+}
+
+std::vector<char> Read(RingStream* stream, size_t size) {
+    std::vector<char> data(size);
+    data.resize(stream->read(data.data(), data.size()));
+    return data;
+}
+
+TEST(RingStreamTest, CountsTraffic) {
+    FakeGuest guest;
+    auto stream = guest.createStream();
+    const RingStream::TrafficStats before = RingStream::getTrafficStats();
+
+    const std::vector<char> small = MakeData(16, 0);
+    const std::vector<char> large = MakeData(64, 16);
+    guest.sendType1(small);
+    guest.sendType1(large);
+
+    EXPECT_EQ(small, Read(stream.get(), 32));
+    // The second transfer does not fit and is read over two calls.
+    EXPECT_EQ(std::vector<char>(large.begin(), large.begin() + 32), Read(stream.get(), 32));
+    EXPECT_EQ(std::vector<char>(large.begin() + 32, large.end()), Read(stream.get(), 32));
+    EXPECT_EQ(0u, guest.pendingXferBytes());
+    EXPECT_EQ(80u, guest.hostConsumedPos());
+
+    const RingStream::TrafficStats after = RingStream::getTrafficStats();
+    EXPECT_EQ(before.type1XferCount + 2, after.type1XferCount);
+    EXPECT_EQ(before.type1XferBytes + 80, after.type1XferBytes);
+    EXPECT_EQ(before.splitType1XferCount + 1, after.splitType1XferCount);
+    EXPECT_EQ(before.largeXferBytes, after.largeXferBytes);
+}
+
+TEST(RingStreamTest, SaveLoadDuringSplitTransfer) {
+    FakeGuest guest;
+    auto stream = guest.createStream();
+
+    const std::vector<char> data = MakeData(64, 1);
+    guest.sendType1(data);
+    EXPECT_EQ(std::vector<char>(data.begin(), data.begin() + 24), Read(stream.get(), 24));
+
+    // Saving takes the rest of the transfer off the ring.
+    MemStream saved;
+    stream->save(&saved);
+    EXPECT_EQ(0u, guest.pendingXferBytes());
+    EXPECT_EQ(64u, guest.hostConsumedPos());
+
+    FakeGuest loadedGuest;
+    auto loaded = loadedGuest.createStream();
+    loaded->load(&saved);
+    EXPECT_EQ(0, saved.readSize());
+
+    const std::vector<char> rest(data.begin() + 24, data.end());
+    EXPECT_EQ(rest, Read(loaded.get(), 64));
+    // The saved stream keeps going from the same place.
+    EXPECT_EQ(rest, Read(stream.get(), 64));
+
+    // Later transfers are read from their start.
+    const std::vector<char> next = MakeData(8, 100);
+    loadedGuest.sendType1(next);
+    EXPECT_EQ(next, Read(loaded.get(), 64));
+}
+
+}  // namespace
+}  // namespace gfxstream
@@ -16,6 +16,7 @@
 
 #ifdef GFXSTREAM_BUILD_WITH_SNAPSHOT_FRONTEND_SUPPORT
 #include <filesystem>
+#include <future>
 #include <fcntl.h>
 // X11 defines status as a preprocessor define which messes up
 // anyone with a `Status` type.
@@ -32,8 +33,10 @@
 // TODO: remove after moving save/load interface to ops.
 #include "gfxstream/host/address_space_graphics.h"
 #include "gfxstream/host/file_stream.h"
+#include "gfxstream/host/mem_stream.h"
 #include "gfxstream/host/Tracing.h"
 #include "gfxstream/memory/SharedMemory.h"
+#include "gfxstream/system/System.h"
 #include "gfxstream/threads/WorkerThread.h"
 #include "virtgpu_gfxstream_protocol.h"
 
@@ -114,12 +117,14 @@ VirtioGpuFrontend::VirtioGpuFrontend() = default;
 
 int VirtioGpuFrontend::init(RendererPtr renderer,
                             void* cookie, const gfxstream::host::FeatureSet& features,
-                            stream_renderer_fence_callback fence_callback) {
+                            stream_renderer_fence_callback fence_callback,
+                            stream_renderer_snapshot_progress_callback snapshot_progress_callback) {
     GFXSTREAM_DEBUG("cookie: %p", cookie);
     mRenderer = renderer;
     mCookie = cookie;
     mFeatures = features;
     mFenceCallback = fence_callback;
+    mSnapshotProgressCallback = snapshot_progress_callback;
     mVirtioGpuTimelines = VirtioGpuTimelines::create(getFenceCompletionCallback());
 
 #if !defined(_WIN32)
@@ -149,6 +154,48 @@ void VirtioGpuFrontend::teardown() {
     }
 }
 
+VirtioGpuFrontend::ContextHandle VirtioGpuFrontend::getContext(VirtioGpuContextId contextId) {
+    std::shared_lock<std::shared_mutex> lock(mContextsMutex);
+    auto contextIt = mContexts.find(contextId);
+    if (contextIt == mContexts.end()) {
+        return nullptr;
+    }
+    return contextIt->second;
+}
+
+VirtioGpuFrontend::ResourceHandle VirtioGpuFrontend::getResource(VirtioGpuResourceId resourceId) {
+    std::shared_lock<std::shared_mutex> lock(mResourcesMutex);
+    auto resourceIt = mResources.find(resourceId);
+    if (resourceIt == mResources.end()) {
+        return nullptr;
+    }
+    return resourceIt->second;
+}
+
+std::vector<std::pair<VirtioGpuContextId, VirtioGpuFrontend::ContextHandle>>
+VirtioGpuFrontend::getContexts() {
+    std::shared_lock<std::shared_mutex> lock(mContextsMutex);
+    return {mContexts.begin(), mContexts.end()};
+}
+
+std::vector<std::pair<VirtioGpuResourceId, VirtioGpuFrontend::ResourceHandle>>
+VirtioGpuFrontend::getResources() {
+    std::shared_lock<std::shared_mutex> lock(mResourcesMutex);
+    return {mResources.begin(), mResources.end()};
+}
+
+void VirtioGpuFrontend::setContext(VirtioGpuContextId contextId, VirtioGpuContext context) {
+    auto handle = std::make_shared<Locked<VirtioGpuContext>>(std::move(context));
+    std::unique_lock<std::shared_mutex> lock(mContextsMutex);
+    mContexts[contextId] = std::move(handle);
+}
+
+void VirtioGpuFrontend::setResource(VirtioGpuResourceId resourceId, VirtioGpuResource resource) {
+    auto handle = std::make_shared<Locked<VirtioGpuResource>>(std::move(resource));
+    std::unique_lock<std::shared_mutex> lock(mResourcesMutex);
+    mResources[resourceId] = std::move(handle);
+}
+
 int VirtioGpuFrontend::createContext(VirtioGpuCtxId contextId, uint32_t nlen, const char* name,
                                      uint32_t contextInit) {
     std::string contextName(name, nlen);
@@ -160,7 +207,7 @@ int VirtioGpuFrontend::createContext(VirtioGpuCtxId contextId, uint32_t nlen, co
         GFXSTREAM_ERROR("Failed to create context %u.", contextId);
         return -EINVAL;
     }
-    mContexts[contextId] = std::move(*contextOpt);
+    setContext(contextId, std::move(*contextOpt));
     return 0;
 }
 
@@ -182,16 +229,24 @@ VirtioGpuTimelines::FenceCompletionCallback VirtioGpuFrontend::getFenceCompletio
 int VirtioGpuFrontend::destroyContext(VirtioGpuCtxId contextId) {
     GFXSTREAM_DEBUG("ctxid: %u", contextId);
 
-    auto contextIt = mContexts.find(contextId);
-    if (contextIt == mContexts.end()) {
-        GFXSTREAM_ERROR("failed to destroy context %d: context not found", contextId);
-        return -EINVAL;
+    ContextHandle context;
+    {
+        std::unique_lock<std::shared_mutex> lock(mContextsMutex);
+        auto contextIt = mContexts.find(contextId);
+        if (contextIt == mContexts.end()) {
+            GFXSTREAM_ERROR("failed to destroy context %d: context not found", contextId);
+            return -EINVAL;
+        }
+        context = std::move(contextIt->second);
+        mContexts.erase(contextIt);
     }
-    auto& context = contextIt->second;
 
-    context.Destroy(get_gfxstream_address_space_ops());
+    {
+        std::lock_guard<std::mutex> lock(context->mutex);
+        context->value.Destroy(get_gfxstream_address_space_ops());
+    }
 
-    mContexts.erase(contextIt);
+    mVirtioGpuTimelines->removeContext(contextId);
     return 0;
 }
 
@@ -202,23 +257,25 @@ int VirtioGpuFrontend::destroyContext(VirtioGpuCtxId contextId) {
 int VirtioGpuFrontend::addressSpaceProcessCmd(VirtioGpuCtxId ctxId, uint32_t* dwords) {
     DECODE(header, gfxstream::gfxstreamHeader, dwords)
 
-    auto contextIt = mContexts.find(ctxId);
-    if (contextIt == mContexts.end()) {
+    ContextHandle contextHandle = getContext(ctxId);
+    if (!contextHandle) {
         GFXSTREAM_ERROR("ctx id %u not found", ctxId);
         return -EINVAL;
     }
-    auto& context = contextIt->second;
+    std::lock_guard<std::mutex> contextLock(contextHandle->mutex);
+    auto& context = contextHandle->value;
 
     switch (header.opCode) {
         case GFXSTREAM_CONTEXT_CREATE: {
             DECODE(contextCreate, gfxstream::gfxstreamContextCreate, dwords)
 
-            auto resourceIt = mResources.find(contextCreate.resourceId);
-            if (resourceIt == mResources.end()) {
+            ResourceHandle resourceHandle = getResource(contextCreate.resourceId);
+            if (!resourceHandle) {
                 GFXSTREAM_ERROR("ASG coherent resource %u not found", contextCreate.resourceId);
                 return -EINVAL;
             }
-            auto& resource = resourceIt->second;
+            std::lock_guard<std::mutex> resourceLock(resourceHandle->mutex);
+            auto& resource = resourceHandle->value;
 
             return context.CreateAddressSpaceGraphicsInstance(get_gfxstream_address_space_ops(),
                                                               resource);
@@ -363,14 +420,14 @@ int VirtioGpuFrontend::submitCmd(struct stream_renderer_command* cmd) {
             rc3d.nr_samples = create3d.nrSamples;
             rc3d.flags = create3d.flags;
 
-            auto contextIt = mContexts.find(cmd->ctx_id);
-            if (contextIt == mContexts.end()) {
+            ContextHandle context = getContext(cmd->ctx_id);
+            if (!context) {
                 GFXSTREAM_ERROR("ctx id %u is not found", cmd->ctx_id);
                 return -EINVAL;
             }
-            auto& context = contextIt->second;
+            std::lock_guard<std::mutex> lock(context->mutex);
 
-            return context.AddPendingBlob(create3d.blobId, rc3d);
+            return context->value.AddPendingBlob(create3d.blobId, rc3d);
         }
         case GFXSTREAM_ACQUIRE_SYNC: {
             GFXSTREAM_TRACE_EVENT(GFXSTREAM_TRACE_STREAM_RENDERER_CATEGORY,
@@ -378,13 +435,13 @@ int VirtioGpuFrontend::submitCmd(struct stream_renderer_command* cmd) {
 
             DECODE(acquireSync, gfxstream::gfxstreamAcquireSync, buffer);
 
-            auto contextIt = mContexts.find(cmd->ctx_id);
-            if (contextIt == mContexts.end()) {
+            ContextHandle context = getContext(cmd->ctx_id);
+            if (!context) {
                 GFXSTREAM_ERROR("ctx id %u is not found", cmd->ctx_id);
                 return -EINVAL;
             }
-            auto& context = contextIt->second;
-            return context.AcquireSync(acquireSync.syncId);
+            std::lock_guard<std::mutex> lock(context->mutex);
+            return context->value.AcquireSync(acquireSync.syncId);
         }
         case GFXSTREAM_PLACEHOLDER_COMMAND_VK: {
             GFXSTREAM_TRACE_EVENT(GFXSTREAM_TRACE_STREAM_RENDERER_CATEGORY,
@@ -400,6 +457,125 @@ int VirtioGpuFrontend::submitCmd(struct stream_renderer_command* cmd) {
     return 0;
 }
 
+namespace {
+
+VirtioGpuRing GetFenceRing(const stream_renderer_fence& fence) {
+    if (fence.flags & STREAM_RENDERER_FLAG_FENCE_RING_IDX) {
+        return VirtioGpuRingContextSpecific{
+            .mCtxId = fence.ctx_id,
+            .mRingIdx = fence.ring_idx,
+        };
+    }
+    return VirtioGpuRingGlobal{};
+}
+
+std::optional<std::vector<struct iovec>> AsVecOption(struct iovec* iov, int iovec_cnt) {
+    if (iovec_cnt > 0) {
+        std::vector<struct iovec> ret;
+        ret.reserve(iovec_cnt);
+        for (int i = 0; i < iovec_cnt; i++) {
+            ret.push_back(iov[i]);
+        }
+        return ret;
+    }
+    return std::nullopt;
+}
+
+}  // namespace
+
+int VirtioGpuFrontend::submitBatch(struct stream_renderer_batch_op* ops, uint32_t numOps) {
+    if (!ops && numOps > 0) {
+        return -EINVAL;
+    }
+
+    int firstError = 0;
+    auto setResult = [&firstError](stream_renderer_batch_op& op, int result) {
+        op.result = result;
+        if (result != 0 && firstError == 0) {
+            firstError = result;
+        }
+    };
+
+    uint32_t i = 0;
+    while (i < numOps) {
+        stream_renderer_batch_op& op = ops[i];
+        switch (op.type) {
+            case STREAM_RENDERER_BATCH_OP_SUBMIT_CMD: {
+                setResult(op, submitCmd(&op.data.cmd));
+                ++i;
+                break;
+            }
+            case STREAM_RENDERER_BATCH_OP_TRANSFER_WRITE: {
+                const uint32_t resourceId = op.data.transfer.res_handle;
+                uint32_t end = i + 1;
+                while (end < numOps && ops[end].type == STREAM_RENDERER_BATCH_OP_TRANSFER_WRITE &&
+                       ops[end].data.transfer.res_handle == resourceId) {
+                    ++end;
+                }
+
+                ResourceHandle resourceHandle = getResource(resourceId);
+                if (!resourceHandle) {
+                    GFXSTREAM_ERROR("Failed to transfer: failed to find resource %u.", resourceId);
+                    for (; i < end; ++i) {
+                        setResult(ops[i], -EINVAL);
+                    }
+                    break;
+                }
+                std::lock_guard<std::mutex> lock(resourceHandle->mutex);
+                auto& resource = resourceHandle->value;
+
+                for (uint32_t j = i; j < end; ++j) {
+                    auto& transfer = ops[j].data.transfer;
+                    ops[j].result = resource.TransferWriteDeferred(
+                        transfer.offset, &transfer.box,
+                        AsVecOption(transfer.iovecs, static_cast<int>(transfer.num_iovecs)));
+                }
+                const int flushResult = resource.FlushDeferredTransferWrites();
+                for (; i < end; ++i) {
+                    setResult(ops[i], ops[i].result != 0 ? ops[i].result : flushResult);
+                }
+                break;
+            }
+            case STREAM_RENDERER_BATCH_OP_CREATE_FENCE: {
+                const VirtioGpuRing ring = GetFenceRing(op.data.fence);
+
+                std::vector<uint64_t> fenceIds;
+                while (i < numOps && ops[i].type == STREAM_RENDERER_BATCH_OP_CREATE_FENCE &&
+                       GetFenceRing(ops[i].data.fence) == ring) {
+                    const stream_renderer_fence& fence = ops[i].data.fence;
+                    int ret = 0;
+                    if (fence.flags & STREAM_RENDERER_FLAG_FENCE_SHAREABLE) {
+                        ret = acquireContextFence(fence.ctx_id, fence.fence_id);
+                    }
+                    if (ret == 0) {
+                        fenceIds.push_back(fence.fence_id);
+                    }
+                    setResult(ops[i], ret);
+                    ++i;
+                }
+
+                GFXSTREAM_DEBUG("fences: %zu ring: %s", fenceIds.size(), to_string(ring).c_str());
+                mVirtioGpuTimelines->enqueueFences(ring, fenceIds);
+                break;
+            }
+            case STREAM_RENDERER_BATCH_OP_FLUSH: {
+                flushResource(op.data.flush_res_handle);
+                setResult(op, 0);
+                ++i;
+                break;
+            }
+            default: {
+                GFXSTREAM_ERROR("Unknown batch op type %u.", op.type);
+                setResult(op, -EINVAL);
+                ++i;
+                break;
+            }
+        }
+    }
+
+    return firstError;
+}
+
 int VirtioGpuFrontend::createFence(uint64_t fence_id, const VirtioGpuRing& ring) {
     GFXSTREAM_DEBUG("fenceid: %llu ring: %s", (unsigned long long)fence_id,
                     to_string(ring).c_str());
@@ -410,19 +586,23 @@ int VirtioGpuFrontend::createFence(uint64_t fence_id, const VirtioGpuRing& ring)
 }
 
 int VirtioGpuFrontend::acquireContextFence(uint32_t contextId, uint64_t fenceId) {
-    auto contextIt = mContexts.find(contextId);
-    if (contextIt == mContexts.end()) {
+    ContextHandle context = getContext(contextId);
+    if (!context) {
         GFXSTREAM_ERROR("failed to acquire context %u fence: context not found", contextId);
         return -EINVAL;
     }
-    auto& context = contextIt->second;
 
-    auto syncInfoOpt = context.TakeSync();
+    std::optional<gfxstream::SyncDescriptorInfo> syncInfoOpt;
+    {
+        std::lock_guard<std::mutex> lock(context->mutex);
+        syncInfoOpt = context->value.TakeSync();
+    }
     if (!syncInfoOpt) {
         GFXSTREAM_ERROR("failed to acquire context %u fence: no sync acquired", contextId);
         return -EINVAL;
     }
 
+    std::lock_guard<std::mutex> lock(mSyncMapMutex);
     mSyncMap[fenceId] = std::make_shared<gfxstream::SyncDescriptorInfo>(std::move(*syncInfoOpt));
 
     return 0;
@@ -437,7 +617,7 @@ int VirtioGpuFrontend::createResource(struct stream_renderer_resource_create_arg
         GFXSTREAM_ERROR("Failed to create resource %u.", args->handle);
         return -EINVAL;
     }
-    mResources[args->handle] = std::move(*resourceOpt);
+    setResource(args->handle, std::move(*resourceOpt));
     return 0;
 }
 
@@ -449,15 +629,16 @@ int VirtioGpuFrontend::importResource(uint32_t res_handle,
                         res_handle);
         return -EINVAL;
     } else if (import_data && (import_data->flags & STREAM_RENDERER_IMPORT_FLAG_RESOURCE_EXISTS)) {
-        auto resourceIt = mResources.find(res_handle);
-        if (resourceIt == mResources.end()) {
+        ResourceHandle resource = getResource(res_handle);
+        if (!resource) {
             GFXSTREAM_ERROR(
                 "import_data::flags specified STREAM_RENDERER_IMPORT_FLAG_RESOURCE_EXISTS, but "
                 "internal resource does not already exist",
                 res_handle);
             return -EINVAL;
         }
-        return resourceIt->second.ImportHandle(import_handle, import_data);
+        std::lock_guard<std::mutex> lock(resource->mutex);
+        return resource->value.ImportHandle(import_handle, import_data);
     } else {
         auto resourceOpt = VirtioGpuResource::Create(res_handle, import_handle, import_data);
         if (!resourceOpt) {
@@ -465,7 +646,7 @@ int VirtioGpuFrontend::importResource(uint32_t res_handle,
                             res_handle);
             return -EINVAL;
         }
-        mResources[res_handle] = std::move(*resourceOpt);
+        setResource(res_handle, std::move(*resourceOpt));
         return 0;
     }
 }
@@ -473,29 +654,41 @@ int VirtioGpuFrontend::importResource(uint32_t res_handle,
 void VirtioGpuFrontend::unrefResource(uint32_t resourceId) {
     GFXSTREAM_DEBUG("resource: %u", resourceId);
 
-    auto resourceIt = mResources.find(resourceId);
-    if (resourceIt == mResources.end()) return;
-    auto& resource = resourceIt->second;
+    ResourceHandle resource = getResource(resourceId);
+    if (!resource) return;
 
-    auto attachedContextIds = resource.GetAttachedContexts();
+    std::unordered_set<VirtioGpuContextId> attachedContextIds;
+    {
+        std::lock_guard<std::mutex> lock(resource->mutex);
+        attachedContextIds = resource->value.GetAttachedContexts();
+    }
+    // Contexts are locked before resources so the resource lock is not held here.
     for (auto contextId : attachedContextIds) {
         detachResource(contextId, resourceId);
     }
 
-    resource.Destroy();
+    {
+        std::unique_lock<std::shared_mutex> lock(mResourcesMutex);
+        auto resourceIt = mResources.find(resourceId);
+        if (resourceIt != mResources.end() && resourceIt->second == resource) {
+            mResources.erase(resourceIt);
+        }
+    }
 
-    mResources.erase(resourceIt);
+    std::lock_guard<std::mutex> lock(resource->mutex);
+    resource->value.Destroy();
 }
 
 int VirtioGpuFrontend::attachIov(int resourceId, struct iovec* iov, int num_iovs) {
     GFXSTREAM_DEBUG("resource:%d numiovs: %d", resourceId, num_iovs);
 
-    auto it = mResources.find(resourceId);
-    if (it == mResources.end()) {
+    ResourceHandle resourceHandle = getResource(resourceId);
+    if (!resourceHandle) {
         GFXSTREAM_ERROR("failed to attach iov: resource %u not found.", resourceId);
         return ENOENT;
     }
-    auto& resource = it->second;
+    std::lock_guard<std::mutex> lock(resourceHandle->mutex);
+    auto& resource = resourceHandle->value;
     resource.AttachIov(iov, num_iovs);
     return 0;
 }
@@ -503,50 +696,37 @@ int VirtioGpuFrontend::attachIov(int resourceId, struct iovec* iov, int num_iovs
 void VirtioGpuFrontend::detachIov(int resourceId) {
     GFXSTREAM_DEBUG("resource:%d", resourceId);
 
-    auto it = mResources.find(resourceId);
-    if (it == mResources.end()) {
+    ResourceHandle resourceHandle = getResource(resourceId);
+    if (!resourceHandle) {
         GFXSTREAM_ERROR("failed to detach iov: resource %u not found.", resourceId);
         return;
     }
-    auto& resource = it->second;
+    std::lock_guard<std::mutex> lock(resourceHandle->mutex);
+    auto& resource = resourceHandle->value;
     resource.DetachIov();
 }
 
-namespace {
-
-std::optional<std::vector<struct iovec>> AsVecOption(struct iovec* iov, int iovec_cnt) {
-    if (iovec_cnt > 0) {
-        std::vector<struct iovec> ret;
-        ret.reserve(iovec_cnt);
-        for (int i = 0; i < iovec_cnt; i++) {
-            ret.push_back(iov[i]);
-        }
-        return ret;
-    }
-    return std::nullopt;
-}
-
-}  // namespace
-
 int VirtioGpuFrontend::transferReadIov(int resId, uint64_t offset, stream_renderer_box* box,
                                        struct iovec* iov, int iovec_cnt) {
-    auto it = mResources.find(resId);
-    if (it == mResources.end()) {
+    ResourceHandle resourceHandle = getResource(resId);
+    if (!resourceHandle) {
         GFXSTREAM_ERROR("Failed to transfer: failed to find resource %d.", resId);
         return EINVAL;
     }
-    auto& resource = it->second;
+    std::lock_guard<std::mutex> lock(resourceHandle->mutex);
+    auto& resource = resourceHandle->value;
     return resource.TransferRead(offset, box, AsVecOption(iov, iovec_cnt));
 }
 
 int VirtioGpuFrontend::transferWriteIov(int resId, uint64_t offset, stream_renderer_box* box,
                                         struct iovec* iov, int iovec_cnt) {
-    auto it = mResources.find(resId);
-    if (it == mResources.end()) {
+    ResourceHandle resourceHandle = getResource(resId);
+    if (!resourceHandle) {
         GFXSTREAM_ERROR("Failed to transfer: failed to find resource %d.", resId);
         return EINVAL;
     }
-    auto& resource = it->second;
+    std::lock_guard<std::mutex> lock(resourceHandle->mutex);
+    auto& resource = resourceHandle->value;
     return resource.TransferWrite(offset, box, AsVecOption(iov, iovec_cnt));
 }
 
@@ -675,21 +855,23 @@ void VirtioGpuFrontend::fillCaps(uint32_t set, void* caps) {
 void VirtioGpuFrontend::attachResource(uint32_t contextId, uint32_t resourceId) {
     GFXSTREAM_DEBUG("ctxid: %u resid: %u", contextId, resourceId);
 
-    auto contextIt = mContexts.find(contextId);
-    if (contextIt == mContexts.end()) {
+    ContextHandle contextHandle = getContext(contextId);
+    if (!contextHandle) {
         GFXSTREAM_ERROR("failed to attach resource %u to context %u: context not found.",
                         resourceId, contextId);
         return;
     }
-    auto& context = contextIt->second;
+    std::lock_guard<std::mutex> contextLock(contextHandle->mutex);
+    auto& context = contextHandle->value;
 
-    auto resourceIt = mResources.find(resourceId);
-    if (resourceIt == mResources.end()) {
+    ResourceHandle resourceHandle = getResource(resourceId);
+    if (!resourceHandle) {
         GFXSTREAM_ERROR("failed to attach resource %u to context %u: resource not found.",
                         resourceId, contextId);
         return;
     }
-    auto& resource = resourceIt->second;
+    std::lock_guard<std::mutex> resourceLock(resourceHandle->mutex);
+    auto& resource = resourceHandle->value;
 
     context.AttachResource(resource);
 }
@@ -697,21 +879,23 @@ void VirtioGpuFrontend::attachResource(uint32_t contextId, uint32_t resourceId)
 void VirtioGpuFrontend::detachResource(uint32_t contextId, uint32_t resourceId) {
     GFXSTREAM_DEBUG("ctxid: %u resid: %u", contextId, resourceId);
 
-    auto contextIt = mContexts.find(contextId);
-    if (contextIt == mContexts.end()) {
+    ContextHandle contextHandle = getContext(contextId);
+    if (!contextHandle) {
         GFXSTREAM_ERROR("failed to detach resource %u to context %u: context not found.",
                         resourceId, contextId);
         return;
     }
-    auto& context = contextIt->second;
+    std::lock_guard<std::mutex> contextLock(contextHandle->mutex);
+    auto& context = contextHandle->value;
 
-    auto resourceIt = mResources.find(resourceId);
-    if (resourceIt == mResources.end()) {
+    ResourceHandle resourceHandle = getResource(resourceId);
+    if (!resourceHandle) {
         GFXSTREAM_ERROR("failed to attach resource %u to context %u: resource not found.",
                         resourceId, contextId);
         return;
     }
-    auto& resource = resourceIt->second;
+    std::lock_guard<std::mutex> resourceLock(resourceHandle->mutex);
+    auto& resource = resourceHandle->value;
 
     auto resourceAsgOpt = context.TakeAddressSpaceGraphicsHandle(resourceId);
     if (resourceAsgOpt) {
@@ -733,12 +917,13 @@ int VirtioGpuFrontend::getResourceInfo(uint32_t resourceId,
         return EINVAL;
     }
 
-    auto resourceIt = mResources.find(resourceId);
-    if (resourceIt == mResources.end()) {
+    ResourceHandle resourceHandle = getResource(resourceId);
+    if (!resourceHandle) {
         GFXSTREAM_ERROR("Failed to get info: failed to find resource %d.", resourceId);
         return ENOENT;
     }
-    auto& resource = resourceIt->second;
+    std::lock_guard<std::mutex> lock(resourceHandle->mutex);
+    auto& resource = resourceHandle->value;
     return resource.GetInfo(info);
 }
 
@@ -754,15 +939,18 @@ void VirtioGpuFrontend::flushResource(uint32_t res_handle) {
 int VirtioGpuFrontend::createBlob(uint32_t contextId, uint32_t resourceId,
                                   const struct stream_renderer_create_blob* createBlobArgs,
                                   const struct stream_renderer_handle* handle) {
-    auto contextIt = mContexts.find(contextId);
-    if (contextIt == mContexts.end()) {
+    ContextHandle context = getContext(contextId);
+    if (!context) {
         GFXSTREAM_ERROR("failed to create blob resource %u: context %u missing.", resourceId,
                         contextId);
         return -EINVAL;
     }
-    auto& context = contextIt->second;
 
-    auto createArgs = context.TakePendingBlob(createBlobArgs->blob_id);
+    std::optional<stream_renderer_resource_create_args> createArgs;
+    {
+        std::lock_guard<std::mutex> lock(context->mutex);
+        createArgs = context->value.TakePendingBlob(createBlobArgs->blob_id);
+    }
     if (createArgs) {
         createArgs->handle = resourceId;
     }
@@ -774,7 +962,7 @@ int VirtioGpuFrontend::createBlob(uint32_t contextId, uint32_t resourceId,
         GFXSTREAM_ERROR("failed to create blob resource %u.", resourceId);
         return -EINVAL;
     }
-    mResources[resourceId] = std::move(*resourceOpt);
+    setResource(resourceId, std::move(*resourceOpt));
     return 0;
 }
 
@@ -786,8 +974,8 @@ int VirtioGpuFrontend::resourceMap(uint32_t resourceId, void** hvaOut, uint64_t*
         return -EINVAL;
     }
 
-    auto it = mResources.find(resourceId);
-    if (it == mResources.end()) {
+    ResourceHandle resource = getResource(resourceId);
+    if (!resource) {
         if (hvaOut) *hvaOut = nullptr;
         if (sizeOut) *sizeOut = 0;
 
@@ -795,15 +983,14 @@ int VirtioGpuFrontend::resourceMap(uint32_t resourceId, void** hvaOut, uint64_t*
         return -EINVAL;
     }
 
-    auto& resource = it->second;
-    return resource.Map(hvaOut, sizeOut);
+    std::lock_guard<std::mutex> lock(resource->mutex);
+    return resource->value.Map(hvaOut, sizeOut);
 }
 
 int VirtioGpuFrontend::resourceUnmap(uint32_t resourceId) {
     GFXSTREAM_DEBUG("resource: %u", resourceId);
 
-    auto it = mResources.find(resourceId);
-    if (it == mResources.end()) {
+    if (!getResource(resourceId)) {
         GFXSTREAM_ERROR("Failed to map resource: unknown resource id %d.", resourceId);
         return -EINVAL;
     }
@@ -832,29 +1019,31 @@ int VirtioGpuFrontend::platformDestroySharedEglContext(void* context) {
 int VirtioGpuFrontend::resourceMapInfo(uint32_t resourceId, uint32_t* map_info) {
     GFXSTREAM_DEBUG("resource: %u", resourceId);
 
-    auto resourceIt = mResources.find(resourceId);
-    if (resourceIt == mResources.end()) {
+    ResourceHandle resource = getResource(resourceId);
+    if (!resource) {
         GFXSTREAM_ERROR("Failed to get resource map info: unknown resource %d.", resourceId);
         return -EINVAL;
     }
 
-    const auto& resource = resourceIt->second;
-    return resource.GetCaching(map_info);
+    std::lock_guard<std::mutex> lock(resource->mutex);
+    return resource->value.GetCaching(map_info);
 }
 
 int VirtioGpuFrontend::exportBlob(uint32_t resourceId, struct stream_renderer_handle* handle) {
     GFXSTREAM_DEBUG("resource: %u", resourceId);
 
-    auto resourceIt = mResources.find(resourceId);
-    if (resourceIt == mResources.end()) {
+    ResourceHandle resourceHandle = getResource(resourceId);
+    if (!resourceHandle) {
         GFXSTREAM_ERROR("Failed to export blob: unknown resource %d.", resourceId);
         return -EINVAL;
     }
-    auto& resource = resourceIt->second;
+    std::lock_guard<std::mutex> lock(resourceHandle->mutex);
+    auto& resource = resourceHandle->value;
     return resource.ExportBlob(handle);
 }
 
 int VirtioGpuFrontend::exportFence(uint64_t fenceId, struct stream_renderer_handle* handle) {
+    std::lock_guard<std::mutex> lock(mSyncMapMutex);
     auto it = mSyncMap.find(fenceId);
     if (it == mSyncMap.end()) {
         return -EINVAL;
@@ -881,40 +1070,46 @@ int VirtioGpuFrontend::exportFence(uint64_t fenceId, struct stream_renderer_hand
 
 int VirtioGpuFrontend::vulkanInfo(uint32_t resourceId,
                                   struct stream_renderer_vulkan_info* vulkanInfo) {
-    auto resourceIt = mResources.find(resourceId);
-    if (resourceIt == mResources.end()) {
+    ResourceHandle resourceHandle = getResource(resourceId);
+    if (!resourceHandle) {
         GFXSTREAM_ERROR("failed to get vulkan info: failed to find resource %d", resourceId);
         return -EINVAL;
     }
-    auto& resource = resourceIt->second;
+    std::lock_guard<std::mutex> lock(resourceHandle->mutex);
+    auto& resource = resourceHandle->value;
     return resource.GetVulkanInfo(vulkanInfo);
 }
 
 int VirtioGpuFrontend::destroyVirtioGpuObjects() {
     {
         std::vector<VirtioGpuResourceId> resourceIds;
-        resourceIds.reserve(mResources.size());
-        for (auto& [resourceId, resource] : mResources) {
-            const auto contextIds = resource.GetAttachedContexts();
-            for (const VirtioGpuContextId contextId : contextIds) {
-                detachResource(contextId, resourceId);
+        {
+            std::shared_lock<std::shared_mutex> lock(mResourcesMutex);
+            resourceIds.reserve(mResources.size());
+            for (const auto& [resourceId, _] : mResources) {
+                resourceIds.push_back(resourceId);
             }
-            resourceIds.push_back(resourceId);
         }
+        // Detaches the resource from its contexts before destroying it.
         for (const VirtioGpuResourceId resourceId : resourceIds) {
             unrefResource(resourceId);
         }
+        std::unique_lock<std::shared_mutex> lock(mResourcesMutex);
         mResources.clear();
     }
     {
         std::vector<VirtioGpuContextId> contextIds;
-        contextIds.reserve(mContexts.size());
-        for (const auto& [contextId, _] : mContexts) {
-            contextIds.push_back(contextId);
+        {
+            std::shared_lock<std::shared_mutex> lock(mContextsMutex);
+            contextIds.reserve(mContexts.size());
+            for (const auto& [contextId, _] : mContexts) {
+                contextIds.push_back(contextId);
+            }
         }
         for (const VirtioGpuContextId contextId : contextIds) {
             destroyContext(contextId);
         }
+        std::unique_lock<std::shared_mutex> lock(mContextsMutex);
         mContexts.clear();
     }
 
@@ -967,37 +1162,92 @@ void VirtioGpuFrontend::setScreenMask(int width,
 #ifdef GFXSTREAM_BUILD_WITH_SNAPSHOT_FRONTEND_SUPPORT
 
 static constexpr const char kSnapshotBasenameAsg[] = "gfxstream_asg.bin";
-static constexpr const char kSnapshotBasenameFrontend[] = "gfxstream_frontend.txtproto";
+static constexpr const char kSnapshotBasenameFrontend[] = "gfxstream_frontend.binpb";
+static constexpr const char kSnapshotBasenameFrontendText[] = "gfxstream_frontend.txtproto";
 static constexpr const char kSnapshotBasenameRenderer[] = "gfxstream_renderer.bin";
 
+// The renderer snapshot holds the contents of all of the color buffers, so use much larger
+// writes and reads than the few KiB that stdio buffers by default.
+static constexpr size_t kSnapshotFileBufferSize = 4 * 1024 * 1024;
+
+static FILE* OpenSnapshotFile(const std::filesystem::path& path, const char* mode) {
+    FILE* file = fopen(path.c_str(), mode);
+    if (!file) {
+        GFXSTREAM_ERROR("Failed to open snapshot file %s", path.c_str());
+        return nullptr;
+    }
+    setvbuf(file, nullptr, _IOFBF, kSnapshotFileBufferSize);
+    return file;
+}
+
+// Runs `step` and adds the time it took to `durationUs`.
+template <typename Step>
+static int TimeSnapshotStep(uint64_t* durationUs, Step step) {
+    const uint64_t startUs = gfxstream::base::getHighResTimeUs();
+    const int ret = step();
+    *durationUs += gfxstream::base::getHighResTimeUs() - startUs;
+    return ret;
+}
+
+void VirtioGpuFrontend::reportSnapshotProgress(uint32_t stage, bool isRestore, int result,
+                                               uint64_t durationUs) {
+    GFXSTREAM_DEBUG("%s stage %" PRIu32 " finished with %d in %" PRIu64 " us",
+                    isRestore ? "restore" : "snapshot", stage, result, durationUs);
+
+    if (!mSnapshotProgressCallback) {
+        return;
+    }
+    const stream_renderer_snapshot_progress progress = {
+        .stage = stage,
+        .is_restore = isRestore ? 1u : 0u,
+        .result = result,
+        .duration_us = durationUs,
+    };
+    mSnapshotProgressCallback(mCookie, &progress);
+}
+
 int VirtioGpuFrontend::snapshotRenderer(const char* directory) {
     const std::filesystem::path snapshotDirectory = std::string(directory);
     const std::filesystem::path snapshotPath = snapshotDirectory / kSnapshotBasenameRenderer;
 
-    StdioStream stream(fopen(snapshotPath.c_str(), "wb"), StdioStream::kOwner);
-
     if (!mRenderer) {
         GFXSTREAM_ERROR("Failed to snapshot renderer: renderer not available.");
         return -EINVAL;
     }
+
+    FILE* file = OpenSnapshotFile(snapshotPath, "wb");
+    if (!file) {
+        return -EIO;
+    }
+    StdioStream stream(file, StdioStream::kOwner);
     mRenderer->save(&stream, nullptr);
 
     return 0;
 }
 
 int VirtioGpuFrontend::snapshotFrontend(const char* directory) {
+    // The text format inlines the ring blobs while the binary format writes them to their own
+    // files next to the frontend snapshot.
+    const bool textFormat = mFeatures.VirtioGpuSnapshotTextFormat.enabled;
+
+    // Blobs destroyed since the previous snapshot in the directory would otherwise leave
+    // their files behind.
+    RingBlob::RemoveSnapshotFiles(directory);
+
     gfxstream::host::snapshot::VirtioGpuFrontendSnapshot snapshot;
 
-    for (const auto& [contextId, context] : mContexts) {
-        auto contextSnapshotOpt = context.Snapshot();
+    for (const auto& [contextId, context] : getContexts()) {
+        std::lock_guard<std::mutex> contextLock(context->mutex);
+        auto contextSnapshotOpt = context->value.Snapshot();
         if (!contextSnapshotOpt) {
             GFXSTREAM_ERROR("Failed to snapshot context %d", contextId);
             return -1;
         }
         (*snapshot.mutable_contexts())[contextId] = std::move(*contextSnapshotOpt);
     }
-    for (const auto& [resourceId, resource] : mResources) {
-        auto resourceSnapshotOpt = resource.Snapshot();
+    for (const auto& [resourceId, resource] : getResources()) {
+        std::lock_guard<std::mutex> resourceLock(resource->mutex);
+        auto resourceSnapshotOpt = resource->value.Snapshot(textFormat ? nullptr : directory);
         if (!resourceSnapshotOpt) {
             GFXSTREAM_ERROR("Failed to snapshot resource %d", resourceId);
             return -1;
@@ -1015,7 +1265,17 @@ int VirtioGpuFrontend::snapshotFrontend(const char* directory) {
     }
 
     const std::filesystem::path snapshotDirectory = std::string(directory);
-    const std::filesystem::path snapshotPath = snapshotDirectory / kSnapshotBasenameFrontend;
+    const char* basename = kSnapshotBasenameFrontend;
+    const char* otherBasename = kSnapshotBasenameFrontendText;
+    if (textFormat) {
+        std::swap(basename, otherBasename);
+    }
+    const std::filesystem::path snapshotPath = snapshotDirectory / basename;
+
+    // Restore prefers the binary format so a stale one must not outlive a newer text one.
+    std::error_code removeError;
+    std::filesystem::remove(snapshotDirectory / otherBasename, removeError);
+
     int snapshotFd = open(snapshotPath.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0660);
     if (snapshotFd < 0) {
         GFXSTREAM_ERROR("Failed to save snapshot: failed to open %s", snapshotPath.c_str());
@@ -1023,7 +1283,10 @@ int VirtioGpuFrontend::snapshotFrontend(const char* directory) {
     }
     google::protobuf::io::FileOutputStream snapshotOutputStream(snapshotFd);
     snapshotOutputStream.SetCloseOnDelete(true);
-    if (!google::protobuf::TextFormat::Print(snapshot, &snapshotOutputStream)) {
+    const bool serialized =
+        textFormat ? google::protobuf::TextFormat::Print(snapshot, &snapshotOutputStream)
+                   : snapshot.SerializeToZeroCopyStream(&snapshotOutputStream);
+    if (!serialized) {
         GFXSTREAM_ERROR("Failed to save snapshot: failed to serialize to stream.");
         return -1;
     }
@@ -1035,7 +1298,11 @@ int VirtioGpuFrontend::snapshotAsg(const char* directory) {
     const std::filesystem::path snapshotDirectory = std::string(directory);
     const std::filesystem::path snapshotPath = snapshotDirectory / kSnapshotBasenameAsg;
 
-   StdioStream stream(fopen(snapshotPath.c_str(), "wb"), StdioStream::kOwner);
+    FILE* file = OpenSnapshotFile(snapshotPath, "wb");
+    if (!file) {
+        return -EIO;
+    }
+    StdioStream stream(file, StdioStream::kOwner);
 
     int ret = gfxstream_address_space_save_memory_state(&stream);
     if (ret) {
@@ -1054,22 +1321,38 @@ int VirtioGpuFrontend::snapshot(const char* directory) {
     }
     mRenderer->pauseAllPreSave();
 
-    int ret = snapshotRenderer(directory);
-    if (ret) {
-        GFXSTREAM_ERROR("Failed to save snapshot: failed to snapshot renderer.");
+    // The stages write separate files from state that does not change while everything is
+    // paused, so they run concurrently and the pause only lasts as long as the slowest one.
+    auto runStage = [this, directory](uint32_t stage,
+                                      int (VirtioGpuFrontend::*snapshotStage)(const char*)) {
+        uint64_t durationUs = 0;
+        const int ret =
+            TimeSnapshotStep(&durationUs, [&]() { return (this->*snapshotStage)(directory); });
+        reportSnapshotProgress(stage, /*isRestore=*/false, ret, durationUs);
         return ret;
+    };
+    std::future<int> rendererResult =
+        std::async(std::launch::async, runStage, STREAM_RENDERER_SNAPSHOT_STAGE_RENDERER,
+                   &VirtioGpuFrontend::snapshotRenderer);
+    std::future<int> asgResult = std::async(std::launch::async, runStage,
+                                            STREAM_RENDERER_SNAPSHOT_STAGE_ASG,
+                                            &VirtioGpuFrontend::snapshotAsg);
+    const int frontendRet =
+        runStage(STREAM_RENDERER_SNAPSHOT_STAGE_FRONTEND, &VirtioGpuFrontend::snapshotFrontend);
+    const int rendererRet = rendererResult.get();
+    const int asgRet = asgResult.get();
+
+    if (rendererRet) {
+        GFXSTREAM_ERROR("Failed to save snapshot: failed to snapshot renderer.");
+        return rendererRet;
     }
-
-    ret = snapshotFrontend(directory);
-    if (ret) {
+    if (frontendRet) {
         GFXSTREAM_ERROR("Failed to save snapshot: failed to snapshot frontend.");
-        return ret;
+        return frontendRet;
     }
-
-    ret = snapshotAsg(directory);
-    if (ret) {
+    if (asgRet) {
         GFXSTREAM_ERROR("Failed to save snapshot: failed to snapshot ASG device.");
-        return ret;
+        return asgRet;
     }
 
     GFXSTREAM_DEBUG("directory:%s - done!", directory);
@@ -1080,38 +1363,59 @@ int VirtioGpuFrontend::restoreRenderer(const char* directory) {
     const std::filesystem::path snapshotDirectory = std::string(directory);
     const std::filesystem::path snapshotPath = snapshotDirectory / kSnapshotBasenameRenderer;
 
-    StdioStream stream(fopen(snapshotPath.c_str(), "rb"), StdioStream::kOwner);
-
     if (!mRenderer) {
         GFXSTREAM_ERROR("Failed to restore renderer: renderer not available.");
         return -EINVAL;
     }
+
+    FILE* file = OpenSnapshotFile(snapshotPath, "rb");
+    if (!file) {
+        return -EIO;
+    }
+    StdioStream stream(file, StdioStream::kOwner);
     mRenderer->load(&stream, nullptr);
 
     return 0;
 }
 
-int VirtioGpuFrontend::restoreFrontend(const char* directory) {
+/*static*/
+int VirtioGpuFrontend::readFrontendSnapshot(
+    const char* directory, gfxstream::host::snapshot::VirtioGpuFrontendSnapshot* snapshot) {
     const std::filesystem::path snapshotDirectory = std::string(directory);
-    const std::filesystem::path snapshotPath = snapshotDirectory / kSnapshotBasenameFrontend;
+    std::filesystem::path snapshotPath = snapshotDirectory / kSnapshotBasenameFrontend;
+    const bool textFormat = !std::filesystem::exists(snapshotPath);
+    if (textFormat) {
+        snapshotPath = snapshotDirectory / kSnapshotBasenameFrontendText;
+    }
 
-    gfxstream::host::snapshot::VirtioGpuFrontendSnapshot snapshot;
-    {
-        int snapshotFd = open(snapshotPath.c_str(), O_RDONLY);
-        if (snapshotFd < 0) {
-            GFXSTREAM_ERROR("Failed to restore snapshot: failed to open %s", snapshotPath.c_str());
-            return -1;
-        }
-        google::protobuf::io::FileInputStream snapshotInputStream(snapshotFd);
-        snapshotInputStream.SetCloseOnDelete(true);
-        if (!google::protobuf::TextFormat::Parse(&snapshotInputStream, &snapshot)) {
-            GFXSTREAM_ERROR("Failed to restore snapshot: failed to parse from file.");
-            return -1;
-        }
+    int snapshotFd = open(snapshotPath.c_str(), O_RDONLY);
+    if (snapshotFd < 0) {
+        GFXSTREAM_ERROR("Failed to restore snapshot: failed to open %s", snapshotPath.c_str());
+        return -1;
+    }
+    google::protobuf::io::FileInputStream snapshotInputStream(snapshotFd);
+    snapshotInputStream.SetCloseOnDelete(true);
+    const bool parsed =
+        textFormat ? google::protobuf::TextFormat::Parse(&snapshotInputStream, snapshot)
+                   : snapshot->ParseFromZeroCopyStream(&snapshotInputStream);
+    if (!parsed) {
+        GFXSTREAM_ERROR("Failed to restore snapshot: failed to parse from file.");
+        return -1;
     }
 
-    mContexts.clear();
-    mResources.clear();
+    return 0;
+}
+
+int VirtioGpuFrontend::restoreFrontend(
+    const char* directory, const gfxstream::host::snapshot::VirtioGpuFrontendSnapshot& snapshot) {
+    {
+        std::unique_lock<std::shared_mutex> lock(mContextsMutex);
+        mContexts.clear();
+    }
+    {
+        std::unique_lock<std::shared_mutex> lock(mResourcesMutex);
+        mResources.clear();
+    }
 
     for (const auto& [contextId, contextSnapshot] : snapshot.contexts()) {
         auto contextOpt = VirtioGpuContext::Restore(mRenderer, contextSnapshot);
@@ -1119,15 +1423,15 @@ int VirtioGpuFrontend::restoreFrontend(const char* directory) {
             GFXSTREAM_ERROR("Failed to restore context %d", contextId);
             return -1;
         }
-        mContexts.emplace(contextId, std::move(*contextOpt));
+        setContext(contextId, std::move(*contextOpt));
     }
     for (const auto& [resourceId, resourceSnapshot] : snapshot.resources()) {
-        auto resourceOpt = VirtioGpuResource::Restore(resourceSnapshot);
+        auto resourceOpt = VirtioGpuResource::Restore(resourceSnapshot, directory);
         if (!resourceOpt) {
             GFXSTREAM_ERROR("Failed to restore resource %d", resourceId);
             return -1;
         }
-        mResources.emplace(resourceId, std::move(*resourceOpt));
+        setResource(resourceId, std::move(*resourceOpt));
     }
 
     mVirtioGpuTimelines =
@@ -1140,25 +1444,48 @@ int VirtioGpuFrontend::restoreFrontend(const char* directory) {
     return 0;
 }
 
-int VirtioGpuFrontend::restoreAsg(const char* directory) {
+int VirtioGpuFrontend::readAsgSnapshot(const char* directory, std::vector<char>* snapshot) {
     const std::filesystem::path snapshotDirectory = std::string(directory);
     const std::filesystem::path snapshotPath = snapshotDirectory / kSnapshotBasenameAsg;
 
-    StdioStream stream(fopen(snapshotPath.c_str(), "rb"), StdioStream::kOwner);
+    std::error_code sizeError;
+    const uintmax_t size = std::filesystem::file_size(snapshotPath, sizeError);
+    if (sizeError) {
+        GFXSTREAM_ERROR("Failed to restore ASG device: failed to stat %s", snapshotPath.c_str());
+        return -EIO;
+    }
 
+    FILE* file = OpenSnapshotFile(snapshotPath, "rb");
+    if (!file) {
+        return -EIO;
+    }
+    snapshot->resize(size);
+    const size_t read = fread(snapshot->data(), 1, snapshot->size(), file);
+    fclose(file);
+    if (read != snapshot->size()) {
+        GFXSTREAM_ERROR("Failed to restore ASG device: failed to read %s", snapshotPath.c_str());
+        return -EIO;
+    }
+
+    return 0;
+}
+
+int VirtioGpuFrontend::restoreAsg(gfxstream::Stream* stream) {
     // Gather external memory info that the ASG device needs to reload.
     AddressSpaceDeviceLoadResources asgLoadResources;
-    for (const auto& [contextId, context] : mContexts) {
-        for (const auto [resourceId, asgId] : context.AsgInstances()) {
-            auto resourceIt = mResources.find(resourceId);
-            if (resourceIt == mResources.end()) {
+    for (const auto& [contextId, contextHandle] : getContexts()) {
+        std::lock_guard<std::mutex> contextLock(contextHandle->mutex);
+        for (const auto [resourceId, asgId] : contextHandle->value.AsgInstances()) {
+            ResourceHandle resourceHandle = getResource(resourceId);
+            if (!resourceHandle) {
                 GFXSTREAM_ERROR("Failed to restore ASG device: context %" PRIu32
                                 " claims resource %" PRIu32 " is used for ASG %" PRIu32
                                 " but resource not found.",
                                 contextId, resourceId, asgId);
                 return -1;
             }
-            auto& resource = resourceIt->second;
+            std::lock_guard<std::mutex> resourceLock(resourceHandle->mutex);
+            auto& resource = resourceHandle->value;
 
             void* mappedAddr = nullptr;
             uint64_t mappedSize = 0;
@@ -1183,7 +1510,7 @@ int VirtioGpuFrontend::restoreAsg(const char* directory) {
         return ret;
     }
 
-    ret = gfxstream_address_space_load_memory_state(&stream);
+    ret = gfxstream_address_space_load_memory_state(stream);
     if (ret) {
         GFXSTREAM_ERROR("Failed to restore ASG device: failed to restore ASG state.");
         return ret;
@@ -1196,22 +1523,59 @@ int VirtioGpuFrontend::restore(const char* directory) {
 
     destroyVirtioGpuObjects();
 
-    int ret = restoreRenderer(directory);
+    // Reading the frontend and ASG snapshots does not depend on anything else, so it overlaps
+    // with loading the renderer. Applying them has to wait for the renderer though: contexts
+    // and external blobs are restored from renderer state and the ASG device needs the
+    // restored resources.
+    uint64_t frontendDurationUs = 0;
+    gfxstream::host::snapshot::VirtioGpuFrontendSnapshot frontendSnapshot;
+    std::future<int> frontendRead = std::async(std::launch::async, [&]() {
+        return TimeSnapshotStep(&frontendDurationUs, [&]() {
+            return readFrontendSnapshot(directory, &frontendSnapshot);
+        });
+    });
+
+    uint64_t asgDurationUs = 0;
+    MemStream::Buffer asgSnapshot;
+    std::future<int> asgRead = std::async(std::launch::async, [&]() {
+        return TimeSnapshotStep(&asgDurationUs,
+                                [&]() { return readAsgSnapshot(directory, &asgSnapshot); });
+    });
+
+    uint64_t rendererDurationUs = 0;
+    int ret = TimeSnapshotStep(&rendererDurationUs, [&]() { return restoreRenderer(directory); });
+    reportSnapshotProgress(STREAM_RENDERER_SNAPSHOT_STAGE_RENDERER, /*isRestore=*/true, ret,
+                           rendererDurationUs);
+
+    int frontendRet = frontendRead.get();
+    int asgRet = asgRead.get();
+
     if (ret) {
         GFXSTREAM_ERROR("Failed to load snapshot: failed to load renderer.");
         return ret;
     }
 
-    ret = restoreFrontend(directory);
-    if (ret) {
+    if (!frontendRet) {
+        frontendRet = TimeSnapshotStep(&frontendDurationUs, [&]() {
+            return restoreFrontend(directory, frontendSnapshot);
+        });
+    }
+    reportSnapshotProgress(STREAM_RENDERER_SNAPSHOT_STAGE_FRONTEND, /*isRestore=*/true,
+                           frontendRet, frontendDurationUs);
+    if (frontendRet) {
         GFXSTREAM_ERROR("Failed to load snapshot: failed to load frontend.");
-        return ret;
+        return frontendRet;
     }
 
-    ret = restoreAsg(directory);
-    if (ret) {
+    if (!asgRet) {
+        MemStream asgStream(std::move(asgSnapshot));
+        asgRet = TimeSnapshotStep(&asgDurationUs, [&]() { return restoreAsg(&asgStream); });
+    }
+    reportSnapshotProgress(STREAM_RENDERER_SNAPSHOT_STAGE_ASG, /*isRestore=*/true, asgRet,
+                           asgDurationUs);
+    if (asgRet) {
         GFXSTREAM_ERROR("Failed to load snapshot: failed to load ASG device.");
-        return ret;
+        return asgRet;
     }
 
     if (!mRenderer) {
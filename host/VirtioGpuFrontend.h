@@ -17,7 +17,11 @@
 #include <stdint.h>
 
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 extern "C" {
 #include "gfxstream/virtio-gpu-gfxstream-renderer-unstable.h"
@@ -32,6 +36,7 @@ extern "C" {
 #endif
 #include "VirtioGpuResource.h"
 #include "VirtioGpuTimelines.h"
+#include "gfxstream/ThreadAnnotations.h"
 #include "gfxstream/host/Features.h"
 #include "render-utils/Renderer.h"
 
@@ -40,13 +45,15 @@ namespace host {
 
 class CleanupThread;
 
+// Thread safe, so that VMMs may call into it from several virtqueue threads at once.
 class VirtioGpuFrontend {
    public:
     VirtioGpuFrontend();
 
     int init(RendererPtr renderer, void* cookie,
              const gfxstream::host::FeatureSet& features,
-             stream_renderer_fence_callback fence_callback);
+             stream_renderer_fence_callback fence_callback,
+             stream_renderer_snapshot_progress_callback snapshot_progress_callback = nullptr);
 
     void teardown();
 
@@ -59,6 +66,8 @@ class VirtioGpuFrontend {
 
     int submitCmd(struct stream_renderer_command* cmd);
 
+    int submitBatch(struct stream_renderer_batch_op* ops, uint32_t numOps);
+
     int createFence(uint64_t fence_id, const VirtioGpuRing& ring);
 
     int acquireContextFence(uint32_t ctx_id, uint64_t fenceId);
@@ -126,9 +135,43 @@ class VirtioGpuFrontend {
 #ifdef GFXSTREAM_BUILD_WITH_SNAPSHOT_FRONTEND_SUPPORT
     int snapshot(const char* directory);
     int restore(const char* directory);
+
+    // Reads the frontend state saved by `snapshot()` in `directory`, in either format. The
+    // ring blobs it refers to are restored from the same directory.
+    static int readFrontendSnapshot(
+        const char* directory, gfxstream::host::snapshot::VirtioGpuFrontendSnapshot* snapshot);
 #endif  // GFXSTREAM_BUILD_WITH_SNAPSHOT_FRONTEND_SUPPORT
 
    private:
+    // A context or resource along with the lock that serializes the operations on it.
+    template <typename T>
+    struct Locked {
+        template <typename... Args>
+        explicit Locked(Args&&... args) : value(std::forward<Args>(args)...) {}
+
+        std::mutex mutex;
+        T value GUARDED_BY(mutex);
+    };
+    using ContextHandle = std::shared_ptr<Locked<VirtioGpuContext>>;
+    using ResourceHandle = std::shared_ptr<Locked<VirtioGpuResource>>;
+
+    // Handles stay usable after the context or resource is removed from its map. Return
+    // nullptr if there is no such context or resource.
+    ContextHandle getContext(VirtioGpuContextId contextId) EXCLUDES(mContextsMutex);
+    ResourceHandle getResource(VirtioGpuResourceId resourceId) EXCLUDES(mResourcesMutex);
+
+    // Copies of the maps, so that the contexts and resources can be locked one at a time
+    // without holding the map locks.
+    std::vector<std::pair<VirtioGpuContextId, ContextHandle>> getContexts()
+        EXCLUDES(mContextsMutex);
+    std::vector<std::pair<VirtioGpuResourceId, ResourceHandle>> getResources()
+        EXCLUDES(mResourcesMutex);
+
+    void setContext(VirtioGpuContextId contextId, VirtioGpuContext context)
+        EXCLUDES(mContextsMutex);
+    void setResource(VirtioGpuResourceId resourceId, VirtioGpuResource resource)
+        EXCLUDES(mResourcesMutex);
+
     VirtioGpuTimelines::FenceCompletionCallback getFenceCompletionCallback();
 
     int destroyVirtioGpuObjects();
@@ -139,22 +182,36 @@ class VirtioGpuFrontend {
     int snapshotAsg(const char* directory);
 
     int restoreRenderer(const char* directory);
-    int restoreFrontend(const char* directory);
-    int restoreAsg(const char* directory);
+    int restoreFrontend(const char* directory,
+                        const gfxstream::host::snapshot::VirtioGpuFrontendSnapshot& snapshot);
+    int readAsgSnapshot(const char* directory, std::vector<char>* snapshot);
+    int restoreAsg(gfxstream::Stream* stream);
+
+    void reportSnapshotProgress(uint32_t stage, bool isRestore, int result, uint64_t durationUs);
 #endif  // GFXSTREAM_BUILD_WITH_SNAPSHOT_FRONTEND_SUPPORT
 
     RendererPtr mRenderer;
     void* mCookie = nullptr;
     gfxstream::host::FeatureSet mFeatures;
     stream_renderer_fence_callback mFenceCallback;
+    stream_renderer_snapshot_progress_callback mSnapshotProgressCallback = nullptr;
     uint32_t mPageSize = 4096;
 
     // State that is preserved across snapshots:
     //
+    // The map locks are only held to look up, add or remove entries and never while waiting
+    // for the lock of a context or resource. When both are needed, the lock of the context is
+    // taken before the lock of the resource.
+    //
     // LINT.IfChange(virtio_gpu_frontend)
-    std::unordered_map<VirtioGpuContextId, VirtioGpuContext> mContexts;
-    std::unordered_map<VirtioGpuResourceId, VirtioGpuResource> mResources;
-    std::unordered_map<uint64_t, std::shared_ptr<SyncDescriptorInfo>> mSyncMap;
+    std::shared_mutex mContextsMutex;
+    std::unordered_map<VirtioGpuContextId, ContextHandle> mContexts GUARDED_BY(mContextsMutex);
+    std::shared_mutex mResourcesMutex;
+    std::unordered_map<VirtioGpuResourceId, ResourceHandle> mResources
+        GUARDED_BY(mResourcesMutex);
+    std::mutex mSyncMapMutex;
+    std::unordered_map<uint64_t, std::shared_ptr<SyncDescriptorInfo>> mSyncMap
+        GUARDED_BY(mSyncMapMutex);
     // When we wait for gpu or wait for gpu vulkan, the next (and subsequent)
     // fences created for that context should not be signaled immediately.
     // Rather, they should get in line.
@@ -573,6 +573,37 @@ int VirtioGpuResource::TransferWrite(uint64_t offset, stream_renderer_box* box,
     }
 }
 
+int VirtioGpuResource::TransferWriteDeferred(uint64_t offset, stream_renderer_box* box,
+                                             std::optional<std::vector<struct iovec>> iovs) {
+    // Pipes consume exactly the written range, so only buffers and color buffers, which are
+    // always updated in full, can defer.
+    if (mResourceType != VirtioGpuResourceType::BUFFER &&
+        mResourceType != VirtioGpuResourceType::COLOR_BUFFER) {
+        return TransferWrite(offset, box, std::move(iovs));
+    }
+
+    int ret = TransferFromIov(offset, box, std::move(iovs));
+    if (ret != 0) {
+        GFXSTREAM_ERROR("Failed to transfer: failed to copy from iov.");
+        return ret;
+    }
+    mHasDeferredTransferWrites = true;
+    return 0;
+}
+
+int VirtioGpuResource::FlushDeferredTransferWrites() {
+    if (!mHasDeferredTransferWrites) {
+        return 0;
+    }
+    mHasDeferredTransferWrites = false;
+
+    // The box is unused as the whole linear buffer is written.
+    if (mResourceType == VirtioGpuResourceType::BUFFER) {
+        return WriteToBufferFromLinear(0, nullptr);
+    }
+    return WriteToColorBufferFromLinear(0, nullptr);
+}
+
 int VirtioGpuResource::ReadFromPipeToLinear(uint64_t offset, stream_renderer_box* box) {
     if (mResourceType != VirtioGpuResourceType::PIPE) {
         GFXSTREAM_ERROR("Failed to transfer: resource %d is not PIPE.", mId);
@@ -845,7 +876,8 @@ std::shared_ptr<RingBlob> VirtioGpuResource::ShareRingBlob() {
 
 #ifdef GFXSTREAM_BUILD_WITH_SNAPSHOT_FRONTEND_SUPPORT
 
-std::optional<VirtioGpuResourceSnapshot> VirtioGpuResource::Snapshot() const {
+std::optional<VirtioGpuResourceSnapshot> VirtioGpuResource::Snapshot(
+    const char* blobDirectory) const {
     VirtioGpuResourceSnapshot resourceSnapshot;
     resourceSnapshot.set_id(mId);
     resourceSnapshot.set_type(static_cast<::gfxstream::host::snapshot::VirtioGpuResourceType>(mResourceType));
@@ -877,7 +909,7 @@ std::optional<VirtioGpuResourceSnapshot> VirtioGpuResource::Snapshot() const {
         if (std::holds_alternative<RingBlobMemory>(*mBlobMemory)) {
             auto& memory = std::get<RingBlobMemory>(*mBlobMemory);
 
-            auto snapshotRingBlobOpt = memory->Snapshot();
+            auto snapshotRingBlobOpt = memory->Snapshot(blobDirectory);
             if (!snapshotRingBlobOpt) {
                 GFXSTREAM_ERROR("Failed to snapshot ring blob for resource %d.", mId);
                 return std::nullopt;
@@ -921,7 +953,7 @@ std::optional<VirtioGpuResourceSnapshot> VirtioGpuResource::Snapshot() const {
 }
 
 /*static*/ std::optional<VirtioGpuResource> VirtioGpuResource::Restore(
-    const VirtioGpuResourceSnapshot& resourceSnapshot) {
+    const VirtioGpuResourceSnapshot& resourceSnapshot, const char* blobDirectory) {
     VirtioGpuResource resource = {};
     resource.mId = resourceSnapshot.id();
     resource.mResourceType = static_cast<VirtioGpuResourceType>(resourceSnapshot.type());
@@ -954,7 +986,8 @@ std::optional<VirtioGpuResourceSnapshot> VirtioGpuResource::Snapshot() const {
     }
 
     if (resourceSnapshot.has_ring_blob()) {
-        auto resourceRingBlobOpt = RingBlob::Restore(resourceSnapshot.ring_blob());
+        auto resourceRingBlobOpt =
+            RingBlob::Restore(resourceSnapshot.ring_blob(), blobDirectory);
         if (!resourceRingBlobOpt) {
             GFXSTREAM_ERROR("Failed to restore ring blob for resource %d", resource.mId);
             return std::nullopt;
@@ -100,15 +100,25 @@ class VirtioGpuResource {
     int TransferWrite(uint64_t offset, stream_renderer_box* box,
                       std::optional<std::vector<struct iovec>> iovs = std::nullopt);
 
+    // Same as `TransferWrite()` except that, for resources whose backend is always updated
+    // in full from the linear buffer, the backend update is deferred to the next
+    // `FlushDeferredTransferWrites()` so that consecutive writes only update it once.
+    int TransferWriteDeferred(uint64_t offset, stream_renderer_box* box,
+                              std::optional<std::vector<struct iovec>> iovs = std::nullopt);
+    int FlushDeferredTransferWrites();
+
     int ExportBlob(struct stream_renderer_handle* outHandle);
 
     std::shared_ptr<RingBlob> ShareRingBlob();
 
 #ifdef GFXSTREAM_BUILD_WITH_SNAPSHOT_FRONTEND_SUPPORT
-    std::optional<gfxstream::host::snapshot::VirtioGpuResourceSnapshot> Snapshot() const;
+    // See `RingBlob::Snapshot()` for `blobDirectory`.
+    std::optional<gfxstream::host::snapshot::VirtioGpuResourceSnapshot> Snapshot(
+        const char* blobDirectory) const;
 
     static std::optional<VirtioGpuResource> Restore(
-        const gfxstream::host::snapshot::VirtioGpuResourceSnapshot& snapshot);
+        const gfxstream::host::snapshot::VirtioGpuResourceSnapshot& snapshot,
+        const char* blobDirectory);
 #endif
 
    private:
@@ -166,6 +176,9 @@ class VirtioGpuResource {
     using BlobMemory = std::variant<RingBlobMemory, ExternalMemoryInfo, ExternalMemoryMapping>;
     std::optional<BlobMemory> mBlobMemory;
     // LINT.ThenChange(VirtioGpuResourceSnapshot.proto:virtio_gpu_resource)
+
+    // Not snapshotted as deferred writes are always flushed before returning to the VMM.
+    bool mHasDeferredTransferWrites = false;
 };
 
 }  // namespace host
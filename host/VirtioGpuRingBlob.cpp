@@ -14,7 +14,18 @@
 
 #include "VirtioGpuRingBlob.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "gfxstream/common/logging.h"
 #include "gfxstream/virtio-gpu-gfxstream-renderer.h"
@@ -78,7 +89,58 @@ std::unique_ptr<RingBlob> RingBlob::CreateWithHostMemory(uint32_t id, uint64_t s
 
 using gfxstream::host::snapshot::VirtioGpuRingBlobSnapshot;
 
-std::optional<VirtioGpuRingBlobSnapshot> RingBlob::Snapshot() {
+namespace {
+
+// The granularity at which zero parts of blobs are skipped when writing binary snapshots.
+constexpr uint64_t kSnapshotChunkSize = 64 * 1024;
+
+constexpr const char kSnapshotFilePrefix[] = "gfxstream_ring_blob_";
+constexpr const char kSnapshotFileSuffix[] = ".bin";
+
+std::string SnapshotFilename(uint32_t id) {
+    return kSnapshotFilePrefix + std::to_string(id) + kSnapshotFileSuffix;
+}
+
+bool IsSnapshotFilename(const std::string& filename) {
+    const std::string_view name(filename);
+    const std::string_view prefix(kSnapshotFilePrefix);
+    const std::string_view suffix(kSnapshotFileSuffix);
+    if (name.size() <= prefix.size() + suffix.size() || name.substr(0, prefix.size()) != prefix ||
+        name.substr(name.size() - suffix.size()) != suffix) {
+        return false;
+    }
+    const std::string_view id =
+        name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+    return std::all_of(id.begin(), id.end(), [](char c) { return c >= '0' && c <= '9'; });
+}
+
+bool IsZero(const uint8_t* bytes, uint64_t size) {
+    uint8_t accumulated = 0;
+    for (uint64_t i = 0; i < size; i++) {
+        accumulated |= bytes[i];
+    }
+    return accumulated == 0;
+}
+
+bool WriteAt(int fd, const uint8_t* bytes, uint64_t size, uint64_t offset) {
+    while (size > 0) {
+        const ssize_t written = pwrite(fd, bytes, size, static_cast<off_t>(offset));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<uint64_t>(written);
+        offset += static_cast<uint64_t>(written);
+    }
+    return true;
+}
+
+}  // namespace
+
+std::optional<VirtioGpuRingBlobSnapshot> RingBlob::Snapshot(const char* directory) {
     VirtioGpuRingBlobSnapshot snapshot;
 
     snapshot.set_id(mId);
@@ -95,13 +157,73 @@ std::optional<VirtioGpuRingBlobSnapshot> RingBlob::Snapshot() {
         GFXSTREAM_ERROR("Failed to map ring blob memory for snapshot.");
         return std::nullopt;
     }
-    snapshot.set_memory(mapped, mSize);
 
+    if (directory == nullptr) {
+        snapshot.set_memory(mapped, mSize);
+        return snapshot;
+    }
+
+    const std::string filename = SnapshotFilename(mId);
+    const std::filesystem::path path = std::filesystem::path(directory) / filename;
+    int fd = open(path.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0660);
+    if (fd < 0) {
+        GFXSTREAM_ERROR("Failed to snapshot ring blob: failed to open %s", path.c_str());
+        return std::nullopt;
+    }
+    snapshot.set_memory_file(filename);
+
+    // Ring blobs are mostly unused, so only the non-zero chunks are written and the rest of
+    // the file is left as holes.
+    const uint8_t* bytes = static_cast<const uint8_t*>(mapped);
+    bool written = true;
+    uint64_t offset = 0;
+    while (written && offset < mSize) {
+        if (IsZero(bytes + offset, std::min(kSnapshotChunkSize, mSize - offset))) {
+            offset += kSnapshotChunkSize;
+            continue;
+        }
+        uint64_t end = std::min(offset + kSnapshotChunkSize, mSize);
+        while (end < mSize && !IsZero(bytes + end, std::min(kSnapshotChunkSize, mSize - end))) {
+            end = std::min(end + kSnapshotChunkSize, mSize);
+        }
+        written = WriteAt(fd, bytes + offset, end - offset, offset);
+
+        auto* range = snapshot.add_memory_ranges();
+        range->set_offset(offset);
+        range->set_size(end - offset);
+        offset = end;
+    }
+    if (written) {
+        written = ftruncate(fd, static_cast<off_t>(mSize)) == 0;
+    }
+    close(fd);
+
+    if (!written) {
+        GFXSTREAM_ERROR("Failed to snapshot ring blob: failed to write %s", path.c_str());
+        return std::nullopt;
+    }
     return snapshot;
 }
 
+/*static*/
+void RingBlob::RemoveSnapshotFiles(const char* directory) {
+    std::vector<std::filesystem::path> paths;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        if (IsSnapshotFilename(entry.path().filename().string())) {
+            paths.push_back(entry.path());
+        }
+    }
+    for (const auto& path : paths) {
+        std::error_code removeError;
+        if (!std::filesystem::remove(path, removeError)) {
+            GFXSTREAM_WARNING("Failed to remove stale ring blob snapshot %s", path.c_str());
+        }
+    }
+}
+
 /*static*/ std::optional<std::unique_ptr<RingBlob>> RingBlob::Restore(
-        const VirtioGpuRingBlobSnapshot& snapshot) {
+        const VirtioGpuRingBlobSnapshot& snapshot, const char* directory) {
 
     std::unique_ptr<RingBlob> resource;
     if (snapshot.type() == VirtioGpuRingBlobSnapshot::TYPE_SHARED_MEMORY) {
@@ -119,8 +241,66 @@ std::optional<VirtioGpuRingBlobSnapshot> RingBlob::Snapshot() {
         return std::nullopt;
     }
 
-    std::memcpy(mapped, snapshot.memory().c_str(), snapshot.memory().size());
+    if (snapshot.memory_file().empty()) {
+        std::memcpy(mapped, snapshot.memory().c_str(),
+                    std::min<uint64_t>(snapshot.memory().size(), snapshot.size()));
+        return resource;
+    }
+
+    if (directory == nullptr) {
+        GFXSTREAM_ERROR("Failed to restore ring blob: missing snapshot directory.");
+        return std::nullopt;
+    }
+    const std::filesystem::path path = std::filesystem::path(directory) / snapshot.memory_file();
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        GFXSTREAM_ERROR("Failed to restore ring blob: failed to open %s", path.c_str());
+        return std::nullopt;
+    }
+    struct stat fileStat = {};
+    if (fstat(fd, &fileStat) != 0 || static_cast<uint64_t>(fileStat.st_size) != snapshot.size()) {
+        GFXSTREAM_ERROR("Failed to restore ring blob: unexpected size of %s", path.c_str());
+        close(fd);
+        return std::nullopt;
+    }
+    void* file = nullptr;
+    if (snapshot.size() > 0) {
+        file = mmap(nullptr, snapshot.size(), PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (file == MAP_FAILED) {
+        GFXSTREAM_ERROR("Failed to restore ring blob: failed to map %s", path.c_str());
+        return std::nullopt;
+    }
+
+    // Freshly created shared memory is already zero but host memory is not.
+    const bool zeroHoles = snapshot.type() != VirtioGpuRingBlobSnapshot::TYPE_SHARED_MEMORY;
+    uint8_t* bytes = static_cast<uint8_t*>(mapped);
+    const uint8_t* fileBytes = static_cast<const uint8_t*>(file);
+    uint64_t restored = 0;
+    bool valid = true;
+    for (const auto& range : snapshot.memory_ranges()) {
+        if (range.offset() < restored || range.size() > snapshot.size() - range.offset()) {
+            valid = false;
+            break;
+        }
+        if (zeroHoles) {
+            std::memset(bytes + restored, 0, range.offset() - restored);
+        }
+        std::memcpy(bytes + range.offset(), fileBytes + range.offset(), range.size());
+        restored = range.offset() + range.size();
+    }
+    if (valid && zeroHoles) {
+        std::memset(bytes + restored, 0, snapshot.size() - restored);
+    }
+    if (file) {
+        munmap(file, snapshot.size());
+    }
 
+    if (!valid) {
+        GFXSTREAM_ERROR("Failed to restore ring blob: invalid memory ranges.");
+        return std::nullopt;
+    }
     return resource;
 }
 
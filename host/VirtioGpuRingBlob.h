@@ -15,6 +15,7 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <variant>
 
 #ifdef GFXSTREAM_BUILD_WITH_SNAPSHOT_FRONTEND_SUPPORT
@@ -62,10 +63,18 @@ class RingBlob {
     uint64_t size() const { return mSize; }
 
 #ifdef GFXSTREAM_BUILD_WITH_SNAPSHOT_FRONTEND_SUPPORT
-    std::optional<gfxstream::host::snapshot::VirtioGpuRingBlobSnapshot> Snapshot();
+    // If `directory` is null, the contents of the blob are inlined into the snapshot.
+    // Otherwise, the non-zero parts of the blob are written to a sparse file in `directory`.
+    std::optional<gfxstream::host::snapshot::VirtioGpuRingBlobSnapshot> Snapshot(
+        const char* directory);
 
     static std::optional<std::unique_ptr<RingBlob>> Restore(
-        const gfxstream::host::snapshot::VirtioGpuRingBlobSnapshot& snapshot);
+        const gfxstream::host::snapshot::VirtioGpuRingBlobSnapshot& snapshot,
+        const char* directory);
+
+    // Removes the files written by `Snapshot()` for earlier snapshots in `directory`, so that
+    // blobs that no longer exist do not leave their files behind.
+    static void RemoveSnapshotFiles(const char* directory);
 #endif
 
   private:
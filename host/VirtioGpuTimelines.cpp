@@ -13,6 +13,7 @@
 // limitations under the License.
 #include "VirtioGpuTimelines.h"
 
+#include <algorithm>
 #include <cinttypes>
 #include <cstdio>
 
@@ -28,135 +29,308 @@ std::unique_ptr<VirtioGpuTimelines> VirtioGpuTimelines::create(FenceCompletionCa
 }
 
 VirtioGpuTimelines::VirtioGpuTimelines(FenceCompletionCallback callback)
-    : mFenceCompletionCallback(std::move(callback)), mNextId(0) {
+    : mFenceCompletionCallback(std::move(callback)) {
         gfxstream::host::InitializeTracing();
     }
 
+VirtioGpuTimelines::~VirtioGpuTimelines() {
+    const uint32_t count = mTimelineCount.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < count; i++) {
+        delete GetTimeline(i);
+    }
+}
+
+/*static*/
+TaskId VirtioGpuTimelines::makeTaskId(uint32_t timelineIndex, uint32_t taskIndex,
+                                      uint32_t generation) {
+    return (static_cast<TaskId>(timelineIndex) << (kTaskIndexBits + kTaskGenerationBits)) |
+           (static_cast<TaskId>(taskIndex) << kTaskGenerationBits) |
+           (generation & ((1u << kTaskGenerationBits) - 1));
+}
+
+/*static*/
+uint32_t VirtioGpuTimelines::getTimelineIndex(TaskId taskId) {
+    return static_cast<uint32_t>(taskId >> (kTaskIndexBits + kTaskGenerationBits));
+}
+
+/*static*/
+uint32_t VirtioGpuTimelines::getTaskIndex(TaskId taskId) {
+    return static_cast<uint32_t>(taskId >> kTaskGenerationBits) & ((1u << kTaskIndexBits) - 1);
+}
+
+void VirtioGpuTimelines::TimelineQueue::push_back(const TimelineItem& item) {
+    if (mSize == mItems.size()) {
+        std::vector<TimelineItem> items(std::max<size_t>(16, mItems.size() * 2));
+        for (size_t i = 0; i < mSize; i++) {
+            items[i] = (*this)[i];
+        }
+        mItems = std::move(items);
+        mHead = 0;
+    }
+    mItems[(mHead + mSize) & (mItems.size() - 1)] = item;
+    ++mSize;
+}
+
+void VirtioGpuTimelines::TimelineQueue::pop_front() {
+    mHead = (mHead + 1) & (mItems.size() - 1);
+    --mSize;
+}
+
 TaskId VirtioGpuTimelines::enqueueTask(const Ring& ring) {
-    std::lock_guard<std::mutex> lock(mTimelinesMutex);
+    Timeline* timeline = GetOrCreateTimeline(ring);
 
-    TaskId id = mNextId++;
+    std::lock_guard<std::mutex> lock(timeline->mMutex);
 
     const uint64_t traceId = gfxstream::host::GetUniqueTracingId();
+    const TaskId id = timeline->enqueueTaskLocked(traceId, /*completed=*/false);
+
     GFXSTREAM_TRACE_EVENT_INSTANT(GFXSTREAM_TRACE_VIRTIO_GPU_TIMELINE_CATEGORY,
                                   "Queue timeline task", "Task ID", id,
                                   GFXSTREAM_TRACE_FLOW(traceId));
+    return id;
+}
 
-    std::shared_ptr<Task> task(new Task(id, ring, traceId), [this](Task* task) {
-        mTaskIdToTask.erase(task->mId);
-        delete task;
-    });
-    mTaskIdToTask[id] = task;
+TaskId VirtioGpuTimelines::Timeline::enqueueTaskLocked(uint64_t traceId, bool completed) {
+    uint32_t index = 0;
+    if (!mFreeTaskIndices.empty()) {
+        index = mFreeTaskIndices.back();
+        mFreeTaskIndices.pop_back();
+    } else {
+        index = mNextUnusedTaskIndex++;
+    }
+
+    Task* task = mTasks.getOrCreate(index);
+    if (!task) {
+        const std::string ringString = to_string(mRing);
+        GFXSTREAM_FATAL("Too many pending tasks on ring(%s).", ringString.c_str());
+    }
+
+    // Skips generation 0 so that task ids are never 0.
+    if ((++task->mGeneration & ((1u << kTaskGenerationBits) - 1)) == 0) {
+        ++task->mGeneration;
+    }
+    const TaskId id = makeTaskId(mIndex, index, task->mGeneration);
+
+    task->mTraceId = traceId;
+    task->mHasCompleted.store(completed, std::memory_order_relaxed);
+    task->mId.store(id, std::memory_order_release);
 
-    Timeline& timeline = GetOrCreateTimelineLocked(ring);
-    timeline.mQueue.emplace_back(std::move(task));
+    mQueue.push_back(TimelineItem{
+        .mType = TimelineItem::Type::kTask,
+        .mId = id,
+    });
     return id;
 }
 
 void VirtioGpuTimelines::enqueueFence(const Ring& ring, FenceId fenceId) {
-    std::lock_guard<std::mutex> lock(mTimelinesMutex);
+    Timeline* timeline = GetOrCreateTimeline(ring);
+
+    std::lock_guard<std::mutex> lock(timeline->mMutex);
 
-    Timeline& timeline = GetOrCreateTimelineLocked(ring);
-    timeline.mQueue.emplace_back(fenceId);
+    timeline->mQueue.push_back(TimelineItem{
+        .mType = TimelineItem::Type::kFence,
+        .mId = fenceId,
+    });
 
-    poll_locked(ring);
+    poll_locked(*timeline);
 }
 
-void VirtioGpuTimelines::notifyTaskCompletion(TaskId taskId) {
-    std::lock_guard<std::mutex> lock(mTimelinesMutex);
-    auto iTask = mTaskIdToTask.find(taskId);
-    if (iTask == mTaskIdToTask.end()) {
-        GFXSTREAM_FATAL("Task(id = " PRIu64 " can't be found", static_cast<uint64_t>(taskId));
+void VirtioGpuTimelines::enqueueFences(const Ring& ring, const std::vector<FenceId>& fenceIds) {
+    if (fenceIds.empty()) {
+        return;
     }
-    std::shared_ptr<Task> task = iTask->second.lock();
-    if (task == nullptr) {
-        GFXSTREAM_FATAL("Task(id = " PRIu64 " has been destroyed", static_cast<uint64_t>(taskId));
+
+    Timeline* timeline = GetOrCreateTimeline(ring);
+
+    std::lock_guard<std::mutex> lock(timeline->mMutex);
+
+    for (FenceId fenceId : fenceIds) {
+        timeline->mQueue.push_back(TimelineItem{
+            .mType = TimelineItem::Type::kFence,
+            .mId = fenceId,
+        });
     }
-    if (task->mId != taskId) {
-        GFXSTREAM_FATAL("Task id mismatch. Expected " PRIu64 " actual " PRIu64,
-                        static_cast<uint64_t>(taskId), static_cast<uint64_t>(task->mId));
+
+    poll_locked(*timeline);
+}
+
+void VirtioGpuTimelines::notifyTaskCompletion(TaskId taskId) {
+    Timeline* timeline = GetTimeline(getTimelineIndex(taskId));
+    Task* task = timeline ? timeline->mTasks.get(getTaskIndex(taskId)) : nullptr;
+    if (taskId == 0 || task == nullptr || task->mId.load(std::memory_order_acquire) != taskId) {
+        GFXSTREAM_FATAL("Task(id = %" PRIu64 ") can't be found", static_cast<uint64_t>(taskId));
     }
-    if (task->mHasCompleted) {
-        GFXSTREAM_FATAL("Task(id = " PRIu64 " has been set to completed", static_cast<uint64_t>(taskId));
+    if (task->mHasCompleted.exchange(true, std::memory_order_acq_rel)) {
+        GFXSTREAM_FATAL("Task(id = %" PRIu64 ") has been set to completed",
+                        static_cast<uint64_t>(taskId));
     }
 
     GFXSTREAM_TRACE_EVENT_INSTANT(GFXSTREAM_TRACE_VIRTIO_GPU_TIMELINE_CATEGORY,
                                   "Notify timeline task completed",
-                                  GFXSTREAM_TRACE_FLOW(task->mTraceId), "Task ID", task->mId);
+                                  GFXSTREAM_TRACE_FLOW(task->mTraceId), "Task ID", taskId);
 
-    task->mHasCompleted = true;
+    bool release = false;
+    {
+        std::lock_guard<std::mutex> lock(timeline->mMutex);
+        poll_locked(*timeline);
+        release = ShouldReleaseLocked(*timeline);
+    }
+    if (release) {
+        ReleaseTimeline(timeline);
+    }
+}
 
-    poll_locked(task->mRing);
+void VirtioGpuTimelines::removeContext(VirtioGpuCtxId ctxId) {
+    std::vector<Timeline*> removedTimelines;
+    {
+        std::unique_lock<std::shared_mutex> lock(mTimelinesMutex);
+        for (auto it = mTimelinesByRing.begin(); it != mTimelinesByRing.end();) {
+            const auto* contextRing = std::get_if<VirtioGpuRingContextSpecific>(&it->first);
+            if (contextRing && contextRing->mCtxId == ctxId) {
+                removedTimelines.push_back(it->second);
+                it = mTimelinesByRing.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    for (Timeline* timeline : removedTimelines) {
+        bool release = false;
+        {
+            std::lock_guard<std::mutex> lock(timeline->mMutex);
+            timeline->mRemoved = true;
+            poll_locked(*timeline);
+            release = ShouldReleaseLocked(*timeline);
+        }
+        if (release) {
+            ReleaseTimeline(timeline);
+        }
+    }
+}
+
+uint32_t VirtioGpuTimelines::getTimelineCountForTesting() const {
+    return mTimelineCount.load(std::memory_order_acquire);
 }
 
-VirtioGpuTimelines::Timeline& VirtioGpuTimelines::GetOrCreateTimelineLocked(const Ring& ring) {
-    auto [it, inserted] =
-        mTimelineQueues.emplace(std::piecewise_construct, std::make_tuple(ring), std::make_tuple());
-    Timeline& timeline = it->second;
-    if (inserted) {
-        timeline.mTraceTrackId = gfxstream::host::GetUniqueTracingId();
+/*static*/
+bool VirtioGpuTimelines::ShouldReleaseLocked(Timeline& timeline) {
+    if (!timeline.mRemoved || timeline.mReleased || !timeline.mQueue.empty()) {
+        return false;
+    }
+    timeline.mReleased = true;
+    return true;
+}
 
-        const std::string timelineName = "Virtio Gpu Timeline " + to_string(ring);
-        GFXSTREAM_TRACE_NAME_TRACK(GFXSTREAM_TRACE_TRACK(timeline.mTraceTrackId), timelineName);
+void VirtioGpuTimelines::ReleaseTimeline(Timeline* timeline) {
+    std::unique_lock<std::shared_mutex> lock(mTimelinesMutex);
+    mFreeTimelines.push_back(timeline);
+}
 
+VirtioGpuTimelines::Timeline* VirtioGpuTimelines::GetOrCreateTimeline(
+    const Ring& ring, std::optional<uint64_t> traceTrackId) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mTimelinesMutex);
+        auto it = mTimelinesByRing.find(ring);
+        if (it != mTimelinesByRing.end()) {
+            return it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mTimelinesMutex);
+    auto it = mTimelinesByRing.find(ring);
+    if (it != mTimelinesByRing.end()) {
+        return it->second;
+    }
+
+    const uint64_t trackId = traceTrackId ? *traceTrackId : gfxstream::host::GetUniqueTracingId();
+    const std::string timelineName = "Virtio Gpu Timeline " + to_string(ring);
+
+    if (!mFreeTimelines.empty()) {
+        // Keeps the tasks of the timeline, whose generations make sure that the ids of the
+        // tasks of the previous ring are never handed out again.
+        Timeline* timeline = mFreeTimelines.back();
+        mFreeTimelines.pop_back();
+        {
+            std::lock_guard<std::mutex> timelineLock(timeline->mMutex);
+            timeline->mRing = ring;
+            timeline->mTraceTrackId = trackId;
+            timeline->mRemoved = false;
+            timeline->mReleased = false;
+        }
+        mTimelinesByRing.emplace(ring, timeline);
+
+        GFXSTREAM_TRACE_NAME_TRACK(GFXSTREAM_TRACE_TRACK(trackId), timelineName);
         GFXSTREAM_TRACE_EVENT_INSTANT(GFXSTREAM_TRACE_VIRTIO_GPU_TIMELINE_CATEGORY,
-                                      "Create Timeline",
-                                      GFXSTREAM_TRACE_TRACK(timeline.mTraceTrackId));
+                                      "Reuse Timeline", GFXSTREAM_TRACE_TRACK(trackId));
+        return timeline;
+    }
+
+    const uint32_t index = mTimelineCount.load(std::memory_order_relaxed);
+    std::atomic<Timeline*>* slot = mTimelines.getOrCreate(index);
+    if (!slot) {
+        GFXSTREAM_FATAL("Too many virtio gpu timelines.");
     }
 
+    auto* timeline = new Timeline(ring, index, trackId);
+    slot->store(timeline, std::memory_order_release);
+    mTimelineCount.store(index + 1, std::memory_order_release);
+    mTimelinesByRing.emplace(ring, timeline);
+
+    GFXSTREAM_TRACE_NAME_TRACK(GFXSTREAM_TRACE_TRACK(trackId), timelineName);
+
+    GFXSTREAM_TRACE_EVENT_INSTANT(GFXSTREAM_TRACE_VIRTIO_GPU_TIMELINE_CATEGORY,
+                                  "Create Timeline", GFXSTREAM_TRACE_TRACK(trackId));
+
     return timeline;
 }
 
+VirtioGpuTimelines::Timeline* VirtioGpuTimelines::GetTimeline(uint32_t index) const {
+    std::atomic<Timeline*>* slot = mTimelines.get(index);
+    return slot ? slot->load(std::memory_order_acquire) : nullptr;
+}
+
 void VirtioGpuTimelines::poll() {
-    std::lock_guard<std::mutex> lock(mTimelinesMutex);
-    for (const auto& [ring, timeline] : mTimelineQueues) {
-        poll_locked(ring);
+    const uint32_t count = mTimelineCount.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < count; i++) {
+        Timeline* timeline = GetTimeline(i);
+        std::lock_guard<std::mutex> lock(timeline->mMutex);
+        if (!timeline->mQueue.empty()) {
+            poll_locked(*timeline);
+        }
     }
 }
-void VirtioGpuTimelines::poll_locked(const Ring& ring) {
-    auto timelineIt = mTimelineQueues.find(ring);
-    if (timelineIt == mTimelineQueues.end()) {
-        const std::string ringString = to_string(ring);
-        GFXSTREAM_FATAL("Ring(%s) doesn't exist.", ringString.c_str());
-    }
-    Timeline& timeline = timelineIt->second;
 
+void VirtioGpuTimelines::poll_locked(Timeline& timeline) {
     auto& timelineQueue = timeline.mQueue;
-    auto i = timelineQueue.begin();
-    for (; i != timelineQueue.end(); i++) {
-        bool shouldStop = std::visit(
-            [&](auto& arg) {
-                using T = std::decay_t<decltype(arg)>;
-                if constexpr (std::is_same_v<T, FenceId>) {
-                    auto& fenceId = arg;
-
-                    GFXSTREAM_TRACE_EVENT_INSTANT(
-                        GFXSTREAM_TRACE_VIRTIO_GPU_TIMELINE_CATEGORY, "Signal Virtio Gpu Fence",
-                        GFXSTREAM_TRACE_TRACK(timeline.mTraceTrackId), "Fence", fenceId);
-
-                    mFenceCompletionCallback(ring, fenceId);
-
-                    return false;
-                } else if constexpr (std::is_same_v<T, std::shared_ptr<Task>>) {
-                    auto& task = arg;
-
-                    const bool completed = task->mHasCompleted;
-                    if (completed) {
-                        GFXSTREAM_TRACE_EVENT_INSTANT(
-                            GFXSTREAM_TRACE_VIRTIO_GPU_TIMELINE_CATEGORY, "Process Task Complete",
-                            GFXSTREAM_TRACE_TRACK(timeline.mTraceTrackId),
-                            GFXSTREAM_TRACE_FLOW(task->mTraceId), "Task", task->mId);
-                    }
-                    return !completed;
-                }
-            },
-            *i);
-
-        if (shouldStop) {
-            break;
+    while (!timelineQueue.empty()) {
+        const TimelineItem item = timelineQueue[0];
+        if (item.mType == TimelineItem::Type::kFence) {
+            const FenceId fenceId = item.mId;
+
+            GFXSTREAM_TRACE_EVENT_INSTANT(
+                GFXSTREAM_TRACE_VIRTIO_GPU_TIMELINE_CATEGORY, "Signal Virtio Gpu Fence",
+                GFXSTREAM_TRACE_TRACK(timeline.mTraceTrackId), "Fence", fenceId);
+
+            std::lock_guard<std::mutex> callbackLock(mFenceCompletionCallbackMutex);
+            mFenceCompletionCallback(timeline.mRing, fenceId);
+        } else {
+            const TaskId taskId = item.mId;
+            Task* task = timeline.mTasks.get(getTaskIndex(taskId));
+            if (!task->mHasCompleted.load(std::memory_order_acquire)) {
+                break;
+            }
+
+            GFXSTREAM_TRACE_EVENT_INSTANT(
+                GFXSTREAM_TRACE_VIRTIO_GPU_TIMELINE_CATEGORY, "Process Task Complete",
+                GFXSTREAM_TRACE_TRACK(timeline.mTraceTrackId),
+                GFXSTREAM_TRACE_FLOW(task->mTraceId), "Task", taskId);
+
+            task->mId.store(0, std::memory_order_relaxed);
+            timeline.mFreeTaskIndices.push_back(getTaskIndex(taskId));
         }
+        timelineQueue.pop_front();
     }
-    timelineQueue.erase(timelineQueue.begin(), i);
 }
 
 #ifdef GFXSTREAM_BUILD_WITH_SNAPSHOT_FRONTEND_SUPPORT
@@ -193,107 +367,75 @@ std::optional<VirtioGpuRing> RestoreRing(const gfxstream::host::snapshot::Virtio
     }
 }
 
-/*static*/
-std::optional<gfxstream::host::snapshot::VirtioGpuTimelineItem>
-VirtioGpuTimelines::SnapshotTimelineItem(const TimelineItem& timelineItem) {
-    gfxstream::host::snapshot::VirtioGpuTimelineItem snapshot;
-
-    if (std::holds_alternative<FenceId>(timelineItem)) {
-        auto fenceId = std::get<FenceId>(timelineItem);
-
-        auto* fenceSnapshot = snapshot.mutable_fence();
-        fenceSnapshot->set_id(fenceId);
-    } else if (std::holds_alternative<std::shared_ptr<Task>>(timelineItem)) {
-        const auto& task = std::get<std::shared_ptr<Task>>(timelineItem);
-
-        auto ringOpt = SnapshotRing(task->mRing);
-        if (!ringOpt) {
-            GFXSTREAM_ERROR("Failed to snapshot timeline item: failed to snapshot ring.");
-            return std::nullopt;
-        }
-
-        auto* taskSnapshot = snapshot.mutable_task();
-        taskSnapshot->set_id(task->mId);
-        taskSnapshot->mutable_ring()->Swap(&*ringOpt);
-        taskSnapshot->set_trace_id(task->mTraceId);
-        taskSnapshot->set_completed(task->mHasCompleted);
-    } else {
-        GFXSTREAM_ERROR("Failed to snapshot timeline item: unhandled.");
-        return std::nullopt;
-    }
-
-    return snapshot;
-}
-
-/*static*/
-std::optional<VirtioGpuTimelines::TimelineItem> VirtioGpuTimelines::RestoreTimelineItem(
-    const gfxstream::host::snapshot::VirtioGpuTimelineItem& snapshot) {
-    if (snapshot.has_fence()) {
-        return snapshot.fence().id();
-    } else if (snapshot.has_task()) {
-        const auto& taskSnapshot = snapshot.task();
-
-        auto ringOpt = RestoreRing(taskSnapshot.ring());
-        if (!ringOpt) {
-            GFXSTREAM_ERROR("Failed to restore timeline item: failed to restore ring.");
-            return std::nullopt;
-        }
-
-        auto task = std::make_shared<Task>(taskSnapshot.id(), *ringOpt, taskSnapshot.trace_id());
-        task->mHasCompleted = taskSnapshot.completed();
-        return task;
-    }
-
-    GFXSTREAM_ERROR("Failed to restore timeline item: unhandled.");
-    return std::nullopt;
-}
-
 std::optional<gfxstream::host::snapshot::VirtioGpuTimeline> VirtioGpuTimelines::Timeline::Snapshot()
     const {
     gfxstream::host::snapshot::VirtioGpuTimeline timeline;
     timeline.set_trace_id(mTraceTrackId);
-    for (const auto& timelineItem : mQueue) {
-        auto timelineItemSnapshotOpt = SnapshotTimelineItem(timelineItem);
-        if (!timelineItemSnapshotOpt) {
-            GFXSTREAM_ERROR("Failed to snapshot timeline item.");
-            return std::nullopt;
+    for (size_t i = 0; i < mQueue.size(); i++) {
+        const TimelineItem& timelineItem = mQueue[i];
+
+        gfxstream::host::snapshot::VirtioGpuTimelineItem timelineItemSnapshot;
+        if (timelineItem.mType == TimelineItem::Type::kFence) {
+            timelineItemSnapshot.mutable_fence()->set_id(timelineItem.mId);
+        } else {
+            const Task* task = mTasks.get(getTaskIndex(timelineItem.mId));
+
+            auto ringOpt = SnapshotRing(mRing);
+            if (!ringOpt) {
+                GFXSTREAM_ERROR("Failed to snapshot timeline item: failed to snapshot ring.");
+                return std::nullopt;
+            }
+
+            auto* taskSnapshot = timelineItemSnapshot.mutable_task();
+            taskSnapshot->set_id(timelineItem.mId);
+            taskSnapshot->mutable_ring()->Swap(&*ringOpt);
+            taskSnapshot->set_trace_id(task->mTraceId);
+            taskSnapshot->set_completed(task->mHasCompleted.load(std::memory_order_acquire));
         }
-        timeline.mutable_items()->Add(std::move(*timelineItemSnapshotOpt));
+        timeline.mutable_items()->Add(std::move(timelineItemSnapshot));
     }
     return timeline;
 }
 
-/*static*/
-std::optional<VirtioGpuTimelines::Timeline> VirtioGpuTimelines::Timeline::Restore(
+bool VirtioGpuTimelines::Timeline::Restore(
     const gfxstream::host::snapshot::VirtioGpuTimeline& snapshot) {
-    VirtioGpuTimelines::Timeline timeline;
-    timeline.mTraceTrackId = snapshot.trace_id();
     for (const auto& timelineItemSnapshot : snapshot.items()) {
-        auto timelineItemOpt = RestoreTimelineItem(timelineItemSnapshot);
-        if (!timelineItemOpt) {
-            GFXSTREAM_ERROR("Failed to snapshot timeline item.");
-            return std::nullopt;
+        if (timelineItemSnapshot.has_fence()) {
+            mQueue.push_back(TimelineItem{
+                .mType = TimelineItem::Type::kFence,
+                .mId = timelineItemSnapshot.fence().id(),
+            });
+        } else if (timelineItemSnapshot.has_task()) {
+            // Task ids depend on where the task lives, so restored tasks get new ids. Nothing
+            // can still hold the old ids as the waits that completed tasks are not restored.
+            const auto& taskSnapshot = timelineItemSnapshot.task();
+            enqueueTaskLocked(taskSnapshot.trace_id(), taskSnapshot.completed());
+        } else {
+            GFXSTREAM_ERROR("Failed to restore timeline item: unhandled.");
+            return false;
         }
-        timeline.mQueue.emplace_back(std::move(*timelineItemOpt));
     }
-    return timeline;
+    return true;
 }
 
 std::optional<gfxstream::host::snapshot::VirtioGpuTimelinesSnapshot> VirtioGpuTimelines::Snapshot()
     const {
-    std::lock_guard<std::mutex> lock(mTimelinesMutex);
+    std::shared_lock<std::shared_mutex> lock(mTimelinesMutex);
 
     gfxstream::host::snapshot::VirtioGpuTimelinesSnapshot snapshot;
-    snapshot.set_next_id(mNextId);
 
-    for (const auto& [ring, timeline] : mTimelineQueues) {
+    for (const auto& [ring, timeline] : mTimelinesByRing) {
         auto ringSnapshotOpt = SnapshotRing(ring);
         if (!ringSnapshotOpt) {
             GFXSTREAM_ERROR("Failed to snapshot timelines: failed to snapshot ring.");
             return std::nullopt;
         }
 
-        auto timelineSnapshotOpt = timeline.Snapshot();
+        std::optional<gfxstream::host::snapshot::VirtioGpuTimeline> timelineSnapshotOpt;
+        {
+            std::lock_guard<std::mutex> timelineLock(timeline->mMutex);
+            timelineSnapshotOpt = timeline->Snapshot();
+        }
         if (!timelineSnapshotOpt) {
             GFXSTREAM_ERROR("Failed to snapshot timelines: failed to snapshot timeline.");
             return std::nullopt;
@@ -313,10 +455,6 @@ std::unique_ptr<VirtioGpuTimelines> VirtioGpuTimelines::Restore(
     const gfxstream::host::snapshot::VirtioGpuTimelinesSnapshot& snapshot) {
     std::unique_ptr<VirtioGpuTimelines> timelines(new VirtioGpuTimelines(std::move(callback)));
 
-    std::lock_guard<std::mutex> lock(timelines->mTimelinesMutex);
-
-    timelines->mNextId.store(snapshot.next_id());
-
     for (const auto& timelineSnapshot : snapshot.timelines()) {
         if (!timelineSnapshot.has_ring()) {
             GFXSTREAM_ERROR("Failed to restore timelines: missing ring.");
@@ -332,23 +470,14 @@ std::unique_ptr<VirtioGpuTimelines> VirtioGpuTimelines::Restore(
             GFXSTREAM_ERROR("Failed to restore timelines: missing timeline.");
             return nullptr;
         }
-        auto timelineOpt = Timeline::Restore(timelineSnapshot.timeline());
-        if (!timelineOpt) {
+        Timeline* timeline =
+            timelines->GetOrCreateTimeline(*ringOpt, timelineSnapshot.timeline().trace_id());
+
+        std::lock_guard<std::mutex> timelineLock(timeline->mMutex);
+        if (!timeline->Restore(timelineSnapshot.timeline())) {
             GFXSTREAM_ERROR("Failed to restore timelines: failed to restore timeline.");
             return nullptr;
         }
-
-        timelines->mTimelineQueues[std::move(*ringOpt)] = std::move(*timelineOpt);
-    }
-
-    // Rebuild task index:
-    for (const auto& [_, timeline] : timelines->mTimelineQueues) {
-        for (const auto& timelineItem : timeline.mQueue) {
-            if (std::holds_alternative<std::shared_ptr<Task>>(timelineItem)) {
-                auto& task = std::get<std::shared_ptr<Task>>(timelineItem);
-                timelines->mTaskIdToTask[task->mId] = task;
-            }
-        }
     }
 
     return timelines;
@@ -14,15 +14,22 @@
 #ifndef VIRTIO_GPU_TIMELINES_H
 #define VIRTIO_GPU_TIMELINES_H
 
+#include <array>
 #include <atomic>
 #include <functional>
-#include <list>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <shared_mutex>
 #include <sstream>
 #include <string>
 #include <unordered_map>
 #include <variant>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 #ifdef GFXSTREAM_BUILD_WITH_SNAPSHOT_FRONTEND_SUPPORT
 #include "VirtioGpuTimelinesSnapshot.pb.h"
@@ -87,10 +94,22 @@ class VirtioGpuTimelines {
 
     static std::unique_ptr<VirtioGpuTimelines> create(FenceCompletionCallback callback);
 
+    ~VirtioGpuTimelines();
+
     TaskId enqueueTask(const Ring&);
     void enqueueFence(const Ring&, FenceId);
+    // Same as `enqueueFence()` for each of the fences but only looks up, locks and polls the
+    // timeline once.
+    void enqueueFences(const Ring&, const std::vector<FenceId>&);
+    // Lock free apart from the lock of the timeline of the task, which is then polled.
     void notifyTaskCompletion(TaskId);
     void poll();
+    // Removes the timelines of the rings of the context. The fences already queued on them
+    // are still signaled once their tasks complete, after which the timelines are reused.
+    void removeContext(VirtioGpuCtxId);
+
+    // Number of timelines that were ever created, whether used or not.
+    uint32_t getTimelineCountForTesting() const;
 
 #ifdef GFXSTREAM_BUILD_WITH_SNAPSHOT_FRONTEND_SUPPORT
     std::optional<gfxstream::host::snapshot::VirtioGpuTimelinesSnapshot> Snapshot() const;
@@ -103,62 +122,189 @@ class VirtioGpuTimelines {
    private:
     VirtioGpuTimelines(FenceCompletionCallback callback);
 
-    struct Task {
-        Task(TaskId id, const Ring& ring, uint64_t traceId)
-            : mId(id), mRing(ring), mTraceId(traceId), mHasCompleted(false) {}
+    // Task ids encode where their task lives so that completing a task does not need any
+    // lookup shared between timelines: the index of the timeline in the top bits, followed by
+    // the index of the task within its timeline and a generation that is bumped every time the
+    // task slot is reused. Task ids are never 0.
+    static constexpr uint32_t kTaskGenerationBits = 20;
+    static constexpr uint32_t kTaskIndexBits = 24;
+    static constexpr uint32_t kTimelineIndexBits = 64 - kTaskIndexBits - kTaskGenerationBits;
+
+    static TaskId makeTaskId(uint32_t timelineIndex, uint32_t taskIndex, uint32_t generation);
+    static uint32_t getTimelineIndex(TaskId taskId);
+    static uint32_t getTaskIndex(TaskId taskId);
+
+    // An array whose elements never move once created, so that they can be read without a
+    // lock while it grows. Element `i` lives in chunk `log2(i + 64) - 6`, with chunks doubling
+    // in size.
+    template <typename T, uint32_t kIndexBits>
+    class StableArray {
+       public:
+        StableArray() {
+            for (auto& chunk : mChunks) {
+                chunk.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+        ~StableArray() {
+            for (auto& chunk : mChunks) {
+                delete[] chunk.load(std::memory_order_relaxed);
+            }
+        }
+
+        // Returns nullptr if the element was never created.
+        T* get(uint32_t index) const {
+            if (index >> kIndexBits) {
+                return nullptr;
+            }
+            uint32_t chunk = 0;
+            size_t offset = 0;
+            getChunkAndOffset(index, &chunk, &offset);
+            T* elements = mChunks[chunk].load(std::memory_order_acquire);
+            return elements ? &elements[offset] : nullptr;
+        }
+
+        // Must not race with itself. Returns nullptr if `index` does not fit.
+        T* getOrCreate(uint32_t index) {
+            if (index >> kIndexBits) {
+                return nullptr;
+            }
+            uint32_t chunk = 0;
+            size_t offset = 0;
+            getChunkAndOffset(index, &chunk, &offset);
+            T* elements = mChunks[chunk].load(std::memory_order_relaxed);
+            if (!elements) {
+                elements = new T[size_t(1) << (kFirstChunkBits + chunk)]();
+                mChunks[chunk].store(elements, std::memory_order_release);
+            }
+            return &elements[offset];
+        }
+
+       private:
+        static constexpr uint32_t kFirstChunkBits = 6;
+        static constexpr uint32_t kMaxChunks = kIndexBits - kFirstChunkBits + 1;
+
+        static void getChunkAndOffset(uint32_t index, uint32_t* chunk, size_t* offset) {
+            const uint64_t biased = uint64_t(index) + (uint64_t(1) << kFirstChunkBits);
+#if defined(_MSC_VER)
+            unsigned long bit = 0;
+            _BitScanReverse64(&bit, biased);
+#else
+            const uint32_t bit = 63 - static_cast<uint32_t>(__builtin_clzll(biased));
+#endif
+            *chunk = bit - kFirstChunkBits;
+            *offset = static_cast<size_t>(biased - (uint64_t(1) << bit));
+        }
 
+        std::array<std::atomic<T*>, kMaxChunks> mChunks;
+    };
+
+    struct Task {
         // LINT.IfChange(virtio_gpu_timeline_task)
-        TaskId mId;
-        Ring mRing;
-        uint64_t mTraceId;
-        std::atomic_bool mHasCompleted;
+        // The id of the task while it is queued on its timeline and 0 otherwise.
+        std::atomic<TaskId> mId{0};
+        uint64_t mTraceId = 0;
+        std::atomic_bool mHasCompleted{false};
         // LINT.ThenChange(VirtioGpuTimelinesSnapshot.proto:virtio_gpu_timeline_task)
+
+        // Only accessed with the lock of the timeline held.
+        uint32_t mGeneration = 0;
     };
 
     // LINT.IfChange(virtio_gpu_timeline_item)
-    using TimelineItem = std::variant<FenceId, std::shared_ptr<Task>>;
+    struct TimelineItem {
+        enum class Type : uint8_t {
+            kFence,
+            kTask,
+        };
+        Type mType;
+        // A `FenceId` or a `TaskId` depending on `mType`.
+        uint64_t mId;
+    };
     // LINT.ThenChange(VirtioGpuTimelinesSnapshot.proto:virtio_gpu_timeline_item)
 
-#ifdef GFXSTREAM_BUILD_WITH_SNAPSHOT_FRONTEND_SUPPORT
-    static std::optional<gfxstream::host::snapshot::VirtioGpuTimelineItem> SnapshotTimelineItem(
-        const TimelineItem& timelineItem);
+    // The items of a timeline in submission order, in a ring buffer that doubles in size when
+    // full instead of allocating per item.
+    class TimelineQueue {
+       public:
+        bool empty() const { return mSize == 0; }
+        size_t size() const { return mSize; }
+        const TimelineItem& operator[](size_t i) const {
+            return mItems[(mHead + i) & (mItems.size() - 1)];
+        }
+        void push_back(const TimelineItem& item);
+        void pop_front();
 
-    static std::optional<TimelineItem> RestoreTimelineItem(
-        const gfxstream::host::snapshot::VirtioGpuTimelineItem& snapshot);
-#endif
+       private:
+        std::vector<TimelineItem> mItems;
+        size_t mHead = 0;
+        size_t mSize = 0;
+    };
 
     struct Timeline {
+        Timeline(const Ring& ring, uint32_t index, uint64_t traceTrackId)
+            : mIndex(index), mRing(ring), mTraceTrackId(traceTrackId) {}
+
+        const uint32_t mIndex;
+
+        std::mutex mMutex;
+        // Timelines are reused for other rings once removed and empty.
+        Ring mRing GUARDED_BY(mMutex);
         // LINT.IfChange(virtio_gpu_timeline)
-        uint64_t mTraceTrackId;
-        std::list<TimelineItem> mQueue;
+        uint64_t mTraceTrackId GUARDED_BY(mMutex);
+        TimelineQueue mQueue GUARDED_BY(mMutex);
         // LINT.ThenChange(VirtioGpuTimelinesSnapshot.proto:virtio_gpu_timeline)
+        // Set once the ring of the timeline is gone, so that nothing new is queued on it.
+        bool mRemoved GUARDED_BY(mMutex) = false;
+        // Set once the removed timeline is empty and handed back for reuse.
+        bool mReleased GUARDED_BY(mMutex) = false;
+
+        // The tasks of the timeline, indexed by `getTaskIndex()`. Created with `mMutex` held
+        // but read without it when tasks complete.
+        StableArray<Task, kTaskIndexBits> mTasks;
+        std::vector<uint32_t> mFreeTaskIndices GUARDED_BY(mMutex);
+        uint32_t mNextUnusedTaskIndex GUARDED_BY(mMutex) = 0;
+
+        TaskId enqueueTaskLocked(uint64_t traceId, bool completed) REQUIRES(mMutex);
 
 #ifdef GFXSTREAM_BUILD_WITH_SNAPSHOT_FRONTEND_SUPPORT
-        std::optional<gfxstream::host::snapshot::VirtioGpuTimeline> Snapshot() const;
+        std::optional<gfxstream::host::snapshot::VirtioGpuTimeline> Snapshot() const
+            REQUIRES(mMutex);
 
-        static std::optional<Timeline> Restore(
-            const gfxstream::host::snapshot::VirtioGpuTimeline& snapshot);
+        bool Restore(const gfxstream::host::snapshot::VirtioGpuTimeline& snapshot)
+            REQUIRES(mMutex);
 #endif
     };
 
-    Timeline& GetOrCreateTimelineLocked(const Ring& ring) REQUIRES(mTimelinesMutex);
+    // `traceTrackId` is only used if the timeline is created.
+    Timeline* GetOrCreateTimeline(const Ring& ring, std::optional<uint64_t> traceTrackId = {})
+        EXCLUDES(mTimelinesMutex);
+
+    Timeline* GetTimeline(uint32_t index) const;
 
     // Go over the timeline, signal any fences without pending tasks, and remove
     // timeline items that are no longer needed.
-    void poll_locked(const Ring&) REQUIRES(mTimelinesMutex);
+    void poll_locked(Timeline& timeline) REQUIRES(timeline.mMutex);
 
-    FenceCompletionCallback mFenceCompletionCallback;
+    // Returns true if the timeline was removed and is now empty, in which case the caller must
+    // pass it to `ReleaseTimeline()` once its lock is dropped.
+    static bool ShouldReleaseLocked(Timeline& timeline) REQUIRES(timeline.mMutex);
+    void ReleaseTimeline(Timeline* timeline) EXCLUDES(mTimelinesMutex);
 
-    mutable std::mutex mTimelinesMutex;
-    // The mTaskIdToTask cache must be destroyed after the actual owner of Task,
-    // mTimelineQueues, is destroyed, because the deleter of Task will
-    // automatically remove the entry in mTaskIdToTask.
-    std::unordered_map<TaskId, std::weak_ptr<Task>> mTaskIdToTask;
+    FenceCompletionCallback mFenceCompletionCallback;
+    // Timelines are polled concurrently but the callback is only ever called by one thread at
+    // a time.
+    std::mutex mFenceCompletionCallbackMutex;
 
+    // Only taken to look up or add timelines by ring, never while polling.
+    mutable std::shared_mutex mTimelinesMutex;
     // LINT.IfChange(virtio_gpu_timelines)
-    std::atomic<TaskId> mNextId;
-    std::unordered_map<Ring, Timeline> mTimelineQueues GUARDED_BY(mTimelinesMutex);
+    std::unordered_map<Ring, Timeline*> mTimelinesByRing GUARDED_BY(mTimelinesMutex);
     // LINT.ThenChange(VirtioGpuTimelinesSnapshot.proto:virtio_gpu_timelines)
+    // Owns the timelines, which are never deleted so that tasks can be completed without a
+    // lookup. Removed timelines are reused instead.
+    StableArray<std::atomic<Timeline*>, kTimelineIndexBits> mTimelines;
+    std::atomic<uint32_t> mTimelineCount{0};
+    std::vector<Timeline*> mFreeTimelines GUARDED_BY(mTimelinesMutex);
 };
 
 #endif  // VIRTIO_GPU_TIMELINES_H
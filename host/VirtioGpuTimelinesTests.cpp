@@ -16,7 +16,12 @@
 
 #include "VirtioGpuTimelines.h"
 
+#include <atomic>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace gfxstream {
 namespace {
@@ -149,6 +154,41 @@ TEST(VirtioGpuTimelinesTest, FencesWithoutPendingTasksWithAsyncCallback) {
                 }));
 }
 
+TEST(VirtioGpuTimelinesTest, EnqueuedFencesWaitForPendingTasks) {
+    std::vector<std::pair<Ring, FenceId>> signaledFences;
+
+    auto fenceCallback =
+        [&](const Ring& ring, FenceId fenceId) {
+            signaledFences.push_back(std::make_pair(ring, fenceId));
+        };
+    std::unique_ptr<VirtioGpuTimelines> virtioGpuTimelines =
+        VirtioGpuTimelines::create(fenceCallback);
+
+    virtioGpuTimelines->enqueueFences(kContext2Ring, {});
+    EXPECT_THAT(signaledFences, IsEmpty());
+
+    virtioGpuTimelines->enqueueFences(kContext2Ring, {1, 2});
+    EXPECT_THAT(signaledFences,
+                ElementsAreArray({
+                    Pair(Eq(kContext2Ring), Eq(1u)),
+                    Pair(Eq(kContext2Ring), Eq(2u)),
+                }));
+
+    auto taskId = virtioGpuTimelines->enqueueTask(kContext2Ring);
+    virtioGpuTimelines->enqueueFences(kContext2Ring, {3, 4, 5});
+    EXPECT_THAT(signaledFences.size(), Eq(2u));
+
+    virtioGpuTimelines->notifyTaskCompletion(taskId);
+    EXPECT_THAT(signaledFences,
+                ElementsAreArray({
+                    Pair(Eq(kContext2Ring), Eq(1u)),
+                    Pair(Eq(kContext2Ring), Eq(2u)),
+                    Pair(Eq(kContext2Ring), Eq(3u)),
+                    Pair(Eq(kContext2Ring), Eq(4u)),
+                    Pair(Eq(kContext2Ring), Eq(5u)),
+                }));
+}
+
 TEST(VirtioGpuTimelinesTest, FencesSharingSamePendingTasksWithAsyncCallback) {
    std::vector<std::pair<Ring, FenceId>> signaledFences;
 
@@ -291,5 +331,253 @@ TEST(VirtioGpuTimelinesTest, TasksAndFencesOnMultipleRingsWithAsyncCallback) {
                 }));
 }
 
+TEST(VirtioGpuTimelinesTest, ManyPendingTasksCompletedOutOfOrder) {
+    std::vector<FenceId> signaledFences;
+
+    auto fenceCallback = [&](const Ring&, FenceId fenceId) { signaledFences.push_back(fenceId); };
+    std::unique_ptr<VirtioGpuTimelines> virtioGpuTimelines =
+        VirtioGpuTimelines::create(fenceCallback);
+
+    // Enough to grow the queue and the task storage of the timeline a few times.
+    constexpr int kCount = 1000;
+    std::vector<VirtioGpuTimelines::TaskId> taskIds;
+    std::vector<FenceId> expectedFences;
+    for (int i = 0; i < kCount; i++) {
+        taskIds.push_back(virtioGpuTimelines->enqueueTask(kGlobalRing));
+        virtioGpuTimelines->enqueueFence(kGlobalRing, i);
+        expectedFences.push_back(i);
+    }
+    EXPECT_THAT(signaledFences, IsEmpty());
+
+    for (int i = kCount - 1; i > 0; i--) {
+        virtioGpuTimelines->notifyTaskCompletion(taskIds[i]);
+    }
+    EXPECT_THAT(signaledFences, IsEmpty());
+
+    virtioGpuTimelines->notifyTaskCompletion(taskIds[0]);
+    EXPECT_THAT(signaledFences, ElementsAreArray(expectedFences));
+
+    // Task storage is reused once tasks are done, with new ids.
+    auto reusedTaskId = virtioGpuTimelines->enqueueTask(kGlobalRing);
+    for (auto taskId : taskIds) {
+        ASSERT_NE(reusedTaskId, taskId);
+    }
+    virtioGpuTimelines->notifyTaskCompletion(reusedTaskId);
+}
+
+TEST(VirtioGpuTimelinesTest, TasksCompletedConcurrentlyOnManyRings) {
+    std::mutex signaledFencesMutex;
+    std::map<uint32_t, std::vector<FenceId>> signaledFences;
+
+    auto fenceCallback = [&](const Ring& ring, FenceId fenceId) {
+        std::lock_guard<std::mutex> lock(signaledFencesMutex);
+        signaledFences[std::get<RingContextSpecific>(ring).mCtxId].push_back(fenceId);
+    };
+    std::unique_ptr<VirtioGpuTimelines> virtioGpuTimelines =
+        VirtioGpuTimelines::create(fenceCallback);
+
+    constexpr uint32_t kRingCount = 8;
+    constexpr int kFencesPerRing = 2000;
+
+    std::vector<std::thread> threads;
+    for (uint32_t ctxId = 0; ctxId < kRingCount; ctxId++) {
+        threads.emplace_back([&, ctxId]() {
+            const Ring ring = RingContextSpecific{
+                .mCtxId = ctxId,
+                .mRingIdx = 0,
+            };
+            for (int i = 0; i < kFencesPerRing; i++) {
+                auto taskId = virtioGpuTimelines->enqueueTask(ring);
+                virtioGpuTimelines->enqueueFence(ring, i);
+                std::thread completer(
+                    [&, taskId]() { virtioGpuTimelines->notifyTaskCompletion(taskId); });
+                if (i % 2 == 0) {
+                    virtioGpuTimelines->poll();
+                }
+                completer.join();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<FenceId> expectedFences;
+    for (int i = 0; i < kFencesPerRing; i++) {
+        expectedFences.push_back(i);
+    }
+    for (uint32_t ctxId = 0; ctxId < kRingCount; ctxId++) {
+        EXPECT_THAT(signaledFences[ctxId], ElementsAreArray(expectedFences));
+    }
+}
+
+TEST(VirtioGpuTimelinesTest, ConcurrentContextsSharingTheGlobalRing) {
+    std::mutex signaledFencesMutex;
+    std::map<uint32_t, std::vector<FenceId>> signaledContextFences;
+    std::map<uint32_t, std::vector<FenceId>> signaledGlobalFences;
+
+    // Global fences carry the id of the context that enqueued them in their upper bits.
+    auto fenceCallback = [&](const Ring& ring, FenceId fenceId) {
+        std::lock_guard<std::mutex> lock(signaledFencesMutex);
+        if (const auto* contextRing = std::get_if<RingContextSpecific>(&ring)) {
+            signaledContextFences[contextRing->mCtxId].push_back(fenceId);
+        } else {
+            signaledGlobalFences[fenceId >> 32].push_back(fenceId & 0xffffffff);
+        }
+    };
+    std::unique_ptr<VirtioGpuTimelines> virtioGpuTimelines =
+        VirtioGpuTimelines::create(fenceCallback);
+
+    constexpr uint32_t kContextCount = 8;
+    constexpr uint32_t kCompleterCount = 4;
+    constexpr uint64_t kBatchesPerContext = 500;
+    constexpr uint64_t kFencesPerBatch = 3;
+
+    // Tasks are completed by other threads in whatever order they are picked up, as the
+    // renderer does with the work of independent contexts.
+    std::mutex pendingTasksMutex;
+    std::vector<VirtioGpuTimelines::TaskId> pendingTasks;
+    std::atomic<uint32_t> submittersRunning{kContextCount};
+
+    std::vector<std::thread> completers;
+    for (uint32_t i = 0; i < kCompleterCount; i++) {
+        completers.emplace_back([&]() {
+            while (true) {
+                std::vector<VirtioGpuTimelines::TaskId> tasks;
+                {
+                    std::lock_guard<std::mutex> lock(pendingTasksMutex);
+                    tasks.swap(pendingTasks);
+                }
+                if (tasks.empty()) {
+                    if (submittersRunning == 0) {
+                        std::lock_guard<std::mutex> lock(pendingTasksMutex);
+                        if (pendingTasks.empty()) {
+                            return;
+                        }
+                    }
+                    std::this_thread::yield();
+                    continue;
+                }
+                for (auto it = tasks.rbegin(); it != tasks.rend(); ++it) {
+                    virtioGpuTimelines->notifyTaskCompletion(*it);
+                }
+            }
+        });
+    }
+
+    std::vector<std::thread> submitters;
+    for (uint32_t ctxId = 0; ctxId < kContextCount; ctxId++) {
+        submitters.emplace_back([&, ctxId]() {
+            const Ring ring = RingContextSpecific{
+                .mCtxId = ctxId,
+                .mRingIdx = 0,
+            };
+            for (uint64_t batch = 0; batch < kBatchesPerContext; batch++) {
+                const auto contextTaskId = virtioGpuTimelines->enqueueTask(ring);
+                const auto globalTaskId = virtioGpuTimelines->enqueueTask(kGlobalRing);
+                {
+                    std::lock_guard<std::mutex> lock(pendingTasksMutex);
+                    pendingTasks.push_back(contextTaskId);
+                    pendingTasks.push_back(globalTaskId);
+                }
+
+                std::vector<FenceId> fenceIds;
+                for (uint64_t i = 0; i < kFencesPerBatch; i++) {
+                    fenceIds.push_back(batch * kFencesPerBatch + i);
+                }
+                virtioGpuTimelines->enqueueFences(ring, fenceIds);
+                virtioGpuTimelines->enqueueFence(kGlobalRing, (uint64_t{ctxId} << 32) | batch);
+
+                if (batch % 4 == 0) {
+                    virtioGpuTimelines->poll();
+                }
+            }
+            --submittersRunning;
+        });
+    }
+    for (auto& thread : submitters) {
+        thread.join();
+    }
+    for (auto& thread : completers) {
+        thread.join();
+    }
+
+    std::vector<FenceId> expectedContextFences;
+    for (uint64_t i = 0; i < kBatchesPerContext * kFencesPerBatch; i++) {
+        expectedContextFences.push_back(i);
+    }
+    std::vector<FenceId> expectedGlobalFences;
+    for (uint64_t i = 0; i < kBatchesPerContext; i++) {
+        expectedGlobalFences.push_back(i);
+    }
+    for (uint32_t ctxId = 0; ctxId < kContextCount; ctxId++) {
+        EXPECT_THAT(signaledContextFences[ctxId], ElementsAreArray(expectedContextFences));
+        EXPECT_THAT(signaledGlobalFences[ctxId], ElementsAreArray(expectedGlobalFences));
+    }
+}
+
+TEST(VirtioGpuTimelinesTest, RemovedContextStillSignalsPendingFences) {
+    std::vector<std::pair<Ring, FenceId>> signaledFences;
+    auto fenceCallback = [&](const Ring& ring, FenceId fenceId) {
+        signaledFences.push_back(std::make_pair(ring, fenceId));
+    };
+    std::unique_ptr<VirtioGpuTimelines> virtioGpuTimelines =
+        VirtioGpuTimelines::create(fenceCallback);
+
+    auto taskId = virtioGpuTimelines->enqueueTask(kContext2Ring);
+    virtioGpuTimelines->enqueueFence(kContext2Ring, 1);
+    virtioGpuTimelines->removeContext(2);
+    EXPECT_THAT(signaledFences, IsEmpty());
+
+    // The timeline is still in use, so the new ring gets a timeline of its own.
+    auto context3TaskId = virtioGpuTimelines->enqueueTask(kContext3Ring);
+    EXPECT_EQ(virtioGpuTimelines->getTimelineCountForTesting(), 2u);
+
+    virtioGpuTimelines->notifyTaskCompletion(taskId);
+    EXPECT_THAT(signaledFences, ElementsAreArray({Pair(kContext2Ring, 1)}));
+
+    // The reused timeline never hands out the ids of the tasks of the removed context.
+    auto reusedTaskId = virtioGpuTimelines->enqueueTask(kContext2Ring);
+    virtioGpuTimelines->enqueueFence(kContext2Ring, 2);
+    EXPECT_EQ(virtioGpuTimelines->getTimelineCountForTesting(), 2u);
+    EXPECT_NE(reusedTaskId, taskId);
+    virtioGpuTimelines->notifyTaskCompletion(reusedTaskId);
+    EXPECT_THAT(signaledFences,
+                ElementsAreArray({Pair(kContext2Ring, 1), Pair(kContext2Ring, 2)}));
+
+    virtioGpuTimelines->notifyTaskCompletion(context3TaskId);
+}
+
+TEST(VirtioGpuTimelinesTest, RemovedContextTimelinesAreReused) {
+    std::vector<std::pair<Ring, FenceId>> signaledFences;
+    auto fenceCallback = [&](const Ring& ring, FenceId fenceId) {
+        signaledFences.push_back(std::make_pair(ring, fenceId));
+    };
+    std::unique_ptr<VirtioGpuTimelines> virtioGpuTimelines =
+        VirtioGpuTimelines::create(fenceCallback);
+
+    constexpr uint32_t kContextCount = 1000;
+    for (uint32_t ctxId = 1; ctxId <= kContextCount; ctxId++) {
+        const auto ring = Ring{RingContextSpecific{
+            .mCtxId = ctxId,
+            .mRingIdx = 0,
+        }};
+        auto taskId = virtioGpuTimelines->enqueueTask(ring);
+        virtioGpuTimelines->enqueueFence(ring, ctxId);
+        virtioGpuTimelines->notifyTaskCompletion(taskId);
+        virtioGpuTimelines->removeContext(ctxId);
+    }
+
+    EXPECT_EQ(virtioGpuTimelines->getTimelineCountForTesting(), 1u);
+    ASSERT_EQ(signaledFences.size(), kContextCount);
+    for (uint32_t ctxId = 1; ctxId <= kContextCount; ctxId++) {
+        EXPECT_THAT(signaledFences[ctxId - 1], Pair(Ring{RingContextSpecific{
+                                                         .mCtxId = ctxId,
+                                                         .mRingIdx = 0,
+                                                     }},
+                                                     ctxId));
+    }
+}
+
 }  // namespace
 }  // namespace gfxstream
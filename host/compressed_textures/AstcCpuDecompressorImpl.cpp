@@ -17,6 +17,7 @@
 #include <unordered_map>
 
 #include "gfxstream/host/AstcCpuDecompressor.h"
+#include "gfxstream/host/DecodedTextureCache.h"
 #include "astcenc.h"
 
 namespace gfxstream {
@@ -25,6 +26,9 @@ namespace {
 
 constexpr uint32_t kNumThreads = 2;
 
+// Source format tag for DecodedTextureCache keys; the block footprint goes in the low bits.
+constexpr uint32_t kAstcCacheFormat = 0x41530000;  // "AS"
+
 const astcenc_swizzle kSwizzle = {ASTCENC_SWZ_R, ASTCENC_SWZ_G, ASTCENC_SWZ_B, ASTCENC_SWZ_A};
 
 // Used by std::unique_ptr to release the context when the pointer is destroyed
@@ -226,6 +230,19 @@ class AstcCpuDecompressorImpl : public AstcCpuDecompressor {
     int32_t decompress(const uint32_t imgWidth, const uint32_t imgHeight, const uint32_t blockWidth,
                        const uint32_t blockHeight, const uint8_t* astcData, size_t astcDataLength,
                        uint8_t* output) override {
+        // Games tend to upload the same atlases again after every restart.
+        auto& cache = host::DecodedTextureCache::get();
+        const size_t outputSize = static_cast<size_t>(imgWidth) * imgHeight * 4;
+        host::DecodedTextureCache::Key key;
+        if (cache.enabled()) {
+            const uint32_t format = kAstcCacheFormat | blockWidth << 8 | blockHeight;
+            key = host::DecodedTextureCache::makeKey(format, 0, imgWidth, imgHeight, astcData,
+                                                     astcDataLength);
+            if (cache.lookup(key, output, outputSize)) {
+                return ASTCENC_SUCCESS;
+            }
+        }
+
         std::array<std::future<astcenc_error>, kNumThreads> futures;
 
         std::lock_guard global_lock(mMutex);
@@ -257,6 +274,10 @@ class AstcCpuDecompressorImpl : public AstcCpuDecompressor {
 
         astcenc_decompress_reset(context);
 
+        if (result == ASTCENC_SUCCESS) {
+            cache.insert(key, output, outputSize);
+        }
+
         return result;
     }
 
@@ -0,0 +1,369 @@
+// Copyright 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gfxstream/host/BcnEncoder.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GFXSTREAM_BCN_USE_SSE2 1
+#endif
+
+namespace gfxstream {
+namespace host {
+namespace {
+
+constexpr uint32_t kBlockDim = 4;
+constexpr uint32_t kTexelsPerBlock = kBlockDim * kBlockDim;
+
+struct Rgba {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+    uint8_t a;
+};
+
+size_t getBlockSize(BcnFormat format) {
+    switch (format) {
+        case BcnFormat::kBc1:
+        case BcnFormat::kBc1Alpha:
+        case BcnFormat::kBc4Unorm:
+        case BcnFormat::kBc4Snorm:
+            return 8;
+        case BcnFormat::kBc3:
+        case BcnFormat::kBc5Unorm:
+        case BcnFormat::kBc5Snorm:
+            return 16;
+    }
+    return 0;
+}
+
+void writeLe16(uint8_t* out, uint16_t v) {
+    out[0] = static_cast<uint8_t>(v & 0xff);
+    out[1] = static_cast<uint8_t>(v >> 8);
+}
+
+void writeLe32(uint8_t* out, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = static_cast<uint8_t>((v >> (8 * i)) & 0xff);
+    }
+}
+
+// Copies a 4x4 block into `texels`, replicating the last row/column for blocks that hang over
+// the edge of the image. Missing channels are filled in with 0 (color) or 255 (alpha).
+void gatherBlock(const uint8_t* pixels, uint32_t width, uint32_t height, size_t pixelSize,
+                 size_t rowPitch, uint32_t blockX, uint32_t blockY, Rgba* texels) {
+    const size_t channels = std::min<size_t>(pixelSize, 4);
+    for (uint32_t y = 0; y < kBlockDim; y++) {
+        const uint32_t srcY = std::min(blockY * kBlockDim + y, height - 1);
+        const uint8_t* row = pixels + srcY * rowPitch;
+        for (uint32_t x = 0; x < kBlockDim; x++) {
+            const uint32_t srcX = std::min(blockX * kBlockDim + x, width - 1);
+            const uint8_t* src = row + srcX * pixelSize;
+            uint8_t rgba[4] = {0, 0, 0, 255};
+            memcpy(rgba, src, channels);
+            texels[y * kBlockDim + x] = {rgba[0], rgba[1], rgba[2], rgba[3]};
+        }
+    }
+}
+
+void blockMinMax(const Rgba* texels, Rgba* outMin, Rgba* outMax) {
+#if defined(GFXSTREAM_BCN_USE_SSE2)
+    const __m128i* src = reinterpret_cast<const __m128i*>(texels);
+    __m128i t0 = _mm_loadu_si128(src + 0);
+    __m128i t1 = _mm_loadu_si128(src + 1);
+    __m128i t2 = _mm_loadu_si128(src + 2);
+    __m128i t3 = _mm_loadu_si128(src + 3);
+    __m128i mn = _mm_min_epu8(_mm_min_epu8(t0, t1), _mm_min_epu8(t2, t3));
+    __m128i mx = _mm_max_epu8(_mm_max_epu8(t0, t1), _mm_max_epu8(t2, t3));
+    // Fold the four texels in each register down to one.
+    mn = _mm_min_epu8(mn, _mm_shuffle_epi32(mn, _MM_SHUFFLE(1, 0, 3, 2)));
+    mx = _mm_max_epu8(mx, _mm_shuffle_epi32(mx, _MM_SHUFFLE(1, 0, 3, 2)));
+    mn = _mm_min_epu8(mn, _mm_shuffle_epi32(mn, _MM_SHUFFLE(2, 3, 0, 1)));
+    mx = _mm_max_epu8(mx, _mm_shuffle_epi32(mx, _MM_SHUFFLE(2, 3, 0, 1)));
+    const uint32_t packedMin = static_cast<uint32_t>(_mm_cvtsi128_si32(mn));
+    const uint32_t packedMax = static_cast<uint32_t>(_mm_cvtsi128_si32(mx));
+    memcpy(outMin, &packedMin, sizeof(Rgba));
+    memcpy(outMax, &packedMax, sizeof(Rgba));
+#else
+    Rgba mn = texels[0];
+    Rgba mx = texels[0];
+    for (uint32_t i = 1; i < kTexelsPerBlock; i++) {
+        const Rgba& t = texels[i];
+        mn = {std::min(mn.r, t.r), std::min(mn.g, t.g), std::min(mn.b, t.b), std::min(mn.a, t.a)};
+        mx = {std::max(mx.r, t.r), std::max(mx.g, t.g), std::max(mx.b, t.b), std::max(mx.a, t.a)};
+    }
+    *outMin = mn;
+    *outMax = mx;
+#endif
+}
+
+uint16_t toRgb565(int r, int g, int b) {
+    return static_cast<uint16_t>(((r * 31 + 127) / 255) << 11 | ((g * 63 + 127) / 255) << 5 |
+                                 ((b * 31 + 127) / 255));
+}
+
+void fromRgb565(uint16_t c, int* rgb) {
+    const int r = (c >> 11) & 0x1f;
+    const int g = (c >> 5) & 0x3f;
+    const int b = c & 0x1f;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+// Range fit: picks the endpoints on the diagonal of the color bounding box that best follows
+// the texels, then insets them slightly to reduce the error at the extremes.
+void selectColorEndpoints(const Rgba* texels, const bool* used, bool allUsed, uint16_t* outC0,
+                          uint16_t* outC1) {
+    int mn[3] = {255, 255, 255};
+    int mx[3] = {0, 0, 0};
+    if (allUsed) {
+        Rgba blockMin;
+        Rgba blockMax;
+        blockMinMax(texels, &blockMin, &blockMax);
+        mn[0] = blockMin.r;
+        mn[1] = blockMin.g;
+        mn[2] = blockMin.b;
+        mx[0] = blockMax.r;
+        mx[1] = blockMax.g;
+        mx[2] = blockMax.b;
+    } else {
+        for (uint32_t i = 0; i < kTexelsPerBlock; i++) {
+            if (!used[i]) continue;
+            const int c[3] = {texels[i].r, texels[i].g, texels[i].b};
+            for (int k = 0; k < 3; k++) {
+                mn[k] = std::min(mn[k], c[k]);
+                mx[k] = std::max(mx[k], c[k]);
+            }
+        }
+    }
+
+    // Flip green and/or blue when they are anti-correlated with red so that the endpoints
+    // lie on the right diagonal of the bounding box.
+    const int center[3] = {(mn[0] + mx[0]) / 2, (mn[1] + mx[1]) / 2, (mn[2] + mx[2]) / 2};
+    int covRG = 0;
+    int covRB = 0;
+    for (uint32_t i = 0; i < kTexelsPerBlock; i++) {
+        if (!used[i]) continue;
+        const int dr = texels[i].r - center[0];
+        covRG += dr * (texels[i].g - center[1]);
+        covRB += dr * (texels[i].b - center[2]);
+    }
+    if (covRG < 0) std::swap(mn[1], mx[1]);
+    if (covRB < 0) std::swap(mn[2], mx[2]);
+
+    for (int k = 0; k < 3; k++) {
+        const int inset = (mx[k] - mn[k]) / 16;
+        mx[k] = std::clamp(mx[k] - inset, 0, 255);
+        mn[k] = std::clamp(mn[k] + inset, 0, 255);
+    }
+
+    *outC0 = toRgb565(mx[0], mx[1], mx[2]);
+    *outC1 = toRgb565(mn[0], mn[1], mn[2]);
+}
+
+int colorDistance(const int* a, const Rgba& b) {
+    const int dr = a[0] - b.r;
+    const int dg = a[1] - b.g;
+    const int db = a[2] - b.b;
+    return dr * dr + dg * dg + db * db;
+}
+
+// Writes an 8 byte BC1 color block. With `punchthroughAlpha`, texels with alpha < 128 are
+// encoded with the transparent index of the 3 color mode.
+void encodeColorBlock(const Rgba* texels, bool punchthroughAlpha, uint8_t* out) {
+    bool used[kTexelsPerBlock];
+    bool anyTransparent = false;
+    bool anyOpaque = false;
+    for (uint32_t i = 0; i < kTexelsPerBlock; i++) {
+        used[i] = !punchthroughAlpha || texels[i].a >= 128;
+        anyTransparent |= !used[i];
+        anyOpaque |= used[i];
+    }
+
+    uint16_t c0 = 0;
+    uint16_t c1 = 0;
+    if (anyOpaque) {
+        selectColorEndpoints(texels, used, !anyTransparent, &c0, &c1);
+    }
+
+    // Four color mode requires c0 > c1 while three color mode (needed for transparency)
+    // requires c0 <= c1.
+    if (anyTransparent ? (c0 > c1) : (c0 < c1)) {
+        std::swap(c0, c1);
+    }
+
+    int palette[4][3];
+    fromRgb565(c0, palette[0]);
+    fromRgb565(c1, palette[1]);
+    int paletteSize = 4;
+    if (c0 > c1) {
+        for (int k = 0; k < 3; k++) {
+            palette[2][k] = (2 * palette[0][k] + palette[1][k]) / 3;
+            palette[3][k] = (palette[0][k] + 2 * palette[1][k]) / 3;
+        }
+    } else {
+        for (int k = 0; k < 3; k++) {
+            palette[2][k] = (palette[0][k] + palette[1][k]) / 2;
+        }
+        paletteSize = 3;
+    }
+
+    uint32_t indices = 0;
+    for (uint32_t i = 0; i < kTexelsPerBlock; i++) {
+        uint32_t best = 3;
+        if (used[i]) {
+            int bestDistance = colorDistance(palette[0], texels[i]);
+            best = 0;
+            for (int p = 1; p < paletteSize; p++) {
+                const int distance = colorDistance(palette[p], texels[i]);
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = p;
+                }
+            }
+        }
+        indices |= best << (2 * i);
+    }
+
+    writeLe16(out, c0);
+    writeLe16(out + 2, c1);
+    writeLe32(out + 4, indices);
+}
+
+// Writes an 8 byte BC4 style block (also used for the BC3 alpha channel) using the eight
+// value interpolation mode. `values` are either in [0, 255] or, for snorm, in [-127, 127].
+void encodeSingleChannelBlock(const int* values, bool isSigned, uint8_t* out) {
+    int mn = values[0];
+    int mx = values[0];
+    for (uint32_t i = 1; i < kTexelsPerBlock; i++) {
+        mn = std::min(mn, values[i]);
+        mx = std::max(mx, values[i]);
+    }
+
+    int palette[8];
+    palette[0] = mx;
+    palette[1] = mn;
+    for (int k = 1; k < 7; k++) {
+        palette[k + 1] = ((7 - k) * mx + k * mn) / 7;
+    }
+
+    uint64_t indices = 0;
+    if (mx != mn) {
+        for (uint32_t i = 0; i < kTexelsPerBlock; i++) {
+            uint64_t best = 0;
+            int bestDistance = std::abs(values[i] - palette[0]);
+            for (int p = 1; p < 8; p++) {
+                const int distance = std::abs(values[i] - palette[p]);
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = p;
+                }
+            }
+            indices |= best << (3 * i);
+        }
+    }
+
+    out[0] = isSigned ? static_cast<uint8_t>(static_cast<int8_t>(mx)) : static_cast<uint8_t>(mx);
+    out[1] = isSigned ? static_cast<uint8_t>(static_cast<int8_t>(mn)) : static_cast<uint8_t>(mn);
+    for (int i = 0; i < 6; i++) {
+        out[2 + i] = static_cast<uint8_t>((indices >> (8 * i)) & 0xff);
+    }
+}
+
+void extractChannel(const Rgba* texels, int channel, bool isSigned, int* values) {
+    for (uint32_t i = 0; i < kTexelsPerBlock; i++) {
+        const uint8_t* t = reinterpret_cast<const uint8_t*>(&texels[i]);
+        if (isSigned) {
+            // -128 and -127 both map to -1.0.
+            values[i] = std::max<int>(static_cast<int8_t>(t[channel]), -127);
+        } else {
+            values[i] = t[channel];
+        }
+    }
+}
+
+void encodeBlock(BcnFormat format, const Rgba* texels, uint8_t* out) {
+    int values[kTexelsPerBlock];
+    switch (format) {
+        case BcnFormat::kBc1:
+            encodeColorBlock(texels, /*punchthroughAlpha=*/false, out);
+            break;
+        case BcnFormat::kBc1Alpha:
+            encodeColorBlock(texels, /*punchthroughAlpha=*/true, out);
+            break;
+        case BcnFormat::kBc3:
+            extractChannel(texels, 3, /*isSigned=*/false, values);
+            encodeSingleChannelBlock(values, /*isSigned=*/false, out);
+            encodeColorBlock(texels, /*punchthroughAlpha=*/false, out + 8);
+            break;
+        case BcnFormat::kBc4Unorm:
+        case BcnFormat::kBc4Snorm: {
+            const bool isSigned = format == BcnFormat::kBc4Snorm;
+            extractChannel(texels, 0, isSigned, values);
+            encodeSingleChannelBlock(values, isSigned, out);
+            break;
+        }
+        case BcnFormat::kBc5Unorm:
+        case BcnFormat::kBc5Snorm: {
+            const bool isSigned = format == BcnFormat::kBc5Snorm;
+            extractChannel(texels, 0, isSigned, values);
+            encodeSingleChannelBlock(values, isSigned, out);
+            extractChannel(texels, 1, isSigned, values);
+            encodeSingleChannelBlock(values, isSigned, out + 8);
+            break;
+        }
+    }
+}
+
+}  // namespace
+
+size_t getBcnEncodedSize(BcnFormat format, uint32_t width, uint32_t height) {
+    const size_t blocksX = (width + kBlockDim - 1) / kBlockDim;
+    const size_t blocksY = (height + kBlockDim - 1) / kBlockDim;
+    return blocksX * blocksY * getBlockSize(format);
+}
+
+bool bcnEncode(BcnFormat format, const uint8_t* pixels, uint32_t width, uint32_t height,
+               size_t pixelSize, size_t rowPitch, uint8_t* output, size_t outputSize) {
+    if (!pixels || !output || width == 0 || height == 0 || pixelSize == 0 ||
+        rowPitch < width * pixelSize) {
+        return false;
+    }
+    if (outputSize < getBcnEncodedSize(format, width, height)) {
+        return false;
+    }
+
+    const size_t blockSize = getBlockSize(format);
+    const uint32_t blocksX = (width + kBlockDim - 1) / kBlockDim;
+    const uint32_t blocksY = (height + kBlockDim - 1) / kBlockDim;
+
+    Rgba texels[kTexelsPerBlock];
+    uint8_t* out = output;
+    for (uint32_t by = 0; by < blocksY; by++) {
+        for (uint32_t bx = 0; bx < blocksX; bx++) {
+            gatherBlock(pixels, width, height, pixelSize, rowPitch, bx, by, texels);
+            encodeBlock(format, texels, out);
+            out += blockSize;
+        }
+    }
+    return true;
+}
+
+}  // namespace host
+}  // namespace gfxstream
@@ -0,0 +1,200 @@
+// Copyright 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <cstdlib>
+#include <vector>
+
+#include "gfxstream/host/BcnEncoder.h"
+
+namespace gfxstream {
+namespace host {
+namespace {
+
+struct Rgba {
+    uint8_t r, g, b, a;
+};
+
+void expand565(uint16_t c, int* rgb) {
+    const int r = (c >> 11) & 0x1f;
+    const int g = (c >> 5) & 0x3f;
+    const int b = c & 0x1f;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+// Reference BC1 decoder for a single block. Returns RGBA texels.
+std::vector<Rgba> decodeBc1Block(const uint8_t* block, bool alwaysFourColors = false) {
+    const uint16_t c0 = block[0] | (block[1] << 8);
+    const uint16_t c1 = block[2] | (block[3] << 8);
+    const uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | (block[7] << 24);
+    int palette[4][4];
+    expand565(c0, palette[0]);
+    expand565(c1, palette[1]);
+    palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+    if (c0 > c1 || alwaysFourColors) {
+        for (int k = 0; k < 3; k++) {
+            palette[2][k] = (2 * palette[0][k] + palette[1][k]) / 3;
+            palette[3][k] = (palette[0][k] + 2 * palette[1][k]) / 3;
+        }
+    } else {
+        for (int k = 0; k < 3; k++) {
+            palette[2][k] = (palette[0][k] + palette[1][k]) / 2;
+            palette[3][k] = 0;
+        }
+        palette[3][3] = 0;
+    }
+    std::vector<Rgba> texels(16);
+    for (int i = 0; i < 16; i++) {
+        const int* p = palette[(indices >> (2 * i)) & 3];
+        texels[i] = {static_cast<uint8_t>(p[0]), static_cast<uint8_t>(p[1]),
+                     static_cast<uint8_t>(p[2]), static_cast<uint8_t>(p[3])};
+    }
+    return texels;
+}
+
+// Reference BC4 unorm/snorm decoder for a single block.
+std::vector<int> decodeBc4Block(const uint8_t* block, bool isSigned) {
+    const int a0 = isSigned ? static_cast<int8_t>(block[0]) : block[0];
+    const int a1 = isSigned ? static_cast<int8_t>(block[1]) : block[1];
+    uint64_t indices = 0;
+    for (int i = 0; i < 6; i++) {
+        indices |= static_cast<uint64_t>(block[2 + i]) << (8 * i);
+    }
+    int palette[8] = {a0, a1};
+    if (a0 > a1) {
+        for (int k = 1; k < 7; k++) palette[k + 1] = ((7 - k) * a0 + k * a1) / 7;
+    } else {
+        for (int k = 1; k < 5; k++) palette[k + 1] = ((5 - k) * a0 + k * a1) / 5;
+        palette[6] = isSigned ? -127 : 0;
+        palette[7] = isSigned ? 127 : 255;
+    }
+    std::vector<int> values(16);
+    for (int i = 0; i < 16; i++) {
+        values[i] = palette[(indices >> (3 * i)) & 7];
+    }
+    return values;
+}
+
+TEST(BcnEncoder, EncodedSize) {
+    EXPECT_EQ(getBcnEncodedSize(BcnFormat::kBc1, 4, 4), 8u);
+    EXPECT_EQ(getBcnEncodedSize(BcnFormat::kBc1, 5, 5), 32u);
+    EXPECT_EQ(getBcnEncodedSize(BcnFormat::kBc3, 1, 1), 16u);
+    EXPECT_EQ(getBcnEncodedSize(BcnFormat::kBc4Unorm, 16, 8), 64u);
+    EXPECT_EQ(getBcnEncodedSize(BcnFormat::kBc5Snorm, 16, 8), 128u);
+}
+
+TEST(BcnEncoder, RejectsInvalidArguments) {
+    std::vector<uint8_t> pixels(4 * 4 * 4);
+    std::vector<uint8_t> out(8);
+    EXPECT_FALSE(bcnEncode(BcnFormat::kBc3, pixels.data(), 4, 4, 4, 16, out.data(), out.size()));
+    EXPECT_FALSE(bcnEncode(BcnFormat::kBc1, pixels.data(), 4, 4, 4, 8, out.data(), out.size()));
+    EXPECT_TRUE(bcnEncode(BcnFormat::kBc1, pixels.data(), 4, 4, 4, 16, out.data(), out.size()));
+}
+
+TEST(BcnEncoder, Bc1SolidColor) {
+    std::vector<Rgba> pixels(4 * 4, Rgba{200, 100, 50, 255});
+    uint8_t block[8];
+    ASSERT_TRUE(bcnEncode(BcnFormat::kBc1, reinterpret_cast<const uint8_t*>(pixels.data()), 4, 4,
+                          4, 16, block, sizeof(block)));
+    for (const Rgba& t : decodeBc1Block(block)) {
+        EXPECT_NEAR(t.r, 200, 4);
+        EXPECT_NEAR(t.g, 100, 2);
+        EXPECT_NEAR(t.b, 50, 4);
+        EXPECT_EQ(t.a, 255);
+    }
+}
+
+TEST(BcnEncoder, Bc1GradientFromRgb) {
+    // Tightly packed RGB input, as produced by the ETC2 RGB8 decoder.
+    std::vector<uint8_t> pixels;
+    for (int i = 0; i < 16; i++) {
+        pixels.push_back(static_cast<uint8_t>(i * 16));
+        pixels.push_back(static_cast<uint8_t>(255 - i * 16));
+        pixels.push_back(128);
+    }
+    uint8_t block[8];
+    ASSERT_TRUE(bcnEncode(BcnFormat::kBc1, pixels.data(), 4, 4, 3, 12, block, sizeof(block)));
+    const std::vector<Rgba> decoded = decodeBc1Block(block);
+    for (int i = 0; i < 16; i++) {
+        EXPECT_NEAR(decoded[i].r, pixels[3 * i + 0], 40) << "texel " << i;
+        EXPECT_NEAR(decoded[i].g, pixels[3 * i + 1], 40) << "texel " << i;
+        EXPECT_NEAR(decoded[i].b, pixels[3 * i + 2], 8) << "texel " << i;
+    }
+}
+
+TEST(BcnEncoder, Bc1PunchthroughAlpha) {
+    std::vector<Rgba> pixels(4 * 4, Rgba{255, 255, 255, 255});
+    pixels[0].a = 0;
+    pixels[5].a = 0;
+    uint8_t block[8];
+    ASSERT_TRUE(bcnEncode(BcnFormat::kBc1Alpha, reinterpret_cast<const uint8_t*>(pixels.data()),
+                          4, 4, 4, 16, block, sizeof(block)));
+    const std::vector<Rgba> decoded = decodeBc1Block(block);
+    for (int i = 0; i < 16; i++) {
+        EXPECT_EQ(decoded[i].a, (i == 0 || i == 5) ? 0 : 255) << "texel " << i;
+    }
+}
+
+TEST(BcnEncoder, Bc3Alpha) {
+    std::vector<Rgba> pixels(4 * 4);
+    for (int i = 0; i < 16; i++) {
+        pixels[i] = {10, 20, 30, static_cast<uint8_t>(i * 17)};
+    }
+    uint8_t block[16];
+    ASSERT_TRUE(bcnEncode(BcnFormat::kBc3, reinterpret_cast<const uint8_t*>(pixels.data()), 4, 4,
+                          4, 16, block, sizeof(block)));
+    const std::vector<int> alpha = decodeBc4Block(block, /*isSigned=*/false);
+    const std::vector<Rgba> color = decodeBc1Block(block + 8, /*alwaysFourColors=*/true);
+    for (int i = 0; i < 16; i++) {
+        EXPECT_NEAR(alpha[i], i * 17, 19) << "texel " << i;
+        EXPECT_NEAR(color[i].r, 10, 4) << "texel " << i;
+    }
+}
+
+TEST(BcnEncoder, Bc4Unorm) {
+    std::vector<uint8_t> pixels(4 * 4);
+    for (int i = 0; i < 16; i++) {
+        pixels[i] = static_cast<uint8_t>(64 + i * 8);
+    }
+    uint8_t block[8];
+    ASSERT_TRUE(bcnEncode(BcnFormat::kBc4Unorm, pixels.data(), 4, 4, 1, 4, block, sizeof(block)));
+    const std::vector<int> decoded = decodeBc4Block(block, /*isSigned=*/false);
+    for (int i = 0; i < 16; i++) {
+        EXPECT_NEAR(decoded[i], pixels[i], 9) << "texel " << i;
+    }
+}
+
+TEST(BcnEncoder, Bc5SnormPartialBlock) {
+    // 3x2 image of signed RG texels; the encoder must replicate the edges.
+    const int8_t pixels[] = {-128, 127, -64, 64, 0, 0, 32, -32, 96, -96, 127, -128};
+    uint8_t block[16];
+    ASSERT_TRUE(bcnEncode(BcnFormat::kBc5Snorm, reinterpret_cast<const uint8_t*>(pixels), 3, 2, 2,
+                          6, block, sizeof(block)));
+    const std::vector<int> red = decodeBc4Block(block, /*isSigned=*/true);
+    const std::vector<int> green = decodeBc4Block(block + 8, /*isSigned=*/true);
+    EXPECT_EQ(red[0], -127);
+    EXPECT_EQ(green[0], 127);
+    EXPECT_EQ(red[6], 127);
+    EXPECT_EQ(green[6], -127);
+    // Texel (3, 1) repeats texel (2, 1).
+    EXPECT_EQ(red[7], red[6]);
+    EXPECT_EQ(green[7], green[6]);
+}
+
+}  // namespace
+}  // namespace host
+}  // namespace gfxstream
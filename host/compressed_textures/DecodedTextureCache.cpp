@@ -0,0 +1,413 @@
+// Copyright 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gfxstream/host/DecodedTextureCache.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+#include "gfxstream/system/System.h"
+
+namespace gfxstream {
+namespace host {
+namespace {
+
+constexpr size_t kDefaultMaxMegabytes = 64;
+constexpr size_t kDefaultMaxSpillMegabytes = 512;
+
+constexpr uint32_t kSpillMagic = 0x44584647;  // "GFXD"
+constexpr uint32_t kSpillVersion = 1;
+
+struct SpillHeader {
+    uint32_t magic;
+    uint32_t version;
+    DecodedTextureCache::Key key;
+    uint64_t payloadSize;
+};
+
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+
+uint64_t rotl64(uint64_t v, int r) { return (v << r) | (v >> (64 - r)); }
+
+uint64_t fmix64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xFF51AFD7ED558CCDULL;
+    k ^= k >> 33;
+    k *= 0xC4CEB9FE1A85EC53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+// Two independent 64-bit lanes over 8 byte words. Not cryptographic, but 128 bits plus the
+// format, extent and size in the key make accidental collisions negligible.
+void hash128(const void* data, size_t size, uint64_t* out) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t h1 = kPrime1 ^ size;
+    uint64_t h2 = kPrime2 ^ (size * kPrime1);
+
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + i, sizeof(word));
+        h1 = rotl64(h1 ^ (word * kPrime2), 31) * kPrime1;
+        h2 = rotl64(h2 + word, 27) * kPrime2 + h1;
+    }
+    uint64_t tail = 0;
+    for (size_t shift = 0; i < size; i++, shift += 8) {
+        tail |= static_cast<uint64_t>(bytes[i]) << shift;
+    }
+    h1 = rotl64(h1 ^ (tail * kPrime2), 31) * kPrime1;
+    h2 = rotl64(h2 + tail, 27) * kPrime2 + h1;
+
+    out[0] = fmix64(h1 + h2);
+    out[1] = fmix64(h2 ^ rotl64(h1, 17));
+}
+
+size_t readSizeFromEnvironment(const char* name, size_t defaultValue) {
+    const std::string value = gfxstream::base::getEnvironmentVariable(name);
+    if (value.empty()) {
+        return defaultValue;
+    }
+    return static_cast<size_t>(std::strtoull(value.c_str(), nullptr, 10));
+}
+
+// Matches the names that DecodedTextureCache::getSpillPath() produces, so that other files in
+// the spill directory are left alone.
+bool isSpillFileName(const std::string& name) {
+    static constexpr char kSuffix[] = ".bin";
+    static constexpr size_t kSuffixLength = sizeof(kSuffix) - 1;
+    static constexpr size_t kLength = 32 + 1 + 8 + 1 + 8 + kSuffixLength;
+    if (name.size() != kLength || name.compare(kLength - kSuffixLength, kSuffixLength, kSuffix)) {
+        return false;
+    }
+    for (size_t i = 0; i < kLength - kSuffixLength; i++) {
+        const bool isSeparator = i == 32 || i == 32 + 1 + 8;
+        if (isSeparator ? name[i] != '-' : !isxdigit(static_cast<unsigned char>(name[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool hasValidSpillHeader(const std::string& path, uint64_t fileSize) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    SpillHeader header;
+    const bool valid = fread(&header, sizeof(header), 1, file) == 1 &&
+                       header.magic == kSpillMagic && header.version == kSpillVersion &&
+                       sizeof(header) + header.payloadSize == fileSize;
+    fclose(file);
+    return valid;
+}
+
+}  // namespace
+
+bool DecodedTextureCache::Key::operator==(const Key& other) const {
+    return hash[0] == other.hash[0] && hash[1] == other.hash[1] && format == other.format &&
+           variant == other.variant && width == other.width && height == other.height &&
+           dataSize == other.dataSize;
+}
+
+DecodedTextureCache& DecodedTextureCache::get() {
+    static DecodedTextureCache* sCache = [] {
+        const size_t maxBytes =
+            readSizeFromEnvironment("ANDROID_EMUGL_DECODED_TEXTURE_CACHE_MB",
+                                    kDefaultMaxMegabytes) *
+            1024 * 1024;
+        auto* cache = new DecodedTextureCache(
+            maxBytes,
+            gfxstream::base::getEnvironmentVariable("ANDROID_EMUGL_DECODED_TEXTURE_CACHE_DIR"),
+            kDefaultMaxSpillMegabytes * 1024 * 1024);
+        cache->setEnabled(false);
+        return cache;
+    }();
+    return *sCache;
+}
+
+DecodedTextureCache::DecodedTextureCache(size_t maxBytes, std::string spillDirectory,
+                                         size_t maxSpillBytes)
+    : mMaxBytes(maxBytes),
+      mSpillDirectory(std::move(spillDirectory)),
+      mMaxSpillBytes(maxSpillBytes) {
+    if (!mSpillDirectory.empty()) {
+        pruneSpillDirectory();
+    }
+}
+
+DecodedTextureCache::Key DecodedTextureCache::makeKey(uint32_t format, uint32_t variant,
+                                                      uint32_t width, uint32_t height,
+                                                      const void* data, size_t dataSize) {
+    Key key;
+    hash128(data, dataSize, key.hash);
+    key.format = format;
+    key.variant = variant;
+    key.width = width;
+    key.height = height;
+    key.dataSize = dataSize;
+    return key;
+}
+
+bool DecodedTextureCache::lookup(const Key& key, void* output, size_t outputSize) {
+    if (!enabled()) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mIndex.find(key);
+        if (it != mIndex.end() && it->second->payload.size() == outputSize) {
+            mEntries.splice(mEntries.begin(), mEntries, it->second);
+            memcpy(output, it->second->payload.data(), outputSize);
+            mStats.hits++;
+            mStats.bytesSaved += outputSize;
+            return true;
+        }
+    }
+
+    if (readSpilled(key, output, outputSize)) {
+        insert(key, output, outputSize);
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStats.diskHits++;
+        mStats.bytesSaved += outputSize;
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats.misses++;
+    return false;
+}
+
+void DecodedTextureCache::insert(const Key& key, const void* payload, size_t payloadSize) {
+    if (!enabled() || payloadSize > mMaxBytes) {
+        return;
+    }
+
+    std::vector<Entry> evicted;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mIndex.count(key)) {
+            return;
+        }
+
+        const uint8_t* bytes = static_cast<const uint8_t*>(payload);
+        mEntries.push_front(Entry{key, std::vector<uint8_t>(bytes, bytes + payloadSize)});
+        mIndex[key] = mEntries.begin();
+        mStats.residentBytes += payloadSize;
+
+        while (mStats.residentBytes > mMaxBytes) {
+            Entry& victim = mEntries.back();
+            mStats.residentBytes -= victim.payload.size();
+            mStats.evictions++;
+            mIndex.erase(victim.key);
+            if (!mSpillDirectory.empty()) {
+                evicted.push_back(std::move(victim));
+            }
+            mEntries.pop_back();
+        }
+    }
+
+    // Disk writes happen without holding the lock.
+    for (const Entry& entry : evicted) {
+        spill(entry);
+    }
+}
+
+DecodedTextureCache::Stats DecodedTextureCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+std::string DecodedTextureCache::getSpillPath(const Key& key) const {
+    char name[96];
+    snprintf(name, sizeof(name), "%016" PRIx64 "%016" PRIx64 "-%08x-%08x.bin", key.hash[0],
+             key.hash[1], key.format, key.variant);
+    return mSpillDirectory + "/" + name;
+}
+
+bool DecodedTextureCache::readSpilled(const Key& key, void* output, size_t outputSize) {
+    if (mSpillDirectory.empty()) {
+        return false;
+    }
+
+    const std::string path = getSpillPath(key);
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    SpillHeader header;
+    const bool validHeader = fread(&header, sizeof(header), 1, file) == 1 &&
+                             header.magic == kSpillMagic && header.version == kSpillVersion;
+    const bool valid = validHeader && header.key == key && header.payloadSize == outputSize &&
+                       fread(output, 1, outputSize, file) == outputSize;
+    fclose(file);
+
+    if (!validHeader) {
+        // Left behind by another version, or damaged. It would never be read.
+        remove(path.c_str());
+        std::lock_guard<std::mutex> lock(mMutex);
+        removeSpillFileLocked(path);
+        return false;
+    }
+    if (valid) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mSpillFileIndex.find(path);
+        if (it != mSpillFileIndex.end()) {
+            mSpillFiles.splice(mSpillFiles.end(), mSpillFiles, it->second);
+        }
+    }
+    return valid;
+}
+
+void DecodedTextureCache::spill(const Entry& entry) {
+    const std::string path = getSpillPath(entry.key);
+    const uint64_t fileSize = sizeof(SpillHeader) + entry.payload.size();
+    if (fileSize > mMaxSpillBytes) {
+        return;
+    }
+
+    std::vector<std::string> deletedPaths;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        // A file with the same name is replaced below.
+        removeSpillFileLocked(path);
+        while (!mSpillFiles.empty() && mStats.spilledBytes + fileSize > mMaxSpillBytes) {
+            deletedPaths.push_back(mSpillFiles.front().path);
+            removeSpillFileLocked(deletedPaths.back());
+        }
+        addSpillFileLocked(path, fileSize);
+    }
+
+    // Disk accesses happen without holding the lock.
+    for (const std::string& deletedPath : deletedPaths) {
+        remove(deletedPath.c_str());
+    }
+
+    // Write to a temporary file first so that a concurrent reader, possibly in another process,
+    // never observes a partially written entry.
+    const std::string tmpPath = path + ".tmp";
+    FILE* file = fopen(tmpPath.c_str(), "wb");
+    if (!file) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        removeSpillFileLocked(path);
+        return;
+    }
+
+    SpillHeader header{};
+    header.magic = kSpillMagic;
+    header.version = kSpillVersion;
+    header.key = entry.key;
+    header.payloadSize = entry.payload.size();
+    const bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                         fwrite(entry.payload.data(), 1, entry.payload.size(), file) ==
+                             entry.payload.size();
+    const bool closed = fclose(file) == 0;
+    if (!written || !closed || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        remove(tmpPath.c_str());
+        std::lock_guard<std::mutex> lock(mMutex);
+        removeSpillFileLocked(path);
+    }
+}
+
+void DecodedTextureCache::pruneSpillDirectory() {
+    struct FoundFile {
+        std::string path;
+        uint64_t size = 0;
+        std::filesystem::file_time_type writeTime;
+    };
+    std::vector<FoundFile> found;
+
+    std::error_code error;
+    for (const auto& dirEntry : std::filesystem::directory_iterator(mSpillDirectory, error)) {
+        std::error_code entryError;
+        if (!dirEntry.is_regular_file(entryError)) {
+            continue;
+        }
+        const std::string name = dirEntry.path().filename().string();
+        const std::string path = dirEntry.path().string();
+
+        static constexpr char kTmpSuffix[] = ".tmp";
+        static constexpr size_t kTmpSuffixLength = sizeof(kTmpSuffix) - 1;
+        if (name.size() > kTmpSuffixLength &&
+            !name.compare(name.size() - kTmpSuffixLength, kTmpSuffixLength, kTmpSuffix) &&
+            isSpillFileName(name.substr(0, name.size() - kTmpSuffixLength))) {
+            // Left behind by a writer that did not get to rename it.
+            std::filesystem::remove(dirEntry.path(), entryError);
+            continue;
+        }
+        if (!isSpillFileName(name)) {
+            continue;
+        }
+
+        const uint64_t size = dirEntry.file_size(entryError);
+        if (entryError || !hasValidSpillHeader(path, size)) {
+            std::filesystem::remove(dirEntry.path(), entryError);
+            continue;
+        }
+        found.push_back(FoundFile{
+            .path = path,
+            .size = size,
+            .writeTime = dirEntry.last_write_time(entryError),
+        });
+    }
+
+    std::sort(found.begin(), found.end(), [](const FoundFile& a, const FoundFile& b) {
+        return a.writeTime < b.writeTime;
+    });
+
+    uint64_t totalSize = 0;
+    for (const FoundFile& file : found) {
+        totalSize += file.size;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (const FoundFile& file : found) {
+        if (totalSize > mMaxSpillBytes) {
+            std::filesystem::remove(file.path, error);
+            totalSize -= file.size;
+            continue;
+        }
+        addSpillFileLocked(file.path, file.size);
+    }
+}
+
+void DecodedTextureCache::addSpillFileLocked(const std::string& path, uint64_t size) {
+    removeSpillFileLocked(path);
+    mSpillFiles.push_back(SpillFile{path, size});
+    mSpillFileIndex[path] = std::prev(mSpillFiles.end());
+    mStats.spilledBytes += size;
+}
+
+void DecodedTextureCache::removeSpillFileLocked(const std::string& path) {
+    auto it = mSpillFileIndex.find(path);
+    if (it == mSpillFileIndex.end()) {
+        return;
+    }
+    mStats.spilledBytes -= it->second->size;
+    mSpillFiles.erase(it->second);
+    mSpillFileIndex.erase(it);
+}
+
+}  // namespace host
+}  // namespace gfxstream
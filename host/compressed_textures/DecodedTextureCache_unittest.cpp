@@ -0,0 +1,277 @@
+// Copyright 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "gfxstream/host/DecodedTextureCache.h"
+
+namespace gfxstream {
+namespace host {
+namespace {
+
+using ::testing::ElementsAreArray;
+
+std::vector<uint8_t> makeData(size_t size, uint8_t seed) {
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = static_cast<uint8_t>(seed + i * 7);
+    }
+    return data;
+}
+
+std::vector<DecodedTextureCache::Key> makeKeys(uint8_t count) {
+    std::vector<DecodedTextureCache::Key> keys;
+    for (uint8_t i = 0; i < count; i++) {
+        const std::vector<uint8_t> compressed = makeData(8, i);
+        keys.push_back(
+            DecodedTextureCache::makeKey(1, 0, 4, 4, compressed.data(), compressed.size()));
+    }
+    return keys;
+}
+
+// Returns an empty directory that is private to the calling test.
+std::string makeSpillDirectory(const std::string& name) {
+    const std::filesystem::path directory =
+        std::filesystem::path(::testing::TempDir()) / ("DecodedTextureCache_" + name);
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    return directory.string();
+}
+
+size_t countFiles(const std::string& directory) {
+    size_t count = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        (void)entry;
+        count++;
+    }
+    return count;
+}
+
+uint64_t getSizeOnDisk(const std::string& directory) {
+    uint64_t size = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        size += entry.file_size();
+    }
+    return size;
+}
+
+void writeFile(const std::string& path, const std::vector<uint8_t>& contents) {
+    FILE* file = fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    fwrite(contents.data(), 1, contents.size(), file);
+    fclose(file);
+}
+
+TEST(DecodedTextureCache, KeyDependsOnContentsAndFormat) {
+    const std::vector<uint8_t> a = makeData(64, 1);
+    std::vector<uint8_t> b = a;
+    b[63] ^= 1;
+
+    const auto keyA = DecodedTextureCache::makeKey(1, 0, 4, 4, a.data(), a.size());
+    EXPECT_EQ(keyA, DecodedTextureCache::makeKey(1, 0, 4, 4, a.data(), a.size()));
+    EXPECT_FALSE(keyA == DecodedTextureCache::makeKey(1, 0, 4, 4, b.data(), b.size()));
+    EXPECT_FALSE(keyA == DecodedTextureCache::makeKey(2, 0, 4, 4, a.data(), a.size()));
+    EXPECT_FALSE(keyA == DecodedTextureCache::makeKey(1, 1, 4, 4, a.data(), a.size()));
+    EXPECT_FALSE(keyA == DecodedTextureCache::makeKey(1, 0, 8, 2, a.data(), a.size()));
+}
+
+TEST(DecodedTextureCache, HitAndMiss) {
+    DecodedTextureCache cache(1024);
+    const std::vector<uint8_t> compressed = makeData(16, 3);
+    const std::vector<uint8_t> decoded = makeData(64, 9);
+    const auto key = DecodedTextureCache::makeKey(1, 0, 4, 4, compressed.data(), compressed.size());
+
+    std::vector<uint8_t> output(decoded.size());
+    EXPECT_FALSE(cache.lookup(key, output.data(), output.size()));
+    cache.insert(key, decoded.data(), decoded.size());
+    ASSERT_TRUE(cache.lookup(key, output.data(), output.size()));
+    EXPECT_THAT(output, ElementsAreArray(decoded));
+
+    // Size mismatches are misses.
+    std::vector<uint8_t> smaller(decoded.size() - 1);
+    EXPECT_FALSE(cache.lookup(key, smaller.data(), smaller.size()));
+
+    const DecodedTextureCache::Stats stats = cache.getStats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(stats.bytesSaved, decoded.size());
+    EXPECT_EQ(stats.residentBytes, decoded.size());
+}
+
+TEST(DecodedTextureCache, EvictsLeastRecentlyUsed) {
+    DecodedTextureCache cache(200);
+    const std::vector<uint8_t> payload = makeData(100, 0);
+    std::vector<DecodedTextureCache::Key> keys;
+    for (uint8_t i = 0; i < 3; i++) {
+        const std::vector<uint8_t> compressed = makeData(8, i);
+        keys.push_back(
+            DecodedTextureCache::makeKey(1, 0, 4, 4, compressed.data(), compressed.size()));
+    }
+
+    std::vector<uint8_t> output(payload.size());
+    cache.insert(keys[0], payload.data(), payload.size());
+    cache.insert(keys[1], payload.data(), payload.size());
+    // Touch the first entry so that the second one is evicted next.
+    EXPECT_TRUE(cache.lookup(keys[0], output.data(), output.size()));
+    cache.insert(keys[2], payload.data(), payload.size());
+
+    EXPECT_TRUE(cache.lookup(keys[0], output.data(), output.size()));
+    EXPECT_FALSE(cache.lookup(keys[1], output.data(), output.size()));
+    EXPECT_TRUE(cache.lookup(keys[2], output.data(), output.size()));
+    EXPECT_EQ(cache.getStats().evictions, 1u);
+    EXPECT_EQ(cache.getStats().residentBytes, 200u);
+}
+
+TEST(DecodedTextureCache, SpilledEntriesSurviveRestart) {
+    const std::string directory = makeSpillDirectory("SpilledEntriesSurviveRestart");
+    const std::vector<uint8_t> first = makeData(100, 1);
+    const std::vector<uint8_t> second = makeData(100, 2);
+    const auto firstKey = DecodedTextureCache::makeKey(7, 0, 4, 4, second.data(), 16);
+    const auto secondKey = DecodedTextureCache::makeKey(7, 0, 4, 4, first.data(), 16);
+
+    {
+        DecodedTextureCache cache(100, directory, 1024);
+        cache.insert(firstKey, first.data(), first.size());
+        // Evicts and spills the first entry.
+        cache.insert(secondKey, second.data(), second.size());
+        EXPECT_EQ(cache.getStats().spilledBytes, getSizeOnDisk(directory));
+        EXPECT_EQ(countFiles(directory), 1u);
+    }
+
+    DecodedTextureCache restarted(100, directory, 1024);
+    EXPECT_EQ(restarted.getStats().spilledBytes, getSizeOnDisk(directory));
+    std::vector<uint8_t> output(first.size());
+    ASSERT_TRUE(restarted.lookup(firstKey, output.data(), output.size()));
+    EXPECT_THAT(output, ElementsAreArray(first));
+    EXPECT_EQ(restarted.getStats().diskHits, 1u);
+    EXPECT_FALSE(restarted.lookup(secondKey, output.data(), output.size()));
+}
+
+TEST(DecodedTextureCache, SpillingReplacesOldestFiles) {
+    const std::string directory = makeSpillDirectory("SpillingReplacesOldestFiles");
+    const std::vector<uint8_t> payload = makeData(100, 0);
+    const std::vector<DecodedTextureCache::Key> keys = makeKeys(5);
+
+    // Room for two spilled entries, each of which is the payload plus a header.
+    DecodedTextureCache cache(100, directory, 2 * payload.size() + 200);
+    for (const auto& key : keys) {
+        cache.insert(key, payload.data(), payload.size());
+    }
+
+    // Four entries were spilled in total, far more than the budget, but only
+    // the two most recent remain on disk.
+    EXPECT_EQ(countFiles(directory), 2u);
+    EXPECT_EQ(cache.getStats().spilledBytes, getSizeOnDisk(directory));
+    EXPECT_LE(cache.getStats().spilledBytes, 2 * payload.size() + 200);
+
+    // Reading back the fourth entry spills the fifth one over the third one,
+    // then spilling the fourth entry again replaces its own file.
+    std::vector<uint8_t> output(payload.size());
+    ASSERT_TRUE(cache.lookup(keys[3], output.data(), output.size()));
+    cache.insert(keys[0], payload.data(), payload.size());
+    EXPECT_EQ(countFiles(directory), 2u);
+    EXPECT_EQ(cache.getStats().spilledBytes, getSizeOnDisk(directory));
+
+    DecodedTextureCache restarted(100, directory, 2 * payload.size() + 200);
+    EXPECT_FALSE(restarted.lookup(keys[0], output.data(), output.size()));
+    EXPECT_FALSE(restarted.lookup(keys[1], output.data(), output.size()));
+    EXPECT_FALSE(restarted.lookup(keys[2], output.data(), output.size()));
+    EXPECT_TRUE(restarted.lookup(keys[3], output.data(), output.size()));
+    EXPECT_TRUE(restarted.lookup(keys[4], output.data(), output.size()));
+}
+
+TEST(DecodedTextureCache, PrunesSpillDirectoryOnStartup) {
+    const std::string directory = makeSpillDirectory("PrunesSpillDirectoryOnStartup");
+    const std::vector<uint8_t> payload = makeData(100, 0);
+    const std::vector<DecodedTextureCache::Key> keys = makeKeys(4);
+
+    {
+        DecodedTextureCache cache(100, directory, 1024 * 1024);
+        for (const auto& key : keys) {
+            cache.insert(key, payload.data(), payload.size());
+        }
+    }
+    ASSERT_EQ(countFiles(directory), 3u);
+
+    // Orders the spilled files from the oldest to the newest write.
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    const auto now = std::filesystem::file_time_type::clock::now();
+    for (size_t i = 0; i < files.size(); i++) {
+        std::filesystem::last_write_time(files[i], now - std::chrono::hours(files.size() - i));
+    }
+
+    // An interrupted write, a damaged file and a file that is not the cache's.
+    const std::string interrupted = files[0].string() + ".tmp";
+    std::filesystem::copy_file(files[0], interrupted);
+    const std::string damaged = directory + "/" + std::string(32, '0') + "-00000000-00000000.bin";
+    writeFile(damaged, makeData(200, 5));
+    const std::string unrelated = directory + "/unrelated.txt";
+    writeFile(unrelated, makeData(8, 0));
+
+    // Only leaves room for the two most recently written files.
+    const uint64_t fileSize = std::filesystem::file_size(files[0]);
+    DecodedTextureCache restarted(100, directory, 2 * fileSize);
+    EXPECT_FALSE(std::filesystem::exists(files[0]));
+    EXPECT_TRUE(std::filesystem::exists(files[1]));
+    EXPECT_TRUE(std::filesystem::exists(files[2]));
+    EXPECT_FALSE(std::filesystem::exists(interrupted));
+    EXPECT_FALSE(std::filesystem::exists(damaged));
+    EXPECT_TRUE(std::filesystem::exists(unrelated));
+    EXPECT_EQ(restarted.getStats().spilledBytes, 2 * fileSize);
+}
+
+TEST(DecodedTextureCache, CanBeDisabled) {
+    DecodedTextureCache cache(1024);
+    const std::vector<uint8_t> payload = makeData(16, 0);
+    const auto key = DecodedTextureCache::makeKey(1, 0, 4, 4, payload.data(), payload.size());
+    std::vector<uint8_t> output(payload.size());
+
+    cache.setEnabled(false);
+    EXPECT_FALSE(cache.enabled());
+    cache.insert(key, payload.data(), payload.size());
+    EXPECT_FALSE(cache.lookup(key, output.data(), output.size()));
+
+    cache.setEnabled(true);
+    EXPECT_TRUE(cache.enabled());
+    cache.insert(key, payload.data(), payload.size());
+    EXPECT_TRUE(cache.lookup(key, output.data(), output.size()));
+}
+
+TEST(DecodedTextureCache, ProcessCacheIsDisabledByDefault) {
+    EXPECT_FALSE(DecodedTextureCache::get().enabled());
+}
+
+TEST(DecodedTextureCache, DisabledWhenEmpty) {
+    DecodedTextureCache cache(0);
+    const std::vector<uint8_t> payload = makeData(16, 0);
+    const auto key = DecodedTextureCache::makeKey(1, 0, 4, 4, payload.data(), payload.size());
+    cache.insert(key, payload.data(), payload.size());
+    std::vector<uint8_t> output(payload.size());
+    EXPECT_FALSE(cache.lookup(key, output.data(), output.size()));
+}
+
+}  // namespace
+}  // namespace host
+}  // namespace gfxstream
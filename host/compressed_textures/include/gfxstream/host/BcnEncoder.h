@@ -0,0 +1,56 @@
+// Copyright 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace gfxstream {
+namespace host {
+
+// Block compressed formats that decoded ETC2/EAC/ASTC images can be re-encoded
+// into so that they stay compressed in host VRAM when the host GPU does not
+// support the guest's format natively.
+enum class BcnFormat {
+    // 4 bpp, opaque RGB.
+    kBc1,
+    // 4 bpp, RGB with 1-bit alpha (texels with alpha < 128 become transparent black).
+    kBc1Alpha,
+    // 8 bpp, RGB plus interpolated alpha.
+    kBc3,
+    // 4 bpp, single unsigned or signed channel.
+    kBc4Unorm,
+    kBc4Snorm,
+    // 8 bpp, two unsigned or signed channels.
+    kBc5Unorm,
+    kBc5Snorm,
+};
+
+// Returns the number of bytes needed to hold a width x height image encoded as `format`.
+size_t getBcnEncodedSize(BcnFormat format, uint32_t width, uint32_t height);
+
+// Encodes an 8-bit per channel image into `format` using a fast range fit encoder.
+//
+// pixels: source image. The first channels of every texel are consumed: RGB(A) for BC1/BC3,
+//         R for BC4 and RG for BC5. Snorm formats interpret the channels as int8_t.
+// pixelSize: distance in bytes between two horizontally adjacent texels.
+// rowPitch: distance in bytes between two rows of texels.
+// output: must be able to hold at least getBcnEncodedSize(format, width, height) bytes.
+//
+// Returns false if the arguments are invalid.
+bool bcnEncode(BcnFormat format, const uint8_t* pixels, uint32_t width, uint32_t height,
+               size_t pixelSize, size_t rowPitch, uint8_t* output, size_t outputSize);
+
+}  // namespace host
+}  // namespace gfxstream
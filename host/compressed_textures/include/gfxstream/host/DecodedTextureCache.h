@@ -0,0 +1,127 @@
+// Copyright 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gfxstream {
+namespace host {
+
+// Bounded cache of decoded (or transcoded) compressed textures, keyed by a hash of the compressed
+// block data, the source format and the image extent. Entries evicted from memory can optionally
+// be spilled to a directory so they survive process restarts. The spill files are bounded too:
+// the oldest ones are deleted to make room for new ones, and when the cache is created.
+//
+// This class is thread-safe and all its methods can be called by any thread.
+class DecodedTextureCache {
+   public:
+    struct Key {
+        uint64_t hash[2] = {0, 0};
+        // Source format (e.g. a GL enum or an ASTC block footprint).
+        uint32_t format = 0;
+        // Distinguishes different outputs of the same source, e.g. RGBA8 versus BC3.
+        uint32_t variant = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint64_t dataSize = 0;
+
+        bool operator==(const Key& other) const;
+    };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t diskHits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        // Decoded bytes served from the cache instead of being decoded again.
+        uint64_t bytesSaved = 0;
+        uint64_t residentBytes = 0;
+        // Size of the spill files that this cache knows of in the spill directory.
+        uint64_t spilledBytes = 0;
+    };
+
+    // Returns the process wide cache. It is disabled until setEnabled() is called, which the
+    // GlDecodedTextureCache feature does. Its size is read from
+    // ANDROID_EMUGL_DECODED_TEXTURE_CACHE_MB (0 disables it) and the spill directory from
+    // ANDROID_EMUGL_DECODED_TEXTURE_CACHE_DIR.
+    static DecodedTextureCache& get();
+
+    DecodedTextureCache(size_t maxBytes, std::string spillDirectory = "",
+                        size_t maxSpillBytes = 0);
+
+    void setEnabled(bool enabled) { mEnabled = enabled; }
+    bool enabled() const { return mEnabled && mMaxBytes > 0; }
+
+    static Key makeKey(uint32_t format, uint32_t variant, uint32_t width, uint32_t height,
+                       const void* data, size_t dataSize);
+
+    // Copies the cached payload for `key` into `output` if there is one of exactly `outputSize`
+    // bytes.
+    bool lookup(const Key& key, void* output, size_t outputSize);
+
+    void insert(const Key& key, const void* payload, size_t payloadSize);
+
+    Stats getStats() const;
+
+   private:
+    struct KeyHash {
+        size_t operator()(const Key& key) const { return static_cast<size_t>(key.hash[0]); }
+    };
+    struct Entry {
+        Key key;
+        std::vector<uint8_t> payload;
+    };
+    using EntryList = std::list<Entry>;
+
+    struct SpillFile {
+        std::string path;
+        uint64_t size = 0;
+    };
+    using SpillFileList = std::list<SpillFile>;
+
+    std::string getSpillPath(const Key& key) const;
+    bool readSpilled(const Key& key, void* output, size_t outputSize);
+    void spill(const Entry& entry);
+
+    // Deletes partially written and unreadable spill files, and the oldest ones beyond
+    // |mMaxSpillBytes|, and records the remaining ones.
+    void pruneSpillDirectory();
+    // Records a spill file as the most recently used one.
+    void addSpillFileLocked(const std::string& path, uint64_t size);
+    void removeSpillFileLocked(const std::string& path);
+
+    const size_t mMaxBytes;
+    const std::string mSpillDirectory;
+    const size_t mMaxSpillBytes;
+    std::atomic<bool> mEnabled{true};
+
+    mutable std::mutex mMutex;
+    // Most recently used entries first.
+    EntryList mEntries;
+    std::unordered_map<Key, EntryList::iterator, KeyHash> mIndex;
+    // Least recently written or read spill files first.
+    SpillFileList mSpillFiles;
+    std::unordered_map<std::string, SpillFileList::iterator> mSpillFileIndex;
+    Stats mStats;
+};
+
+}  // namespace host
+}  // namespace gfxstream
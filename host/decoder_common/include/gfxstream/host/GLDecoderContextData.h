@@ -65,8 +65,41 @@ public:
         }
     }
 
+    // Number of slots that keep client vertex array data which guests can refer back to
+    // with glVertexAttribPointerCachedAEMU() instead of sending the same data again. The
+    // guest decides which slot each upload goes to.
+    static const int kMaxCachedPointerData = 32;
+
+    // Store |len| bytes from |data| into the cache slot |slot|.
+    void storeCachedPointerData(unsigned int slot, void *data, size_t len) {
+        if (slot < mCachedPointerData.size()) {
+            mCachedPointerData[slot].assign(reinterpret_cast<char*>(data),
+                                            reinterpret_cast<char*>(data) + len);
+        } else {
+            // User error, don't do anything here
+        }
+    }
+
+    // Return pointer to the data of cache slot |slot| if it holds exactly
+    // |len| bytes, or nullptr otherwise.
+    void* cachedPointerData(unsigned int slot, size_t len) const {
+        if (slot < mCachedPointerData.size() && mCachedPointerData[slot].size() == len) {
+            return const_cast<char*>(mCachedPointerData[slot].data());
+        } else {
+            // User error. Return nullptr.
+            return nullptr;
+        }
+    }
+
+    // Return the cache slot |slot| so that it can be saved with and restored
+    // from snapshots. |slot| must be less than kMaxCachedPointerData.
+    std::vector<char>& cachedPointerDataSlot(unsigned int slot) {
+        return mCachedPointerData[slot];
+    }
+
 private:
     static const int kMaxVertexAttributes = 16;
 
     std::array<std::vector<char>, kMaxVertexAttributes> mPointerData = {};
+    std::array<std::vector<char>, kMaxCachedPointerData> mCachedPointerData = {};
 };
\ No newline at end of file
@@ -64,6 +64,13 @@ struct FeatureSet {
         "to compose and post frame buffers.",
         &map,
     };
+    FeatureInfo AsyncColorBufferReadback = {
+        "AsyncColorBufferReadback",
+        "If enabled, readbacks of Vulkan only ColorBuffers are copied to a "
+        "staging buffer and waited on without holding the FrameBuffer lock, so "
+        "that other render threads are not blocked while the GPU drains.",
+        &map,
+    };
     FeatureInfo ExternalBlob = {
         "ExternalBlob",
         "If enabled, virtio gpu blob resources will be allocated with external "
@@ -89,12 +96,43 @@ struct FeatureSet {
         "completion.",
         &map,
     };
+    FeatureInfo GlClientArrayCache = {
+        "GlClientArrayCache",
+        "If enabled, the host keeps recently uploaded client vertex array data "
+        "of each context so that the guest can refer back to it instead of "
+        "sending the same data again for every draw.",
+        &map,
+    };
+    FeatureInfo ColorBufferEviction = {
+        "ColorBufferEviction",
+        "If enabled, when the GL only ColorBuffers take more GPU memory than the "
+        "budget (STREAM_RENDERER_PARAM_COLOR_BUFFER_BUDGET_MB), the host moves the "
+        "contents of the ones that have been idle for a while "
+        "(STREAM_RENDERER_PARAM_COLOR_BUFFER_EVICTION_MIN_IDLE_MS) to system memory "
+        "and restores them on their next use.",
+        &map,
+    };
+    FeatureInfo GlDecodedTextureCache = {
+        "GlDecodedTextureCache",
+        "If enabled, the host GLES translator keeps recently decoded ETC2 images and "
+        "BCn transcodes in a bounded memory cache, optionally spilled to the "
+        "directory in ANDROID_EMUGL_DECODED_TEXTURE_CACHE_DIR, so that uploading the "
+        "same compressed data again skips the CPU decode.",
+        &map,
+    };
     FeatureInfo GlDirectMem = {
         "GlDirectMem",
         "If enabled, allows mapping the host address from glMapBufferRange() into "
         "the guest.",
         &map,
     };
+    FeatureInfo GlDrawCoalescing = {
+        "GlDrawCoalescing",
+        "If enabled, the host GLES translator records consecutive draws that "
+        "differ only in their ranges and issues them with a single glMultiDraw*() "
+        "call to the host driver.",
+        &map,
+    };
     FeatureInfo GlDma = {
         "GlDma",
         "Default description: consider contributing a description if you see this!",
@@ -105,6 +143,20 @@ struct FeatureSet {
         "Default description: consider contributing a description if you see this!",
         &map,
     };
+    FeatureInfo GlBcnTranscode = {
+        "GlBcnTranscode",
+        "If enabled, the host GLES translator re-encodes ETC2/EAC/ASTC textures that the "
+        "host GL does not support to BC1/BC3/BC4/BC5 when the host supports S3TC/RGTC, "
+        "instead of fully decompressing them.",
+        &map,
+    };
+    FeatureInfo GlEtcComputeDecode = {
+        "GlEtcComputeDecode",
+        "If enabled, the host GLES translator decodes ETC2/EAC textures with GL "
+        "compute shaders when the host GL supports them, instead of decoding them "
+        "on the CPU.",
+        &map,
+    };
     FeatureInfo GlProgramBinaryLinkStatus = {
         "GlProgramBinaryLinkStatus",
         "If enabled, the host will track and report the correct link status of programs "
@@ -219,6 +271,13 @@ struct FeatureSet {
         "called on a virtio-gpu-next branch in upstream kernel?).",
         &map,
     };
+    FeatureInfo VirtioGpuSnapshotTextFormat = {
+        "VirtioGpuSnapshotTextFormat",
+        "If enabled, the virtio gpu frontend state of snapshots is saved as a text proto "
+        "with the contents of the ring blobs inlined, which is easier to debug but slower "
+        "and larger than the default binary format.",
+        &map,
+    };
     FeatureInfo BypassVulkanDeviceFeatureOverrides = {
         "BypassVulkanDeviceFeatureOverrides",
         "We are force disabling (overriding) some vulkan features (private data, uniform inline "
@@ -247,6 +306,13 @@ struct FeatureSet {
         "in vkQueueSubmit() commands.",
         &map,
     };
+    FeatureInfo VulkanDeferredDestroy = {
+        "VulkanDeferredDestroy",
+        "If enabled, the host destroys guest image views, samplers, framebuffers, render "
+        "passes and descriptor pools in batches once previously submitted work completes "
+        "instead of during the guest's destroy call.",
+        &map,
+    };
     FeatureInfo VulkanIgnoredHandles = {
         "VulkanIgnoredHandles",
         "If enabled, the guest to host Vulkan protocol will ignore handles in some "
@@ -264,6 +330,13 @@ struct FeatureSet {
         "strings as actual null values instead of as empty strings.",
         &map,
     };
+    FeatureInfo VulkanParallelSubDecode = {
+        "VulkanParallelSubDecode",
+        "If enabled, the command buffer streams flushed with vkQueueFlushCommandsGOOGLE() "
+        "are decoded on worker threads, in parallel across command pools, instead of on "
+        "the render thread that received them.",
+        &map,
+    };
     FeatureInfo VulkanQueueSubmitWithCommands = {
         "VulkanQueueSubmitWithCommands",
         "If enabled, uses deferred command submission with global sequence number "
@@ -280,6 +353,12 @@ struct FeatureSet {
         "If enabled, supports snapshotting the guest and host Vulkan state.",
         &map,
     };
+    FeatureInfo VulkanSubAllocateMemory = {
+        "VulkanSubAllocateMemory",
+        "If enabled, places small device local guest memory allocations inside of "
+        "larger host memory allocations to reduce the number of host driver allocations.",
+        &map,
+    };
     FeatureInfo VulkanUseDedicatedAhbMemoryType = {
         "VulkanUseDedicatedAhbMemoryType",
         "If enabled, emulates an additional memory type for AHardwareBuffer allocations "
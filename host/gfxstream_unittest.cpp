@@ -14,13 +14,23 @@
 
 #include <gtest/gtest.h>
 
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "VirtioGpuFormatUtils.h"
+#ifdef GFXSTREAM_BUILD_WITH_SNAPSHOT_FRONTEND_SUPPORT
+#include "VirtioGpuFrontend.h"
+#include "VirtioGpuRingBlob.h"
+#endif
 #include "gfxstream/host/testing/OSWindow.h"
 #include "gfxstream/system/System.h"
 #include "gfxstream/virtio-gpu-gfxstream-renderer-unstable.h"
 #include "gfxstream/virtio-gpu-gfxstream-renderer.h"
+#include "virtgpu_gfxstream_protocol.h"
 
 using gfxstream::base::sleepMs;
 
@@ -203,3 +213,161 @@ TEST_F(GfxStreamBackendTest, MissingRequiredParameter) {
     int initResult = stream_renderer_init(streamRendererParams.data(), streamRendererParams.size());
     EXPECT_EQ(initResult, 0);
 }
+
+TEST_F(GfxStreamBackendTest, ConcurrentSubmitAndResourceChurn) {
+    ASSERT_EQ(stream_renderer_init(streamRendererParams.data(), streamRendererParams.size()), 0);
+
+    constexpr uint32_t kContextCount = 4;
+    constexpr uint32_t kIterations = 200;
+    const std::string name = "churn";
+    for (uint32_t ctxId = 1; ctxId <= kContextCount; ctxId++) {
+        ASSERT_EQ(stream_renderer_context_create(ctxId, name.size(), name.c_str(), 0), 0);
+    }
+
+    std::vector<std::thread> threads;
+    // Commands that lock their context.
+    for (uint32_t ctxId = 1; ctxId <= kContextCount; ctxId++) {
+        threads.emplace_back([ctxId] {
+            for (uint32_t i = 0; i < kIterations; i++) {
+                gfxstream::gfxstreamResourceCreate3d create3d = {};
+                create3d.hdr.opCode = GFXSTREAM_RESOURCE_CREATE_3D;
+                create3d.blobId = i;
+                struct stream_renderer_command cmd = {};
+                cmd.ctx_id = ctxId;
+                cmd.cmd_size = sizeof(create3d);
+                cmd.cmd = reinterpret_cast<uint8_t*>(&create3d);
+                EXPECT_EQ(stream_renderer_submit_cmd(&cmd), 0);
+            }
+        });
+    }
+    // Resources created, attached to the contexts and destroyed, sometimes while attached.
+    threads.emplace_back([] {
+        for (uint32_t i = 0; i < kIterations; i++) {
+            const uint32_t resId = 100 + i;
+            struct stream_renderer_resource_create_args args = {
+                .handle = resId,
+                .target = 2,  // PIPE_TEXTURE_2D
+                .format = VIRGL_FORMAT_R8G8B8A8_UNORM,
+                .bind = VIRGL_BIND_SAMPLER_VIEW,
+                .width = 16,
+                .height = 16,
+                .depth = 1,
+                .array_size = 1,
+            };
+            EXPECT_EQ(stream_renderer_resource_create(&args, nullptr, 0), 0);
+            for (uint32_t ctxId = 1; ctxId <= kContextCount; ctxId++) {
+                stream_renderer_ctx_attach_resource(ctxId, resId);
+            }
+            if (i % 2) {
+                stream_renderer_ctx_detach_resource(1 + i % kContextCount, resId);
+            }
+            stream_renderer_resource_unref(resId);
+        }
+    });
+    // Contexts created and destroyed while the resources are attached to the others.
+    threads.emplace_back([&name] {
+        for (uint32_t i = 0; i < kIterations; i++) {
+            const uint32_t ctxId = 100 + i % 4;
+            EXPECT_EQ(stream_renderer_context_create(ctxId, name.size(), name.c_str(), 0), 0);
+            stream_renderer_ctx_attach_resource(ctxId, 100 + i);
+            stream_renderer_context_destroy(ctxId);
+        }
+    });
+#ifdef GFXSTREAM_BUILD_WITH_SNAPSHOT_FRONTEND_SUPPORT
+    // Snapshots walk every context and resource while they are being used.
+    threads.emplace_back([] {
+        const std::string directory = ::testing::TempDir() + "/gfxstream_churn_snapshot";
+        for (uint32_t i = 0; i < 4; i++) {
+            stream_renderer_snapshot(directory.c_str());
+        }
+    });
+#endif
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (uint32_t ctxId = 1; ctxId <= kContextCount; ctxId++) {
+        stream_renderer_context_destroy(ctxId);
+    }
+}
+
+#ifdef GFXSTREAM_BUILD_WITH_SNAPSHOT_FRONTEND_SUPPORT
+// Saves a ring blob with some zero chunks, which binary snapshots leave out of the blob file,
+// and checks that it is restored in full from what was written.
+static void SnapshotAndRestoreRingBlob(std::vector<stream_renderer_param> params,
+                                       bool textFormat) {
+    const std::string features = textFormat ? "VirtioGpuSnapshotTextFormat:enabled" : "";
+    params.push_back({STREAM_RENDERER_PARAM_RENDERER_FEATURES,
+                      static_cast<uint64_t>(reinterpret_cast<uintptr_t>(features.c_str()))});
+    ASSERT_EQ(stream_renderer_init(params.data(), params.size()), 0);
+
+    const std::string name = "snapshot";
+    const uint32_t ctxId = 1;
+    const uint32_t resId = 1;
+    ASSERT_EQ(stream_renderer_context_create(ctxId, name.size(), name.c_str(), 0), 0);
+
+    constexpr uint64_t kBlobSize = 256 * 1024 + 4096;
+    const struct stream_renderer_create_blob createBlob = {
+        .blob_mem = STREAM_BLOB_MEM_HOST3D,
+        .blob_flags = STREAM_BLOB_FLAG_USE_MAPPABLE,
+        .blob_id = 0,
+        .size = kBlobSize,
+    };
+    ASSERT_EQ(stream_renderer_create_blob(ctxId, resId, &createBlob, nullptr, 0, nullptr), 0);
+
+    std::vector<uint8_t> expected(kBlobSize, 0);
+    for (uint64_t i = 0; i < 4096; i++) {
+        expected[i] = static_cast<uint8_t>(i + 1);
+        expected[160 * 1024 + i] = static_cast<uint8_t>(i * 3 + 1);
+        expected[kBlobSize - 4096 + i] = static_cast<uint8_t>(i * 7 + 1);
+    }
+    void* hva = nullptr;
+    uint64_t size = 0;
+    ASSERT_EQ(stream_renderer_resource_map(resId, &hva, &size), 0);
+    ASSERT_EQ(size, kBlobSize);
+    std::memcpy(hva, expected.data(), kBlobSize);
+
+    const std::filesystem::path directory =
+        std::filesystem::path(::testing::TempDir()) /
+        (textFormat ? "gfxstream_ring_blob_snapshot_text" : "gfxstream_ring_blob_snapshot");
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    // Left behind by an earlier snapshot of a blob that no longer exists.
+    const std::filesystem::path staleBlobPath = directory / "gfxstream_ring_blob_99.bin";
+    std::ofstream(staleBlobPath) << "stale";
+
+    ASSERT_EQ(stream_renderer_snapshot(directory.c_str()), 0);
+    EXPECT_EQ(std::filesystem::exists(directory / "gfxstream_frontend.binpb"), !textFormat);
+    EXPECT_EQ(std::filesystem::exists(directory / "gfxstream_frontend.txtproto"), textFormat);
+    EXPECT_EQ(std::filesystem::exists(directory / "gfxstream_ring_blob_1.bin"), !textFormat);
+    EXPECT_FALSE(std::filesystem::exists(staleBlobPath));
+
+    // Restores the blob the way the frontend does, without going through the renderer.
+    gfxstream::host::snapshot::VirtioGpuFrontendSnapshot snapshot;
+    ASSERT_EQ(gfxstream::host::VirtioGpuFrontend::readFrontendSnapshot(directory.c_str(),
+                                                                       &snapshot),
+              0);
+    ASSERT_EQ(snapshot.resources().count(resId), 1u);
+    const auto& ringBlobSnapshot = snapshot.resources().at(resId).ring_blob();
+    EXPECT_EQ(ringBlobSnapshot.memory_file().empty(), textFormat);
+    // Only the three non-zero chunks are written to the blob file.
+    EXPECT_EQ(ringBlobSnapshot.memory_ranges_size(), textFormat ? 0 : 3);
+
+    auto ringBlobOpt = gfxstream::host::RingBlob::Restore(ringBlobSnapshot, directory.c_str());
+    ASSERT_TRUE(ringBlobOpt.has_value());
+    auto& ringBlob = *ringBlobOpt;
+    ASSERT_EQ(ringBlob->size(), kBlobSize);
+    EXPECT_EQ(std::memcmp(ringBlob->map(), expected.data(), kBlobSize), 0);
+
+    stream_renderer_resource_unref(resId);
+    stream_renderer_context_destroy(ctxId);
+}
+
+TEST_F(GfxStreamBackendTest, SnapshotRestoresRingBlob) {
+    SnapshotAndRestoreRingBlob(streamRendererParams, /*textFormat=*/false);
+}
+
+TEST_F(GfxStreamBackendTest, TextSnapshotRestoresRingBlob) {
+    SnapshotAndRestoreRingBlob(streamRendererParams, /*textFormat=*/true);
+}
+#endif
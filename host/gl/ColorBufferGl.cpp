@@ -747,6 +747,18 @@ bool ColorBufferGl::readContents(size_t* numBytes, void* pixels) {
     }
 }
 
+bool ColorBufferGl::readContents(int x, int y, int width, int height, size_t* numBytes,
+                                 void* pixels) {
+    if (m_yuv_converter) {
+        return false;
+    }
+    *numBytes = m_numBytes / (m_width * m_height) * width * height;
+    if (!pixels) {
+        return true;
+    }
+    return readPixels(x, y, width, height, m_format, m_type, pixels);
+}
+
 bool ColorBufferGl::blitFromCurrentReadBuffer() {
     RenderThreadInfoGl* const tInfo = RenderThreadInfoGl::get();
     if (!tInfo) {
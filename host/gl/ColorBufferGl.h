@@ -151,6 +151,9 @@ class ColorBufferGl {
     // Reads back entire contents, tightly packed rows.
     // If the framework format is YUV, it will read back as raw YUV data.
     bool readContents(size_t* numBytes, void* pixels);
+    // Reads back a region in the same layout as readContents(). Not supported
+    // for YUV framework formats.
+    bool readContents(int x, int y, int width, int height, size_t* numBytes, void* pixels);
 
     // Draw a ColorBufferGl instance, i.e. blit it to the current guest
     // framebuffer object / window surface. This doesn't display anything.
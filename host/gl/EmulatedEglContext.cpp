@@ -98,23 +98,46 @@ EmulatedEglContext::~EmulatedEglContext() {
     }
 }
 
-void EmulatedEglContext::onSave(gfxstream::Stream* stream) {
+void EmulatedEglContext::onSave(gfxstream::Stream* stream, bool clientArrayCache) {
     stream->putBe32(mHndl);
     stream->putBe32(static_cast<uint32_t>(mVersion));
     assert(s_egl.eglCreateContext);
     if (s_egl.eglSaveContext) {
         s_egl.eglSaveContext(mDisplay, mContext, static_cast<EGLStreamKHR>(stream));
     }
+    // The guest keeps referring to the client arrays that it uploaded before the snapshot.
+    // TODO(b/309858017): remove if when ready to bump snapshot version
+    if (!clientArrayCache) {
+        return;
+    }
+    for (int slot = 0; slot < GLDecoderContextData::kMaxCachedPointerData; slot++) {
+        const std::vector<char>& data = mContextData.cachedPointerDataSlot(slot);
+        stream->putBe32(static_cast<uint32_t>(data.size()));
+        stream->write(data.data(), data.size());
+    }
 }
 
 std::unique_ptr<EmulatedEglContext> EmulatedEglContext::onLoad(
         gfxstream::Stream* stream,
-        EGLDisplay display) {
+        EGLDisplay display,
+        bool clientArrayCache) {
     HandleType hndl = static_cast<HandleType>(stream->getBe32());
     GLESApi version = static_cast<GLESApi>(stream->getBe32());
 
-    return createImpl(display, (EGLConfig)0, EGL_NO_CONTEXT, hndl, version,
-                      stream);
+    auto context = createImpl(display, (EGLConfig)0, EGL_NO_CONTEXT, hndl, version,
+                              stream);
+    // TODO(b/309858017): remove if when ready to bump snapshot version
+    if (!clientArrayCache) {
+        return context;
+    }
+    for (int slot = 0; slot < GLDecoderContextData::kMaxCachedPointerData; slot++) {
+        std::vector<char> data(stream->getBe32());
+        stream->read(data.data(), data.size());
+        if (context) {
+            context->mContextData.cachedPointerDataSlot(slot) = std::move(data);
+        }
+    }
+    return context;
 }
 
 GLESApi EmulatedEglContext::clientVersion() const {
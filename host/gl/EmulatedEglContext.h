@@ -61,8 +61,11 @@ class EmulatedEglContext {
 
    HandleType getHndl() const { return mHndl; }
 
-   void onSave(gfxstream::Stream* stream);
-   static std::unique_ptr<EmulatedEglContext> onLoad(gfxstream::Stream* stream, EGLDisplay display);
+   // The cached client arrays are only part of the snapshot with the GlClientArrayCache
+   // feature, so that snapshots taken without it keep loading.
+   void onSave(gfxstream::Stream* stream, bool clientArrayCache);
+   static std::unique_ptr<EmulatedEglContext> onLoad(gfxstream::Stream* stream, EGLDisplay display,
+                                                     bool clientArrayCache);
   private:
     EmulatedEglContext(EGLDisplay display,
                        EGLContext context,
@@ -255,6 +255,30 @@ std::unique_ptr<EmulationGl> EmulationGl::create(uint32_t width, uint32_t height
             emulationGl->mFeatures.GlProgramBinaryLinkStatus.enabled);
     }
 
+    if (s_egl.eglSetDrawCoalescingEnabledANDROID) {
+        s_egl.eglSetDrawCoalescingEnabledANDROID(
+            emulationGl->mEglDisplay,
+            emulationGl->mFeatures.GlDrawCoalescing.enabled);
+    }
+
+    if (s_egl.eglSetDecodedTextureCacheEnabledANDROID) {
+        s_egl.eglSetDecodedTextureCacheEnabledANDROID(
+            emulationGl->mEglDisplay,
+            emulationGl->mFeatures.GlDecodedTextureCache.enabled);
+    }
+
+    if (s_egl.eglSetBcnTranscodeEnabledANDROID) {
+        s_egl.eglSetBcnTranscodeEnabledANDROID(
+            emulationGl->mEglDisplay,
+            emulationGl->mFeatures.GlBcnTranscode.enabled);
+    }
+
+    if (s_egl.eglSetEtcComputeDecodeEnabledANDROID) {
+        s_egl.eglSetEtcComputeDecodeEnabledANDROID(
+            emulationGl->mEglDisplay,
+            emulationGl->mFeatures.GlEtcComputeDecode.enabled);
+    }
+
     s_egl.eglBindAPI(EGL_OPENGL_ES_API);
 
 #ifdef ENABLE_GFXSTREAM_DEBUG
@@ -734,7 +758,7 @@ std::unique_ptr<EmulatedEglContext> EmulationGl::createEmulatedEglContext(
 
 std::unique_ptr<EmulatedEglContext> EmulationGl::loadEmulatedEglContext(
         gfxstream::Stream* stream) {
-    return EmulatedEglContext::onLoad(stream, mEglDisplay);
+    return EmulatedEglContext::onLoad(stream, mEglDisplay, mFeatures.GlClientArrayCache.enabled);
 }
 
 std::unique_ptr<EmulatedEglFenceSync> EmulationGl::createEmulatedEglFenceSync(
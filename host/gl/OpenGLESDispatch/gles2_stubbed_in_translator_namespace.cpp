@@ -46,5 +46,7 @@ GL_APICALL void GL_APIENTRY glReadnPixelsEXT(GLint, GLint, GLsizei, GLsizei, GLe
 GL_APICALL void GL_APIENTRY glGetnUniformfvEXT(GLuint, GLint, GLsizei, float *) { return; }
 GL_APICALL void GL_APIENTRY glGetnUniformivEXT(GLuint, GLint, GLsizei, GLint *) { return; }
 GL_APICALL void GL_APIENTRY glFramebufferTexture3DOES(GLenum, GLenum, GLenum, GLuint, GLint, GLint) { return; }
+GL_APICALL void GL_APIENTRY glMultiDrawArrays(GLenum, const GLint *, const GLsizei *, GLsizei) { return; }
+GL_APICALL void GL_APIENTRY glMultiDrawElements(GLenum, const GLsizei *, GLenum, const void *const *, GLsizei) { return; }
 } // namespace gles2
 } // namespace translator
@@ -43,6 +43,10 @@
   X(EGLint, eglDebugMessageControlKHR, (EGLDEBUGPROCKHR callback, const EGLAttrib * attrib_list)) \
   X(EGLBoolean, eglSetNativeTextureDecompressionEnabledANDROID, (EGLDisplay display, EGLBoolean enabled)) \
   X(EGLBoolean, eglSetProgramBinaryLinkStatusEnabledANDROID, (EGLDisplay display, EGLBoolean enabled)) \
+  X(EGLBoolean, eglSetDrawCoalescingEnabledANDROID, (EGLDisplay display, EGLBoolean enabled)) \
+  X(EGLBoolean, eglSetDecodedTextureCacheEnabledANDROID, (EGLDisplay display, EGLBoolean enabled)) \
+  X(EGLBoolean, eglSetEtcComputeDecodeEnabledANDROID, (EGLDisplay display, EGLBoolean enabled)) \
+  X(EGLBoolean, eglSetBcnTranscodeEnabledANDROID, (EGLDisplay display, EGLBoolean enabled)) \
 
 EGLAPI EGLint EGLAPIENTRY eglGetMaxGLESVersion(EGLDisplay display);
 EGLAPI void EGLAPIENTRY eglBlitFromCurrentReadBufferANDROID(EGLDisplay display, EGLImageKHR image);
@@ -36,6 +36,7 @@ GL_APICALL void GL_APIENTRY glShaderBinary(GLsizei n, const GLuint* shaders, GLe
 GL_APICALL void GL_APIENTRY glVertexAttribPointerWithDataSize(GLuint indx, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* ptr, GLsizei dataSize);
 GL_APICALL void GL_APIENTRY glFramebufferTexture3DOES(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level, GLint zoffset);
 GL_APICALL void GL_APIENTRY glTestHostDriverPerformance(GLuint count, uint64_t* duration_us, uint64_t* duration_cpu_us);
+GL_APICALL void GL_APIENTRY glFlushPendingDrawsHOST();
 GL_APICALL void GL_APIENTRY glBindVertexArrayOES(GLuint array);
 GL_APICALL void GL_APIENTRY glDeleteVertexArraysOES(GLsizei n, const GLuint * arrays);
 GL_APICALL void GL_APIENTRY glGenVertexArraysOES(GLsizei n, GLuint * arrays);
@@ -46,5 +47,7 @@ GL_APICALL void GL_APIENTRY glDebugMessageCallbackKHR(GFXSTREAM_GLES2_GLDEBUGPRO
 GL_APICALL GLuint GL_APIENTRY glGetDebugMessageLogKHR(GLuint count, GLsizei bufSize, GLenum * sources, GLenum * types, GLuint * ids, GLenum * severities, GLsizei * lengths, GLchar * messageLog);
 GL_APICALL void GL_APIENTRY glPushDebugGroupKHR(GLenum source, GLuint id, GLsizei length, const GLchar* message);
 GL_APICALL void GL_APIENTRY glPopDebugGroupKHR();
+GL_APICALL void GL_APIENTRY glMultiDrawArrays(GLenum mode, const GLint * first, const GLsizei * count, GLsizei drawcount);
+GL_APICALL void GL_APIENTRY glMultiDrawElements(GLenum mode, const GLsizei * count, GLenum type, const void *const * indices, GLsizei drawcount);
 } // namespace translator
 } // namespace gles2
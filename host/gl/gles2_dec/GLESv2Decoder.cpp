@@ -27,6 +27,7 @@
 #include <GLES3/gl3.h>
 #include <GLES3/gl31.h>
 
+#include "gfxstream/common/logging.h"
 #include "gfxstream/host/dma_device.h"
 #include "gfxstream/host/vm_operations.h"
 #include "gfxstream/synchronization/Lock.h"
@@ -114,6 +115,8 @@ int GLESv2Decoder::initGL(get_proc_func_t getProcFunc, void *getProcFuncData)
     glGetCompressedTextureFormats = s_glGetCompressedTextureFormats;
     glVertexAttribPointerData = s_glVertexAttribPointerData;
     glVertexAttribPointerOffset = s_glVertexAttribPointerOffset;
+    glVertexAttribPointerDataCachedAEMU = s_glVertexAttribPointerDataCachedAEMU;
+    glVertexAttribPointerCachedAEMU = s_glVertexAttribPointerCachedAEMU;
     glShaderString = s_glShaderString;
 
     glDrawElementsOffset = s_glDrawElementsOffset;
@@ -333,6 +336,37 @@ void GLESv2Decoder::s_glVertexAttribPointerOffset(void *self, GLuint indx, GLint
     ctx->glVertexAttribPointer(indx, size, type, normalized, stride, SafePointerFromUInt(data));
 }
 
+void GLESv2Decoder::s_glVertexAttribPointerDataCachedAEMU(void *self, GLuint indx, GLint size, GLenum type,
+                                                      GLboolean normalized, GLsizei stride, GLuint slot,
+                                                      void * data, GLuint datalen)
+{
+    GLESv2Decoder *ctx = (GLESv2Decoder *) self;
+    if (ctx->m_contextData != NULL) {
+        ctx->m_contextData->storeCachedPointerData(slot, data, datalen);
+        s_glVertexAttribPointerCachedAEMU(self, indx, size, type, normalized, stride, slot, datalen);
+    }
+}
+
+void GLESv2Decoder::s_glVertexAttribPointerCachedAEMU(void *self, GLuint indx, GLint size, GLenum type,
+                                                  GLboolean normalized, GLsizei stride, GLuint slot,
+                                                  GLuint datalen)
+{
+    GLESv2Decoder *ctx = (GLESv2Decoder *) self;
+    if (ctx->m_contextData == NULL) {
+        return;
+    }
+    void* data = ctx->m_contextData->cachedPointerData(slot, datalen);
+    if (!data) {
+        GFXSTREAM_ERROR("Client array cache slot %u does not hold %u bytes.", slot, datalen);
+        return;
+    }
+    // note - as with glVertexAttribPointerData, the cached data is packed and has no stride.
+    if ((void*)ctx->glVertexAttribPointerWithDataSize != gles2_unimplemented) {
+        ctx->glVertexAttribPointerWithDataSize(indx, size, type, normalized, 0, data, datalen);
+    } else {
+        ctx->glVertexAttribPointer(indx, size, type, normalized, 0, data);
+    }
+}
 
 void GLESv2Decoder::s_glDrawElementsData(void *self, GLenum mode, GLsizei count, GLenum type, void * data, GLuint datalen)
 {
@@ -60,6 +60,10 @@ private:
                                       GLboolean normalized, GLsizei stride,  void * data, GLuint datalen);
     static void gles2_APIENTRY s_glVertexAttribPointerOffset(void *self, GLuint indx, GLint size, GLenum type,
                                         GLboolean normalized, GLsizei stride,  GLuint offset);
+    static void gles2_APIENTRY s_glVertexAttribPointerDataCachedAEMU(void *self, GLuint indx, GLint size, GLenum type,
+                                      GLboolean normalized, GLsizei stride, GLuint slot, void * data, GLuint datalen);
+    static void gles2_APIENTRY s_glVertexAttribPointerCachedAEMU(void *self, GLuint indx, GLint size, GLenum type,
+                                      GLboolean normalized, GLsizei stride, GLuint slot, GLuint datalen);
 
     static void gles2_APIENTRY s_glDrawElementsOffset(void *self, GLenum mode, GLsizei count, GLenum type, GLuint offset);
     static void gles2_APIENTRY s_glDrawElementsData(void *self, GLenum mode, GLsizei count, GLenum type, void * data, GLuint datalen);
@@ -10676,6 +10676,58 @@ size_t gles2_decoder_context_t::decode(void *buf, size_t len, IOStream *stream,
 			gfxstream::base::endTrace();
 			break;
 		}
+		case OP_glVertexAttribPointerDataCachedAEMU: {
+			gfxstream::base::beginTrace("glVertexAttribPointerDataCachedAEMU decode");
+			GLuint var_indx = Unpack<GLuint,uint32_t>(ptr + 8);
+			GLint var_size = Unpack<GLint,uint32_t>(ptr + 8 + 4);
+			GLenum var_type = Unpack<GLenum,uint32_t>(ptr + 8 + 4 + 4);
+			GLboolean var_normalized = Unpack<GLboolean,uint8_t>(ptr + 8 + 4 + 4 + 4);
+			GLsizei var_stride = Unpack<GLsizei,uint32_t>(ptr + 8 + 4 + 4 + 4 + 1);
+			GLuint var_slot = Unpack<GLuint,uint32_t>(ptr + 8 + 4 + 4 + 4 + 1 + 4);
+			uint32_t size_data __attribute__((unused)) = Unpack<uint32_t,uint32_t>(ptr + 8 + 4 + 4 + 4 + 1 + 4 + 4);
+			InputBuffer inptr_data(ptr + 8 + 4 + 4 + 4 + 1 + 4 + 4 + 4, size_data);
+			GLuint var_datalen = Unpack<GLuint,uint32_t>(ptr + 8 + 4 + 4 + 4 + 1 + 4 + 4 + 4 + size_data);
+			if (useChecksum) {
+				ChecksumCalculatorThreadInfo::validOrDie(checksumCalc, ptr, 8 + 4 + 4 + 4 + 1 + 4 + 4 + 4 + size_data + 4, ptr + 8 + 4 + 4 + 4 + 1 + 4 + 4 + 4 + size_data + 4, checksumSize,
+					"gles2_decoder_context_t::decode, OP_glVertexAttribPointerDataCachedAEMU: GL checksumCalculator failure\n");
+			}
+#ifdef CHECK_GL_ERRORS
+			GLint err = this->glGetError();
+			if (err) {
+				GFXSTREAM_ERROR("gles2 Error (pre-call): 0x%X before glVertexAttribPointerDataCachedAEMU", err);
+			}
+#endif  // ifdef CHECK_GL_ERRORS
+			DECODER_DEBUG_LOG("gles2(%p): glVertexAttribPointerDataCachedAEMU(indx:%u size:%d type:0x%08x normalized:%d stride:%d slot:%u data:%p(%u) datalen:%u )", stream, var_indx, var_size, var_type, var_normalized, var_stride, var_slot, (void*)(inptr_data.get()), size_data, var_datalen);
+			this->glVertexAttribPointerDataCachedAEMU(this, var_indx, var_size, var_type, var_normalized, var_stride, var_slot, (void*)(inptr_data.get()), var_datalen);
+			SET_LASTCALL("glVertexAttribPointerDataCachedAEMU");
+			gfxstream::base::endTrace();
+			break;
+		}
+		case OP_glVertexAttribPointerCachedAEMU: {
+			gfxstream::base::beginTrace("glVertexAttribPointerCachedAEMU decode");
+			GLuint var_indx = Unpack<GLuint,uint32_t>(ptr + 8);
+			GLint var_size = Unpack<GLint,uint32_t>(ptr + 8 + 4);
+			GLenum var_type = Unpack<GLenum,uint32_t>(ptr + 8 + 4 + 4);
+			GLboolean var_normalized = Unpack<GLboolean,uint8_t>(ptr + 8 + 4 + 4 + 4);
+			GLsizei var_stride = Unpack<GLsizei,uint32_t>(ptr + 8 + 4 + 4 + 4 + 1);
+			GLuint var_slot = Unpack<GLuint,uint32_t>(ptr + 8 + 4 + 4 + 4 + 1 + 4);
+			GLuint var_datalen = Unpack<GLuint,uint32_t>(ptr + 8 + 4 + 4 + 4 + 1 + 4 + 4);
+			if (useChecksum) {
+				ChecksumCalculatorThreadInfo::validOrDie(checksumCalc, ptr, 8 + 4 + 4 + 4 + 1 + 4 + 4 + 4, ptr + 8 + 4 + 4 + 4 + 1 + 4 + 4 + 4, checksumSize,
+					"gles2_decoder_context_t::decode, OP_glVertexAttribPointerCachedAEMU: GL checksumCalculator failure\n");
+			}
+#ifdef CHECK_GL_ERRORS
+			GLint err = this->glGetError();
+			if (err) {
+				GFXSTREAM_ERROR("gles2 Error (pre-call): 0x%X before glVertexAttribPointerCachedAEMU", err);
+			}
+#endif  // ifdef CHECK_GL_ERRORS
+			DECODER_DEBUG_LOG("gles2(%p): glVertexAttribPointerCachedAEMU(indx:%u size:%d type:0x%08x normalized:%d stride:%d slot:%u datalen:%u )", stream, var_indx, var_size, var_type, var_normalized, var_stride, var_slot, var_datalen);
+			this->glVertexAttribPointerCachedAEMU(this, var_indx, var_size, var_type, var_normalized, var_stride, var_slot, var_datalen);
+			SET_LASTCALL("glVertexAttribPointerCachedAEMU");
+			gfxstream::base::endTrace();
+			break;
+		}
 		default:
 			return ptr - (unsigned char*)buf;
 		} //switch
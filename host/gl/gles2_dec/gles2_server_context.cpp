@@ -463,6 +463,8 @@ int gles2_server_context_t::initDispatchByName(void *(*getProc)(const char *, vo
 	glBlendFuncSeparateiEXT = (glBlendFuncSeparateiEXT_dec_server_proc_t) getProc("glBlendFuncSeparateiEXT", userData);
 	glColorMaskiEXT = (glColorMaskiEXT_dec_server_proc_t) getProc("glColorMaskiEXT", userData);
 	glIsEnablediEXT = (glIsEnablediEXT_dec_server_proc_t) getProc("glIsEnablediEXT", userData);
+	glVertexAttribPointerDataCachedAEMU = (glVertexAttribPointerDataCachedAEMU_server_proc_t) getProc("glVertexAttribPointerDataCachedAEMU", userData);
+	glVertexAttribPointerCachedAEMU = (glVertexAttribPointerCachedAEMU_server_proc_t) getProc("glVertexAttribPointerCachedAEMU", userData);
 	return 0;
 }
 
@@ -574,6 +574,8 @@ struct gles2_server_context_t {
 	glColorMaskiEXT_server_proc_t glColorMaskiEXT_dec;
 	glIsEnablediEXT_dec_server_proc_t glIsEnablediEXT;
 	glIsEnablediEXT_server_proc_t glIsEnablediEXT_dec;
+	glVertexAttribPointerDataCachedAEMU_server_proc_t glVertexAttribPointerDataCachedAEMU;
+	glVertexAttribPointerCachedAEMU_server_proc_t glVertexAttribPointerCachedAEMU;
 	virtual ~gles2_server_context_t() {}
 	int initDispatchByName( void *(*getProc)(const char *name, void *userData), void *userData);
 };
@@ -576,6 +576,8 @@ typedef void (gles2_APIENTRY *glColorMaskiEXT_server_proc_t) (void *ctx, GLuint,
 typedef void (gles2_APIENTRY *glColorMaskiEXT_dec_server_proc_t) (GLuint, GLboolean, GLboolean, GLboolean, GLboolean);
 typedef GLboolean (gles2_APIENTRY *glIsEnablediEXT_server_proc_t) (void *ctx, GLenum, GLuint);
 typedef GLboolean (gles2_APIENTRY *glIsEnablediEXT_dec_server_proc_t) (GLenum, GLuint);
+typedef void (gles2_APIENTRY *glVertexAttribPointerDataCachedAEMU_server_proc_t) (void *ctx, GLuint, GLint, GLenum, GLboolean, GLsizei, GLuint, void*, GLuint);
+typedef void (gles2_APIENTRY *glVertexAttribPointerCachedAEMU_server_proc_t) (void *ctx, GLuint, GLint, GLenum, GLboolean, GLsizei, GLuint, GLuint);
 
 
 #endif
@@ -720,3 +720,11 @@ bool EglDisplay::programBinaryLinkStatusEnabled() const {
 void EglDisplay::setProgramBinaryLinkStatusEnabled(bool enabled) {
     m_programBinaryLinkStatusEnabled = enabled;
 }
+
+bool EglDisplay::drawCoalescingEnabled() const {
+    return m_drawCoalescingEnabled;
+}
+
+void EglDisplay::setDrawCoalescingEnabled(bool enabled) {
+    m_drawCoalescingEnabled = enabled;
+}
@@ -155,6 +155,9 @@ public:
     bool programBinaryLinkStatusEnabled() const;
     void setProgramBinaryLinkStatusEnabled(bool enabled);
 
+    bool drawCoalescingEnabled() const;
+    void setDrawCoalescingEnabled(bool enabled);
+
 private:
     static void addConfig(void* opaque, const EglOS::ConfigInfo* configInfo);
 
@@ -179,6 +182,7 @@ private:
     ConfigSet               m_uniqueConfigs;
     bool                    m_nativeTextureDecompressionEnabled = false;
     bool                    m_programBinaryLinkStatusEnabled = false;
+    bool                    m_drawCoalescingEnabled = false;
 };
 
 #endif
@@ -128,6 +128,10 @@ EGLAPI EGLBoolean EGLAPIENTRY eglQueryVulkanInteropSupportANDROID(void);
 EGLAPI EGLBoolean EGLAPIENTRY eglGetSyncAttribKHR(EGLDisplay display, EGLSyncKHR sync, EGLint attribute, EGLint *value);
 EGLAPI EGLBoolean EGLAPIENTRY eglSetNativeTextureDecompressionEnabledANDROID(EGLDisplay display, EGLBoolean enabled);
 EGLAPI EGLBoolean EGLAPIENTRY eglSetProgramBinaryLinkStatusEnabledANDROID(EGLDisplay display, EGLBoolean enabled);
+EGLAPI EGLBoolean EGLAPIENTRY eglSetDrawCoalescingEnabledANDROID(EGLDisplay display, EGLBoolean enabled);
+EGLAPI EGLBoolean EGLAPIENTRY eglSetDecodedTextureCacheEnabledANDROID(EGLDisplay display, EGLBoolean enabled);
+EGLAPI EGLBoolean EGLAPIENTRY eglSetEtcComputeDecodeEnabledANDROID(EGLDisplay display, EGLBoolean enabled);
+EGLAPI EGLBoolean EGLAPIENTRY eglSetBcnTranscodeEnabledANDROID(EGLDisplay display, EGLBoolean enabled);
 
 EGLAPI EGLBoolean EGLAPIENTRY eglSaveConfig(EGLDisplay display, EGLConfig config, EGLStreamKHR stream);
 EGLAPI EGLConfig EGLAPIENTRY eglLoadConfig(EGLDisplay display, EGLStreamKHR stream);
@@ -193,6 +197,14 @@ static const ExtensionDescriptor s_eglExtensions[] = {
                 (__eglMustCastToProperFunctionPointerType)eglSetNativeTextureDecompressionEnabledANDROID },
         {"eglSetProgramBinaryLinkStatusEnabledANDROID",
                 (__eglMustCastToProperFunctionPointerType)eglSetProgramBinaryLinkStatusEnabledANDROID },
+        {"eglSetDrawCoalescingEnabledANDROID",
+                (__eglMustCastToProperFunctionPointerType)eglSetDrawCoalescingEnabledANDROID },
+        {"eglSetDecodedTextureCacheEnabledANDROID",
+                (__eglMustCastToProperFunctionPointerType)eglSetDecodedTextureCacheEnabledANDROID },
+        {"eglSetEtcComputeDecodeEnabledANDROID",
+                (__eglMustCastToProperFunctionPointerType)eglSetEtcComputeDecodeEnabledANDROID },
+        {"eglSetBcnTranscodeEnabledANDROID",
+                (__eglMustCastToProperFunctionPointerType)eglSetBcnTranscodeEnabledANDROID },
 };
 
 static const int s_eglExtensionsSize =
@@ -1178,7 +1190,8 @@ EGLAPI EGLBoolean EGLAPIENTRY eglMakeCurrent(EGLDisplay display,
             newCtx->setSurfaces(newReadSrfc,newDrawSrfc);
             g_eglInfo->getIface(newCtx->version())->initContext(newCtx->getGlesContext(), newCtx->getShareGroup(),
                                                                 dpy->nativeTextureDecompressionEnabled(),
-                                                                dpy->programBinaryLinkStatusEnabled());
+                                                                dpy->programBinaryLinkStatusEnabled(),
+                                                                dpy->drawCoalescingEnabled());
             g_eglInfo->sweepDestroySurfaces();
         }
 
@@ -1655,6 +1668,30 @@ EGLAPI EGLBoolean EGLAPIENTRY eglSetProgramBinaryLinkStatusEnabledANDROID(EGLDis
     return EGL_TRUE;
 }
 
+EGLAPI EGLBoolean EGLAPIENTRY eglSetDrawCoalescingEnabledANDROID(EGLDisplay display, EGLBoolean enabled) {
+    VALIDATE_DISPLAY_RETURN(display, EGL_FALSE);
+    dpy->setDrawCoalescingEnabled(enabled == EGL_TRUE);
+    return EGL_TRUE;
+}
+
+EGLAPI EGLBoolean EGLAPIENTRY eglSetDecodedTextureCacheEnabledANDROID(EGLDisplay display, EGLBoolean enabled) {
+    VALIDATE_DISPLAY_RETURN(display, EGL_FALSE);
+    setDecodedTextureCacheEnabled(enabled == EGL_TRUE);
+    return EGL_TRUE;
+}
+
+EGLAPI EGLBoolean EGLAPIENTRY eglSetEtcComputeDecodeEnabledANDROID(EGLDisplay display, EGLBoolean enabled) {
+    VALIDATE_DISPLAY_RETURN(display, EGL_FALSE);
+    setEtcComputeDecodeEnabled(enabled == EGL_TRUE);
+    return EGL_TRUE;
+}
+
+EGLAPI EGLBoolean EGLAPIENTRY eglSetBcnTranscodeEnabledANDROID(EGLDisplay display, EGLBoolean enabled) {
+    VALIDATE_DISPLAY_RETURN(display, EGL_FALSE);
+    setBcnTranscodeEnabled(enabled == EGL_TRUE);
+    return EGL_TRUE;
+}
+
 /*********************************************************************************/
 
 EGLAPI EGLBoolean EGLAPIENTRY eglPreSaveContext(EGLDisplay display, EGLContext contex, EGLStreamKHR stream) {
@@ -61,7 +61,7 @@ extern "C" {
 
 //decleration
 static void initGLESx(bool isGles2Gles);
-static void initContext(GLEScontext* ctx, ShareGroupPtr grp, bool nativeTextureDecompressionEnabled, bool programBinaryLinkStatusEnabled);
+static void initContext(GLEScontext* ctx, ShareGroupPtr grp, bool nativeTextureDecompressionEnabled, bool programBinaryLinkStatusEnabled, bool drawCoalescingEnabled);
 static void setMaxGlesVersion(GLESVersion version);
 static void deleteGLESContext(GLEScontext* ctx);
 static void setShareGroup(GLEScontext* ctx,ShareGroupPtr grp);
@@ -200,7 +200,7 @@ static void initGLESx(bool isGles2Gles) {
     return;
 }
 
-static void initContext(GLEScontext* ctx, ShareGroupPtr grp, bool nativeTextureDecompressionEnabled, bool programBinaryLinkStatusEnabled) {
+static void initContext(GLEScontext* ctx, ShareGroupPtr grp, bool nativeTextureDecompressionEnabled, bool programBinaryLinkStatusEnabled, bool drawCoalescingEnabled) {
     setCoreProfile(ctx->isCoreProfile());
     GLEScmContext::initGlobal(s_eglIface);
 
@@ -20,12 +20,15 @@
 #include "SamplerData.h"
 #include "ShaderParser.h"
 #include "TransformFeedbackData.h"
+#include "gfxstream/Tracing.h"
 #include "gfxstream/synchronization/Lock.h"
 #include "gfxstream/host/stream_utils.h"
 #include "gfxstream/common/logging.h"
 
 #include <string.h>
 
+#include <atomic>
+
 static const char kGLES20StringPart[] = "OpenGL ES 2.0";
 static const char kGLES30StringPart[] = "OpenGL ES 3.0";
 static const char kGLES31StringPart[] = "OpenGL ES 3.1";
@@ -33,6 +36,9 @@ static const char kGLES32StringPart[] = "OpenGL ES 3.2";
 
 static GLESVersion s_maxGlesVersion = GLES_2_0;
 
+static std::atomic<uint64_t> s_coalescedDrawCount{0};
+static std::atomic<uint64_t> s_multiDrawCount{0};
+
 static const char* sPickVersionStringPart(int maj, int min) {
     switch (maj) {
         case 2:
@@ -501,6 +507,89 @@ void GLESv2Context::validateAtt0PostDraw(void)
     }
 }
 
+// static
+GLESv2Context::DrawCoalescingStats GLESv2Context::getDrawCoalescingStats() {
+    DrawCoalescingStats stats;
+    stats.coalescedDraws = s_coalescedDrawCount;
+    stats.multiDraws = s_multiDrawCount;
+    return stats;
+}
+
+bool GLESv2Context::canCoalesceDraw(DrawCallCmd cmd, GLenum mode) const {
+    if (!m_drawCoalescingEnabled) {
+        return false;
+    }
+    // Points toggle host state around each draw, see s_glDrawPre().
+    if (mode == GL_POINTS) {
+        return false;
+    }
+    switch (cmd) {
+        case DrawCallCmd::Arrays:
+            return dispatcher().glMultiDrawArrays != nullptr;
+        case DrawCallCmd::Elements:
+            return dispatcher().glMultiDrawElements != nullptr;
+        default:
+            return false;
+    }
+}
+
+bool GLESv2Context::canJoinPendingDraws(DrawCallCmd cmd, GLenum mode, GLenum type) const {
+    return m_hasPendingDraws && m_pendingDrawCmd == cmd && m_pendingDrawMode == mode &&
+           m_pendingDrawType == type && m_pendingDrawCounts.size() < kMaxPendingDraws;
+}
+
+void GLESv2Context::addPendingDraw(DrawCallCmd cmd, GLenum mode, GLint first, GLsizei count,
+                                   GLenum type, const GLvoid* indices) {
+    if (!canJoinPendingDraws(cmd, mode, type)) {
+        flushPendingDraws();
+        m_pendingDrawCmd = cmd;
+        m_pendingDrawMode = mode;
+        m_pendingDrawType = type;
+        m_hasPendingDraws = true;
+    }
+    m_pendingDrawCounts.push_back(count);
+    if (cmd == DrawCallCmd::Arrays) {
+        m_pendingDrawFirsts.push_back(first);
+    } else {
+        m_pendingDrawIndices.push_back(indices);
+    }
+}
+
+void GLESv2Context::onFlushPendingDraws() {
+    m_hasPendingDraws = false;
+
+    const GLsizei drawCount = static_cast<GLsizei>(m_pendingDrawCounts.size());
+    if (m_pendingDrawCmd == DrawCallCmd::Arrays) {
+        if (drawCount == 1) {
+            dispatcher().glDrawArrays(m_pendingDrawMode, m_pendingDrawFirsts[0],
+                                      m_pendingDrawCounts[0]);
+        } else {
+            dispatcher().glMultiDrawArrays(m_pendingDrawMode, m_pendingDrawFirsts.data(),
+                                           m_pendingDrawCounts.data(), drawCount);
+        }
+    } else {
+        if (drawCount == 1) {
+            dispatcher().glDrawElements(m_pendingDrawMode, m_pendingDrawCounts[0],
+                                        m_pendingDrawType, m_pendingDrawIndices[0]);
+        } else {
+            dispatcher().glMultiDrawElements(m_pendingDrawMode, m_pendingDrawCounts.data(),
+                                             m_pendingDrawType, m_pendingDrawIndices.data(),
+                                             drawCount);
+        }
+    }
+    if (drawCount > 1) {
+        const uint64_t coalescedDraws = s_coalescedDrawCount += drawCount;
+        const uint64_t multiDraws = ++s_multiDrawCount;
+        gfxstream::base::traceCounter("gfxstreamCoalescedDraws",
+                                      static_cast<int64_t>(coalescedDraws));
+        gfxstream::base::traceCounter("gfxstreamMultiDraws", static_cast<int64_t>(multiDraws));
+    }
+
+    m_pendingDrawFirsts.clear();
+    m_pendingDrawCounts.clear();
+    m_pendingDrawIndices.clear();
+}
+
 void GLESv2Context::drawWithEmulations(
     DrawCallCmd cmd,
     GLenum mode,
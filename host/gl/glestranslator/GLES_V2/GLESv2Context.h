@@ -22,6 +22,7 @@
 #include <GLcommon/ShareGroup.h>
 
 #include <memory>
+#include <vector>
 
 // Extra desktop-specific OpenGL enums that we need to properly emulate OpenGL ES.
 #define GL_FRAMEBUFFER_SRGB 0x8DB9
@@ -66,6 +67,26 @@ public:
         GLuint start,
         GLuint end);
 
+    // Draw coalescing. While consecutive fast path draws only differ in their
+    // ranges, they are recorded instead of issued, and issued together with
+    // one glMultiDraw*() call before anything else runs on the context.
+    void setDrawCoalescingEnabled(bool enabled) { m_drawCoalescingEnabled = enabled; }
+    // Whether a fast path draw with |cmd| and |mode| may be recorded at all.
+    bool canCoalesceDraw(DrawCallCmd cmd, GLenum mode) const;
+    // Whether a draw can join the pending ones. A draw that cannot, has to set
+    // up the draw state after flushPendingDraws() before it is recorded.
+    bool canJoinPendingDraws(DrawCallCmd cmd, GLenum mode, GLenum type) const;
+    void addPendingDraw(DrawCallCmd cmd, GLenum mode, GLint first, GLsizei count,
+                        GLenum type, const GLvoid* indices);
+    // Totals of all the contexts of the process, which are also traced as the
+    // gfxstreamCoalescedDraws and gfxstreamMultiDraws counters.
+    struct DrawCoalescingStats {
+        // The number of draws that were merged into glMultiDraw*() calls.
+        uint64_t coalescedDraws = 0;
+        uint64_t multiDraws = 0;
+    };
+    static DrawCoalescingStats getDrawCoalescingStats();
+
     void setupArraysPointers(GLESConversionArrays& fArrs,GLint first,GLsizei count,GLenum type,const GLvoid* indices,bool direct, bool* needEnablingPostDraw);
     void setVertexAttribDivisor(GLuint bindingindex, GLuint divisor);
     void setVertexAttribBindingIndex(GLuint attribindex, GLuint bindingindex);
@@ -131,6 +152,7 @@ protected:
     void addVertexArrayObject(GLuint array) override;
 
     virtual void postLoadRestoreCtx();
+    void onFlushPendingDraws() override;
     bool needConvert(GLESConversionArrays& fArrs,GLint first,GLsizei count,GLenum type,const GLvoid* indices,bool direct,GLESpointer* p,GLenum array_id);
 private:
     void setupArrWithDataSize(GLsizei datasize, const GLvoid* arr,
@@ -150,6 +172,17 @@ private:
     std::vector<GLuint> m_emulatedClientVBOs;
     GLuint m_emulatedClientIBO = 0;
 
+    // Bounds the memory of the pending draws and how long they are held back.
+    static constexpr size_t kMaxPendingDraws = 1024;
+
+    bool m_drawCoalescingEnabled = false;
+    DrawCallCmd m_pendingDrawCmd = DrawCallCmd::Arrays;
+    GLenum m_pendingDrawMode = 0;
+    GLenum m_pendingDrawType = 0;
+    std::vector<GLint> m_pendingDrawFirsts;
+    std::vector<GLsizei> m_pendingDrawCounts;
+    std::vector<const GLvoid*> m_pendingDrawIndices;
+
     NameSpace* m_transformFeedbackNameSpace = nullptr;
     ObjectLocalName m_bindTransformFeedback = 0;
     bool m_transformFeedbackDeletePending = false;
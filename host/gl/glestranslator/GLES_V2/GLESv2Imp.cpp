@@ -69,7 +69,7 @@ extern "C" {
 
 //decleration
 static void initGLESx(bool isGles2Gles);
-static void initContext(GLEScontext* ctx, ShareGroupPtr grp, bool nativeTextureDecompressionEnabled, bool programBinaryLinkStatusEnabled);
+static void initContext(GLEScontext* ctx, ShareGroupPtr grp, bool nativeTextureDecompressionEnabled, bool programBinaryLinkStatusEnabled, bool drawCoalescingEnabled);
 static void setMaxGlesVersion(GLESVersion version);
 static void deleteGLESContext(GLEScontext* ctx);
 static void setShareGroup(GLEScontext* ctx,ShareGroupPtr grp);
@@ -145,6 +145,7 @@ GL_API void GL_APIENTRY glBindTexture (GLenum target, GLuint texture);
 GL_APICALL void  GL_APIENTRY glVertexAttribPointerWithDataSize(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* ptr, GLsizei dataSize);
 GL_APICALL void  GL_APIENTRY glVertexAttribIPointerWithDataSize(GLuint index, GLint size, GLenum type, GLsizei stride, const GLvoid* ptr, GLsizei dataSize);
 GL_APICALL void  GL_APIENTRY glTestHostDriverPerformance(GLuint count, uint64_t* duration_us, uint64_t* duration_cpu_us);
+GL_APICALL void  GL_APIENTRY glFlushPendingDrawsHOST();
 GL_APICALL void  GL_APIENTRY glDrawArraysNullAEMU(GLenum mode, GLint first, GLsizei count);
 GL_APICALL void  GL_APIENTRY glDrawElementsNullAEMU(GLenum mode, GLsizei count, GLenum type, const void* indices);
 
@@ -235,7 +236,7 @@ static void setMaxGlesVersion(GLESVersion version) {
     GLESv2Context::setMaxGlesVersion(version);
 }
 
-static void initContext(GLEScontext* ctx, ShareGroupPtr grp, bool nativeTextureDecompressionEnabled, bool programBinaryLinkStatusEnabled) {
+static void initContext(GLEScontext* ctx, ShareGroupPtr grp, bool nativeTextureDecompressionEnabled, bool programBinaryLinkStatusEnabled, bool drawCoalescingEnabled) {
     setCoreProfile(ctx->isCoreProfile());
     GLESv2Context::initGlobal(s_eglIface);
 
@@ -247,6 +248,7 @@ static void initContext(GLEScontext* ctx, ShareGroupPtr grp, bool nativeTextureD
         translator::gles2::glBindTexture(GL_TEXTURE_2D,0);
         translator::gles2::glBindTexture(GL_TEXTURE_CUBE_MAP,0);
     }
+    static_cast<GLESv2Context*>(ctx)->setDrawCoalescingEnabled(drawCoalescingEnabled);
     if (ctx->needRestore()) {
         ctx->restore();
     }
@@ -298,6 +300,7 @@ static __translatorMustCastToProperFunctionPointerType getProcAddressGles2(const
         (*s_gles2Extensions)["glVertexAttribPointerWithDataSize"] = (__translatorMustCastToProperFunctionPointerType)GLES2_NAMESPACED(glVertexAttribPointerWithDataSize);
         (*s_gles2Extensions)["glVertexAttribIPointerWithDataSize"] = (__translatorMustCastToProperFunctionPointerType)GLES2_NAMESPACED(glVertexAttribIPointerWithDataSize);
         (*s_gles2Extensions)["glTestHostDriverPerformance"] = (__translatorMustCastToProperFunctionPointerType)GLES2_NAMESPACED(glTestHostDriverPerformance);
+        (*s_gles2Extensions)["glFlushPendingDrawsHOST"] = (__translatorMustCastToProperFunctionPointerType)GLES2_NAMESPACED(glFlushPendingDrawsHOST);
         (*s_gles2Extensions)["glDrawArraysNullAEMU"] = (__translatorMustCastToProperFunctionPointerType)GLES2_NAMESPACED(glDrawArraysNullAEMU);
         (*s_gles2Extensions)["glDrawElementsNullAEMU"] = (__translatorMustCastToProperFunctionPointerType)GLES2_NAMESPACED(glDrawElementsNullAEMU);
         (*s_gles2Extensions)["glGetUnsignedBytevEXT"] = (__translatorMustCastToProperFunctionPointerType)GLES2_NAMESPACED(glGetUnsignedBytevEXT);
@@ -915,6 +918,9 @@ GL_APICALL void  GL_APIENTRY glCompileShader(GLuint shader){
 }
 
 GL_APICALL void  GL_APIENTRY glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* pixels);
+void s_glInitTexImage2D(GLenum target, GLint level, GLint internalformat,
+        GLsizei width, GLsizei height, GLint border, GLint samples, GLenum* format,
+        GLenum* type, GLint* internalformat_out);
 
 GL_APICALL void  GL_APIENTRY glCompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const GLvoid* data)
 {
@@ -924,9 +930,20 @@ GL_APICALL void  GL_APIENTRY glCompressedTexImage2D(GLenum target, GLint level,
 
     auto funcPtr = translator::gles2::glTexImage2D;
 
-    if (shouldPassthroughCompressedFormat(ctx, internalformat)) {
+    const bool passthrough = shouldPassthroughCompressedFormat(ctx, internalformat);
+    const GLenum transcodedFormat =
+        passthrough ? 0 : getBcnTranscodeFormat(ctx, internalformat);
+    if (passthrough) {
         doCompressedTexImage2DNative(ctx, target, level, internalformat,
                                           width, height, border, imageSize, data);
+    } else if (transcodedFormat) {
+        GLenum format = 0;
+        GLenum type = 0;
+        getBcnTranscodeReadbackFormat(transcodedFormat, &format, &type);
+        s_glInitTexImage2D(target, level, internalformat, width, height, border, 0, &format,
+                           &type, nullptr);
+        doCompressedTexImage2DTranscoded(ctx, target, level, internalformat, transcodedFormat,
+                                         width, height, border, imageSize, data);
     } else {
         doCompressedTexImage2D(ctx, target, level, internalformat,
                                     width, height, border,
@@ -937,8 +954,10 @@ GL_APICALL void  GL_APIENTRY glCompressedTexImage2D(GLenum target, GLint level,
     if (texData) {
         texData->compressed = true;
         texData->compressedFormat = internalformat;
-        if (shouldPassthroughCompressedFormat(ctx, internalformat)) {
+        if (passthrough) {
             texData->internalFormat = internalformat;
+        } else if (transcodedFormat) {
+            texData->internalFormat = transcodedFormat;
         }
     }
 }
@@ -972,6 +991,10 @@ GL_APICALL void  GL_APIENTRY glCompressedTexSubImage2D(GLenum target, GLint leve
         if (shouldPassthroughCompressedFormat(ctx, format)) {
             doCompressedTexSubImage2DNative(ctx, target, level, xoffset, yoffset,
                                                  width, height, format, imageSize, data);
+        } else if (texData && isBcnTranscodedTexture(format, texData->internalFormat)) {
+            doCompressedTexSubImage2DTranscoded(ctx, target, level, xoffset, yoffset, width,
+                                                height, format, texData->internalFormat,
+                                                imageSize, data);
         } else {
             doCompressedTexImage2D(ctx, target, level, format,
                     width, height, 0, imageSize, data,
@@ -1586,16 +1609,39 @@ static void s_glDrawPost(GLESv2Context* ctx, GLenum mode) {
     }
 }
 
+// Records a fast path draw to be issued together with the following ones.
+// Returns false after issuing the pending draws if the draw has to be issued
+// right away instead.
+static bool s_glCoalesceDraw(GLESv2Context* ctx, GLESv2Context::DrawCallCmd cmd, GLenum mode,
+                             GLint first, GLsizei count, GLenum type, const GLvoid* indices) {
+    if (!ctx->canCoalesceDraw(cmd, mode)) {
+        ctx->flushPendingDraws();
+        return false;
+    }
+    if (!ctx->canJoinPendingDraws(cmd, mode, type)) {
+        // The draw state is the same for all the draws that join this one.
+        ctx->flushPendingDraws();
+        s_glDrawPre(ctx, mode, type);
+    }
+    ctx->addPendingDraw(cmd, mode, first, count, type, indices);
+    return true;
+}
+
 GL_APICALL void  GL_APIENTRY glDrawArrays(GLenum mode, GLint first, GLsizei count){
-    GET_CTX_V2();
+    GET_CTX_V2_KEEP_PENDING_DRAWS();
     SET_ERROR_IF(count < 0,GL_INVALID_VALUE)
     SET_ERROR_IF(!GLESv2Validate::drawMode(mode),GL_INVALID_ENUM);
 
     if (ctx->vertexAttributesBufferBacked()) {
+        if (s_glCoalesceDraw(ctx, GLESv2Context::DrawCallCmd::Arrays, mode, first, count,
+                             0 /* type */, nullptr /* indices */)) {
+            return;
+        }
         s_glDrawPre(ctx, mode);
         ctx->dispatcher().glDrawArrays(mode,first,count);
         s_glDrawPost(ctx, mode);
     } else {
+        ctx->flushPendingDraws();
         ctx->drawWithEmulations(
                 GLESv2Context::DrawCallCmd::Arrays,
                 mode, first, count,
@@ -1622,16 +1668,21 @@ GL_APICALL void  GL_APIENTRY glDrawArraysNullAEMU(GLenum mode, GLint first, GLsi
 }
 
 GL_APICALL void  GL_APIENTRY glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices) {
-    GET_CTX_V2();
+    GET_CTX_V2_KEEP_PENDING_DRAWS();
     SET_ERROR_IF(count < 0,GL_INVALID_VALUE)
     SET_ERROR_IF(!(GLESv2Validate::drawMode(mode) && GLESv2Validate::drawType(type)),GL_INVALID_ENUM);
 
     if (ctx->isBindedBuffer(GL_ELEMENT_ARRAY_BUFFER) &&
         ctx->vertexAttributesBufferBacked()) {
+        if (s_glCoalesceDraw(ctx, GLESv2Context::DrawCallCmd::Elements, mode, 0 /* first */,
+                             count, type, indices)) {
+            return;
+        }
         s_glDrawPre(ctx, mode, type);
         ctx->dispatcher().glDrawElements(mode, count, type, indices);
         s_glDrawPost(ctx, mode);
     } else {
+        ctx->flushPendingDraws();
         ctx->drawWithEmulations(
                 GLESv2Context::DrawCallCmd::Elements,
                 mode, 0 /* first (unused) */, count, type, indices,
@@ -4484,6 +4535,13 @@ static GLint compileAndLinkShaderProgram(GLDispatch* gl,
 
 } // namespace glperf
 
+// Called by the render thread once it has decoded the GL commands that it has,
+// so that no draws stay pending while it waits for more.
+GL_APICALL void GL_APIENTRY glFlushPendingDrawsHOST() {
+    // GET_CTX_V2() issues the pending draws.
+    GET_CTX_V2();
+}
+
 GL_APICALL void GL_APIENTRY
 glTestHostDriverPerformance(GLuint count,
                             uint64_t* duration_us,
@@ -1121,7 +1121,21 @@ GL_APICALL void GL_APIENTRY glTexSubImage3D(GLenum target, GLint level, GLint xo
 
 GL_APICALL void GL_APIENTRY glCompressedTexImage3D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLsizei imageSize, const GLvoid * data) {
     GET_CTX_V2();
-    ctx->dispatcher().glCompressedTexImage3D(target, level, internalformat, width, height, depth, border, imageSize, data);
+    const GLenum transcodedFormat =
+        target == GL_TEXTURE_2D_ARRAY && !shouldPassthroughCompressedFormat(ctx, internalformat)
+            ? getBcnTranscodeFormat(ctx, internalformat)
+            : 0;
+    if (transcodedFormat) {
+        GLenum format = 0;
+        GLenum type = 0;
+        getBcnTranscodeReadbackFormat(transcodedFormat, &format, &type);
+        s_glInitTexImage3D(target, level, internalformat, width, height, depth, border, format,
+                           type);
+        doCompressedTexImage3DTranscoded(ctx, target, level, internalformat, transcodedFormat,
+                                         width, height, depth, border, imageSize, data);
+    } else {
+        ctx->dispatcher().glCompressedTexImage3D(target, level, internalformat, width, height, depth, border, imageSize, data);
+    }
     if (ctx->shareGroup().get()) {
         TextureData *texData = getTextureTargetData(target);
 
@@ -1129,6 +1143,9 @@ GL_APICALL void GL_APIENTRY glCompressedTexImage3D(GLenum target, GLint level, G
             texData->hasStorage = true;
             texData->compressed = true;
             texData->compressedFormat = internalformat;
+            if (transcodedFormat) {
+                texData->internalFormat = transcodedFormat;
+            }
             texData->makeDirty();
         }
     }
@@ -1140,6 +1157,12 @@ GL_APICALL void GL_APIENTRY glCompressedTexSubImage3D(GLenum target, GLint level
     if (texData) {
         texData->makeDirty();
     }
+    if (texData && isBcnTranscodedTexture(format, texData->internalFormat)) {
+        doCompressedTexSubImage3DTranscoded(ctx, target, level, xoffset, yoffset, zoffset, width,
+                                            height, depth, format, texData->internalFormat,
+                                            imageSize, data);
+        return;
+    }
     ctx->dispatcher().glCompressedTexSubImage3D(target, level, xoffset, yoffset, zoffset, width, height, depth, format, imageSize, data);
 }
 
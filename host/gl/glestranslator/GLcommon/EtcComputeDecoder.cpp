@@ -0,0 +1,541 @@
+// Copyright 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "GLcommon/EtcComputeDecoder.h"
+
+#include <GLES3/gl31.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "GLcommon/GLEScontext.h"
+#include "gfxstream/common/logging.h"
+
+namespace {
+
+constexpr GLuint kBlocksPerWorkgroup = 8;
+
+std::atomic<bool> sEnabled{false};
+
+// GLSL port of etc2_decode_image() (see common/etc/etc.cpp and the Vulkan equivalent in
+// host/vulkan/emulated_textures/shaders/Etc2ShaderLib.comp). It is written in the common subset
+// of GLSL 4.30 and GLSL ES 3.10 so that it runs on both desktop and GLES hosts.
+//
+// Each invocation decodes one 4x4 block. The compressed blocks live at the start of `words` and
+// the decoded image starts at word `u_dstOffset`. Since a row of blocks always starts on a word
+// boundary (4 texels of 3, 4 or 8 bytes), invocations never write to the same word.
+constexpr char kEtcDecodeShaderSrc[] = R"(
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+layout(std430, binding = 0) buffer Data {
+    uint words[];
+};
+
+uniform int u_format;
+uniform uvec2 u_extent;
+uniform uint u_rowPitch;
+uniform uint u_dstOffset;
+
+const int kLookup[8] = int[8](0, 1, 2, 3, -4, -3, -2, -1);
+
+const ivec4 kRGBModifierTable[8] = ivec4[8](
+    ivec4(2, 8, -2, -8), ivec4(5, 17, -5, -17), ivec4(9, 29, -9, -29),
+    ivec4(13, 42, -13, -42), ivec4(18, 60, -18, -60), ivec4(24, 80, -24, -80),
+    ivec4(33, 106, -33, -106), ivec4(47, 183, -47, -183));
+
+const int kTHModifierTable[8] = int[8](3, 6, 11, 16, 23, 32, 41, 64);
+
+const ivec4 kAlphaModifierTable[32] = ivec4[32](
+    ivec4(-3, -6, -9, -15), ivec4(2, 5, 8, 14),
+    ivec4(-3, -7, -10, -13), ivec4(2, 6, 9, 12),
+    ivec4(-2, -5, -8, -13), ivec4(1, 4, 7, 12),
+    ivec4(-2, -4, -6, -13), ivec4(1, 3, 5, 12),
+    ivec4(-3, -6, -8, -12), ivec4(2, 5, 7, 11),
+    ivec4(-3, -7, -9, -11), ivec4(2, 6, 8, 10),
+    ivec4(-4, -7, -8, -11), ivec4(3, 6, 7, 10),
+    ivec4(-3, -5, -8, -11), ivec4(2, 4, 7, 10),
+    ivec4(-2, -6, -8, -10), ivec4(1, 5, 7, 9),
+    ivec4(-2, -5, -8, -10), ivec4(1, 4, 7, 9),
+    ivec4(-2, -4, -8, -10), ivec4(1, 3, 7, 9),
+    ivec4(-2, -5, -7, -10), ivec4(1, 4, 6, 9),
+    ivec4(-3, -4, -7, -10), ivec4(2, 3, 6, 9),
+    ivec4(-1, -2, -3, -10), ivec4(0, 1, 2, 9),
+    ivec4(-4, -6, -8, -9), ivec4(3, 5, 7, 8),
+    ivec4(-3, -5, -7, -9), ivec4(2, 4, 6, 8));
+
+// Decoded block, indexed by x + 4 * y.
+ivec4 g_texels[16];
+int g_channel[16];
+float g_red[16];
+float g_green[16];
+
+uint flip32(uint a) {
+    return (a << 24) | ((a & 0xff00u) << 8) | ((a >> 8) & 0xff00u) | (a >> 24);
+}
+
+int convert4To8(uint b) {
+    int c = int(b & 0xfu);
+    return (c << 4) | c;
+}
+
+int convert5To8(uint b) {
+    int c = int(b & 0x1fu);
+    return (c << 3) | (c >> 2);
+}
+
+int convert6To8(uint b) {
+    int c = int(b & 0x3fu);
+    return (c << 2) | (c >> 4);
+}
+
+int convert7To8(uint b) {
+    int c = int(b & 0x7fu);
+    return (c << 1) | (c >> 6);
+}
+
+bool isOverflowed(uint base, uint diff) {
+    int val = int(base & 0x1fu) + kLookup[diff & 0x7u];
+    return val < 0 || val >= 32;
+}
+
+int convertDiff(uint base, uint diff) {
+    return convert5To8(uint(int(base & 0x1fu) + kLookup[diff & 0x7u]));
+}
+
+bool isTransparent(uint msb, uint lsb, bool isPunchthroughAlpha, bool opaque) {
+    return isPunchthroughAlpha && !opaque && msb != 0u && lsb == 0u;
+}
+
+void decodeTHIndices(ivec3 c0, ivec3 c1, ivec3 c2, ivec3 c3, uint low,
+                     bool isPunchthroughAlpha, bool opaque) {
+    ivec3 table[4] = ivec3[4](c0, c1, c2, c3);
+    for (uint y = 0u; y < 4u; y++) {
+        for (uint x = 0u; x < 4u; x++) {
+            uint k = y + x * 4u;
+            uint msb = (low >> (k + 15u)) & 2u;
+            uint lsb = (low >> k) & 1u;
+            if (isTransparent(msb, lsb, isPunchthroughAlpha, opaque)) {
+                g_texels[y * 4u + x] = ivec4(0);
+            } else {
+                g_texels[y * 4u + x] = ivec4(table[msb | lsb], 255);
+            }
+        }
+    }
+}
+
+void decodeBlockT(uint high, uint low, bool isPunchthroughAlpha, bool opaque) {
+    ivec3 c1 = ivec3(convert4To8((((high >> 27) & 3u) << 2) | ((high >> 24) & 3u)),
+                     convert4To8(high >> 20), convert4To8(high >> 16));
+    ivec3 c2 = ivec3(convert4To8(high >> 12), convert4To8(high >> 8), convert4To8(high >> 4));
+    int intenseMod = kTHModifierTable[(((high >> 2) & 3u) << 1) | (high & 1u)];
+    decodeTHIndices(c1, clamp(c2 + intenseMod, 0, 255), c2, clamp(c2 - intenseMod, 0, 255), low,
+                    isPunchthroughAlpha, opaque);
+}
+
+void decodeBlockH(uint high, uint low, bool isPunchthroughAlpha, bool opaque) {
+    ivec3 c1 = ivec3(convert4To8(high >> 27),
+                     convert4To8(((high >> 24) << 1) | ((high >> 20) & 1u)),
+                     convert4To8(((high >> 19) << 3) | ((high >> 15) & 7u)));
+    ivec3 c2 = ivec3(convert4To8(high >> 11), convert4To8(high >> 7), convert4To8(high >> 3));
+    uint intenseIdx = (high & 4u) | ((high & 1u) << 1);
+    if (((c1.r << 16) | (c1.g << 8) | c1.b) >= ((c2.r << 16) | (c2.g << 8) | c2.b)) {
+        intenseIdx |= 1u;
+    }
+    int intenseMod = kTHModifierTable[intenseIdx];
+    decodeTHIndices(clamp(c1 + intenseMod, 0, 255), clamp(c1 - intenseMod, 0, 255),
+                    clamp(c2 + intenseMod, 0, 255), clamp(c2 - intenseMod, 0, 255), low,
+                    isPunchthroughAlpha, opaque);
+}
+
+void decodeBlockP(uint high, uint low) {
+    ivec3 o = ivec3(convert6To8(high >> 25),
+                    convert7To8(((high >> 24) << 6) | ((high >> 17) & 63u)),
+                    convert6To8(((high >> 16) << 5) | (((high >> 11) & 3u) << 3) |
+                                ((high >> 7) & 7u)));
+    ivec3 h = ivec3(convert6To8(((high >> 2) << 1) | (high & 1u)), convert7To8(low >> 25),
+                    convert6To8(low >> 19));
+    ivec3 v = ivec3(convert6To8(low >> 13), convert7To8(low >> 6), convert6To8(low));
+    for (int i = 0; i < 16; i++) {
+        int x = i & 3;
+        int y = i >> 2;
+        g_texels[i] = ivec4(clamp((x * (h - o) + y * (v - o) + 4 * o + 2) >> 2, 0, 255), 255);
+    }
+}
+
+void decodeSubblock(ivec3 base, ivec4 table, uint low, bool second, bool flipped,
+                    bool isPunchthroughAlpha, bool opaque) {
+    uint baseX = (second && !flipped) ? 2u : 0u;
+    uint baseY = (second && flipped) ? 2u : 0u;
+    for (uint i = 0u; i < 8u; i++) {
+        uint x = baseX + (flipped ? (i >> 1) : (i >> 2));
+        uint y = baseY + (flipped ? (i & 1u) : (i & 3u));
+        uint k = y + x * 4u;
+        uint msb = (low >> (k + 15u)) & 2u;
+        uint lsb = (low >> k) & 1u;
+        if (isTransparent(msb, lsb, isPunchthroughAlpha, opaque)) {
+            g_texels[x + 4u * y] = ivec4(0);
+        } else {
+            g_texels[x + 4u * y] = ivec4(clamp(base + table[msb | lsb], 0, 255), 255);
+        }
+    }
+}
+
+void decodeRgbBlock(uint high, uint low, bool isPunchthroughAlpha) {
+    bool opaque = (high & 2u) != 0u;
+    ivec3 c1;
+    ivec3 c2;
+    if (isPunchthroughAlpha || opaque) {
+        // Differential mode, or one of the T, H and P modes when the base overflows.
+        uint rBase = high >> 27;
+        uint gBase = high >> 19;
+        uint bBase = high >> 11;
+        if (isOverflowed(rBase, high >> 24)) {
+            decodeBlockT(high, low, isPunchthroughAlpha, opaque);
+            return;
+        }
+        if (isOverflowed(gBase, high >> 16)) {
+            decodeBlockH(high, low, isPunchthroughAlpha, opaque);
+            return;
+        }
+        if (isOverflowed(bBase, high >> 8)) {
+            decodeBlockP(high, low);
+            return;
+        }
+        c1 = ivec3(convert5To8(rBase), convert5To8(gBase), convert5To8(bBase));
+        c2 = ivec3(convertDiff(rBase, high >> 24), convertDiff(gBase, high >> 16),
+                   convertDiff(bBase, high >> 8));
+    } else {
+        c1 = ivec3(convert4To8(high >> 28), convert4To8(high >> 20), convert4To8(high >> 12));
+        c2 = ivec3(convert4To8(high >> 24), convert4To8(high >> 16), convert4To8(high >> 8));
+    }
+    ivec4 tableA = kRGBModifierTable[(high >> 5) & 7u];
+    ivec4 tableB = kRGBModifierTable[(high >> 2) & 7u];
+    if (isPunchthroughAlpha && !opaque) {
+        tableA *= ivec4(0, 1, 0, 1);
+        tableB *= ivec4(0, 1, 0, 1);
+    }
+    bool flipped = (high & 1u) != 0u;
+    decodeSubblock(c1, tableA, low, false, flipped, isPunchthroughAlpha, opaque);
+    decodeSubblock(c2, tableB, low, true, flipped, isPunchthroughAlpha, opaque);
+}
+
+// Decodes an EAC block into g_channel. 11 bit channels are left scaled by 8 (and biased by 4
+// when unsigned) as in etc.cpp, ready to be normalized.
+void decodeEacBlock(uint high, uint low, bool isSigned, bool is11Bit) {
+    int baseCodeword = int(high >> 24);
+    if (isSigned) {
+        if (baseCodeword >= 128) {
+            baseCodeword -= 256;
+        }
+        if (baseCodeword == -128) {
+            baseCodeword = -127;
+        }
+    }
+    int multiplier = int((high >> 20) & 15u);
+    uint tableIndex = (high >> 16) & 15u;
+    ivec4 table0 = kAlphaModifierTable[tableIndex * 2u];
+    ivec4 table1 = kAlphaModifierTable[tableIndex * 2u + 1u];
+    uint p[16] = uint[16](high >> 13, high >> 10, high >> 7, high >> 4, high >> 1,
+                          (high << 2) | (low >> 30), low >> 27, low >> 24, low >> 21,
+                          low >> 18, low >> 15, low >> 12, low >> 9, low >> 6, low >> 3, low);
+    for (uint i = 0u; i < 16u; i++) {
+        uint modifier = p[i] & 7u;
+        int modifierValue = modifier >= 4u ? table1[modifier - 4u] : table0[modifier];
+        int decoded = baseCodeword + modifierValue * multiplier;
+        if (!is11Bit) {
+            decoded = clamp(decoded, 0, 255);
+        } else {
+            decoded *= 8;
+            if (multiplier == 0) {
+                decoded += modifierValue;
+            }
+            decoded = isSigned ? clamp(decoded, -1023, 1023) : clamp(decoded + 4, 0, 2047);
+        }
+        // Indices are stored column major.
+        g_channel[(i % 4u) * 4u + i / 4u] = decoded;
+    }
+}
+
+void decodeEacFloatBlock(uint high, uint low, bool isSigned, bool isGreen) {
+    decodeEacBlock(high, low, isSigned, true);
+    for (int i = 0; i < 16; i++) {
+        float value = isSigned ? float(g_channel[i]) / 1023.0 : float(g_channel[i]) / 2047.0;
+        if (isGreen) {
+            g_green[i] = value;
+        } else {
+            g_red[i] = value;
+        }
+    }
+}
+
+void main() {
+    uvec2 block = gl_GlobalInvocationID.xy;
+    uvec2 blockCount = (u_extent + 3u) / 4u;
+    if (block.x >= blockCount.x || block.y >= blockCount.y) {
+        return;
+    }
+
+    bool isWide = u_format == kEtcRGBA8 || u_format == kEtcRG11 || u_format == kEtcSignedRG11;
+    bool isSigned = u_format == kEtcSignedR11 || u_format == kEtcSignedRG11;
+    uint src = (block.y * blockCount.x + block.x) * (isWide ? 4u : 2u);
+    uint high = flip32(words[src]);
+    uint low = flip32(words[src + 1u]);
+
+    uint pixelSize = 4u;
+    if (u_format == kEtcRGB8) {
+        decodeRgbBlock(high, low, false);
+        pixelSize = 3u;
+    } else if (u_format == kEtcRGB8A1) {
+        decodeRgbBlock(high, low, true);
+    } else if (u_format == kEtcRGBA8) {
+        decodeEacBlock(high, low, false, false);
+        decodeRgbBlock(flip32(words[src + 2u]), flip32(words[src + 3u]), false);
+        for (int i = 0; i < 16; i++) {
+            g_texels[i].a = g_channel[i];
+        }
+    } else if (u_format == kEtcR11 || u_format == kEtcSignedR11) {
+        decodeEacFloatBlock(high, low, isSigned, false);
+    } else {
+        decodeEacFloatBlock(high, low, isSigned, false);
+        decodeEacFloatBlock(flip32(words[src + 2u]), flip32(words[src + 3u]), isSigned, true);
+        pixelSize = 8u;
+    }
+
+    uvec2 texel = block * 4u;
+    uint columns = min(4u, u_extent.x - texel.x);
+    uint rows = min(4u, u_extent.y - texel.y);
+    for (uint y = 0u; y < rows; y++) {
+        uint dst = u_dstOffset + ((texel.y + y) * u_rowPitch + texel.x * pixelSize) / 4u;
+        if (u_format == kEtcRGB8) {
+            uint rowWords[3] = uint[3](0u, 0u, 0u);
+            for (uint x = 0u; x < columns; x++) {
+                ivec4 t = g_texels[y * 4u + x];
+                for (uint c = 0u; c < 3u; c++) {
+                    uint byteIndex = x * 3u + c;
+                    rowWords[byteIndex / 4u] |= uint(t[c]) << (8u * (byteIndex % 4u));
+                }
+            }
+            for (uint n = 0u; n < (columns * 3u + 3u) / 4u; n++) {
+                words[dst + n] = rowWords[n];
+            }
+        } else if (u_format == kEtcRGB8A1 || u_format == kEtcRGBA8) {
+            for (uint x = 0u; x < columns; x++) {
+                uvec4 t = uvec4(g_texels[y * 4u + x]);
+                words[dst + x] = t.r | (t.g << 8) | (t.b << 16) | (t.a << 24);
+            }
+        } else if (pixelSize == 4u) {
+            for (uint x = 0u; x < columns; x++) {
+                words[dst + x] = floatBitsToUint(g_red[y * 4u + x]);
+            }
+        } else {
+            for (uint x = 0u; x < columns; x++) {
+                words[dst + 2u * x] = floatBitsToUint(g_red[y * 4u + x]);
+                words[dst + 2u * x + 1u] = floatBitsToUint(g_green[y * 4u + x]);
+            }
+        }
+    }
+}
+)";
+
+bool isComputeSupported(bool isGles) {
+    auto& gl = GLEScontext::dispatcher();
+    if (!gl.glDispatchCompute || !gl.glMemoryBarrier || !gl.glBindBufferBase) {
+        return false;
+    }
+    GLint major = 0;
+    GLint minor = 0;
+    gl.glGetIntegerv(GL_MAJOR_VERSION, &major);
+    gl.glGetIntegerv(GL_MINOR_VERSION, &minor);
+    const int version = major * 10 + minor;
+    return isGles ? version >= 31 : version >= 43;
+}
+
+std::string getShaderSource(bool isGles) {
+    std::string src = isGles ? "#version 310 es\nprecision highp float;\nprecision highp int;\n"
+                             : "#version 430\n";
+    const struct {
+        const char* name;
+        ETC2ImageFormat format;
+    } kFormats[] = {
+        {"kEtcRGB8", EtcRGB8},         {"kEtcRGBA8", EtcRGBA8},
+        {"kEtcR11", EtcR11},           {"kEtcSignedR11", EtcSignedR11},
+        {"kEtcRG11", EtcRG11},         {"kEtcSignedRG11", EtcSignedRG11},
+        {"kEtcRGB8A1", EtcRGB8A1},
+    };
+    for (const auto& format : kFormats) {
+        src += std::string("const int ") + format.name + " = " +
+               std::to_string(static_cast<int>(format.format)) + ";\n";
+    }
+    return src + kEtcDecodeShaderSrc;
+}
+
+GLuint buildProgram(const std::string& src) {
+    auto& gl = GLEScontext::dispatcher();
+
+    GLuint shader = gl.glCreateShader(GL_COMPUTE_SHADER);
+    const GLchar* srcPtr = src.c_str();
+    gl.glShaderSource(shader, 1, &srcPtr, nullptr);
+    gl.glCompileShader(shader);
+
+    GLint status = GL_FALSE;
+    gl.glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE) {
+        GLsizei infoLogLength = 0;
+        gl.glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLogLength);
+        std::vector<char> infoLog(infoLogLength + 1, 0);
+        gl.glGetShaderInfoLog(shader, infoLogLength, nullptr, infoLog.data());
+        GFXSTREAM_ERROR("Failed to compile the ETC decode shader: %s", infoLog.data());
+        gl.glDeleteShader(shader);
+        return 0;
+    }
+
+    GLuint program = gl.glCreateProgram();
+    gl.glAttachShader(program, shader);
+    gl.glLinkProgram(program);
+    gl.glDeleteShader(shader);
+
+    gl.glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+        GLsizei infoLogLength = 0;
+        gl.glGetProgramiv(program, GL_INFO_LOG_LENGTH, &infoLogLength);
+        std::vector<char> infoLog(infoLogLength + 1, 0);
+        gl.glGetProgramInfoLog(program, infoLogLength, nullptr, infoLog.data());
+        GFXSTREAM_ERROR("Failed to link the ETC decode shader: %s", infoLog.data());
+        gl.glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+// Saves and restores the bindings the decoder touches. The app may have its own buffers bound
+// to any of them, including a ranged binding on shader storage buffer index 0.
+class ScopedComputeState {
+   public:
+    ScopedComputeState() {
+        auto& gl = GLEScontext::dispatcher();
+        gl.glGetIntegerv(GL_CURRENT_PROGRAM, &mProgram);
+        gl.glGetIntegerv(GL_SHADER_STORAGE_BUFFER_BINDING, &mStorageBuffer);
+        gl.glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &mUnpackBuffer);
+        gl.glGetIntegeri_v(GL_SHADER_STORAGE_BUFFER_BINDING, 0, &mIndexedBuffer);
+        gl.glGetInteger64i_v(GL_SHADER_STORAGE_BUFFER_START, 0, &mIndexedStart);
+        gl.glGetInteger64i_v(GL_SHADER_STORAGE_BUFFER_SIZE, 0, &mIndexedSize);
+    }
+
+    ~ScopedComputeState() {
+        auto& gl = GLEScontext::dispatcher();
+        if (mIndexedBuffer && mIndexedSize) {
+            gl.glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, mIndexedBuffer, mIndexedStart,
+                                 mIndexedSize);
+        } else {
+            gl.glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, mIndexedBuffer);
+        }
+        // Indexed binds also replace the generic binding, so restore it last.
+        gl.glBindBuffer(GL_SHADER_STORAGE_BUFFER, mStorageBuffer);
+        gl.glBindBuffer(GL_PIXEL_UNPACK_BUFFER, mUnpackBuffer);
+        gl.glUseProgram(mProgram);
+    }
+
+   private:
+    GLint mProgram = 0;
+    GLint mStorageBuffer = 0;
+    GLint mUnpackBuffer = 0;
+    GLint mIndexedBuffer = 0;
+    GLint64 mIndexedStart = 0;
+    GLint64 mIndexedSize = 0;
+};
+
+}  // namespace
+
+// static
+void EtcComputeDecoder::setEnabled(bool enabled) { sEnabled.store(enabled, std::memory_order_relaxed); }
+
+// static
+bool EtcComputeDecoder::isEnabled() { return sEnabled.load(std::memory_order_relaxed); }
+
+// static
+std::unique_ptr<EtcComputeDecoder> EtcComputeDecoder::create(bool isGles) {
+    if (!isComputeSupported(isGles)) {
+        return nullptr;
+    }
+
+    GLuint program = buildProgram(getShaderSource(isGles));
+    if (!program) {
+        return nullptr;
+    }
+
+    auto& gl = GLEScontext::dispatcher();
+    std::unique_ptr<EtcComputeDecoder> decoder(new EtcComputeDecoder());
+    decoder->mProgram = program;
+    decoder->mFormatLoc = gl.glGetUniformLocation(program, "u_format");
+    decoder->mExtentLoc = gl.glGetUniformLocation(program, "u_extent");
+    decoder->mRowPitchLoc = gl.glGetUniformLocation(program, "u_rowPitch");
+    decoder->mDstOffsetLoc = gl.glGetUniformLocation(program, "u_dstOffset");
+    gl.glGenBuffers(1, &decoder->mBuffer);
+
+    GFXSTREAM_DEBUG("Decoding ETC2/EAC textures with compute shaders.");
+    return decoder;
+}
+
+EtcComputeDecoder::~EtcComputeDecoder() {
+    auto& gl = GLEScontext::dispatcher();
+    gl.glDeleteBuffers(1, &mBuffer);
+    gl.glDeleteProgram(mProgram);
+}
+
+bool EtcComputeDecoder::decode(ETC2ImageFormat format, const void* data, GLsizei width,
+                               GLsizei height, GLsizei stride, const UploadFunc& upload) {
+    if (!data || width <= 0 || height <= 0) {
+        return false;
+    }
+
+    auto& gl = GLEScontext::dispatcher();
+
+    // The compressed blocks are followed by the decoded image in the same buffer. Blocks are
+    // 8 or 16 bytes, so the image starts on a word boundary, and its offset is never zero,
+    // which keeps it distinguishable from a null pixel pointer for the translator.
+    const GLsizeiptr compressedSize = etc_get_encoded_data_size(format, width, height);
+    const GLsizeiptr decodedSize = static_cast<GLsizeiptr>(stride) * height;
+    const GLsizeiptr totalSize = compressedSize + decodedSize;
+
+    GLint64 maxBlockSize = 0;
+    gl.glGetInteger64v(GL_MAX_SHADER_STORAGE_BLOCK_SIZE, &maxBlockSize);
+    if (totalSize > maxBlockSize || stride % 4 != 0) {
+        return false;
+    }
+
+    ScopedComputeState state;
+
+    // Orphan the previous contents so that an upload still in flight does not stall us.
+    gl.glBindBuffer(GL_SHADER_STORAGE_BUFFER, mBuffer);
+    gl.glBufferData(GL_SHADER_STORAGE_BUFFER, totalSize, nullptr, GL_STREAM_COPY);
+    gl.glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, compressedSize, data);
+    gl.glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, mBuffer);
+
+    gl.glUseProgram(mProgram);
+    gl.glUniform1i(mFormatLoc, static_cast<GLint>(format));
+    gl.glUniform2ui(mExtentLoc, width, height);
+    gl.glUniform1ui(mRowPitchLoc, stride);
+    gl.glUniform1ui(mDstOffsetLoc, compressedSize / 4);
+
+    const GLuint blocksX = (width + 3) / 4;
+    const GLuint blocksY = (height + 3) / 4;
+    gl.glDispatchCompute((blocksX + kBlocksPerWorkgroup - 1) / kBlocksPerWorkgroup,
+                         (blocksY + kBlocksPerWorkgroup - 1) / kBlocksPerWorkgroup, 1);
+    gl.glMemoryBarrier(GL_PIXEL_BUFFER_BARRIER_BIT);
+
+    gl.glBindBuffer(GL_PIXEL_UNPACK_BUFFER, mBuffer);
+    upload(reinterpret_cast<const GLvoid*>(compressedSize));
+    return true;
+}
@@ -20,6 +20,7 @@
 #include <GLES2/gl2ext.h>
 #include <GLES3/gl3.h>
 #include <GLES3/gl31.h>
+#include <GLcommon/EtcComputeDecoder.h>
 #include <GLcommon/FramebufferData.h>
 #include <GLcommon/GLEScontext.h>
 #include <GLcommon/GLESmacros.h>
@@ -593,6 +594,8 @@ GLEScontext::~GLEScontext() {
         gl.glDeleteVertexArrays(1, &m_textureEmulationVAO);
     }
 
+    m_etcComputeDecoder.reset();
+
     if (m_defaultFBO) {
         gl.glBindFramebuffer(GL_FRAMEBUFFER, m_defaultFBO);
         gl.glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, 0);
@@ -2014,6 +2017,10 @@ void GLEScontext::initCapsLocked(const GLubyte * extensionString, bool nativeTex
         glSupport.hasS3tcSupport = true;
     }
 
+    if (glSupport.hasS3tcSupport && strstr(cstring, "GL_EXT_texture_sRGB") != NULL) {
+        glSupport.hasS3tcSrgbSupport = true;
+    }
+
     if (strstr(cstring, "GL_EXT_texture_compression_rgtc") != NULL) {
         glSupport.hasRgtcSupport = true;
     }
@@ -2737,6 +2744,17 @@ void GLEScontext::copyTexImageWithEmulation(
     }
 }
 
+EtcComputeDecoder* GLEScontext::getEtcComputeDecoder() {
+    if (!EtcComputeDecoder::isEnabled()) {
+        return nullptr;
+    }
+    if (!m_etcComputeDecoderInitialized) {
+        m_etcComputeDecoderInitialized = true;
+        m_etcComputeDecoder = EtcComputeDecoder::create(isGles2Gles());
+    }
+    return m_etcComputeDecoder.get();
+}
+
 // static
 GLuint GLEScontext::compileAndValidateCoreShader(GLenum shaderType, const char* src) {
     GLDispatch& gl = dispatcher();
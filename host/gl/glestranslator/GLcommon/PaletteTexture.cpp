@@ -14,18 +14,14 @@
 * limitations under the License.
 */
 #include "GLcommon/PaletteTexture.h"
+#include "GLcommon/TextureDecodeThreadPool.h"
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
+#include <algorithm>
 
 
-struct Color
-{
-  Color(unsigned char r, unsigned char g,unsigned char b, unsigned char a):red(r),green(g),blue(b),alpha(a){};
-  unsigned char red;
-  unsigned char green;
-  unsigned char blue;
-  unsigned char alpha;
-};
 
 void getPaletteInfo(GLenum internalFormat,unsigned int& indexSizeBits,unsigned int& colorSizeBytes,GLenum& colorFrmt) {
 
@@ -75,33 +71,74 @@ void getPaletteInfo(GLenum internalFormat,unsigned int& indexSizeBits,unsigned i
 }
 
 
-Color paletteColor(const unsigned char* pallete,unsigned int index,GLenum format)
+// Expands palette entry `index` of `format` into 8 bit RGBA.
+static void paletteColor(const unsigned char* pallete, unsigned int index, GLenum format,
+                         unsigned char* rgba)
 {
-        short s;
-        switch(format) {
+    uint16_t s;
+    switch(format) {
         //RGB
     case GL_PALETTE4_RGB8_OES:
     case GL_PALETTE8_RGB8_OES:
-            return Color(pallete[index],pallete[index+1],pallete[index+2],0);
+        rgba[0] = pallete[index];
+        rgba[1] = pallete[index + 1];
+        rgba[2] = pallete[index + 2];
+        rgba[3] = 0;
+        return;
     case GL_PALETTE8_R5_G6_B5_OES:
     case GL_PALETTE4_R5_G6_B5_OES:
-            s = *((short *)(pallete+index));
-            return Color((s >> 11)*255/31,((s >> 5) & 0x3f)*255/63 ,(s & 0x1f)*255/31,0);
+        memcpy(&s, pallete + index, sizeof(s));
+        rgba[0] = (s >> 11) * 255 / 31;
+        rgba[1] = ((s >> 5) & 0x3f) * 255 / 63;
+        rgba[2] = (s & 0x1f) * 255 / 31;
+        rgba[3] = 0;
+        return;
 
         //RGBA
     case GL_PALETTE4_RGBA8_OES:
     case GL_PALETTE8_RGBA8_OES:
-            return Color(pallete[index],pallete[index+1],pallete[index+2],pallete[index+3]);
+        memcpy(rgba, pallete + index, 4);
+        return;
     case GL_PALETTE4_RGBA4_OES:
     case GL_PALETTE8_RGBA4_OES:
-            s = *((short *)(pallete+index));
-            return Color(((s >> 12) & 0xf)*255/15,((s >> 8) & 0xf)*255/15,((s >> 4) & 0xf)*255/15 ,(s & 0xf)*255/15);
+        memcpy(&s, pallete + index, sizeof(s));
+        rgba[0] = ((s >> 12) & 0xf) * 255 / 15;
+        rgba[1] = ((s >> 8) & 0xf) * 255 / 15;
+        rgba[2] = ((s >> 4) & 0xf) * 255 / 15;
+        rgba[3] = (s & 0xf) * 255 / 15;
+        return;
     case GL_PALETTE4_RGB5_A1_OES:
     case GL_PALETTE8_RGB5_A1_OES:
-            s = *((short *)(pallete+index));
-            return Color(((s >> 11) & 0x1f)*255/31,((s >> 6) & 0x1f)*255/31,((s >> 1) & 0x1f)*255/31 ,(s & 0x1) * 255);
-        default:
-            return Color(255,255,255,255);
+        memcpy(&s, pallete + index, sizeof(s));
+        rgba[0] = ((s >> 11) & 0x1f) * 255 / 31;
+        rgba[1] = ((s >> 6) & 0x1f) * 255 / 31;
+        rgba[2] = ((s >> 1) & 0x1f) * 255 / 31;
+        rgba[3] = (s & 0x1) * 255;
+        return;
+    default:
+        memset(rgba, 255, 4);
+        return;
+    }
+}
+
+// Writes `count` texels starting at texel `first` of the image. The palette has already been
+// expanded to RGBA, so the inner loop is a plain table lookup.
+template <unsigned int kIndexSizeBits, int kColorSizeOut>
+static void decodePaletteRange(const unsigned char* indices, const unsigned char (*colors)[4],
+                               int first, int count, unsigned char* pixelsOut)
+{
+    unsigned char* out = pixelsOut + first * kColorSizeOut;
+    for (int i = first; i < first + count; i++) {
+        int paletteIndex;
+        if (kIndexSizeBits == 4) {
+            paletteIndex = (i % 2) == 0 ?
+                           indices[i / 2] >> 4:  //upper bits
+                           indices[i / 2] & 0xf; //lower bits
+        } else {
+            paletteIndex = indices[i];
+        }
+        memcpy(out, colors[paletteIndex], kColorSizeOut);
+        out += kColorSizeOut;
     }
 }
 
@@ -142,29 +179,37 @@ unsigned char* uncompressTexture(GLenum internalformat,GLenum& formatOut,GLsizei
     int leftPixels = (leftBytes * 8 )/indexSizeBits;
 
     int maxIndices = (leftPixels < nPixels) ? leftPixels:nPixels;
+    if (maxIndices < nPixels) {
+        memset(pixelsOut + std::max(maxIndices, 0) * colorSizeOut, 0,
+               (nPixels - std::max(maxIndices, 0)) * colorSizeOut);
+    }
+    if (maxIndices <= 0) {
+        return pixelsOut;
+    }
 
-    //filling the pixels array
-    for(int i =0 ; i < maxIndices ; i++) {
-        int paletteIndex = 0;
-        int indexOut = i*colorSizeOut;
-        if(indexSizeBits == 4) {
-            paletteIndex = (i%2) == 0 ?
-                           imageIndices[i/2] >> 4:  //upper bits
-                           imageIndices[i/2] & 0xf; //lower bits
-        } else {
-            paletteIndex = imageIndices[i];
-        }
-
-        paletteIndex*=colorSizeBytes;
-        Color c = paletteColor(palette,paletteIndex,internalformat);
+    unsigned char colors[256][4];
+    for (int i = 0; i < nColors; i++) {
+        paletteColor(palette, i * colorSizeBytes, internalformat, colors[i]);
+    }
 
-        pixelsOut[indexOut] = c.red;
-        pixelsOut[indexOut+1] = c.green;
-        pixelsOut[indexOut+2] = c.blue;
-        if(formatOut == GL_RGBA) {
-            pixelsOut[indexOut+3] = c.alpha;
+    //filling the pixels array, one row of texels per item
+    const int rows = (maxIndices + width - 1) / width;
+    parallelTextureDecode(rows, width * colorSizeOut, [&](uint32_t begin, uint32_t end) {
+        const int first = begin * width;
+        const int count = std::min<int>(end * width, maxIndices) - first;
+        if (indexSizeBits == 4) {
+            if (colorSizeOut == 3) {
+                decodePaletteRange<4, 3>(imageIndices, colors, first, count, pixelsOut);
+            } else {
+                decodePaletteRange<4, 4>(imageIndices, colors, first, count, pixelsOut);
+            }
+        } else {
+            if (colorSizeOut == 3) {
+                decodePaletteRange<8, 3>(imageIndices, colors, first, count, pixelsOut);
+            } else {
+                decodePaletteRange<8, 4>(imageIndices, colors, first, count, pixelsOut);
+            }
         }
-    }
+    });
     return pixelsOut;
 }
-
@@ -933,9 +933,19 @@ void SaveableTexture::restore() {
             }
         }
 
+        // ETC2/EAC/ASTC textures transcoded to BCn were read back
+        // uncompressed and are re-encoded into the same BCn format.
+        GLenum transcodeReadbackFormat = 0;
+        GLenum transcodeReadbackType = 0;
+        getBcnTranscodeReadbackFormat(m_internalFormat, &transcodeReadbackFormat,
+                                      &transcodeReadbackType);
+        const bool restoreTranscoded = !m_texStorageLevels &&
+                                       m_format == transcodeReadbackFormat &&
+                                       m_type == transcodeReadbackType;
+
         auto restoreTex2D =
                 [this, numLevels, resultInternalFormat,
-                resultFormat, &dispatcher](
+                resultFormat, restoreTranscoded, &dispatcher](
                         GLenum target,
                         std::unique_ptr<LevelImageData[]>& levelData) {
                     for (unsigned int level = 0; level < numLevels; level++) {
@@ -943,7 +953,18 @@ void SaveableTexture::restore() {
                                 levelData[level].m_data.empty()
                                         ? nullptr
                                         : levelData[level].m_data.data();
-                        if (!level || pixels) {
+                        std::vector<uint8_t> encoded;
+                        if (restoreTranscoded && pixels &&
+                            encodeBcnTranscodedTexels(m_internalFormat, pixels,
+                                                      levelData[level].m_width,
+                                                      levelData[level].m_height, 1,
+                                                      &encoded)) {
+                            dispatcher.glCompressedTexImage2D(
+                                    target, level, m_internalFormat,
+                                    levelData[level].m_width,
+                                    levelData[level].m_height, m_border,
+                                    encoded.size(), encoded.data());
+                        } else if (!level || pixels) {
                             if (m_texStorageLevels) {
                                 dispatcher.glTexSubImage2D(
                                         target, level, 0, 0,
@@ -961,7 +982,7 @@ void SaveableTexture::restore() {
                     }
                 };
         auto restoreTex3D =
-                [this, numLevels, resultFormat, &dispatcher](
+                [this, numLevels, resultFormat, restoreTranscoded, &dispatcher](
                         GLenum target,
                         std::unique_ptr<LevelImageData[]>& levelData) {
                     for (unsigned int level = 0; level < numLevels; level++) {
@@ -969,7 +990,20 @@ void SaveableTexture::restore() {
                                 levelData[level].m_data.empty()
                                         ? nullptr
                                         : levelData[level].m_data.data();
-                        if (!level || pixels) {
+                        std::vector<uint8_t> encoded;
+                        if (restoreTranscoded && pixels &&
+                            encodeBcnTranscodedTexels(m_internalFormat, pixels,
+                                                      levelData[level].m_width,
+                                                      levelData[level].m_height,
+                                                      levelData[level].m_depth,
+                                                      &encoded)) {
+                            dispatcher.glCompressedTexImage3D(
+                                    target, level, m_internalFormat,
+                                    levelData[level].m_width,
+                                    levelData[level].m_height,
+                                    levelData[level].m_depth, m_border,
+                                    encoded.size(), encoded.data());
+                        } else if (!level || pixels) {
                             if (m_texStorageLevels) {
                                 dispatcher.glTexSubImage3D(
                                         target, level, 0, 0, 0,
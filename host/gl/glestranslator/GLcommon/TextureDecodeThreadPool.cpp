@@ -0,0 +1,129 @@
+// Copyright 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "GLcommon/TextureDecodeThreadPool.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+
+#include "gfxstream/system/System.h"
+#include "gfxstream/threads/ThreadPool.h"
+
+namespace {
+
+// The pool gets one thread per core, up to this many. Uploads are decoded on
+// the render threads of the guest, so more would only compete with them.
+constexpr int kMaxDecodeThreads = 4;
+
+// Below this much output, waking up other threads costs more than it saves.
+constexpr size_t kMinParallelBytes = 256 * 1024;
+
+struct DecodeJob {
+    const std::function<void(uint32_t, uint32_t)>* decode = nullptr;
+    std::mutex mutex;
+    std::condition_variable cv;
+    uint32_t remaining = 0;
+};
+
+struct DecodeTask {
+    DecodeJob* job = nullptr;
+    uint32_t begin = 0;
+    uint32_t end = 0;
+};
+
+using DecodeThreadPool = gfxstream::base::ThreadPool<DecodeTask>;
+
+thread_local bool tIsDecodeThread = false;
+
+void runTask(DecodeTask&& task) {
+    (*task.job->decode)(task.begin, task.end);
+    std::lock_guard<std::mutex> lock(task.job->mutex);
+    if (--task.job->remaining == 0) {
+        task.job->cv.notify_one();
+    }
+}
+
+// Returns nullptr if |threads| is too few to spread decoding over.
+DecodeThreadPool* createDecodeThreadPool(int threads) {
+    if (threads <= 1) {
+        return nullptr;
+    }
+    auto* pool = new DecodeThreadPool(threads, [](DecodeTask&& task) {
+        tIsDecodeThread = true;
+        runTask(std::move(task));
+    });
+    if (!pool->start()) {
+        delete pool;
+        return nullptr;
+    }
+    return pool;
+}
+
+std::mutex sPoolMutex;
+bool sPoolCreated = false;
+// Intentionally leaked, like other process wide host singletons, so that exiting does not
+// wait for the workers.
+DecodeThreadPool* sPool = nullptr;
+
+// Returns nullptr if decoding should not be spread over other threads.
+DecodeThreadPool* getDecodeThreadPool() {
+    std::lock_guard<std::mutex> lock(sPoolMutex);
+    if (!sPoolCreated) {
+        sPool = createDecodeThreadPool(
+            std::min(gfxstream::base::getCpuCoreCount(), kMaxDecodeThreads));
+        sPoolCreated = true;
+    }
+    return sPool;
+}
+
+}  // namespace
+
+void parallelTextureDecode(uint32_t count, size_t bytesPerItem,
+                           const std::function<void(uint32_t begin, uint32_t end)>& decode) {
+    if (count == 0) {
+        return;
+    }
+
+    DecodeThreadPool* pool = nullptr;
+    if (!tIsDecodeThread && count > 1 && count * bytesPerItem >= kMinParallelBytes) {
+        pool = getDecodeThreadPool();
+    }
+    if (!pool) {
+        decode(0, count);
+        return;
+    }
+
+    // One range per worker plus one for this thread, which would otherwise sit idle.
+    const uint32_t maxRanges = std::min<uint32_t>(count, pool->numWorkers() + 1);
+    const uint32_t itemsPerRange = (count + maxRanges - 1) / maxRanges;
+
+    DecodeJob job;
+    job.decode = &decode;
+    job.remaining = (count + itemsPerRange - 1) / itemsPerRange;
+    for (uint32_t begin = itemsPerRange; begin < count; begin += itemsPerRange) {
+        pool->enqueue({&job, begin, std::min(count, begin + itemsPerRange)});
+    }
+    runTask({&job, 0, std::min(count, itemsPerRange)});
+
+    std::unique_lock<std::mutex> lock(job.mutex);
+    job.cv.wait(lock, [&job] { return job.remaining == 0; });
+}
+
+void setTextureDecodeThreadCountForTesting(int threads) {
+    std::lock_guard<std::mutex> lock(sPoolMutex);
+    delete sPool;
+    sPool = createDecodeThreadPool(threads);
+    sPoolCreated = true;
+}
@@ -0,0 +1,91 @@
+// Copyright 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <GLES/gl.h>
+#include <GLES/glext.h>
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "GLcommon/PaletteTexture.h"
+#include "GLcommon/rgtc.h"
+
+namespace {
+
+std::vector<uint8_t> randomBytes(size_t size) {
+    std::mt19937 rng(42);
+    std::vector<uint8_t> bytes(size);
+    for (auto& byte : bytes) {
+        byte = static_cast<uint8_t>(rng());
+    }
+    return bytes;
+}
+
+void BM_RgtcDecode(benchmark::State& state, RGTCImageFormat format) {
+    const uint32_t size = static_cast<uint32_t>(state.range(0));
+    const std::vector<uint8_t> in = randomBytes(rgtc_get_encoded_image_size(format, size, size));
+    const uint32_t stride = size * rgtc_get_decoded_pixel_size(format);
+    std::vector<uint8_t> out(stride * size);
+    for (auto _ : state) {
+        rgtc_decode_image(in.data(), format, out.data(), size, size, stride);
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * out.size());
+}
+
+BENCHMARK_CAPTURE(BM_RgtcDecode, BC4_UNORM, BC4_UNORM)->Arg(64)->Arg(512)->Arg(2048);
+BENCHMARK_CAPTURE(BM_RgtcDecode, BC4_SNORM, BC4_SNORM)->Arg(64)->Arg(512)->Arg(2048);
+BENCHMARK_CAPTURE(BM_RgtcDecode, BC5_UNORM, BC5_UNORM)->Arg(64)->Arg(512)->Arg(2048);
+BENCHMARK_CAPTURE(BM_RgtcDecode, BC5_SNORM, BC5_SNORM)->Arg(64)->Arg(512)->Arg(2048);
+
+void BM_PaletteDecode(benchmark::State& state, GLenum format) {
+    const GLsizei size = static_cast<GLsizei>(state.range(0));
+    // Large enough for the biggest palette (256 RGBA8 entries) and 8 bit indices.
+    const std::vector<uint8_t> in = randomBytes(256 * 4 + size * size);
+    size_t decodedSize = 0;
+    for (auto _ : state) {
+        GLenum decodedFormat;
+        std::unique_ptr<unsigned char[]> out(
+            uncompressTexture(format, decodedFormat, size, size, in.size(), in.data(), 0));
+        benchmark::DoNotOptimize(out.get());
+        decodedSize = size * size * (decodedFormat == GL_RGB ? 3 : 4);
+    }
+    state.SetBytesProcessed(state.iterations() * decodedSize);
+}
+
+BENCHMARK_CAPTURE(BM_PaletteDecode, PALETTE4_RGB8, GL_PALETTE4_RGB8_OES)->Arg(64)->Arg(1024);
+BENCHMARK_CAPTURE(BM_PaletteDecode, PALETTE4_RGBA8, GL_PALETTE4_RGBA8_OES)->Arg(64)->Arg(1024);
+BENCHMARK_CAPTURE(BM_PaletteDecode, PALETTE4_R5_G6_B5, GL_PALETTE4_R5_G6_B5_OES)
+    ->Arg(64)
+    ->Arg(1024);
+BENCHMARK_CAPTURE(BM_PaletteDecode, PALETTE4_RGBA4, GL_PALETTE4_RGBA4_OES)->Arg(64)->Arg(1024);
+BENCHMARK_CAPTURE(BM_PaletteDecode, PALETTE4_RGB5_A1, GL_PALETTE4_RGB5_A1_OES)
+    ->Arg(64)
+    ->Arg(1024);
+BENCHMARK_CAPTURE(BM_PaletteDecode, PALETTE8_RGB8, GL_PALETTE8_RGB8_OES)->Arg(64)->Arg(1024);
+BENCHMARK_CAPTURE(BM_PaletteDecode, PALETTE8_RGBA8, GL_PALETTE8_RGBA8_OES)->Arg(64)->Arg(1024);
+BENCHMARK_CAPTURE(BM_PaletteDecode, PALETTE8_R5_G6_B5, GL_PALETTE8_R5_G6_B5_OES)
+    ->Arg(64)
+    ->Arg(1024);
+BENCHMARK_CAPTURE(BM_PaletteDecode, PALETTE8_RGBA4, GL_PALETTE8_RGBA4_OES)->Arg(64)->Arg(1024);
+BENCHMARK_CAPTURE(BM_PaletteDecode, PALETTE8_RGB5_A1, GL_PALETTE8_RGB5_A1_OES)
+    ->Arg(64)
+    ->Arg(1024);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -14,17 +14,24 @@
 * limitations under the License.
 */
 #include <GLcommon/TextureUtils.h>
+#include <GLcommon/EtcComputeDecoder.h>
 #include <GLcommon/GLESmacros.h>
 #include <GLcommon/GLDispatch.h>
 #include <GLcommon/GLESvalidate.h>
 #include <stdio.h>
+#include <atomic>
 #include <cmath>
 #include <memory>
+#include <vector>
 
 #include "gfxstream/AlignedBuf.h"
 #include "gfxstream/host/AstcCpuDecompressor.h"
+#include "gfxstream/host/BcnEncoder.h"
+#include "gfxstream/host/DecodedTextureCache.h"
 
 using gfxstream::AlignedBuf;
+using gfxstream::host::BcnFormat;
+using gfxstream::host::DecodedTextureCache;
 using gfxstream::vk::AstcCpuDecompressor;
 
 #define GL_R16 0x822A
@@ -482,13 +489,41 @@ void doCompressedTexImage2D(GLEScontext* ctx, GLenum target, GLint level,
         const int32_t align = unpackAlignment - 1;
         const int32_t bpr = ((width * pixelSize) + align) & ~align;
         const size_t size = bpr * height;
+
+        // Prefer decoding on the GPU, which keeps both the decode and the
+        // upload of the decoded image off this thread.
+        EtcComputeDecoder* computeDecoder =
+                needUnpackBuffer ? nullptr : ctx->getEtcComputeDecoder();
+        if (computeDecoder &&
+            computeDecoder->decode(etcFormat, data, width, height, bpr,
+                                   [&](const GLvoid* pixels) {
+                                       glTexImage2DPtr(target, level, convertedInternalFormat,
+                                                       width, height, border, format, type,
+                                                       pixels);
+                                   })) {
+            return;
+        }
+
         std::unique_ptr<etc1_byte[]> pOut(new etc1_byte[size]);
 
-        int res =
-            etc2_decode_image(
-                    (const etc1_byte*)data, etcFormat, pOut.get(),
-                    width, height, bpr);
-        SET_ERROR_IF(res!=0, GL_INVALID_VALUE);
+        // Without guest data the input is an uninitialized buffer, which must
+        // not be hashed nor cached.
+        auto& cache = DecodedTextureCache::get();
+        const bool useCache = cache.enabled() && !emulatedData;
+        const DecodedTextureCache::Key key =
+            useCache ? DecodedTextureCache::makeKey(internalformat, 0, width, height,
+                                                    data, compressedSize)
+                     : DecodedTextureCache::Key();
+        if (!useCache || !cache.lookup(key, pOut.get(), size)) {
+            int res =
+                etc2_decode_image(
+                        (const etc1_byte*)data, etcFormat, pOut.get(),
+                        width, height, bpr);
+            SET_ERROR_IF(res!=0, GL_INVALID_VALUE);
+            if (useCache) {
+                cache.insert(key, pOut.get(), size);
+            }
+        }
 
         glTexImage2DPtr(target, level, convertedInternalFormat,
                         width, height, border, format, type, pOut.get());
@@ -825,6 +860,412 @@ void doCompressedTexSubImage2DNative(GLEScontext* ctx, GLenum target, GLint leve
     // }
 }
 
+namespace {
+
+std::atomic<bool> sBcnTranscodeEnabled{false};
+
+bool getBcnFormat(GLenum transcodedFormat, BcnFormat* bcnFormat) {
+    switch (transcodedFormat) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+            *bcnFormat = BcnFormat::kBc1;
+            return true;
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+            *bcnFormat = BcnFormat::kBc1Alpha;
+            return true;
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+            *bcnFormat = BcnFormat::kBc3;
+            return true;
+        case GL_COMPRESSED_RED_RGTC1_EXT:
+            *bcnFormat = BcnFormat::kBc4Unorm;
+            return true;
+        case GL_COMPRESSED_SIGNED_RED_RGTC1_EXT:
+            *bcnFormat = BcnFormat::kBc4Snorm;
+            return true;
+        case GL_COMPRESSED_RED_GREEN_RGTC2_EXT:
+            *bcnFormat = BcnFormat::kBc5Unorm;
+            return true;
+        case GL_COMPRESSED_SIGNED_RED_GREEN_RGTC2_EXT:
+            *bcnFormat = BcnFormat::kBc5Snorm;
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Host VRAM that would have been used by the decompressed textures versus what
+// the transcoded textures actually use.
+std::atomic<uint64_t> sBcnDecompressedBytes{0};
+std::atomic<uint64_t> sBcnTranscodedBytes{0};
+
+void recordBcnTranscode(GLenum internalformat, GLenum transcodedFormat, GLsizei width,
+                        GLsizei height, size_t transcodedSize) {
+    // Decompressed uploads would have used at least one byte per channel (EAC
+    // uses 32-bit floats).
+    const size_t decompressedPixelSize =
+        isEtcFormat(internalformat) ? etc_get_decoded_pixel_size(getEtcFormat(internalformat))
+                                    : 4;
+    const size_t decompressedSize = (size_t)width * height * decompressedPixelSize;
+    const uint64_t decompressedBytes = sBcnDecompressedBytes += decompressedSize;
+    const uint64_t transcodedBytes = sBcnTranscodedBytes += transcodedSize;
+    GFXSTREAM_DEBUG(
+        "Transcoded 0x%x %dx%d to 0x%x: %zu bytes instead of %zu. Total: %llu bytes instead of "
+        "%llu.",
+        internalformat, width, height, transcodedFormat, transcodedSize, decompressedSize,
+        (unsigned long long)transcodedBytes, (unsigned long long)decompressedBytes);
+}
+
+// Decodes |data| (in |internalformat|) and re-encodes it as |transcodedFormat|
+// into |out|. Returns a GL error code.
+GLenum transcodeToBcn(GLenum internalformat, GLenum transcodedFormat, GLsizei width,
+                      GLsizei height, GLsizei imageSize, const GLvoid* data,
+                      std::vector<uint8_t>* out) {
+    BcnFormat bcnFormat;
+    if (!getBcnFormat(transcodedFormat, &bcnFormat) || width <= 0 || height <= 0) {
+        return GL_INVALID_OPERATION;
+    }
+    const size_t encodedSize = gfxstream::host::getBcnEncodedSize(bcnFormat, width, height);
+    if (!data) {
+        // Matches the decompression path: a null pointer defines the contents
+        // as undefined, so any block data will do.
+        out->assign(encodedSize, 0);
+        return GL_NO_ERROR;
+    }
+
+    auto& cache = DecodedTextureCache::get();
+    const DecodedTextureCache::Key key =
+        cache.enabled() ? DecodedTextureCache::makeKey(internalformat, transcodedFormat, width,
+                                                       height, data, imageSize)
+                        : DecodedTextureCache::Key();
+    out->resize(encodedSize);
+    if (cache.enabled() && cache.lookup(key, out->data(), out->size())) {
+        recordBcnTranscode(internalformat, transcodedFormat, width, height, out->size());
+        return GL_NO_ERROR;
+    }
+
+    std::vector<uint8_t> decoded;
+    size_t decodedPixelSize = 0;
+    if (isEtcFormat(internalformat)) {
+        const ETC2ImageFormat etcFormat = getEtcFormat(internalformat);
+        if ((GLsizei)etc_get_encoded_data_size(etcFormat, width, height) != imageSize) {
+            return GL_INVALID_VALUE;
+        }
+        const size_t pixelSize = etc_get_decoded_pixel_size(etcFormat);
+        const size_t bpr = width * pixelSize;
+        std::vector<etc1_byte> etcDecoded(bpr * height);
+        if (etc2_decode_image((const etc1_byte*)data, etcFormat, etcDecoded.data(), width,
+                              height, bpr) != 0) {
+            return GL_INVALID_VALUE;
+        }
+        if (etcFormat == EtcR11 || etcFormat == EtcSignedR11 || etcFormat == EtcRG11 ||
+            etcFormat == EtcSignedRG11) {
+            // EAC decodes to normalized floats; BC4/BC5 endpoints are 8-bit.
+            const bool isSigned = etcFormat == EtcSignedR11 || etcFormat == EtcSignedRG11;
+            const size_t channels = pixelSize / sizeof(float);
+            const float* src = reinterpret_cast<const float*>(etcDecoded.data());
+            decoded.resize(width * height * channels);
+            for (size_t i = 0; i < decoded.size(); i++) {
+                if (isSigned) {
+                    const float v = std::fmin(std::fmax(src[i], -1.0f), 1.0f);
+                    decoded[i] = static_cast<uint8_t>(static_cast<int8_t>(std::lround(v * 127.0f)));
+                } else {
+                    const float v = std::fmin(std::fmax(src[i], 0.0f), 1.0f);
+                    decoded[i] = static_cast<uint8_t>(std::lround(v * 255.0f));
+                }
+            }
+            decodedPixelSize = channels;
+        } else {
+            decoded = std::move(etcDecoded);
+            decodedPixelSize = pixelSize;
+        }
+    } else if (isAstcFormat(internalformat)) {
+        uint32_t blockWidth = 0;
+        uint32_t blockHeight = 0;
+        bool srgb;
+        getAstcFormatInfo(internalformat, &blockWidth, &blockHeight, &srgb);
+        decodedPixelSize = 4;
+        decoded.resize(width * height * decodedPixelSize);
+        if (!astcDecompress(reinterpret_cast<const uint8_t*>(data), imageSize, width, height,
+                            blockWidth, blockHeight, decoded.data(), decoded.size())) {
+            return GL_INVALID_VALUE;
+        }
+    } else {
+        return GL_INVALID_ENUM;
+    }
+
+    if (!gfxstream::host::bcnEncode(bcnFormat, decoded.data(), width, height, decodedPixelSize,
+                                    width * decodedPixelSize, out->data(), out->size())) {
+        return GL_INVALID_VALUE;
+    }
+    cache.insert(key, out->data(), out->size());
+    recordBcnTranscode(internalformat, transcodedFormat, width, height, out->size());
+    return GL_NO_ERROR;
+}
+
+// Transcodes the |depth| slices of |data| one after the other.
+GLenum transcodeSlicesToBcn(GLenum internalformat, GLenum transcodedFormat, GLsizei width,
+                            GLsizei height, GLsizei depth, GLsizei imageSize, const GLvoid* data,
+                            std::vector<uint8_t>* out) {
+    if (depth <= 0 || imageSize % depth) {
+        return GL_INVALID_VALUE;
+    }
+    const GLsizei sliceSize = imageSize / depth;
+    out->clear();
+    std::vector<uint8_t> slice;
+    for (GLsizei i = 0; i < depth; i++) {
+        const GLvoid* sliceData =
+            data ? static_cast<const uint8_t*>(data) + (size_t)i * sliceSize : nullptr;
+        const GLenum err = transcodeToBcn(internalformat, transcodedFormat, width, height,
+                                          sliceSize, sliceData, &slice);
+        if (err != GL_NO_ERROR) {
+            return err;
+        }
+        out->insert(out->end(), slice.begin(), slice.end());
+    }
+    return GL_NO_ERROR;
+}
+
+}  // namespace
+
+void setBcnTranscodeEnabled(bool enabled) {
+    sBcnTranscodeEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+GLenum getBcnTranscodeFormat(GLEScontext* ctx, GLenum compressedFormat) {
+    if (!sBcnTranscodeEnabled.load(std::memory_order_relaxed)) {
+        return 0;
+    }
+    const GLSupport* caps = ctx->getCaps();
+
+    {
+        const bool s3tc = caps->hasS3tcSupport;
+        const bool s3tcSrgb = caps->hasS3tcSrgbSupport;
+        switch (compressedFormat) {
+            case GL_ETC1_RGB8_OES:
+            case GL_COMPRESSED_RGB8_ETC2:
+                return s3tc ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : 0;
+            case GL_COMPRESSED_SRGB8_ETC2:
+                return s3tcSrgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : 0;
+            case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+                return s3tc ? GL_COMPRESSED_RGBA_S3TC_DXT1_EXT : 0;
+            case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+                return s3tcSrgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT : 0;
+            case GL_COMPRESSED_RGBA8_ETC2_EAC:
+                return s3tc ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : 0;
+            case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+                return s3tcSrgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : 0;
+            default:
+                break;
+        }
+    }
+
+    if (caps->hasRgtcSupport) {
+        switch (compressedFormat) {
+            case GL_COMPRESSED_R11_EAC:
+                return GL_COMPRESSED_RED_RGTC1_EXT;
+            case GL_COMPRESSED_SIGNED_R11_EAC:
+                return GL_COMPRESSED_SIGNED_RED_RGTC1_EXT;
+            case GL_COMPRESSED_RG11_EAC:
+                return GL_COMPRESSED_RED_GREEN_RGTC2_EXT;
+            case GL_COMPRESSED_SIGNED_RG11_EAC:
+                return GL_COMPRESSED_SIGNED_RED_GREEN_RGTC2_EXT;
+            default:
+                break;
+        }
+    }
+
+    if (isAstcFormat(compressedFormat) && AstcCpuDecompressor::get().available()) {
+        uint32_t blockWidth = 0;
+        uint32_t blockHeight = 0;
+        bool srgb;
+        getAstcFormatInfo(compressedFormat, &blockWidth, &blockHeight, &srgb);
+        // Sub image updates are aligned to the ASTC block size, which must
+        // also be a multiple of the 4x4 BCn block size.
+        if (blockWidth % 4 || blockHeight % 4) {
+            return 0;
+        }
+        if (srgb) {
+            return caps->hasS3tcSrgbSupport ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : 0;
+        }
+        return caps->hasS3tcSupport ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : 0;
+    }
+
+    return 0;
+}
+
+bool isBcnTranscodedTexture(GLenum compressedFormat, GLenum internalFormat) {
+    BcnFormat bcnFormat;
+    return (isEtcFormat(compressedFormat) || isAstcFormat(compressedFormat)) &&
+           getBcnFormat(internalFormat, &bcnFormat);
+}
+
+void getBcnTranscodeReadbackFormat(GLenum transcodedFormat, GLenum* format, GLenum* type) {
+    switch (transcodedFormat) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+            *format = GL_RGB;
+            *type = GL_UNSIGNED_BYTE;
+            break;
+        case GL_COMPRESSED_RED_RGTC1_EXT:
+            *format = GL_RED;
+            *type = GL_UNSIGNED_BYTE;
+            break;
+        case GL_COMPRESSED_SIGNED_RED_RGTC1_EXT:
+            *format = GL_RED;
+            *type = GL_BYTE;
+            break;
+        case GL_COMPRESSED_RED_GREEN_RGTC2_EXT:
+            *format = GL_RG;
+            *type = GL_UNSIGNED_BYTE;
+            break;
+        case GL_COMPRESSED_SIGNED_RED_GREEN_RGTC2_EXT:
+            *format = GL_RG;
+            *type = GL_BYTE;
+            break;
+        default:
+            *format = GL_RGBA;
+            *type = GL_UNSIGNED_BYTE;
+            break;
+    }
+}
+
+bool encodeBcnTranscodedTexels(GLenum transcodedFormat, const void* pixels, GLsizei width,
+                               GLsizei height, GLsizei depth, std::vector<uint8_t>* out) {
+    BcnFormat bcnFormat;
+    if (!getBcnFormat(transcodedFormat, &bcnFormat) || width <= 0 || height <= 0 ||
+        depth <= 0) {
+        return false;
+    }
+    GLenum format = 0;
+    GLenum type = 0;
+    getBcnTranscodeReadbackFormat(transcodedFormat, &format, &type);
+    const size_t pixelSize = format == GL_RGBA ? 4 : format == GL_RGB ? 3 : format == GL_RG ? 2 : 1;
+    const size_t sliceSize = (size_t)width * height * pixelSize;
+    const size_t encodedSliceSize = gfxstream::host::getBcnEncodedSize(bcnFormat, width, height);
+
+    out->resize(encodedSliceSize * depth);
+    for (GLsizei i = 0; i < depth; i++) {
+        if (!gfxstream::host::bcnEncode(bcnFormat,
+                                        static_cast<const uint8_t*>(pixels) + i * sliceSize,
+                                        width, height, pixelSize, width * pixelSize,
+                                        out->data() + i * encodedSliceSize, encodedSliceSize)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void doCompressedTexImage2DTranscoded(GLEScontext* ctx, GLenum target, GLint level,
+                                      GLenum internalformat, GLenum transcodedFormat,
+                                      GLsizei width, GLsizei height, GLint border,
+                                      GLsizei imageSize, const GLvoid* data) {
+    bool needUnpackBuffer = false;
+    if (ctx->getMajorVersion() >= 3) {
+        GLint unpackBuffer = 0;
+        ctx->dispatcher().glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &unpackBuffer);
+        needUnpackBuffer = unpackBuffer;
+    }
+    TextureUnpackReset unpack(ctx);
+    std::unique_ptr<ScopedFetchUnpackData> unpackData;
+    if (needUnpackBuffer) {
+        unpackData.reset(
+            new ScopedFetchUnpackData(ctx, reinterpret_cast<GLintptr>(data), imageSize));
+        data = unpackData->data();
+        SET_ERROR_IF(!data, GL_INVALID_OPERATION);
+    }
+
+    std::vector<uint8_t> encoded;
+    const GLenum err = transcodeToBcn(internalformat, transcodedFormat, width, height, imageSize,
+                                      data, &encoded);
+    SET_ERROR_IF(err != GL_NO_ERROR, err);
+
+    ctx->dispatcher().glCompressedTexImage2D(target, level, transcodedFormat, width, height,
+                                             border, encoded.size(), encoded.data());
+}
+
+void doCompressedTexSubImage2DTranscoded(GLEScontext* ctx, GLenum target, GLint level,
+                                         GLint xoffset, GLint yoffset, GLsizei width,
+                                         GLsizei height, GLenum format,
+                                         GLenum transcodedFormat, GLsizei imageSize,
+                                         const GLvoid* data) {
+    SET_ERROR_IF(xoffset % 4 || yoffset % 4, GL_INVALID_OPERATION);
+    bool needUnpackBuffer = false;
+    if (ctx->getMajorVersion() >= 3) {
+        GLint unpackBuffer = 0;
+        ctx->dispatcher().glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &unpackBuffer);
+        needUnpackBuffer = unpackBuffer;
+    }
+    TextureUnpackReset unpack(ctx);
+    std::unique_ptr<ScopedFetchUnpackData> unpackData;
+    if (needUnpackBuffer) {
+        unpackData.reset(
+            new ScopedFetchUnpackData(ctx, reinterpret_cast<GLintptr>(data), imageSize));
+        data = unpackData->data();
+        SET_ERROR_IF(!data, GL_INVALID_OPERATION);
+    }
+
+    std::vector<uint8_t> encoded;
+    const GLenum err =
+        transcodeToBcn(format, transcodedFormat, width, height, imageSize, data, &encoded);
+    SET_ERROR_IF(err != GL_NO_ERROR, err);
+
+    ctx->dispatcher().glCompressedTexSubImage2D(target, level, xoffset, yoffset, width, height,
+                                                transcodedFormat, encoded.size(), encoded.data());
+}
+
+void doCompressedTexImage3DTranscoded(GLEScontext* ctx, GLenum target, GLint level,
+                                      GLenum internalformat, GLenum transcodedFormat,
+                                      GLsizei width, GLsizei height, GLsizei depth, GLint border,
+                                      GLsizei imageSize, const GLvoid* data) {
+    GLint unpackBuffer = 0;
+    ctx->dispatcher().glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &unpackBuffer);
+    TextureUnpackReset unpack(ctx);
+    std::unique_ptr<ScopedFetchUnpackData> unpackData;
+    if (unpackBuffer) {
+        unpackData.reset(
+            new ScopedFetchUnpackData(ctx, reinterpret_cast<GLintptr>(data), imageSize));
+        data = unpackData->data();
+        SET_ERROR_IF(!data, GL_INVALID_OPERATION);
+    }
+
+    std::vector<uint8_t> encoded;
+    const GLenum err = transcodeSlicesToBcn(internalformat, transcodedFormat, width, height,
+                                            depth, imageSize, data, &encoded);
+    SET_ERROR_IF(err != GL_NO_ERROR, err);
+
+    ctx->dispatcher().glCompressedTexImage3D(target, level, transcodedFormat, width, height,
+                                             depth, border, encoded.size(), encoded.data());
+}
+
+void doCompressedTexSubImage3DTranscoded(GLEScontext* ctx, GLenum target, GLint level,
+                                         GLint xoffset, GLint yoffset, GLint zoffset,
+                                         GLsizei width, GLsizei height, GLsizei depth,
+                                         GLenum format, GLenum transcodedFormat,
+                                         GLsizei imageSize, const GLvoid* data) {
+    SET_ERROR_IF(xoffset % 4 || yoffset % 4, GL_INVALID_OPERATION);
+    GLint unpackBuffer = 0;
+    ctx->dispatcher().glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &unpackBuffer);
+    TextureUnpackReset unpack(ctx);
+    std::unique_ptr<ScopedFetchUnpackData> unpackData;
+    if (unpackBuffer) {
+        unpackData.reset(
+            new ScopedFetchUnpackData(ctx, reinterpret_cast<GLintptr>(data), imageSize));
+        data = unpackData->data();
+        SET_ERROR_IF(!data, GL_INVALID_OPERATION);
+    }
+
+    std::vector<uint8_t> encoded;
+    const GLenum err = transcodeSlicesToBcn(format, transcodedFormat, width, height, depth,
+                                            imageSize, data, &encoded);
+    SET_ERROR_IF(err != GL_NO_ERROR, err);
+
+    ctx->dispatcher().glCompressedTexSubImage3D(target, level, xoffset, yoffset, zoffset, width,
+                                                height, depth, transcodedFormat, encoded.size(),
+                                                encoded.data());
+}
+
 void forEachEtc2Format(std::function<void(GLint format)> f) {
     f(GL_COMPRESSED_RGB8_ETC2);
     f(GL_COMPRESSED_SRGB8_ETC2);
@@ -896,6 +1337,14 @@ bool isEtc2OrAstcFormat(GLenum format) {
     return isAstcFormat(format);
 }
 
+void setDecodedTextureCacheEnabled(bool enabled) {
+    DecodedTextureCache::get().setEnabled(enabled);
+}
+
+void setEtcComputeDecodeEnabled(bool enabled) {
+    EtcComputeDecoder::setEnabled(enabled);
+}
+
 bool shouldPassthroughCompressedFormat(GLEScontext* ctx, GLenum internalformat) {
     if (isEtc2Format(internalformat)) {
         return ctx->getCaps()->hasEtc2Support;
@@ -0,0 +1,61 @@
+// Copyright 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#pragma once
+
+#include <GLES3/gl31.h>
+
+#include <functional>
+#include <memory>
+
+#include "gfxstream/etc.h"
+
+// Decodes ETC1/ETC2/EAC images with a GL compute shader instead of etc2_decode_image().
+//
+// The compressed blocks are uploaded into a buffer object and the shader writes the decoded
+// texels into the same buffer, laid out exactly like the output of etc2_decode_image(): tightly
+// packed texels of etc_get_decoded_pixel_size() bytes in rows of `stride` bytes. The result is
+// then consumed through GL_PIXEL_UNPACK_BUFFER so the decoded image never touches the CPU.
+//
+// An instance belongs to one GLEScontext and must only be used while that context is current.
+class EtcComputeDecoder {
+   public:
+    // Returns nullptr if the current context cannot run compute shaders.
+    static std::unique_ptr<EtcComputeDecoder> create(bool isGles);
+
+    // Process wide switch, off by default, that contexts check before using their decoder.
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    ~EtcComputeDecoder();
+
+    // Called with GL_PIXEL_UNPACK_BUFFER bound to the decoded image. `pixels` is the offset of
+    // the image in that buffer and must be passed on as the glTex(Sub)Image2D data pointer.
+    using UploadFunc = std::function<void(const GLvoid* pixels)>;
+
+    // Decodes `data`, which must hold etc_get_encoded_data_size(format, width, height) bytes,
+    // and calls `upload`. All GL state touched here is restored before returning. Returns false
+    // without calling `upload` if the image could not be decoded on the GPU.
+    bool decode(ETC2ImageFormat format, const void* data, GLsizei width, GLsizei height,
+                GLsizei stride, const UploadFunc& upload);
+
+   private:
+    EtcComputeDecoder() = default;
+
+    GLuint mProgram = 0;
+    GLuint mBuffer = 0;
+    GLint mFormatLoc = -1;
+    GLint mExtentLoc = -1;
+    GLint mRowPitchLoc = -1;
+    GLint mDstOffsetLoc = -1;
+};
@@ -123,6 +123,7 @@ struct GLSupport {
     bool hasAstcSupport = false;
     bool hasBptcSupport = false;
     bool hasS3tcSupport = false;
+    bool hasS3tcSrgbSupport = false;
     bool hasRgtcSupport = false;
 };
 
@@ -224,6 +225,7 @@ struct VAOStateRef {
     VAOStateMap::iterator it;
 };
 
+class EtcComputeDecoder;
 class FramebufferData;
 
 class GLESConversionArrays
@@ -471,6 +473,10 @@ public:
         GLsizei width, GLsizei height,
         GLint border);
 
+    // Returns the compute shader ETC2/EAC decoder of this context, or nullptr
+    // if the host GL cannot run it. Created on first use.
+    EtcComputeDecoder* getEtcComputeDecoder();
+
     // Primitive restart emulation
     void setPrimitiveRestartEnabled(bool enabled);
     bool primitiveRestartEnabled() const {
@@ -512,7 +518,16 @@ public:
 
     bool programBinaryLinkStatusEnabled() const { return m_programBinaryLinkStatusEnabled; }
 
+    // Issues the draws that the context held back to coalesce them with the
+    // following ones, see GLESv2Context::addPendingDraw().
+    void flushPendingDraws() {
+        if (m_hasPendingDraws) {
+            onFlushPendingDraws();
+        }
+    }
+
 protected:
+    virtual void onFlushPendingDraws() {}
     void initDefaultFboImpl(
         GLint width, GLint height,
         GLint colorFormat, GLint depthstencilFormat,
@@ -667,6 +682,9 @@ protected:
     GLuint m_textureEmulationVBO = 0;
     GLuint m_textureEmulationSamplerLoc = 0;
 
+    std::unique_ptr<EtcComputeDecoder> m_etcComputeDecoder;
+    bool m_etcComputeDecoderInitialized = false;
+
     std::function<GLESbuffer*(GLuint)> getBufferObj
             = [this] (GLuint bufferName) -> GLESbuffer* {
                 return (GLESbuffer*)m_shareGroup->getObjectData(
@@ -679,6 +697,8 @@ protected:
     bool m_nativeTextureDecompressionEnabled = false;
     bool m_programBinaryLinkStatusEnabled = false;
 
+    bool m_hasPendingDraws = false;
+
 private:
 
     GLenum                m_glError = GL_NO_ERROR;
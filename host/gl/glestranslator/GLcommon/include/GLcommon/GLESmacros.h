@@ -25,18 +25,28 @@
         return ret;                                                                            \
     }
 
+// Every GL function first issues the draws that the context held back to
+// coalesce them, see GLEScontext::flushPendingDraws(), so that they execute
+// in order with what the function does.
 #define GET_CTX()                                                             \
     FAIL_IF(!s_eglIface, "null s_eglIface")                                   \
     GLEScontext* ctx = s_eglIface->getGLESContext();                          \
-    FAIL_IF(!ctx, "null ctx")
+    FAIL_IF(!ctx, "null ctx")                                                 \
+    ctx->flushPendingDraws();
 
 #define GET_CTX_CM()                                                          \
     FAIL_IF(!s_eglIface, "null s_eglIface")                                   \
     GLEScmContext* ctx =                                                      \
             static_cast<GLEScmContext*>(s_eglIface->getGLESContext());        \
-    FAIL_IF(!ctx, "null ctx")
+    FAIL_IF(!ctx, "null ctx")                                                 \
+    ctx->flushPendingDraws();
 
 #define GET_CTX_V2()                                                          \
+    GET_CTX_V2_KEEP_PENDING_DRAWS()                                           \
+    ctx->flushPendingDraws();
+
+// Only for the draws that may join the pending ones instead.
+#define GET_CTX_V2_KEEP_PENDING_DRAWS()                                       \
     FAIL_IF(!s_eglIface, "null s_eglIface")                                   \
     GLESv2Context* ctx =                                                      \
             static_cast<GLESv2Context*>(s_eglIface->getGLESContext());        \
@@ -45,19 +55,22 @@
 #define GET_CTX_RET(failure_ret)                                              \
     RET_AND_FAIL_IF(!s_eglIface, "null s_eglIface", failure_ret)              \
     GLEScontext* ctx = s_eglIface->getGLESContext();                          \
-    RET_AND_FAIL_IF(!ctx, "null ctx", failure_ret)
+    RET_AND_FAIL_IF(!ctx, "null ctx", failure_ret)                            \
+    ctx->flushPendingDraws();
 
 #define GET_CTX_CM_RET(failure_ret)                                           \
     RET_AND_FAIL_IF(!s_eglIface, "null s_eglIface", failure_ret)              \
     GLEScmContext* ctx =                                                      \
             static_cast<GLEScmContext*>(s_eglIface->getGLESContext());        \
-    RET_AND_FAIL_IF(!ctx, "null ctx", failure_ret)
+    RET_AND_FAIL_IF(!ctx, "null ctx", failure_ret)                            \
+    ctx->flushPendingDraws();
 
 #define GET_CTX_V2_RET(failure_ret)                                           \
     RET_AND_FAIL_IF(!s_eglIface, "null s_eglIface", failure_ret)              \
     GLESv2Context* ctx =                                                      \
             static_cast<GLESv2Context*>(s_eglIface->getGLESContext());        \
-    RET_AND_FAIL_IF(!ctx, "null ctx", failure_ret)
+    RET_AND_FAIL_IF(!ctx, "null ctx", failure_ret)                            \
+    ctx->flushPendingDraws();
 
 #define SET_ERROR_IF(condition,err) if((condition)) {                            \
                         fprintf(stderr, "%s:%s:%d error 0x%x\n", __FILE__, __FUNCTION__, __LINE__, err); \
@@ -0,0 +1,34 @@
+// Copyright 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+// Splits [0, count) into contiguous ranges and calls `decode(begin, end)` for each of them, on a
+// thread pool shared by the CPU texture decoders of all contexts as well as on the calling
+// thread. Returns once every range has been decoded.
+//
+// `bytesPerItem` is the approximate amount of output produced per item. Jobs too small to
+// amortize the hand-off run entirely on the calling thread, as do calls made from a pool thread.
+// The pool has one thread per core, up to 4, and is not used on single core hosts. The
+// ranges must not depend on each other, so that the output does not depend on how the
+// work was split.
+void parallelTextureDecode(uint32_t count, size_t bytesPerItem,
+                           const std::function<void(uint32_t begin, uint32_t end)>& decode);
+
+// Replaces the shared pool with one of `threads` threads, or with none if `threads` is 0 or 1.
+// Must not be called while a decode is in progress.
+void setTextureDecodeThreadCountForTesting(int threads);
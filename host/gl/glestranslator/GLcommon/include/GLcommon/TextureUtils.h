@@ -22,6 +22,7 @@
 #include "rgtc.h"
 
 #include <functional>
+#include <vector>
 #include <GLES/gl.h>
 #include <GLES/glext.h>
 
@@ -93,8 +94,49 @@ void forEachS3tcForamt(std::function<void(GLint format)>);
 
 bool isEtc2OrAstcFormat(GLenum format);
 
+// Enables the process wide cache of decoded ETC2 images and BCn transcodes.
+void setDecodedTextureCacheEnabled(bool enabled);
+
+// Lets contexts decode ETC2/EAC images with compute shaders. Off by default.
+void setEtcComputeDecodeEnabled(bool enabled);
+
+// Lets contexts re-encode emulated ETC2/EAC/ASTC images to BCn. Off by default.
+void setBcnTranscodeEnabled(bool enabled);
+
 bool shouldPassthroughCompressedFormat(GLEScontext* ctx, GLenum internalformat);
 
+// Returns the BCn format an emulated ETC2/EAC/ASTC format should be re-encoded
+// to so that it stays compressed in host VRAM, or 0 if it should be fully
+// decompressed instead.
+GLenum getBcnTranscodeFormat(GLEScontext* ctx, GLenum compressedFormat);
+// Whether a texture created with |compressedFormat| is stored as a transcoded
+// |internalFormat| on the host.
+bool isBcnTranscodedTexture(GLenum compressedFormat, GLenum internalFormat);
+// Uncompressed format and type that can be used to read back a transcoded texture.
+void getBcnTranscodeReadbackFormat(GLenum transcodedFormat, GLenum* format, GLenum* type);
+// Encodes |depth| slices of texels read back as getBcnTranscodeReadbackFormat() into
+// |transcodedFormat|, to restore a transcoded texture from a snapshot.
+bool encodeBcnTranscodedTexels(GLenum transcodedFormat, const void* pixels, GLsizei width,
+                               GLsizei height, GLsizei depth, std::vector<uint8_t>* out);
+void doCompressedTexImage2DTranscoded(GLEScontext* ctx, GLenum target, GLint level,
+                                      GLenum internalformat, GLenum transcodedFormat,
+                                      GLsizei width, GLsizei height, GLint border,
+                                      GLsizei imageSize, const GLvoid* data);
+void doCompressedTexSubImage2DTranscoded(GLEScontext* ctx, GLenum target, GLint level,
+                                         GLint xoffset, GLint yoffset, GLsizei width,
+                                         GLsizei height, GLenum format,
+                                         GLenum transcodedFormat, GLsizei imageSize,
+                                         const GLvoid* data);
+void doCompressedTexImage3DTranscoded(GLEScontext* ctx, GLenum target, GLint level,
+                                      GLenum internalformat, GLenum transcodedFormat,
+                                      GLsizei width, GLsizei height, GLsizei depth, GLint border,
+                                      GLsizei imageSize, const GLvoid* data);
+void doCompressedTexSubImage3DTranscoded(GLEScontext* ctx, GLenum target, GLint level,
+                                         GLint xoffset, GLint yoffset, GLint zoffset,
+                                         GLsizei width, GLsizei height, GLsizei depth,
+                                         GLenum format, GLenum transcodedFormat,
+                                         GLsizei imageSize, const GLvoid* data);
+
 uint32_t texImageSize(GLenum internalformat,
                       GLenum type,
                       int unpackAlignment,
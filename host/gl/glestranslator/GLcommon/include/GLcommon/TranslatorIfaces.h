@@ -96,7 +96,7 @@ namespace android_studio {
 typedef struct {
     void (*initGLESx)(bool isGles2Gles);
     GLEScontext*                                    (*createGLESContext)(int majorVersion, int minorVersion, GlobalNameSpace* globalNameSpace, gfxstream::Stream* stream);
-    void                                            (*initContext)(GLEScontext*, ShareGroupPtr, bool, bool);
+    void                                            (*initContext)(GLEScontext*, ShareGroupPtr, bool, bool, bool);
     void                                            (*setMaxGlesVersion)(GLESVersion);
     void                                            (*deleteGLESContext)(GLEScontext*);
     void                                            (*flush)();
@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include "GLcommon/rgtc.h"
+#include "GLcommon/TextureDecodeThreadPool.h"
+#include <algorithm>
 #include <cstring>
 #include <assert.h>
 #include <type_traits>
@@ -69,11 +71,17 @@ struct get_expand_type<uint8_t> {
     typedef uint32_t type;
 };
 
+// Decodes one channel of a 4x4 block straight into the |cols| x |rows| texels at |out|, which
+// are |texel_size| bytes apart in a row and |stride| bytes apart between rows. d0 and d1 are
+// the extremes used by the 6 value mode: 0.0 and 1.0 for unorm, -1.0 and 1.0 for snorm, in
+// the 8 bit encoding of the channel.
 template <class T>
-void rgtc_decode_subblock(const uint32_t* data, T* out, int step, T d0, T d1 ) {
-    T r0 = static_cast<T>(data[0] & 0xff);
-    T r1 = static_cast<T>((data[0] >> 8) & 0xff);
-    uint64_t color_indexs = ((uint64_t)data[1] << 32 | data[0]) >> 16;
+void rgtc_decode_subblock(const uint8_t* data, uint8_t* out, uint32_t stride, size_t texel_size,
+                          uint32_t cols, uint32_t rows, T d0, T d1) {
+    uint64_t bits;
+    std::memcpy(&bits, data, sizeof(bits));
+    T r0 = static_cast<T>(bits & 0xff);
+    T r1 = static_cast<T>((bits >> 8) & 0xff);
     T colors[8] = {r0, r1,};
     typename get_expand_type<T>::type c0 = r0;
     typename get_expand_type<T>::type c1 = r1;
@@ -90,55 +98,61 @@ void rgtc_decode_subblock(const uint32_t* data, T* out, int step, T d0, T d1 ) {
         colors[6] = d0;
         colors[7] = d1;
     }
-    uint64_t index = color_indexs;
-    for (int i = 0 ; i < 16 ; i ++) {
-        *out = colors[index & 0x7];
-        out += step;
-        index >>= 3;
+    // 3 bit indices, 4 per row.
+    const uint64_t index = bits >> 16;
+    for (uint32_t cy = 0; cy < rows; cy++) {
+        uint32_t row_index = static_cast<uint32_t>(index >> (12 * cy));
+        T* row = reinterpret_cast<T*>(out + cy * stride);
+        for (uint32_t cx = 0; cx < cols; cx++) {
+            row[cx * texel_size] = colors[row_index & 0x7];
+            row_index >>= 3;
+        }
+    }
+}
+
+// Decodes one row of blocks, i.e. up to 4 rows of texels.
+static void rgtc_decode_block_row(const uint8_t* in, RGTCImageFormat format, uint8_t* out,
+                                  uint32_t width, uint32_t rows, uint32_t stride) {
+    const size_t data_block_size = rgtc_get_block_size(format);
+    const size_t texel_size = rgtc_get_decoded_pixel_size(format);
+    for (uint32_t x = 0; x < width; x += kBlockSize) {
+        const uint32_t cols = std::min<uint32_t>(width - x, kBlockSize);
+        uint8_t* block_out = out + x * texel_size;
+        switch (format) {
+        case BC4_UNORM:
+            rgtc_decode_subblock<uint8_t>(in, block_out, stride, texel_size, cols, rows, 0, 255);
+            break;
+        case BC4_SNORM:
+            rgtc_decode_subblock<int8_t>(in, block_out, stride, texel_size, cols, rows, -127, 127);
+            break;
+        case BC5_UNORM:
+            // Red and green are interleaved by writing every other byte.
+            rgtc_decode_subblock<uint8_t>(in, block_out, stride, texel_size, cols, rows, 0, 255);
+            rgtc_decode_subblock<uint8_t>(in + 8, block_out + 1, stride, texel_size, cols, rows,
+                                          0, 255);
+            break;
+        case BC5_SNORM:
+            rgtc_decode_subblock<int8_t>(in, block_out, stride, texel_size, cols, rows, -127, 127);
+            rgtc_decode_subblock<int8_t>(in + 8, block_out + 1, stride, texel_size, cols, rows,
+                                         -127, 127);
+            break;
+        }
+        in += data_block_size;
     }
 }
 
 int rgtc_decode_image(const uint8_t* in, RGTCImageFormat format, uint8_t* out, uint32_t width,
                       uint32_t height, uint32_t stride) {
-    size_t data_block_size = rgtc_get_block_size(format);
-    size_t texel_size = rgtc_get_decoded_pixel_size(format);
-    const uint8_t* data_in = in;
-    // BC5 2 bytes per pixel
-    uint8_t pixels[kBlockSize * kBlockSize * 2];
-    for (uint32_t y = 0; y < height; y += kBlockSize) {
-        uint32_t yEnd = height - y;
-        if (yEnd > kBlockSize) {
-            yEnd = kBlockSize;
+    const uint32_t block_rows = (height + kBlockSize - 1) / kBlockSize;
+    const size_t block_row_size = rgtc_get_encoded_image_size(format, width, 1);
+    const size_t decoded_block_row_size = size_t(kBlockSize) * stride;
+    parallelTextureDecode(block_rows, decoded_block_row_size, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t by = begin; by < end; by++) {
+            const uint32_t y = by * kBlockSize;
+            rgtc_decode_block_row(in + by * block_row_size, format, out + y * stride, width,
+                                  std::min<uint32_t>(height - y, kBlockSize), stride);
         }
-        for (uint32_t x = 0; x < width; x += kBlockSize) {
-            uint32_t xEnd = width - x;
-            if (xEnd > kBlockSize) {
-                xEnd = kBlockSize;
-            }
-            switch (format) {
-            case BC4_UNORM:
-                rgtc_decode_subblock<uint8_t>((const uint32_t*)data_in, pixels, 1, 0, 1);
-                break;
-            case BC4_SNORM:
-                rgtc_decode_subblock<int8_t>((const uint32_t*)data_in, (int8_t*)pixels, 1, -1, 1);
-                break;
-            case BC5_UNORM:
-                rgtc_decode_subblock<uint8_t>((const uint32_t*)data_in, pixels, 2, 0, 1);
-                rgtc_decode_subblock<uint8_t>((const uint32_t*)data_in + 2, pixels + 1, 2, 0, 1);
-                break;
-            case BC5_SNORM:
-                rgtc_decode_subblock<int8_t>((const uint32_t*)data_in, (int8_t*)pixels, 2, -1, 1);
-                rgtc_decode_subblock<int8_t>((const uint32_t*)data_in + 2, (int8_t*)(pixels + 1),
-                                             2, -1, 1);
-                break;
-            }
-            for (uint32_t cy = 0; cy < yEnd; cy ++) {
-                uint8_t* data_out = out + (y + cy) * stride + x * texel_size;
-                std::memcpy(data_out, pixels + kBlockSize * texel_size * cy, texel_size * xEnd);
-            }
-            data_in += data_block_size;
-        }
-    }
+    });
     return 0;
 }
 
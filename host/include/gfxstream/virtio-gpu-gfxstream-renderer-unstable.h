@@ -72,6 +72,14 @@ typedef void (*stream_renderer_param_metrics_callback_add_vulkan_out_of_memory_e
 // terminated string of the form "<feature1 name>:[enabled|disabled],<feature 2 ...>".
 #define STREAM_RENDERER_PARAM_RENDERER_FEATURES 11
 
+// GPU memory that the ColorBuffers of the guest may take, in MiB, before idle ones are moved to
+// system memory. 0 disables the evictions. Only used with the ColorBufferEviction feature.
+#define STREAM_RENDERER_PARAM_COLOR_BUFFER_BUDGET_MB 12
+
+// Time in milliseconds that a ColorBuffer must go unused before it may be moved to system memory.
+// Only used with the ColorBufferEviction feature.
+#define STREAM_RENDERER_PARAM_COLOR_BUFFER_EVICTION_MIN_IDLE_MS 13
+
 #define STREAM_RENDERER_PARAM_METRICS_CALLBACK_SET_ANNOTATION 1028
 typedef void (*stream_renderer_param_metrics_callback_set_annotation)(const char* key,
                                                                       const char* value);
@@ -79,6 +87,31 @@ typedef void (*stream_renderer_param_metrics_callback_set_annotation)(const char
 #define STREAM_RENDERER_PARAM_METRICS_CALLBACK_ABORT 1029
 typedef void (*stream_renderer_param_metrics_callback_abort)();
 
+// Stages of `stream_renderer_snapshot()` and `stream_renderer_restore()`. The stages of a
+// snapshot run concurrently. The stages of a restore read their files concurrently but are
+// applied in order.
+#define STREAM_RENDERER_SNAPSHOT_STAGE_RENDERER 0
+#define STREAM_RENDERER_SNAPSHOT_STAGE_FRONTEND 1
+#define STREAM_RENDERER_SNAPSHOT_STAGE_ASG 2
+
+struct stream_renderer_snapshot_progress {
+    // One of STREAM_RENDERER_SNAPSHOT_STAGE_*.
+    uint32_t stage;
+    // 1 if the stage is part of a restore, 0 if it is part of a snapshot.
+    uint32_t is_restore;
+    // 0 on success, negative on failure.
+    int32_t result;
+    // Time spent working on the stage, not counting time spent waiting for other stages.
+    uint64_t duration_us;
+};
+
+// STREAM_RENDERER_PARAM_SNAPSHOT_PROGRESS_CALLBACK: A function of the type
+// `stream_renderer_snapshot_progress_callback`, called with the user data once each stage of a
+// snapshot or restore finishes. It may be called concurrently from several threads.
+#define STREAM_RENDERER_PARAM_SNAPSHOT_PROGRESS_CALLBACK 1030
+typedef void (*stream_renderer_snapshot_progress_callback)(
+    void* user_data, const struct stream_renderer_snapshot_progress* progress);
+
 VG_EXPORT void gfxstream_backend_setup_window(void* native_window_handle, int32_t window_x,
                                               int32_t window_y, int32_t window_width,
                                               int32_t window_height, int32_t fb_width,
@@ -86,6 +119,50 @@ VG_EXPORT void gfxstream_backend_setup_window(void* native_window_handle, int32_
 
 VG_EXPORT void stream_renderer_flush(uint32_t res_handle);
 
+// The types of operations of `stream_renderer_submit_batch()`.
+#define STREAM_RENDERER_BATCH_OP_SUBMIT_CMD 1
+#define STREAM_RENDERER_BATCH_OP_TRANSFER_WRITE 2
+#define STREAM_RENDERER_BATCH_OP_CREATE_FENCE 3
+#define STREAM_RENDERER_BATCH_OP_FLUSH 4
+
+// The arguments of `stream_renderer_transfer_write_iov()`.
+struct stream_renderer_transfer {
+    uint32_t res_handle;
+    uint32_t ctx_id;
+    int32_t level;
+    uint32_t stride;
+    uint32_t layer_stride;
+    struct stream_renderer_box box;
+    uint64_t offset;
+    struct iovec* iovecs;
+    uint32_t num_iovecs;
+};
+
+struct stream_renderer_batch_op {
+    // One of STREAM_RENDERER_BATCH_OP_*, which selects the member of `data` that is used.
+    uint32_t type;
+    // Set by `stream_renderer_submit_batch()` to what the equivalent single call returns, or
+    // 0 for calls that do not return anything.
+    int32_t result;
+    union {
+        // STREAM_RENDERER_BATCH_OP_SUBMIT_CMD: as `stream_renderer_submit_cmd()`.
+        struct stream_renderer_command cmd;
+        // STREAM_RENDERER_BATCH_OP_TRANSFER_WRITE: as `stream_renderer_transfer_write_iov()`.
+        struct stream_renderer_transfer transfer;
+        // STREAM_RENDERER_BATCH_OP_CREATE_FENCE: as `stream_renderer_create_fence()`.
+        struct stream_renderer_fence fence;
+        // STREAM_RENDERER_BATCH_OP_FLUSH: as `stream_renderer_flush()`.
+        uint32_t flush_res_handle;
+    } data;
+};
+
+// Processes `ops` in order, with the same effects as making the equivalent calls one by one,
+// typically for all of the commands of a virtqueue at once. Consecutive transfers to the same
+// resource update the backend resource only once and consecutive fences on the same ring are
+// signaled together. Every operation is processed even if an earlier one fails.
+// Returns 0 if all of the operations succeeded and the first failure otherwise.
+VG_EXPORT int stream_renderer_submit_batch(struct stream_renderer_batch_op* ops, uint32_t num_ops);
+
 VG_EXPORT void* stream_renderer_platform_create_shared_egl_context(void);
 VG_EXPORT int stream_renderer_platform_destroy_shared_egl_context(void*);
 
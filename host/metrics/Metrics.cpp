@@ -37,6 +37,8 @@ constexpr int64_t kEmulatorGraphicsBadPacketLength = 10031;
 constexpr int64_t kEmulatorGraphicsDuplicateSequenceNum = 10032;
 constexpr int64_t kEmulatorGraphicsHangOther = 10034;
 constexpr int64_t kEmulatorGraphicsUnHangOther = 10035;
+constexpr int64_t kEmulatorGraphicsColorBufferResidentBytes = 10036;
+constexpr int64_t kEmulatorGraphicsColorBufferEvictedBytes = 10037;
 
 constexpr int64_t kHangDepthMetricLimit = 10;
 
@@ -220,6 +222,15 @@ struct MetricTypeVisitor {
                 vkOutOfMemoryEvent.allocationSize.has_value());  // is_allocation
         }
     }
+
+    void operator()(const MetricEventColorBufferEviction evictionEvent) const {
+        if (MetricsLogger::add_instant_event_with_metric_callback) {
+            MetricsLogger::add_instant_event_with_metric_callback(
+                kEmulatorGraphicsColorBufferResidentBytes, evictionEvent.residentBytes);
+            MetricsLogger::add_instant_event_with_metric_callback(
+                kEmulatorGraphicsColorBufferEvictedBytes, evictionEvent.evictedBytes);
+        }
+    }
 };
 
 // MetricsLoggerImpl
@@ -99,11 +99,17 @@ struct MetricEventVulkanOutOfMemory {
     std::optional<int> line = std::nullopt;
     std::optional<uint64_t> allocationSize = std::nullopt;
 };
+// ColorBuffer memory of one guest after some of it was evicted to system memory.
+struct MetricEventColorBufferEviction {
+    int64_t residentBytes;
+    int64_t evictedBytes;
+};
 
 using MetricEventType =
     std::variant<std::monostate, MetricEventBadPacketLength, MetricEventDuplicateSequenceNum,
                  MetricEventFreeze, MetricEventUnFreeze, MetricEventHang, MetricEventUnHang,
-                 MetricEventVulkanOutOfMemory, GfxstreamVkAbort>;
+                 MetricEventVulkanOutOfMemory, MetricEventColorBufferEviction,
+                 GfxstreamVkAbort>;
 
 class MetricsLogger {
    public:
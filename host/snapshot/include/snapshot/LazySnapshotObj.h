@@ -17,6 +17,7 @@
 #pragma once
 
 #include <mutex>
+#include <utility>
 
 #include "render-utils/stream.h"
 
@@ -26,7 +27,9 @@ namespace gfxstream {
 // snapshot loading. It separates heavy-weight loading / restoring operations
 // and only triggers it when the object needs to be used.
 // Please implement heavy-weight loading / restoring operations in restore()
-// method and call "touch" before you need to use the object.
+// method and call "touch" before you need to use the object. If restore()
+// fails, it can set mNeedRestore back to true so that the next touch() tries
+// again.
 
 // An example is for texture lazy loading. On load it only reads the data from
 // disk but does not load them into GPU. On restore it performs the heavy-weight
@@ -49,8 +52,8 @@ class LazySnapshotObj {
         if (!mNeedRestore) {
             return;
         }
-        static_cast<Derived*>(this)->restore();
         mNeedRestore = false;
+        static_cast<Derived*>(this)->restore();
     }
 
     bool needRestore() const {
@@ -58,6 +61,22 @@ class LazySnapshotObj {
         return mNeedRestore;
     }
 
+    // Releases the heavy-weight state with Derived::onEvict(args...) until the
+    // next touch() brings it back with restore(). Returns false if the object
+    // was not restored yet or can not be evicted.
+    template <class... Args>
+    bool evict(Args&&... args) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mNeedRestore) {
+            return false;
+        }
+        if (!static_cast<Derived*>(this)->onEvict(std::forward<Args>(args)...)) {
+            return false;
+        }
+        mNeedRestore = true;
+        return true;
+    }
+
   protected:
     bool mNeedRestore = false;
 
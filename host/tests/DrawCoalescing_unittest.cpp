@@ -0,0 +1,158 @@
+// Copyright (C) 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "GLESv2Context.h"
+#include "gfxstream/host/testing/GLTestUtils.h"
+#include "gfxstream/host/testing/OpenGLTestContext.h"
+#include "gfxstream/host/testing/ShaderUtils.h"
+
+namespace gfxstream {
+namespace gl {
+namespace {
+
+const GLsizei kWidth = kTestSurfaceSize[0];
+const GLsizei kHeight = kTestSurfaceSize[1];
+
+const char kVertexShader[] = R"(
+attribute vec2 a_pos;
+void main() {
+    gl_Position = vec4(a_pos, 0.0, 1.0);
+}
+)";
+
+const char kFragmentShader[] = R"(
+precision mediump float;
+uniform vec4 u_color;
+void main() {
+    gl_FragColor = u_color;
+}
+)";
+
+// Two triangles covering the left half of the surface, then two covering the
+// right half.
+const GLfloat kVertices[] = {
+    -1.0f, -1.0f, 0.0f, -1.0f, 0.0f, 1.0f,
+    -1.0f, -1.0f, 0.0f, 1.0f,  -1.0f, 1.0f,
+    0.0f,  -1.0f, 1.0f, -1.0f, 1.0f, 1.0f,
+    0.0f,  -1.0f, 1.0f, 1.0f,  0.0f, 1.0f,
+};
+constexpr GLint kHalfVertexCount = 6;
+
+class DrawCoalescingTest : public GLTest {
+  protected:
+    void SetUp() override {
+        GLTest::SetUp();
+
+        // Contexts pick up the option when they are created.
+        const EGLDispatch* egl = LazyLoadedEGLDispatch::get();
+        ASSERT_NE(egl->eglSetDrawCoalescingEnabledANDROID, nullptr);
+        ASSERT_EQ(EGL_TRUE, egl->eglSetDrawCoalescingEnabledANDROID(m_display, EGL_TRUE));
+        mCoalescingContext = createContext(m_display, m_config, 3, 0);
+        ASSERT_NE(EGL_NO_CONTEXT, mCoalescingContext);
+        ASSERT_EQ(EGL_TRUE,
+                  egl->eglMakeCurrent(m_display, m_surface, m_surface, mCoalescingContext));
+
+        mProgram = compileAndLinkShaderProgram(kVertexShader, kFragmentShader);
+        ASSERT_NE(0, mProgram);
+        gl->glUseProgram(mProgram);
+        mColorLocation = gl->glGetUniformLocation(mProgram, "u_color");
+
+        gl->glGenBuffers(1, &mBuffer);
+        gl->glBindBuffer(GL_ARRAY_BUFFER, mBuffer);
+        gl->glBufferData(GL_ARRAY_BUFFER, sizeof(kVertices), kVertices, GL_STATIC_DRAW);
+        const GLint position = gl->glGetAttribLocation(mProgram, "a_pos");
+        gl->glEnableVertexAttribArray(position);
+        gl->glVertexAttribPointer(position, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+        gl->glViewport(0, 0, kWidth, kHeight);
+        gl->glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        gl->glClear(GL_COLOR_BUFFER_BIT);
+        EXPECT_EQ(GL_NO_ERROR, gl->glGetError());
+    }
+
+    void TearDown() override {
+        if (mCoalescingContext != EGL_NO_CONTEXT) {
+            gl->glDeleteBuffers(1, &mBuffer);
+            gl->glDeleteProgram(mProgram);
+
+            const EGLDispatch* egl = LazyLoadedEGLDispatch::get();
+            egl->eglMakeCurrent(m_display, m_surface, m_surface, m_context);
+            destroyContext(m_display, mCoalescingContext);
+            egl->eglSetDrawCoalescingEnabledANDROID(m_display, EGL_FALSE);
+        }
+        GLTest::TearDown();
+    }
+
+    // Returns the RGBA8888 color of the pixel in the middle of the left or
+    // right half of the surface.
+    std::vector<uint8_t> readHalf(bool right) {
+        std::vector<uint8_t> pixel(4);
+        gl->glReadPixels(right ? kWidth * 3 / 4 : kWidth / 4, kHeight / 2, 1, 1, GL_RGBA,
+                         GL_UNSIGNED_BYTE, pixel.data());
+        EXPECT_EQ(GL_NO_ERROR, gl->glGetError());
+        return pixel;
+    }
+
+    EGLContext mCoalescingContext = EGL_NO_CONTEXT;
+    GLuint mProgram = 0;
+    GLint mColorLocation = -1;
+    GLuint mBuffer = 0;
+};
+
+const std::vector<uint8_t> kRed = {0xff, 0x00, 0x00, 0xff};
+const std::vector<uint8_t> kGreen = {0x00, 0xff, 0x00, 0xff};
+
+TEST_F(DrawCoalescingTest, MergesConsecutiveDraws) {
+    const GLESv2Context::DrawCoalescingStats before = GLESv2Context::getDrawCoalescingStats();
+
+    gl->glUniform4f(mColorLocation, 1.0f, 0.0f, 0.0f, 1.0f);
+    gl->glDrawArrays(GL_TRIANGLES, 0, kHalfVertexCount);
+    gl->glDrawArrays(GL_TRIANGLES, kHalfVertexCount, kHalfVertexCount);
+
+    // Reading back issues the pending draws.
+    EXPECT_EQ(kRed, readHalf(false));
+    EXPECT_EQ(kRed, readHalf(true));
+
+    const GLESv2Context::DrawCoalescingStats after = GLESv2Context::getDrawCoalescingStats();
+    // Host drivers without glMultiDrawArrays() get the draws one by one.
+    EMUGL_SKIP_TEST_IF(after.multiDraws == before.multiDraws);
+    EXPECT_EQ(before.coalescedDraws + 2, after.coalescedDraws);
+    EXPECT_EQ(before.multiDraws + 1, after.multiDraws);
+}
+
+TEST_F(DrawCoalescingTest, InterveningCallFlushesInOrder) {
+    const GLESv2Context::DrawCoalescingStats before = GLESv2Context::getDrawCoalescingStats();
+
+    // Both halves red, then the left half green with a uniform set in between.
+    gl->glUniform4f(mColorLocation, 1.0f, 0.0f, 0.0f, 1.0f);
+    gl->glDrawArrays(GL_TRIANGLES, 0, 2 * kHalfVertexCount);
+    gl->glUniform4f(mColorLocation, 0.0f, 1.0f, 0.0f, 1.0f);
+    gl->glDrawArrays(GL_TRIANGLES, 0, kHalfVertexCount);
+
+    EXPECT_EQ(kGreen, readHalf(false));
+    EXPECT_EQ(kRed, readHalf(true));
+
+    // Each draw was issued on its own.
+    const GLESv2Context::DrawCoalescingStats after = GLESv2Context::getDrawCoalescingStats();
+    EXPECT_EQ(before.coalescedDraws, after.coalescedDraws);
+    EXPECT_EQ(before.multiDraws, after.multiDraws);
+}
+
+}  // namespace
+}  // namespace gl
+}  // namespace gfxstream
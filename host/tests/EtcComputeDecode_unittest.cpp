@@ -0,0 +1,255 @@
+// Copyright (C) 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "gfxstream/host/testing/GLTestUtils.h"
+#include "gfxstream/host/testing/OpenGLTestContext.h"
+
+namespace gfxstream {
+namespace gl {
+namespace {
+
+// Not a multiple of the block size, so that partial blocks are decoded too.
+constexpr GLsizei kWidth = 37;
+constexpr GLsizei kHeight = 22;
+
+enum class BlockKind {
+    kColor,
+    kColorWithPunchthroughAlpha,
+    kEac,
+};
+
+struct EtcFormat {
+    GLenum internalformat;
+    // The color block of each 16 byte block comes after the EAC block.
+    BlockKind kinds[2];
+    int blockCount;
+    // The format and type that glReadPixels() reads the decoded texture with.
+    GLenum readType;
+};
+
+// The sRGB formats are left out: they decode exactly like their linear counterparts, and
+// GL_SRGB8 textures cannot be attached to a framebuffer to read them back.
+const EtcFormat kFormats[] = {
+    {GL_ETC1_RGB8_OES, {BlockKind::kColor}, 1, GL_UNSIGNED_BYTE},
+    {GL_COMPRESSED_RGB8_ETC2, {BlockKind::kColor}, 1, GL_UNSIGNED_BYTE},
+    {GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2, {BlockKind::kColorWithPunchthroughAlpha}, 1,
+     GL_UNSIGNED_BYTE},
+    {GL_COMPRESSED_RGBA8_ETC2_EAC, {BlockKind::kEac, BlockKind::kColor}, 2, GL_UNSIGNED_BYTE},
+    {GL_COMPRESSED_R11_EAC, {BlockKind::kEac}, 1, GL_FLOAT},
+    {GL_COMPRESSED_SIGNED_R11_EAC, {BlockKind::kEac}, 1, GL_FLOAT},
+    {GL_COMPRESSED_RG11_EAC, {BlockKind::kEac, BlockKind::kEac}, 2, GL_FLOAT},
+    {GL_COMPRESSED_SIGNED_RG11_EAC, {BlockKind::kEac, BlockKind::kEac}, 2, GL_FLOAT},
+};
+
+// Fills the 8 bytes at |block| with random bits, then forces the mode selected by |mode| so
+// that every image contains blocks of every mode.
+void makeColorBlock(std::mt19937& rng, int mode, bool punchthroughAlpha, uint8_t* block) {
+    for (int i = 0; i < 8; i++) {
+        block[i] = static_cast<uint8_t>(rng());
+    }
+
+    // Without punch-through alpha, the differential bit selects between the individual and
+    // the other modes. With it, the bit is the opaque bit and the individual mode is gone.
+    const bool differential = punchthroughAlpha ? true : mode != 0;
+    if (punchthroughAlpha) {
+        block[3] = (block[3] & ~0x02) | ((mode & 0x8) ? 0x02 : 0);
+    } else {
+        block[3] = (block[3] & ~0x02) | (differential ? 0x02 : 0);
+    }
+    if (!differential) {
+        return;
+    }
+
+    // In the differential layout, the T, H and planar modes are selected by the red, green
+    // or blue base color overflowing when its delta is added.
+    constexpr uint8_t kNoOverflow = 0x80;  // 16 + 0
+    constexpr uint8_t kOverflow = 0xf9;    // 31 + 1
+    switch (mode & 0x7) {
+        case 1:  // Differential.
+            block[0] = kNoOverflow;
+            block[1] = kNoOverflow;
+            block[2] = kNoOverflow;
+            break;
+        case 2:  // T.
+            block[0] = kOverflow;
+            break;
+        case 3:  // H.
+            block[0] = kNoOverflow;
+            block[1] = kOverflow;
+            break;
+        case 4:  // Planar.
+            block[0] = kNoOverflow;
+            block[1] = kNoOverflow;
+            block[2] = kOverflow;
+            break;
+        default:  // Whatever the random bits select.
+            break;
+    }
+}
+
+void makeEacBlock(std::mt19937& rng, int mode, uint8_t* block) {
+    for (int i = 0; i < 8; i++) {
+        block[i] = static_cast<uint8_t>(rng());
+    }
+    // A zero multiplier is special cased by the 11 bit formats.
+    if (mode % 4 == 0) {
+        block[1] &= 0x0f;
+    }
+}
+
+std::vector<uint8_t> makeImage(const EtcFormat& format) {
+    std::mt19937 rng(format.internalformat);
+
+    const int blocksX = (kWidth + 3) / 4;
+    const int blocksY = (kHeight + 3) / 4;
+    std::vector<uint8_t> data(blocksX * blocksY * format.blockCount * 8);
+    uint8_t* block = data.data();
+    for (int i = 0; i < blocksX * blocksY; i++) {
+        for (int j = 0; j < format.blockCount; j++) {
+            switch (format.kinds[j]) {
+                case BlockKind::kColor:
+                    makeColorBlock(rng, i % 5, false, block);
+                    break;
+                case BlockKind::kColorWithPunchthroughAlpha:
+                    makeColorBlock(rng, i % 5 + ((i / 5) % 2) * 8, true, block);
+                    break;
+                case BlockKind::kEac:
+                    makeEacBlock(rng, i, block);
+                    break;
+            }
+            block += 8;
+        }
+    }
+    return data;
+}
+
+class EtcComputeDecodeTest : public GLTest {
+  protected:
+    void TearDown() override {
+        setComputeDecodeEnabled(false);
+        GLTest::TearDown();
+    }
+
+    void setComputeDecodeEnabled(bool enabled) {
+        const EGLDispatch* egl = LazyLoadedEGLDispatch::get();
+        ASSERT_NE(egl->eglSetEtcComputeDecodeEnabledANDROID, nullptr);
+        EXPECT_EQ(EGL_TRUE, egl->eglSetEtcComputeDecodeEnabledANDROID(
+                                m_display, enabled ? EGL_TRUE : EGL_FALSE));
+    }
+
+    // Uploads |data| and returns the decoded texels as read back from the texture, or an
+    // empty vector if the decoded texture cannot be read back.
+    std::vector<uint8_t> decode(const EtcFormat& format, const std::vector<uint8_t>& data) {
+        GLuint texture = 0;
+        gl->glGenTextures(1, &texture);
+        gl->glBindTexture(GL_TEXTURE_2D, texture);
+        gl->glCompressedTexImage2D(GL_TEXTURE_2D, 0, format.internalformat, kWidth, kHeight, 0,
+                                   static_cast<GLsizei>(data.size()), data.data());
+        EXPECT_EQ(GL_NO_ERROR, gl->glGetError());
+
+        GLuint framebuffer = 0;
+        gl->glGenFramebuffers(1, &framebuffer);
+        gl->glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        gl->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture,
+                                   0);
+
+        std::vector<uint8_t> pixels;
+        if (gl->glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE) {
+            const size_t texelSize = format.readType == GL_FLOAT ? 4 * sizeof(float) : 4;
+            pixels.resize(kWidth * kHeight * texelSize);
+            gl->glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            gl->glReadPixels(0, 0, kWidth, kHeight, GL_RGBA, format.readType, pixels.data());
+            EXPECT_EQ(GL_NO_ERROR, gl->glGetError());
+        }
+
+        gl->glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        gl->glDeleteFramebuffers(1, &framebuffer);
+        gl->glDeleteTextures(1, &texture);
+        return pixels;
+    }
+};
+
+TEST_F(EtcComputeDecodeTest, MatchesCpuDecode) {
+    for (const EtcFormat& format : kFormats) {
+        SCOPED_TRACE(testing::Message() << "internalformat 0x" << std::hex << format.internalformat);
+        const std::vector<uint8_t> data = makeImage(format);
+
+        setComputeDecodeEnabled(false);
+        std::vector<uint8_t> cpuPixels = decode(format, data);
+
+        setComputeDecodeEnabled(true);
+        std::vector<uint8_t> computePixels = decode(format, data);
+
+        // Float color attachments are optional on some hosts.
+        if (cpuPixels.empty() && format.readType == GL_FLOAT) {
+            continue;
+        }
+        ASSERT_FALSE(cpuPixels.empty());
+        ASSERT_EQ(cpuPixels.size(), computePixels.size());
+        const int texelSize = static_cast<int>(cpuPixels.size() / (kWidth * kHeight));
+        EXPECT_TRUE(ImageMatches(kWidth, kHeight, texelSize, kWidth, cpuPixels.data(),
+                                 computePixels.data()));
+    }
+}
+
+TEST_F(EtcComputeDecodeTest, SubImageMatchesCpuDecode) {
+    const EtcFormat& format = kFormats[3];  // GL_COMPRESSED_RGBA8_ETC2_EAC
+    const std::vector<uint8_t> data = makeImage(format);
+    std::vector<uint8_t> pixels[2];
+
+    for (int compute = 0; compute < 2; compute++) {
+        setComputeDecodeEnabled(compute);
+
+        GLuint texture = 0;
+        gl->glGenTextures(1, &texture);
+        gl->glBindTexture(GL_TEXTURE_2D, texture);
+        gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, kWidth, kHeight, 0, GL_RGBA,
+                         GL_UNSIGNED_BYTE, nullptr);
+        gl->glCompressedTexImage2D(GL_TEXTURE_2D, 0, format.internalformat, kWidth, kHeight, 0,
+                                   static_cast<GLsizei>(data.size()), data.data());
+        // Replaces the first 2x2 blocks with the last ones of the image.
+        gl->glCompressedTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 8, 8, format.internalformat,
+                                      4 * 16, data.data() + data.size() - 4 * 16);
+        EXPECT_EQ(GL_NO_ERROR, gl->glGetError());
+
+        GLuint framebuffer = 0;
+        gl->glGenFramebuffers(1, &framebuffer);
+        gl->glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        gl->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture,
+                                   0);
+        ASSERT_EQ(GL_FRAMEBUFFER_COMPLETE, gl->glCheckFramebufferStatus(GL_FRAMEBUFFER));
+        pixels[compute].resize(kWidth * kHeight * 4);
+        gl->glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        gl->glReadPixels(0, 0, kWidth, kHeight, GL_RGBA, GL_UNSIGNED_BYTE,
+                         pixels[compute].data());
+        EXPECT_EQ(GL_NO_ERROR, gl->glGetError());
+
+        gl->glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        gl->glDeleteFramebuffers(1, &framebuffer);
+        gl->glDeleteTextures(1, &texture);
+    }
+
+    EXPECT_TRUE(ImageMatches(kWidth, kHeight, 4, kWidth, pixels[0].data(), pixels[1].data()));
+}
+
+}  // namespace
+}  // namespace gl
+}  // namespace gfxstream
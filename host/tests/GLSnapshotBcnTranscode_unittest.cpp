@@ -0,0 +1,237 @@
+// Copyright (C) 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <GLES3/gl3.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "GLcommon/GLutils.h"
+#include "gfxstream/host/testing/GLSnapshotTesting.h"
+#include "gfxstream/host/testing/GLTestUtils.h"
+#include "gfxstream/host/testing/ShaderUtils.h"
+
+namespace gfxstream {
+namespace gl {
+namespace {
+
+constexpr GLsizei kWidth = 16;
+constexpr GLsizei kHeight = 8;
+constexpr GLsizei kLayers = 3;
+// GL_COMPRESSED_RGBA8_ETC2_EAC, re-encoded to BC3 when the host has S3TC.
+constexpr GLenum kFormat = GL_COMPRESSED_RGBA8_ETC2_EAC;
+constexpr GLsizei kBlockSize = 16;
+constexpr GLsizei kSliceSize = (kWidth / 4) * (kHeight / 4) * kBlockSize;
+
+// A triangle covering the whole viewport.
+const char kVertexShader[] = R"(#version 300 es
+void main() {
+    vec2 pos = vec2(gl_VertexID == 1 ? 3.0 : -1.0, gl_VertexID == 2 ? 3.0 : -1.0);
+    gl_Position = vec4(pos, 0.0, 1.0);
+}
+)";
+
+const char kFragmentShader2D[] = R"(#version 300 es
+precision highp float;
+uniform highp sampler2D u_texture;
+out vec4 color;
+void main() {
+    color = texelFetch(u_texture, ivec2(gl_FragCoord.xy), 0);
+}
+)";
+
+const char kFragmentShaderArray[] = R"(#version 300 es
+precision highp float;
+uniform highp sampler2DArray u_texture;
+uniform int u_layer;
+out vec4 color;
+void main() {
+    color = texelFetch(u_texture, ivec3(ivec2(gl_FragCoord.xy), u_layer), 0);
+}
+)";
+
+std::vector<uint8_t> makeImage() {
+    std::mt19937 rng(kFormat);
+    std::vector<uint8_t> data(kSliceSize * kLayers);
+    for (uint8_t& byte : data) {
+        byte = static_cast<uint8_t>(rng());
+    }
+    return data;
+}
+
+class SnapshotBcnTranscodeTest : public SnapshotTest {
+  protected:
+    void TearDown() override {
+        setTranscodeEnabled(false);
+        SnapshotTest::TearDown();
+    }
+
+    void setTranscodeEnabled(bool enabled) {
+        const EGLDispatch* egl = LazyLoadedEGLDispatch::get();
+        ASSERT_NE(egl->eglSetBcnTranscodeEnabledANDROID, nullptr);
+        EXPECT_EQ(EGL_TRUE, egl->eglSetBcnTranscodeEnabledANDROID(
+                                m_display, enabled ? EGL_TRUE : EGL_FALSE));
+    }
+
+    GLuint create2D(const uint8_t* slice) {
+        GLuint texture = 0;
+        gl->glGenTextures(1, &texture);
+        gl->glBindTexture(GL_TEXTURE_2D, texture);
+        gl->glCompressedTexImage2D(GL_TEXTURE_2D, 0, kFormat, kWidth, kHeight, 0, kSliceSize,
+                                   slice);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        EXPECT_EQ(GL_NO_ERROR, gl->glGetError());
+        return texture;
+    }
+
+    GLuint createArray(const std::vector<uint8_t>& data) {
+        GLuint texture = 0;
+        gl->glGenTextures(1, &texture);
+        gl->glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        gl->glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, 0, kFormat, kWidth, kHeight, kLayers, 0,
+                                   static_cast<GLsizei>(data.size()), data.data());
+        gl->glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        EXPECT_EQ(GL_NO_ERROR, gl->glGetError());
+        return texture;
+    }
+
+    // Reads back |layer| of |texture|, or the 2D texture if |layer| is negative.
+    // Compressed textures cannot be attached to a framebuffer, so the texels
+    // are copied by drawing into a renderbuffer.
+    std::vector<uint8_t> readTexture(GLuint texture, GLint layer) {
+        GLuint program = compileAndLinkShaderProgram(
+            kVertexShader, layer < 0 ? kFragmentShader2D : kFragmentShaderArray);
+        EXPECT_NE(0u, program);
+        gl->glUseProgram(program);
+        if (layer < 0) {
+            gl->glBindTexture(GL_TEXTURE_2D, texture);
+        } else {
+            gl->glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+            gl->glUniform1i(gl->glGetUniformLocation(program, "u_layer"), layer);
+        }
+
+        GLuint renderbuffer = 0;
+        gl->glGenRenderbuffers(1, &renderbuffer);
+        gl->glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+        gl->glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, kWidth, kHeight);
+        GLuint framebuffer = 0;
+        gl->glGenFramebuffers(1, &framebuffer);
+        gl->glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        gl->glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER,
+                                      renderbuffer);
+        EXPECT_EQ(static_cast<GLenum>(GL_FRAMEBUFFER_COMPLETE),
+                  gl->glCheckFramebufferStatus(GL_FRAMEBUFFER));
+
+        gl->glViewport(0, 0, kWidth, kHeight);
+        gl->glDrawArrays(GL_TRIANGLES, 0, 3);
+
+        std::vector<uint8_t> pixels(kWidth * kHeight * 4);
+        gl->glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        gl->glReadPixels(0, 0, kWidth, kHeight, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        EXPECT_EQ(GL_NO_ERROR, gl->glGetError());
+
+        gl->glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        gl->glDeleteFramebuffers(1, &framebuffer);
+        gl->glDeleteRenderbuffers(1, &renderbuffer);
+        gl->glUseProgram(0);
+        gl->glDeleteProgram(program);
+        return pixels;
+    }
+
+    // Whether the host re-encodes kFormat, as opposed to decompressing it.
+    bool hostTranscodes(const uint8_t* slice) {
+        setTranscodeEnabled(false);
+        GLuint decoded = create2D(slice);
+        setTranscodeEnabled(true);
+        GLuint transcoded = create2D(slice);
+        const bool differs = readTexture(decoded, -1) != readTexture(transcoded, -1);
+        gl->glDeleteTextures(1, &decoded);
+        gl->glDeleteTextures(1, &transcoded);
+        return differs;
+    }
+};
+
+TEST_F(SnapshotBcnTranscodeTest, ArrayLayersMatch2D) {
+    const std::vector<uint8_t> data = makeImage();
+    EMUGL_SKIP_TEST_IF(!hostTranscodes(data.data()));
+
+    GLuint array = createArray(data);
+    for (GLint layer = 0; layer < kLayers; layer++) {
+        SCOPED_TRACE(testing::Message() << "layer " << layer);
+        GLuint texture = create2D(data.data() + layer * kSliceSize);
+        std::vector<uint8_t> expected = readTexture(texture, -1);
+        std::vector<uint8_t> actual = readTexture(array, layer);
+        EXPECT_TRUE(ImageMatches(kWidth, kHeight, 4, kWidth, expected.data(), actual.data()));
+        gl->glDeleteTextures(1, &texture);
+    }
+    gl->glDeleteTextures(1, &array);
+}
+
+TEST_F(SnapshotBcnTranscodeTest, ArraySubImage) {
+    const std::vector<uint8_t> data = makeImage();
+    EMUGL_SKIP_TEST_IF(!hostTranscodes(data.data()));
+
+    // Replaces the last layer with the first one.
+    GLuint array = createArray(data);
+    gl->glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, kLayers - 1, kWidth, kHeight, 1,
+                                  kFormat, kSliceSize, data.data());
+    EXPECT_EQ(GL_NO_ERROR, gl->glGetError());
+
+    std::vector<uint8_t> expected = readTexture(array, 0);
+    std::vector<uint8_t> actual = readTexture(array, kLayers - 1);
+    EXPECT_TRUE(ImageMatches(kWidth, kHeight, 4, kWidth, expected.data(), actual.data()));
+    gl->glDeleteTextures(1, &array);
+}
+
+TEST_F(SnapshotBcnTranscodeTest, SnapshotKeepsTranscodedTextures) {
+    // GLES hosts can only save textures that can be attached to a framebuffer.
+    EMUGL_SKIP_TEST_IF(isGles2Gles());
+    const std::vector<uint8_t> data = makeImage();
+    EMUGL_SKIP_TEST_IF(!hostTranscodes(data.data()));
+
+    GLuint texture = create2D(data.data());
+    GLuint array = createArray(data);
+    std::vector<std::vector<uint8_t>> before = {readTexture(texture, -1)};
+    for (GLint layer = 0; layer < kLayers; layer++) {
+        before.push_back(readTexture(array, layer));
+    }
+
+    doSnapshot([] {});
+
+    std::vector<std::vector<uint8_t>> after = {readTexture(texture, -1)};
+    for (GLint layer = 0; layer < kLayers; layer++) {
+        after.push_back(readTexture(array, layer));
+    }
+    // The textures are re-encoded from their decompressed texels, which is
+    // not exact.
+    constexpr int kTolerance = 8;
+    for (size_t i = 0; i < before.size(); i++) {
+        SCOPED_TRACE(testing::Message() << "image " << i);
+        ASSERT_EQ(before[i].size(), after[i].size());
+        int maxDiff = 0;
+        for (size_t j = 0; j < before[i].size(); j++) {
+            maxDiff = std::max(maxDiff, std::abs(before[i][j] - after[i][j]));
+        }
+        EXPECT_LE(maxDiff, kTolerance);
+    }
+    gl->glDeleteTextures(1, &texture);
+    gl->glDeleteTextures(1, &array);
+}
+
+}  // namespace
+}  // namespace gl
+}  // namespace gfxstream
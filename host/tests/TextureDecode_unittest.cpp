@@ -0,0 +1,163 @@
+// Copyright (C) 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <GLES/gl.h>
+#include <GLES/glext.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "GLcommon/PaletteTexture.h"
+#include "GLcommon/TextureDecodeThreadPool.h"
+#include "GLcommon/rgtc.h"
+
+namespace gfxstream {
+namespace gl {
+namespace {
+
+// Large enough to be spread over the decode threads, and not a multiple of
+// the RGTC block size.
+constexpr uint32_t kWidth = 1022;
+constexpr uint32_t kHeight = 514;
+constexpr int kDecodeThreads = 4;
+
+std::vector<uint8_t> makeRandomData(size_t size, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> data(size);
+    for (uint8_t& byte : data) {
+        byte = static_cast<uint8_t>(rng());
+    }
+    return data;
+}
+
+class TextureDecodeTest : public testing::Test {
+  protected:
+    void TearDown() override { setTextureDecodeThreadCountForTesting(kDecodeThreads); }
+};
+
+TEST_F(TextureDecodeTest, ParallelDecodeCoversEveryItemOnce) {
+    setTextureDecodeThreadCountForTesting(kDecodeThreads);
+
+    constexpr uint32_t kCount = 1000;
+    std::vector<std::atomic<int>> calls(kCount);
+    std::atomic<int> ranges{0};
+    parallelTextureDecode(kCount, 1024 * 1024, [&](uint32_t begin, uint32_t end) {
+        ASSERT_LT(begin, end);
+        ASSERT_LE(end, kCount);
+        ranges++;
+        for (uint32_t i = begin; i < end; i++) {
+            calls[i]++;
+        }
+    });
+    EXPECT_EQ(kDecodeThreads + 1, ranges.load());
+    for (uint32_t i = 0; i < kCount; i++) {
+        EXPECT_EQ(1, calls[i].load()) << i;
+    }
+}
+
+TEST_F(TextureDecodeTest, RgtcParallelMatchesSerial) {
+    for (RGTCImageFormat format : {BC4_UNORM, BC4_SNORM, BC5_UNORM, BC5_SNORM}) {
+        SCOPED_TRACE(testing::Message() << "format " << format);
+        const size_t pixelSize = rgtc_get_decoded_pixel_size(format);
+        // Padded rows, to check that the stride is honored.
+        const uint32_t stride = kWidth * pixelSize + 8;
+        const std::vector<uint8_t> data =
+            makeRandomData(rgtc_get_encoded_image_size(format, kWidth, kHeight), format);
+
+        std::vector<uint8_t> decoded[2];
+        for (int parallel = 0; parallel < 2; parallel++) {
+            setTextureDecodeThreadCountForTesting(parallel ? kDecodeThreads : 0);
+            decoded[parallel].assign(stride * kHeight, 0xcd);
+            ASSERT_EQ(0, rgtc_decode_image(data.data(), format, decoded[parallel].data(), kWidth,
+                                           kHeight, stride));
+        }
+        EXPECT_EQ(decoded[0], decoded[1]);
+    }
+}
+
+// Blocks whose first endpoint is not greater than the second use indices 6 and 7 for the
+// minimum and maximum of the channel.
+TEST_F(TextureDecodeTest, RgtcSixValueModeExtremes) {
+    // Endpoints 10 and 20 (-10 and 20 for snorm), then indices 6, 7 and 0.
+    const uint8_t unormBlock[8] = {10, 20, 0x06 | (7 << 3), 0, 0, 0, 0, 0};
+    const uint8_t snormBlock[8] = {static_cast<uint8_t>(-10), 20, 0x06 | (7 << 3), 0, 0, 0, 0, 0};
+
+    uint8_t out[16];
+    ASSERT_EQ(0, rgtc_decode_image(unormBlock, BC4_UNORM, out, 4, 4, 4));
+    EXPECT_EQ(0, out[0]);
+    EXPECT_EQ(255, out[1]);
+    EXPECT_EQ(10, out[2]);
+
+    ASSERT_EQ(0, rgtc_decode_image(snormBlock, BC4_SNORM, out, 4, 4, 4));
+    EXPECT_EQ(-127, static_cast<int8_t>(out[0]));
+    EXPECT_EQ(127, static_cast<int8_t>(out[1]));
+    EXPECT_EQ(-10, static_cast<int8_t>(out[2]));
+}
+
+TEST_F(TextureDecodeTest, PaletteParallelMatchesSerial) {
+    const GLenum formats[] = {
+        GL_PALETTE4_RGB8_OES,     GL_PALETTE4_RGBA8_OES,    GL_PALETTE4_R5_G6_B5_OES,
+        GL_PALETTE4_RGBA4_OES,    GL_PALETTE4_RGB5_A1_OES,  GL_PALETTE8_RGB8_OES,
+        GL_PALETTE8_RGBA8_OES,    GL_PALETTE8_R5_G6_B5_OES, GL_PALETTE8_RGBA4_OES,
+        GL_PALETTE8_RGB5_A1_OES,
+    };
+    for (GLenum format : formats) {
+        SCOPED_TRACE(testing::Message() << "format 0x" << std::hex << format);
+        const bool palette4 = format <= GL_PALETTE4_RGB5_A1_OES;
+        const size_t colorSize = format == GL_PALETTE4_RGB8_OES || format == GL_PALETTE8_RGB8_OES
+                                     ? 3
+                                 : format == GL_PALETTE4_RGBA8_OES ||
+                                         format == GL_PALETTE8_RGBA8_OES
+                                     ? 4
+                                     : 2;
+        const size_t paletteSize = (palette4 ? 16 : 256) * colorSize;
+        const size_t indicesSize = (palette4 ? kWidth / 2 : kWidth) * kHeight;
+        const std::vector<uint8_t> data = makeRandomData(paletteSize + indicesSize, format);
+
+        std::unique_ptr<unsigned char[]> decoded[2];
+        GLenum decodedFormat = 0;
+        for (int parallel = 0; parallel < 2; parallel++) {
+            setTextureDecodeThreadCountForTesting(parallel ? kDecodeThreads : 0);
+            decoded[parallel].reset(uncompressTexture(format, decodedFormat, kWidth, kHeight,
+                                                      data.size(), data.data(), 0));
+            ASSERT_NE(nullptr, decoded[parallel]);
+        }
+        const size_t decodedSize = kWidth * kHeight * (decodedFormat == GL_RGB ? 3 : 4);
+        EXPECT_EQ(0, std::memcmp(decoded[0].get(), decoded[1].get(), decodedSize));
+    }
+}
+
+TEST_F(TextureDecodeTest, PaletteR5G6B5FullRed) {
+    // A 16 entry palette whose first entry is pure red, then a 2x1 image using it.
+    std::vector<uint8_t> data(16 * 2 + 1, 0);
+    data[0] = 0x00;
+    data[1] = 0xf8;
+
+    GLenum decodedFormat = 0;
+    std::unique_ptr<unsigned char[]> decoded(uncompressTexture(
+        GL_PALETTE4_R5_G6_B5_OES, decodedFormat, 2, 1, data.size(), data.data(), 0));
+    ASSERT_NE(nullptr, decoded);
+    ASSERT_EQ(static_cast<GLenum>(GL_RGB), decodedFormat);
+    EXPECT_EQ(255, decoded[0]);
+    EXPECT_EQ(0, decoded[1]);
+    EXPECT_EQ(0, decoded[2]);
+}
+
+}  // namespace
+}  // namespace gl
+}  // namespace gfxstream
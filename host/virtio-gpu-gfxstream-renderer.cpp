@@ -432,6 +432,13 @@ VG_EXPORT void stream_renderer_flush(uint32_t res_handle) {
     sFrontend()->flushResource(res_handle);
 }
 
+VG_EXPORT int stream_renderer_submit_batch(struct stream_renderer_batch_op* ops, uint32_t num_ops) {
+    GFXSTREAM_TRACE_EVENT(GFXSTREAM_TRACE_STREAM_RENDERER_CATEGORY,
+                          "stream_renderer_submit_batch()", "num_ops", num_ops);
+
+    return sFrontend()->submitBatch(ops, num_ops);
+}
+
 VG_EXPORT int stream_renderer_create_blob(uint32_t ctx_id, uint32_t res_handle,
                                           const struct stream_renderer_create_blob* create_blob,
                                           const struct iovec* iovecs, uint32_t num_iovs,
@@ -587,6 +594,7 @@ VG_EXPORT int stream_renderer_init(struct stream_renderer_param* stream_renderer
         {STREAM_RENDERER_PARAM_WIN0_HEIGHT, "WIN0_HEIGHT"},
         {STREAM_RENDERER_PARAM_DEBUG_CALLBACK, "DEBUG_CALLBACK"},
         {STREAM_RENDERER_SKIP_OPENGLES_INIT, "SKIP_OPENGLES_INIT"},
+        {STREAM_RENDERER_PARAM_SNAPSHOT_PROGRESS_CALLBACK, "SNAPSHOT_PROGRESS_CALLBACK"},
         {STREAM_RENDERER_PARAM_METRICS_CALLBACK_ADD_INSTANT_EVENT,
          "METRICS_CALLBACK_ADD_INSTANT_EVENT"},
         {STREAM_RENDERER_PARAM_METRICS_CALLBACK_ADD_INSTANT_EVENT_WITH_DESCRIPTOR,
@@ -596,16 +604,20 @@ VG_EXPORT int stream_renderer_init(struct stream_renderer_param* stream_renderer
         {STREAM_RENDERER_PARAM_METRICS_CALLBACK_ADD_VULKAN_OUT_OF_MEMORY_EVENT,
          "METRICS_CALLBACK_ADD_VULKAN_OUT_OF_MEMORY_EVENT"},
         {STREAM_RENDERER_PARAM_METRICS_CALLBACK_SET_ANNOTATION, "METRICS_CALLBACK_SET_ANNOTATION"},
-        {STREAM_RENDERER_PARAM_METRICS_CALLBACK_ABORT, "METRICS_CALLBACK_ABORT"}};
+        {STREAM_RENDERER_PARAM_METRICS_CALLBACK_ABORT, "METRICS_CALLBACK_ABORT"},
+        {STREAM_RENDERER_PARAM_COLOR_BUFFER_BUDGET_MB, "COLOR_BUFFER_BUDGET_MB"},
+        {STREAM_RENDERER_PARAM_COLOR_BUFFER_EVICTION_MIN_IDLE_MS,
+         "COLOR_BUFFER_EVICTION_MIN_IDLE_MS"}};
 
     // Print full values for these parameters:
     // Values here must not be pointers (e.g. callback functions), to avoid potentially identifying
     // someone via ASLR. Pointers in ASLR are randomized on boot, which means pointers may be
     // different between users but similar across a single user's sessions.
     // As a convenience, any value <= 4096 is also printed, to catch small or null pointer errors.
-    std::unordered_set<uint64_t> printed_param_values{STREAM_RENDERER_PARAM_RENDERER_FLAGS,
-                                                      STREAM_RENDERER_PARAM_WIN0_WIDTH,
-                                                      STREAM_RENDERER_PARAM_WIN0_HEIGHT};
+    std::unordered_set<uint64_t> printed_param_values{
+        STREAM_RENDERER_PARAM_RENDERER_FLAGS, STREAM_RENDERER_PARAM_WIN0_WIDTH,
+        STREAM_RENDERER_PARAM_WIN0_HEIGHT, STREAM_RENDERER_PARAM_COLOR_BUFFER_BUDGET_MB,
+        STREAM_RENDERER_PARAM_COLOR_BUFFER_EVICTION_MIN_IDLE_MS};
 
     // We may have unknown parameters, so this function is lenient.
     auto get_param_string = [&](uint64_t key) -> std::string {
@@ -625,7 +637,10 @@ VG_EXPORT int stream_renderer_init(struct stream_renderer_param* stream_renderer
     std::string renderer_features_str;
     stream_renderer_fence_callback fence_callback = nullptr;
     stream_renderer_debug_callback log_callback = nullptr;
+    stream_renderer_snapshot_progress_callback snapshot_progress_callback = nullptr;
     bool rendererInitializedExternally = false;
+    std::optional<uint64_t> color_buffer_budget_bytes;
+    std::optional<uint64_t> color_buffer_eviction_min_idle_us;
 
     // Iterate all parameters that we support.
     GFXSTREAM_DEBUG("Reading stream renderer parameters:");
@@ -675,6 +690,12 @@ VG_EXPORT int stream_renderer_init(struct stream_renderer_param* stream_renderer
                     static_cast<uintptr_t>(param.value));
                 break;
             }
+            case STREAM_RENDERER_PARAM_SNAPSHOT_PROGRESS_CALLBACK: {
+                snapshot_progress_callback =
+                    reinterpret_cast<stream_renderer_snapshot_progress_callback>(
+                        static_cast<uintptr_t>(param.value));
+                break;
+            }
             case STREAM_RENDERER_SKIP_OPENGLES_INIT: {
                 // AEMU currently does its own initialization in
                 // qemu/android/android-emu/android/opengles.cpp.
@@ -710,6 +731,14 @@ VG_EXPORT int stream_renderer_init(struct stream_renderer_param* stream_renderer
                     std::string(reinterpret_cast<const char*>(static_cast<uintptr_t>(param.value)));
                 break;
             }
+            case STREAM_RENDERER_PARAM_COLOR_BUFFER_BUDGET_MB: {
+                color_buffer_budget_bytes = param.value * 1024 * 1024;
+                break;
+            }
+            case STREAM_RENDERER_PARAM_COLOR_BUFFER_EVICTION_MIN_IDLE_MS: {
+                color_buffer_eviction_min_idle_us = param.value * 1000;
+                break;
+            }
             case STREAM_RENDERER_PARAM_METRICS_CALLBACK_SET_ANNOTATION: {
                 MetricsLogger::set_crash_annotation_callback =
                     reinterpret_cast<stream_renderer_param_metrics_callback_set_annotation>(
@@ -854,7 +883,13 @@ VG_EXPORT int stream_renderer_init(struct stream_renderer_param* stream_renderer
         return -EINVAL;
     }
 
-    sFrontend()->init(renderer, renderer_cookie, features, fence_callback);
+    if (auto fb = gfxstream::FrameBuffer::getFB()) {
+        fb->setColorBufferEvictionParams(color_buffer_budget_bytes,
+                                         color_buffer_eviction_min_idle_us);
+    }
+
+    sFrontend()->init(renderer, renderer_cookie, features, fence_callback,
+                      snapshot_progress_callback);
 
     GFXSTREAM_INFO("Gfxstream initialized successfully!");
     return 0;
@@ -0,0 +1,213 @@
+// Copyright (C) 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BoxedHandleTable.h"
+
+namespace gfxstream {
+namespace vk {
+namespace {
+
+constexpr size_t kInitialBucketCount = 64;
+constexpr size_t kNodesPerChunk = 256;
+
+// How many nodes `get()` walks before checking whether the bucket changed under it, which
+// bounds the walk when it races with a writer that relinked the nodes.
+constexpr size_t kStepsBetweenSequenceChecks = 32;
+
+}  // namespace
+
+BoxedHandleReverseMap::BoxedHandleReverseMap() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    resetLocked();
+}
+
+BoxedHandleReverseMap::~BoxedHandleReverseMap() = default;
+
+size_t BoxedHandleReverseMap::hash(uint64_t unboxed) {
+    // The finalizer of MurmurHash3 as driver handles are often aligned pointers.
+    unboxed ^= unboxed >> 33;
+    unboxed *= 0xff51afd7ed558ccdULL;
+    unboxed ^= unboxed >> 33;
+    return static_cast<size_t>(unboxed);
+}
+
+void BoxedHandleReverseMap::beginWrite(Bucket& bucket) {
+    bucket.sequence.store(bucket.sequence.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void BoxedHandleReverseMap::endWrite(Bucket& bucket) {
+    bucket.sequence.store(bucket.sequence.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_release);
+}
+
+BoxedHandleReverseMap::Node* BoxedHandleReverseMap::allocateNodeLocked() {
+    if (mFreeNodes.empty()) {
+        mNodeChunks.emplace_back(new Node[kNodesPerChunk]);
+        Node* nodes = mNodeChunks.back().get();
+        for (size_t i = 0; i < kNodesPerChunk; i++) {
+            mFreeNodes.push_back(&nodes[kNodesPerChunk - 1 - i]);
+        }
+    }
+    Node* node = mFreeNodes.back();
+    mFreeNodes.pop_back();
+    return node;
+}
+
+void BoxedHandleReverseMap::growLocked() {
+    Buckets* oldBuckets = mBuckets.load(std::memory_order_relaxed);
+    const size_t oldCount = oldBuckets->mask + 1;
+
+    // Leave every old bucket odd for good so that readers still using the old array retry
+    // and pick up the new one.
+    for (size_t i = 0; i < oldCount; i++) {
+        beginWrite(oldBuckets->buckets[i]);
+    }
+
+    auto newBuckets = std::make_unique<Buckets>(oldCount * 2);
+    for (size_t i = 0; i < oldCount; i++) {
+        Node* node = oldBuckets->buckets[i].head.load(std::memory_order_relaxed);
+        while (node) {
+            Node* next = node->next.load(std::memory_order_relaxed);
+            Bucket& bucket =
+                newBuckets->buckets[hash(node->unboxed.load(std::memory_order_relaxed)) &
+                                    newBuckets->mask];
+            node->next.store(bucket.head.load(std::memory_order_relaxed),
+                             std::memory_order_relaxed);
+            bucket.head.store(node, std::memory_order_relaxed);
+            node = next;
+        }
+    }
+
+    mBuckets.store(newBuckets.get(), std::memory_order_release);
+    mAllBuckets.push_back(std::move(newBuckets));
+}
+
+void BoxedHandleReverseMap::resetLocked() {
+    auto buckets = std::make_unique<Buckets>(kInitialBucketCount);
+    mBuckets.store(buckets.get(), std::memory_order_release);
+    mAllBuckets.clear();
+    mAllBuckets.push_back(std::move(buckets));
+    mNodeChunks.clear();
+    mFreeNodes.clear();
+    mSize = 0;
+}
+
+void BoxedHandleReverseMap::set(uint64_t unboxed, uint64_t boxed) {
+    if (unboxed == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    Buckets* buckets = mBuckets.load(std::memory_order_relaxed);
+    Bucket* bucket = &buckets->buckets[hash(unboxed) & buckets->mask];
+    for (Node* node = bucket->head.load(std::memory_order_relaxed); node;
+         node = node->next.load(std::memory_order_relaxed)) {
+        if (node->unboxed.load(std::memory_order_relaxed) == unboxed) {
+            beginWrite(*bucket);
+            node->boxed.store(boxed, std::memory_order_relaxed);
+            endWrite(*bucket);
+            return;
+        }
+    }
+
+    if (mSize + 1 > buckets->mask + 1) {
+        growLocked();
+        buckets = mBuckets.load(std::memory_order_relaxed);
+        bucket = &buckets->buckets[hash(unboxed) & buckets->mask];
+    }
+
+    Node* node = allocateNodeLocked();
+    beginWrite(*bucket);
+    node->unboxed.store(unboxed, std::memory_order_relaxed);
+    node->boxed.store(boxed, std::memory_order_relaxed);
+    node->next.store(bucket->head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    bucket->head.store(node, std::memory_order_relaxed);
+    endWrite(*bucket);
+    ++mSize;
+}
+
+void BoxedHandleReverseMap::remove(uint64_t unboxed, uint64_t boxed) {
+    if (unboxed == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    Buckets* buckets = mBuckets.load(std::memory_order_relaxed);
+    Bucket& bucket = buckets->buckets[hash(unboxed) & buckets->mask];
+    std::atomic<Node*>* link = &bucket.head;
+    for (Node* node = link->load(std::memory_order_relaxed); node;
+         link = &node->next, node = link->load(std::memory_order_relaxed)) {
+        if (node->unboxed.load(std::memory_order_relaxed) != unboxed) {
+            continue;
+        }
+        if (node->boxed.load(std::memory_order_relaxed) != boxed) {
+            return;
+        }
+        beginWrite(bucket);
+        link->store(node->next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        endWrite(bucket);
+        mFreeNodes.push_back(node);
+        --mSize;
+        return;
+    }
+}
+
+uint64_t BoxedHandleReverseMap::get(uint64_t unboxed) const {
+    if (unboxed == 0) {
+        return 0;
+    }
+
+    while (true) {
+        const Buckets* buckets = mBuckets.load(std::memory_order_acquire);
+        const Bucket& bucket = buckets->buckets[hash(unboxed) & buckets->mask];
+
+        const uint32_t sequence = bucket.sequence.load(std::memory_order_acquire);
+        if (sequence & 1) {
+            continue;
+        }
+
+        uint64_t boxed = 0;
+        bool changed = false;
+        size_t steps = 0;
+        for (const Node* node = bucket.head.load(std::memory_order_relaxed); node;
+             node = node->next.load(std::memory_order_relaxed)) {
+            if (node->unboxed.load(std::memory_order_relaxed) == unboxed) {
+                boxed = node->boxed.load(std::memory_order_relaxed);
+                break;
+            }
+            if (++steps % kStepsBetweenSequenceChecks == 0 &&
+                bucket.sequence.load(std::memory_order_acquire) != sequence) {
+                changed = true;
+                break;
+            }
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (!changed && bucket.sequence.load(std::memory_order_relaxed) == sequence) {
+            return boxed;
+        }
+    }
+}
+
+void BoxedHandleReverseMap::clear() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    resetLocked();
+}
+
+}  // namespace vk
+}  // namespace gfxstream
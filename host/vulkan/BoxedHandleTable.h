@@ -0,0 +1,310 @@
+// Copyright (C) 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "gfxstream/ThreadAnnotations.h"
+
+namespace gfxstream {
+namespace vk {
+
+// A dense table of the boxed handles of a single handle type.
+//
+// Handles have the same layout as `gfxstream::base::EntityManager<32, 16, 16>` handles, which
+// keeps handles saved in older snapshots valid: the index of the entry in the low 32 bits
+// followed by a 16 bit generation, bumped every time the entry is freed, and a 16 bit type.
+//
+// Entries live in chunks that double in size and are never moved or freed while the table is
+// alive, so `get()` is lock free and does not slow down as the number of live handles grows.
+// `add()` and `remove()` take a lock.
+template <typename Data>
+class BoxedHandleTable {
+   public:
+    using Handle = uint64_t;
+
+    static uint32_t getIndex(Handle handle) { return static_cast<uint32_t>(handle); }
+    static uint16_t getGeneration(Handle handle) { return static_cast<uint16_t>(handle >> 32); }
+    static uint16_t getType(Handle handle) { return static_cast<uint16_t>(handle >> 48); }
+    static Handle makeHandle(uint32_t index, uint16_t generation, uint16_t type) {
+        return static_cast<Handle>(index) | (static_cast<Handle>(generation) << 32) |
+               (static_cast<Handle>(type) << 48);
+    }
+
+    explicit BoxedHandleTable(uint16_t type) : mType(type) {
+        for (auto& chunk : mChunks) {
+            chunk.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ~BoxedHandleTable() {
+        for (auto& chunk : mChunks) {
+            delete[] chunk.load(std::memory_order_relaxed);
+        }
+    }
+
+    BoxedHandleTable(const BoxedHandleTable&) = delete;
+    BoxedHandleTable& operator=(const BoxedHandleTable&) = delete;
+
+    // Returns 0 if the table is full.
+    Handle add(const Data& data) EXCLUDES(mMutex) {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        uint32_t index = 0;
+        if (!mFreeIndices.empty()) {
+            index = mFreeIndices.back();
+            mFreeIndices.pop_back();
+        } else {
+            index = mNextUnusedIndex++;
+        }
+
+        Entry* entry = getOrCreateEntryLocked(index);
+        if (!entry) {
+            return 0;
+        }
+        return publishLocked(*entry, index, entry->generation, data);
+    }
+
+    // Adds `data` with the given `handle` as used when replaying the handles of a snapshot.
+    // Returns 0 if the entry of `handle` is already live.
+    Handle addFixed(Handle handle, const Data& data) EXCLUDES(mMutex) {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        const uint32_t index = getIndex(handle);
+        if (index >= mNextUnusedIndex) {
+            for (uint32_t i = mNextUnusedIndex; i < index; i++) {
+                mFreeIndices.push_back(i);
+            }
+            mNextUnusedIndex = index + 1;
+        } else {
+            auto it = std::find(mFreeIndices.begin(), mFreeIndices.end(), index);
+            if (it == mFreeIndices.end()) {
+                return 0;
+            }
+            mFreeIndices.erase(it);
+        }
+
+        Entry* entry = getOrCreateEntryLocked(index);
+        if (!entry) {
+            return 0;
+        }
+        return publishLocked(*entry, index, getGeneration(handle), data);
+    }
+
+    // Returns false if `handle` is not live. Otherwise, copies its data into `removed` if
+    // non-null. The data stays readable through previously returned pointers until the entry
+    // is reused.
+    bool remove(Handle handle, Data* removed = nullptr) EXCLUDES(mMutex) {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        const uint32_t index = getIndex(handle);
+        Entry* entry = getEntry(index);
+        if (handle == 0 || !entry || entry->handle.load(std::memory_order_relaxed) != handle) {
+            return false;
+        }
+        if (removed) {
+            *removed = entry->data;
+        }
+        entry->handle.store(0, std::memory_order_release);
+        ++entry->generation;
+        mFreeIndices.push_back(index);
+        mLiveCount.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Lock free. Returns nullptr if `handle` is not live.
+    Data* get(Handle handle) const {
+        if (handle == 0) {
+            return nullptr;
+        }
+        Entry* entry = getEntry(getIndex(handle));
+        if (!entry || entry->handle.load(std::memory_order_acquire) != handle) {
+            return nullptr;
+        }
+        return &entry->data;
+    }
+
+    // Must not race with `get()`.
+    void clear() EXCLUDES(mMutex) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (uint32_t chunk = 0; chunk < kMaxChunks; chunk++) {
+            Entry* entries = mChunks[chunk].load(std::memory_order_relaxed);
+            if (!entries) {
+                continue;
+            }
+            for (size_t i = 0; i < getChunkSize(chunk); i++) {
+                entries[i].handle.store(0, std::memory_order_relaxed);
+                entries[i].generation = 0;
+                entries[i].data = Data();
+            }
+        }
+        mFreeIndices.clear();
+        mNextUnusedIndex = 0;
+        mLiveCount.store(0, std::memory_order_relaxed);
+    }
+
+    size_t size() const { return mLiveCount.load(std::memory_order_relaxed); }
+
+   private:
+    struct Entry {
+        // The handle of the entry while it is live and 0 otherwise.
+        std::atomic<Handle> handle{0};
+        // Only accessed with `mMutex` held.
+        uint16_t generation = 0;
+        Data data;
+    };
+
+    // Chunk `i` holds `2^(kFirstChunkBits + i)` entries, which is enough chunks to cover all
+    // of the 32 bit indices.
+    static constexpr uint32_t kFirstChunkBits = 6;
+    static constexpr uint32_t kMaxChunks = 32 - kFirstChunkBits + 1;
+
+    static uint32_t getHighestBit(uint64_t value) {
+#if defined(_MSC_VER)
+        unsigned long bit = 0;
+        _BitScanReverse64(&bit, value);
+        return static_cast<uint32_t>(bit);
+#else
+        return 63 - static_cast<uint32_t>(__builtin_clzll(value));
+#endif
+    }
+
+    static size_t getChunkSize(uint32_t chunk) { return size_t(1) << (kFirstChunkBits + chunk); }
+
+    static void getChunkAndOffset(uint32_t index, uint32_t* chunk, size_t* offset) {
+        const uint64_t biased = static_cast<uint64_t>(index) + (uint64_t(1) << kFirstChunkBits);
+        const uint32_t bit = getHighestBit(biased);
+        *chunk = bit - kFirstChunkBits;
+        *offset = static_cast<size_t>(biased - (uint64_t(1) << bit));
+    }
+
+    Entry* getEntry(uint32_t index) const {
+        uint32_t chunk = 0;
+        size_t offset = 0;
+        getChunkAndOffset(index, &chunk, &offset);
+        Entry* entries = mChunks[chunk].load(std::memory_order_acquire);
+        return entries ? &entries[offset] : nullptr;
+    }
+
+    Entry* getOrCreateEntryLocked(uint32_t index) REQUIRES(mMutex) {
+        uint32_t chunk = 0;
+        size_t offset = 0;
+        getChunkAndOffset(index, &chunk, &offset);
+        if (chunk >= kMaxChunks) {
+            return nullptr;
+        }
+        Entry* entries = mChunks[chunk].load(std::memory_order_relaxed);
+        if (!entries) {
+            entries = new Entry[getChunkSize(chunk)];
+            mChunks[chunk].store(entries, std::memory_order_release);
+        }
+        return &entries[offset];
+    }
+
+    Handle publishLocked(Entry& entry, uint32_t index, uint16_t generation, const Data& data)
+        REQUIRES(mMutex) {
+        const Handle handle = makeHandle(index, generation, mType);
+        entry.generation = generation;
+        entry.data = data;
+        entry.handle.store(handle, std::memory_order_release);
+        mLiveCount.fetch_add(1, std::memory_order_relaxed);
+        return handle;
+    }
+
+    const uint16_t mType;
+
+    std::mutex mMutex;
+    std::array<std::atomic<Entry*>, kMaxChunks> mChunks;
+    std::vector<uint32_t> mFreeIndices GUARDED_BY(mMutex);
+    uint32_t mNextUnusedIndex GUARDED_BY(mMutex) = 0;
+    std::atomic<size_t> mLiveCount{0};
+};
+
+// Maps the underlying handles of a single handle type back to their boxed handles.
+//
+// A chained hash map whose buckets each have a sequence counter: `get()` retries if the bucket
+// was modified while it was being read instead of taking a lock. Nodes are recycled but never
+// freed before `clear()`, so a reader racing with a writer never touches freed memory.
+class BoxedHandleReverseMap {
+   public:
+    BoxedHandleReverseMap();
+    ~BoxedHandleReverseMap();
+
+    BoxedHandleReverseMap(const BoxedHandleReverseMap&) = delete;
+    BoxedHandleReverseMap& operator=(const BoxedHandleReverseMap&) = delete;
+
+    void set(uint64_t unboxed, uint64_t boxed) EXCLUDES(mMutex);
+
+    // Only removes the mapping if `unboxed` still maps to `boxed`.
+    void remove(uint64_t unboxed, uint64_t boxed) EXCLUDES(mMutex);
+
+    // Lock free. Returns 0 if `unboxed` is not mapped.
+    uint64_t get(uint64_t unboxed) const;
+
+    // Must not race with `get()`.
+    void clear() EXCLUDES(mMutex);
+
+   private:
+    struct Node {
+        std::atomic<uint64_t> unboxed{0};
+        std::atomic<uint64_t> boxed{0};
+        std::atomic<Node*> next{nullptr};
+    };
+
+    struct Bucket {
+        // Odd while the bucket is being modified.
+        std::atomic<uint32_t> sequence{0};
+        std::atomic<Node*> head{nullptr};
+    };
+
+    struct Buckets {
+        explicit Buckets(size_t count) : mask(count - 1), buckets(new Bucket[count]) {}
+
+        size_t mask;
+        std::unique_ptr<Bucket[]> buckets;
+    };
+
+    static size_t hash(uint64_t unboxed);
+
+    static void beginWrite(Bucket& bucket);
+    static void endWrite(Bucket& bucket);
+
+    Node* allocateNodeLocked() REQUIRES(mMutex);
+    void growLocked() REQUIRES(mMutex);
+    void resetLocked() REQUIRES(mMutex);
+
+    mutable std::mutex mMutex;
+    std::atomic<Buckets*> mBuckets{nullptr};
+    // All of the bucket arrays ever used, the current one last. Old arrays are kept so that
+    // readers that loaded them before a resize can still safely notice the resize.
+    std::vector<std::unique_ptr<Buckets>> mAllBuckets GUARDED_BY(mMutex);
+    std::vector<std::unique_ptr<Node[]>> mNodeChunks GUARDED_BY(mMutex);
+    std::vector<Node*> mFreeNodes GUARDED_BY(mMutex);
+    size_t mSize GUARDED_BY(mMutex) = 0;
+};
+
+}  // namespace vk
+}  // namespace gfxstream
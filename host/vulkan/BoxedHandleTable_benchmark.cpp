@@ -0,0 +1,145 @@
+// Copyright (C) 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "BoxedHandleTable.h"
+#include "VulkanBoxedHandles.h"
+#include "gfxstream/containers/HybridEntityManager.h"
+
+namespace gfxstream {
+namespace vk {
+namespace {
+
+// The store that was used for all boxed handles before the per type tables.
+using HybridStore = gfxstream::base::HybridEntityManager<16000, BoxedHandle, BoxedHandleInfo>;
+
+// Handles are looked up in a random order so that large tables do not get an unrealistic
+// amount of help from the caches.
+std::vector<BoxedHandle> ShuffledLookups(const std::vector<BoxedHandle>& handles) {
+    std::vector<BoxedHandle> lookups = handles;
+    std::shuffle(lookups.begin(), lookups.end(), std::mt19937(42));
+    return lookups;
+}
+
+BoxedHandleInfo MakeInfo(uint64_t i) {
+    BoxedHandleInfo info;
+    info.underlying = 0x10000 + i * 64;
+    return info;
+}
+
+void BM_HybridEntityManagerUnbox(benchmark::State& state) {
+    static std::unique_ptr<HybridStore> sStore;
+    static std::vector<BoxedHandle> sLookups;
+    if (state.thread_index() == 0) {
+        sStore = std::make_unique<HybridStore>();
+        std::vector<BoxedHandle> handles;
+        for (int64_t i = 0; i < state.range(0); i++) {
+            handles.push_back(sStore->add(MakeInfo(i), Tag_VkBuffer));
+        }
+        sLookups = ShuffledLookups(handles);
+    }
+
+    size_t next = 0;
+    for (auto _ : state) {
+        const BoxedHandleInfo* info = sStore->get_const(sLookups[next]);
+        benchmark::DoNotOptimize(info->underlying);
+        next = (next + 1) % sLookups.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        sStore.reset();
+    }
+}
+BENCHMARK(BM_HybridEntityManagerUnbox)
+    ->Arg(1000)
+    ->Arg(15000)
+    ->Arg(100000)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+
+void BM_BoxedHandleTableUnbox(benchmark::State& state) {
+    static std::unique_ptr<BoxedHandleTable<BoxedHandleInfo>> sTable;
+    static std::vector<BoxedHandle> sLookups;
+    if (state.thread_index() == 0) {
+        sTable = std::make_unique<BoxedHandleTable<BoxedHandleInfo>>(Tag_VkBuffer);
+        std::vector<BoxedHandle> handles;
+        for (int64_t i = 0; i < state.range(0); i++) {
+            handles.push_back(sTable->add(MakeInfo(i)));
+        }
+        sLookups = ShuffledLookups(handles);
+    }
+
+    size_t next = 0;
+    for (auto _ : state) {
+        const BoxedHandleInfo* info = sTable->get(sLookups[next]);
+        benchmark::DoNotOptimize(info->underlying);
+        next = (next + 1) % sLookups.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        sTable.reset();
+    }
+}
+BENCHMARK(BM_BoxedHandleTableUnbox)
+    ->Arg(1000)
+    ->Arg(15000)
+    ->Arg(100000)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+
+void BM_BoxedHandleReverseMapLookup(benchmark::State& state) {
+    static std::unique_ptr<BoxedHandleReverseMap> sMap;
+    static std::vector<UnboxedHandle> sLookups;
+    if (state.thread_index() == 0) {
+        sMap = std::make_unique<BoxedHandleReverseMap>();
+        std::vector<UnboxedHandle> unboxed;
+        for (int64_t i = 0; i < state.range(0); i++) {
+            const BoxedHandleInfo info = MakeInfo(i);
+            sMap->set(info.underlying, static_cast<BoxedHandle>(i + 1));
+            unboxed.push_back(info.underlying);
+        }
+        sLookups = ShuffledLookups(unboxed);
+    }
+
+    size_t next = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sMap->get(sLookups[next]));
+        next = (next + 1) % sLookups.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        sMap.reset();
+    }
+}
+BENCHMARK(BM_BoxedHandleReverseMapLookup)
+    ->Arg(1000)
+    ->Arg(15000)
+    ->Arg(100000)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace vk
+}  // namespace gfxstream
+
+BENCHMARK_MAIN();
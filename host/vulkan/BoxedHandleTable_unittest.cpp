@@ -0,0 +1,215 @@
+// Copyright (C) 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BoxedHandleTable.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace gfxstream {
+namespace vk {
+namespace {
+
+using ::testing::Eq;
+using ::testing::IsNull;
+using ::testing::NotNull;
+using ::testing::Pointee;
+
+using TestTable = BoxedHandleTable<uint64_t>;
+
+constexpr uint16_t kTestType = 7;
+
+TEST(BoxedHandleTableTest, AddGetRemove) {
+    TestTable table(kTestType);
+
+    const TestTable::Handle handle = table.add(42);
+    EXPECT_THAT(TestTable::getType(handle), Eq(kTestType));
+    EXPECT_THAT(table.get(handle), Pointee(Eq(42u)));
+    EXPECT_THAT(table.size(), Eq(1u));
+
+    uint64_t removed = 0;
+    EXPECT_TRUE(table.remove(handle, &removed));
+    EXPECT_THAT(removed, Eq(42u));
+    EXPECT_THAT(table.get(handle), IsNull());
+    EXPECT_THAT(table.size(), Eq(0u));
+
+    EXPECT_FALSE(table.remove(handle));
+}
+
+TEST(BoxedHandleTableTest, ReusedEntryGetsNewGeneration) {
+    TestTable table(kTestType);
+
+    const TestTable::Handle first = table.add(1);
+    ASSERT_TRUE(table.remove(first));
+
+    const TestTable::Handle second = table.add(2);
+    EXPECT_THAT(TestTable::getIndex(second), Eq(TestTable::getIndex(first)));
+    EXPECT_THAT(TestTable::getGeneration(second), Eq(TestTable::getGeneration(first) + 1));
+
+    // The stale handle must not resolve to the new entry.
+    EXPECT_THAT(table.get(first), IsNull());
+    EXPECT_THAT(table.get(second), Pointee(Eq(2u)));
+}
+
+TEST(BoxedHandleTableTest, GrowsPastManyHandlesWithoutMovingEntries) {
+    TestTable table(kTestType);
+
+    constexpr uint64_t kCount = 100000;
+    std::vector<TestTable::Handle> handles;
+    std::vector<uint64_t*> data;
+    for (uint64_t i = 0; i < kCount; i++) {
+        handles.push_back(table.add(i));
+        data.push_back(table.get(handles.back()));
+    }
+    EXPECT_THAT(table.size(), Eq(kCount));
+
+    for (uint64_t i = 0; i < kCount; i++) {
+        ASSERT_THAT(table.get(handles[i]), Eq(data[i]));
+        ASSERT_THAT(*data[i], Eq(i));
+    }
+}
+
+TEST(BoxedHandleTableTest, AddFixed) {
+    TestTable table(kTestType);
+
+    const TestTable::Handle fixed = TestTable::makeHandle(100, 3, kTestType);
+    EXPECT_THAT(table.addFixed(fixed, 5), Eq(fixed));
+    EXPECT_THAT(table.get(fixed), Pointee(Eq(5u)));
+
+    // Already live.
+    EXPECT_THAT(table.addFixed(fixed, 6), Eq(0u));
+
+    // Indices skipped by the fixed handle are still handed out.
+    const TestTable::Handle lower = TestTable::makeHandle(50, 0, kTestType);
+    EXPECT_THAT(table.addFixed(lower, 7), Eq(lower));
+
+    for (int i = 0; i < 99; i++) {
+        const TestTable::Handle handle = table.add(i);
+        EXPECT_THAT(TestTable::getIndex(handle), ::testing::Lt(100u));
+        EXPECT_THAT(TestTable::getIndex(handle), ::testing::Ne(50u));
+    }
+    EXPECT_THAT(TestTable::getIndex(table.add(0)), Eq(101u));
+}
+
+TEST(BoxedHandleTableTest, ClearRemovesAllHandles) {
+    TestTable table(kTestType);
+
+    const TestTable::Handle handle = table.add(1);
+    table.clear();
+    EXPECT_THAT(table.get(handle), IsNull());
+    EXPECT_THAT(table.size(), Eq(0u));
+}
+
+TEST(BoxedHandleTableTest, ConcurrentGetsWhileAddingAndRemoving) {
+    TestTable table(kTestType);
+
+    std::vector<TestTable::Handle> stable;
+    for (uint64_t i = 0; i < 1000; i++) {
+        stable.push_back(table.add(i));
+    }
+
+    std::atomic<bool> done{false};
+    std::thread writer([&]() {
+        for (int i = 0; i < 100000; i++) {
+            table.remove(table.add(i));
+        }
+        done = true;
+    });
+
+    while (!done) {
+        for (uint64_t i = 0; i < stable.size(); i++) {
+            ASSERT_THAT(table.get(stable[i]), Pointee(Eq(i)));
+        }
+    }
+    writer.join();
+}
+
+TEST(BoxedHandleReverseMapTest, SetGetRemove) {
+    BoxedHandleReverseMap map;
+
+    EXPECT_THAT(map.get(0x1000), Eq(0u));
+
+    map.set(0x1000, 1);
+    map.set(0x2000, 2);
+    EXPECT_THAT(map.get(0x1000), Eq(1u));
+    EXPECT_THAT(map.get(0x2000), Eq(2u));
+
+    map.set(0x1000, 3);
+    EXPECT_THAT(map.get(0x1000), Eq(3u));
+
+    // Stale removals of a handle that was already remapped are ignored.
+    map.remove(0x1000, 1);
+    EXPECT_THAT(map.get(0x1000), Eq(3u));
+
+    map.remove(0x1000, 3);
+    EXPECT_THAT(map.get(0x1000), Eq(0u));
+    EXPECT_THAT(map.get(0x2000), Eq(2u));
+}
+
+TEST(BoxedHandleReverseMapTest, GrowsAndClears) {
+    BoxedHandleReverseMap map;
+
+    constexpr uint64_t kCount = 100000;
+    for (uint64_t i = 1; i <= kCount; i++) {
+        map.set(i * 64, i);
+    }
+    for (uint64_t i = 1; i <= kCount; i++) {
+        ASSERT_THAT(map.get(i * 64), Eq(i));
+    }
+    for (uint64_t i = 1; i <= kCount; i += 2) {
+        map.remove(i * 64, i);
+    }
+    for (uint64_t i = 1; i <= kCount; i++) {
+        ASSERT_THAT(map.get(i * 64), Eq(i % 2 ? 0u : i));
+    }
+
+    map.clear();
+    EXPECT_THAT(map.get(128), Eq(0u));
+}
+
+TEST(BoxedHandleReverseMapTest, ConcurrentGetsWhileSettingAndRemoving) {
+    BoxedHandleReverseMap map;
+
+    constexpr uint64_t kStableCount = 1000;
+    for (uint64_t i = 1; i <= kStableCount; i++) {
+        map.set(i * 64, i);
+    }
+
+    std::atomic<bool> done{false};
+    std::thread writer([&]() {
+        // Enough churn to grow the buckets while the reader is running.
+        for (uint64_t i = kStableCount + 1; i <= 50000; i++) {
+            map.set(i * 64, i);
+            if (i % 4 != 0) {
+                map.remove(i * 64, i);
+            }
+        }
+        done = true;
+    });
+
+    while (!done) {
+        for (uint64_t i = 1; i <= kStableCount; i++) {
+            ASSERT_THAT(map.get(i * 64), Eq(i));
+        }
+    }
+    writer.join();
+}
+
+}  // namespace
+}  // namespace vk
+}  // namespace gfxstream
@@ -62,6 +62,41 @@ bool ColorBufferVk::readToBytes(uint32_t x, uint32_t y, uint32_t w, uint32_t h,
     return mVkEmulation.readColorBufferToBytes(mHandle, x, y, w, h, outBytes, outBytesSize);
 }
 
+bool ColorBufferVk::startReadToBytes(uint32_t x, uint32_t y, uint32_t w, uint32_t h,
+                                     uint32_t* outSlot, uint64_t* outSize) {
+    auto readback = mVkEmulation.startReadColorBufferToBytes(mHandle, x, y, w, h);
+    if (!readback) {
+        return false;
+    }
+    *outSlot = readback->slot;
+    *outSize = readback->size;
+    return true;
+}
+
+bool ColorBufferVk::waitReadToBytes(uint32_t slot, uint64_t size) {
+    return mVkEmulation.waitReadColorBufferToBytes(VkEmulation::AsyncReadback{
+        .slot = slot,
+        .size = size,
+    });
+}
+
+bool ColorBufferVk::finishReadToBytes(uint32_t slot, uint64_t size, void* outBytes,
+                                      uint64_t outBytesSize) {
+    return mVkEmulation.finishReadColorBufferToBytes(
+        VkEmulation::AsyncReadback{
+            .slot = slot,
+            .size = size,
+        },
+        outBytes, outBytesSize);
+}
+
+void ColorBufferVk::cancelReadToBytes(uint32_t slot, uint64_t size) {
+    mVkEmulation.cancelReadColorBufferToBytes(VkEmulation::AsyncReadback{
+        .slot = slot,
+        .size = size,
+    });
+}
+
 bool ColorBufferVk::updateFromBytes(const std::vector<uint8_t>& bytes) {
     return mVkEmulation.updateColorBufferFromBytes(mHandle, bytes);
 }
@@ -41,6 +41,13 @@ class ColorBufferVk {
     bool readToBytes(uint32_t x, uint32_t y, uint32_t w, uint32_t h, void* outBytes,
                      uint64_t outBytesSize);
 
+    // Asynchronous variant of readToBytes(). See VkEmulation::startReadColorBufferToBytes().
+    bool startReadToBytes(uint32_t x, uint32_t y, uint32_t w, uint32_t h, uint32_t* outSlot,
+                          uint64_t* outSize);
+    bool waitReadToBytes(uint32_t slot, uint64_t size);
+    bool finishReadToBytes(uint32_t slot, uint64_t size, void* outBytes, uint64_t outBytesSize);
+    void cancelReadToBytes(uint32_t slot, uint64_t size);
+
     bool updateFromBytes(const std::vector<uint8_t>& bytes);
     bool updateFromBytes(uint32_t x, uint32_t y, uint32_t w, uint32_t h, const void* bytes);
 
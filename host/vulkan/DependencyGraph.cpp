@@ -15,6 +15,9 @@
 
 #include <string.h>
 
+#include <algorithm>
+#include <unordered_set>
+
 #include "VulkanBoxedHandles.h"
 
 namespace gfxstream {
@@ -35,17 +38,21 @@ namespace vk {
 void DependencyGraph::removeGrandChildren(const NodeId id) {
     auto* nd = getDepNode(id);
     if (!nd) return;
-    for (auto child : nd->childNodeIds) {
-        removeDescendantsOfHandle(child);
+    // Copied as a cycle could remove the node itself.
+    const SmallFixedVector<NodeRef, 4> children = nd->children;
+    for (NodeRef child : children) {
+        auto* childNode = getDepNode(child);
+        if (childNode) {
+            removeDescendantsOfHandle(childNode->id);
+        }
     }
 }
 
 void DependencyGraph::removeDescendantsOfHandle(const NodeId id) {
     auto* nd = getDepNode(id);
     if (nd) {
-        for (auto child : nd->childNodeIds) {
-            removeNodeAndDescendants(child);
-        }
+        mRemovalStack.insert(mRemovalStack.end(), nd->children.begin(), nd->children.end());
+        drainRemovalStack();
     }
 }
 
@@ -64,8 +71,72 @@ void DependencyGraph::removeNodesAndDescendants(const NodeId* toRemove, uint32_t
 }
 
 void DependencyGraph::removeNodeAndDescendants(NodeId id) {
-    removeDescendantsOfHandle(id);
-    mDepId2DepNode.erase(id);
+    NodeRef ref = getRef(id);
+    if (ref.index == kNoIndex) return;
+    mRemovalStack.push_back(ref);
+    drainRemovalStack();
+}
+
+void DependencyGraph::drainRemovalStack() {
+    // Iterative rather than recursive as the descendants of an instance can be arbitrarily many.
+    while (!mRemovalStack.empty()) {
+        NodeRef ref = mRemovalStack.back();
+        mRemovalStack.pop_back();
+
+        auto* nd = getDepNode(ref);
+        if (!nd) continue;
+
+        mRemovalStack.insert(mRemovalStack.end(), nd->children.begin(), nd->children.end());
+        freeNode(ref.index);
+    }
+}
+
+uint32_t DependencyGraph::allocateNode() {
+    uint32_t index;
+    if (mFreeHead != kNoIndex) {
+        index = mFreeHead;
+        mFreeHead = nodeAt(index).nextByTime;
+    } else {
+        if ((mSlotCount & (kSlabSize - 1)) == 0) {
+            mSlabs.emplace_back(new DepNode[kSlabSize]);
+        }
+        index = mSlotCount++;
+    }
+
+    DepNode& nd = nodeAt(index);
+    nd.prevByTime = mNewest;
+    nd.nextByTime = kNoIndex;
+    if (mNewest != kNoIndex) {
+        nodeAt(mNewest).nextByTime = index;
+    } else {
+        mOldest = index;
+    }
+    mNewest = index;
+    return index;
+}
+
+void DependencyGraph::freeNode(uint32_t index) {
+    DepNode& nd = nodeAt(index);
+    mNodeIndices.erase(nd.id);
+
+    if (nd.prevByTime != kNoIndex) {
+        nodeAt(nd.prevByTime).nextByTime = nd.nextByTime;
+    } else {
+        mOldest = nd.nextByTime;
+    }
+    if (nd.nextByTime != kNoIndex) {
+        nodeAt(nd.nextByTime).prevByTime = nd.prevByTime;
+    } else {
+        mNewest = nd.prevByTime;
+    }
+
+    nd.id = kInvalidNodeId;
+    nd.apiCallId = 0;
+    nd.generation++;
+    nd.children.clear();
+    nd.prevByTime = kNoIndex;
+    nd.nextByTime = mFreeHead;
+    mFreeHead = index;
 }
 
 void DependencyGraph::addNodes(const NodeId* ids, uint32_t count) {
@@ -75,6 +146,7 @@ void DependencyGraph::addNodes(const NodeId* ids, uint32_t count) {
 }
 
 void DependencyGraph::addDepNode(NodeId id) {
+    if (id == kInvalidNodeId) return;
     if (getDepNode(id)) {
         // this can happen, e.g.
         // vkGetDeviceQueue, can be called
@@ -83,11 +155,9 @@ void DependencyGraph::addDepNode(NodeId id) {
         // multiple times
         return;
     }
-    ++mTimestamp;
-    auto nd = std::make_unique<DepNode>();
-    nd->id = id;
-    nd->timestamp = mTimestamp;
-    mDepId2DepNode[id] = std::move(nd);
+    const uint32_t index = allocateNode();
+    nodeAt(index).id = id;
+    mNodeIndices.emplace(id, index);
 }
 
 uint64_t DependencyGraph::getNodeIdType(NodeId nodeId) const { return (nodeId >> 48) & 0xFF; }
@@ -99,59 +169,53 @@ void DependencyGraph::addNodeIdDependencies(const NodeId* childrenIds, uint32_t
     }
 }
 
-void DependencyGraph::getIdsByTimestamp(std::vector<NodeId>& uniqApiRefsByTopoOrder) {
-    // sort depnodes based on the timestamp
-    std::map<uint64_t, DepNode*> time2node;
-    for (const auto& [nodeId, item] : mDepId2DepNode) {
-        time2node[item->timestamp] = item.get();
-    }
-    std::unordered_set<uint64_t> apiset;
-    for (const auto& [timestamp, item] : time2node) {
-        auto apiCallId = item->apiCallId;
+void DependencyGraph::getIdsByTimestamp(std::vector<ApiCallId>& uniqApiRefsByTopoOrder) {
+    std::unordered_set<ApiCallId> apiset;
+    apiset.reserve(mNodeIndices.size());
+    for (uint32_t index = mOldest; index != kNoIndex; index = nodeAt(index).nextByTime) {
+        auto apiCallId = nodeAt(index).apiCallId;
         if (auto [_, inserted] = apiset.insert(apiCallId); inserted) {
             uniqApiRefsByTopoOrder.push_back(apiCallId);
         }
     }
 }
 
+DependencyGraph::NodeRef DependencyGraph::getRef(NodeId id) const {
+    auto it = mNodeIndices.find(id);
+    if (it == mNodeIndices.end()) return {};
+    const uint32_t index = it->second;
+    return {index, mSlabs[index >> kSlabBits][index & (kSlabSize - 1)].generation};
+}
+
 DependencyGraph::DepNode* DependencyGraph::getDepNode(NodeId id) {
-    if (mDepId2DepNode.find(id) == mDepId2DepNode.end()) return nullptr;
-    auto& nd = mDepId2DepNode[id];
-    return nd.get();
+    auto it = mNodeIndices.find(id);
+    if (it == mNodeIndices.end()) return nullptr;
+    return &nodeAt(it->second);
 }
 
-DependencyGraph::ApiNode* DependencyGraph::getApiNode(NodeId id) {
-    if (mApiId2ApiNode.find(id) == mApiId2ApiNode.end()) return nullptr;
-    auto& nd = mApiId2ApiNode[id];
-    return nd.get();
+DependencyGraph::DepNode* DependencyGraph::getDepNode(NodeRef ref) {
+    if (ref.index >= mSlotCount) return nullptr;
+    DepNode& nd = nodeAt(ref.index);
+    if (nd.generation != ref.generation) return nullptr;
+    return &nd;
 }
 
 void DependencyGraph::setCreatedNodeIdsForApi(ApiCallId apiCallId, const NodeId* nodeIds,
                                               uint32_t count) {
-    addApiNode(apiCallId);
-    auto* apiNode = getApiNode(apiCallId);
-    if (apiNode) {
-        for (uint32_t i = 0; i < count; ++i) {
-            apiNode->createdNodeIds.insert(nodeIds[i]);
+    auto& createdNodeIds = mApiCreatedNodeIds[apiCallId];
+    for (uint32_t i = 0; i < count; ++i) {
+        if (std::find(createdNodeIds.begin(), createdNodeIds.end(), nodeIds[i]) ==
+            createdNodeIds.end()) {
+            createdNodeIds.push_back(nodeIds[i]);
         }
     }
 }
-void DependencyGraph::addApiNode(ApiCallId id) {
-    if (getApiNode(id)) return;
-    auto nd = std::make_unique<ApiNode>();
-    nd->id = id;
-    mApiId2ApiNode[id] = std::move(nd);
-}
-void DependencyGraph::removeApiNode(ApiCallId id) {
-    auto* nd = getApiNode(id);
-    if (nd) {
-        mApiId2ApiNode.erase(id);
-    }
-}
+void DependencyGraph::addApiNode(ApiCallId id) { mApiCreatedNodeIds.try_emplace(id); }
+void DependencyGraph::removeApiNode(ApiCallId id) { mApiCreatedNodeIds.erase(id); }
 void DependencyGraph::clearChildDependencies(NodeId parentId) {
     auto* nd = getDepNode(parentId);
     if (nd) {
-        nd->childNodeIds.clear();
+        nd->children.clear();
     }
 }
 
@@ -166,8 +230,14 @@ void DependencyGraph::associateWithApiCall(const NodeId* nodeIds, uint32_t count
 }
 
 void DependencyGraph::clear() {
-    mDepId2DepNode.clear();
-    mApiId2ApiNode.clear();
+    mSlabs.clear();
+    mSlotCount = 0;
+    mFreeHead = kNoIndex;
+    mOldest = kNoIndex;
+    mNewest = kNoIndex;
+    mNodeIndices.clear();
+    mApiCreatedNodeIds.clear();
+    mRemovalStack.clear();
 }
 
 void DependencyGraph::addDep(NodeId child_id, NodeId parent_id) {
@@ -212,8 +282,29 @@ void DependencyGraph::addDep(NodeId child_id, NodeId parent_id) {
         }
     }
 
-    child->parentNodeId = parent_id;
-    parent->childNodeIds.insert(child_id);
+    // The list is kept sorted, so a dependency that is added again, e.g. once per descriptor
+    // set update, is found with a binary search and recorded only once.
+    const NodeRef childRef = getRef(child_id);
+    auto& children = parent->children;
+    auto it = std::lower_bound(children.begin(), children.end(), childRef);
+    if (it != children.end() && *it == childRef) return;
+
+    // Removing a node does not touch the child lists of its parents, so drop the stale
+    // references before growing a list. This keeps each list within twice its live size.
+    if (children.size() == children.capacity()) {
+        auto liveEnd = std::remove_if(children.begin(), children.end(),
+                                      [this](NodeRef ref) { return getDepNode(ref) == nullptr; });
+        children.resize(liveEnd - children.begin());
+        it = std::lower_bound(children.begin(), children.end(), childRef);
+    }
+    const size_t position = it - children.begin();
+    children.push_back(childRef);
+    std::rotate(children.begin() + position, children.end() - 1, children.end());
+}
+
+size_t DependencyGraph::getChildReferenceCount(NodeId id) {
+    auto* nd = getDepNode(id);
+    return nd ? nd->children.size() : 0;
 }
 
 }  // namespace vk
@@ -13,13 +13,13 @@
 // limitations under the License.
 #pragma once
 
-#include <atomic>
+#include <cstdint>
 #include <memory>
-#include <map>
-#include <set>
 #include <unordered_map>
 #include <vector>
 
+#include "render-utils/small_vector.h"
+
 namespace gfxstream {
 namespace vk {
 
@@ -27,34 +27,12 @@ class DependencyGraph {
    public:
     using ApiCallId = uint64_t;
     using NodeId = uint64_t;
-    struct DepNode {
-        static constexpr const uint64_t kInvalidNodeId = 0;
-        // id of this depnode, 0 is invalid
-        // this id comes from boxed handle manager new_xxx
-        // and boxed handle manager use the following format
-        // <tag>-<gen>-<index>, this format does not follow
-        // the id creation order. we keep it here as is, and
-        // introduce timestamp to record the id creation order
-        NodeId id{kInvalidNodeId};
-        // the api that created this DepNode; 0 is invalid
-        ApiCallId apiCallId{0};
-        std::set<NodeId> childNodeIds;
-        // there could be only one parent, 0 is invalid
-        NodeId parentNodeId{0};
 
-        // the increasing timestamp when this node is created
-        // used by map to sort nodes
-        uint64_t timestamp{0};
-    };
+    static constexpr const NodeId kInvalidNodeId = 0;
 
-    // this is created by VkDecoderSnapshot, to record
-    // the api trace, such as "vkCreateInstance..."
-    // each of such trace is assigned a unique api call id
-    struct ApiNode {
-        // id of this api node, 0 is invalid
-        ApiCallId id{0};
-        std::set<NodeId> createdNodeIds;
-    };
+    DependencyGraph() = default;
+    DependencyGraph(const DependencyGraph&) = delete;
+    DependencyGraph& operator=(const DependencyGraph&) = delete;
 
     void addNodes(const NodeId* ids, uint32_t count);
 
@@ -68,10 +46,6 @@ class DependencyGraph {
 
     void addDep(NodeId child_id, NodeId parent_id);
 
-    DepNode* getDepNode(NodeId id);
-
-    ApiNode* getApiNode(NodeId id);
-
     void clearChildDependencies(NodeId id);
 
     void removeGrandChildren(const NodeId id);
@@ -83,13 +57,83 @@ class DependencyGraph {
     void removeApiNode(ApiCallId id);
     void addDepNode(NodeId id);
 
+    // Appends the api calls that created the live nodes, in node creation order and without
+    // duplicates. The creation order is maintained as nodes come and go, so this is a walk
+    // over the live nodes rather than a sort.
     void getIdsByTimestamp(std::vector<ApiCallId>& uniqApiRefsByTimestamp);
 
+    size_t getNodeCount() const { return mNodeIndices.size(); }
+    // Number of child references held by the node, including stale ones.
+    size_t getChildReferenceCount(NodeId id);
+
    private:
+    static constexpr uint32_t kNoIndex = UINT32_MAX;
+    static constexpr uint32_t kSlabBits = 10;
+    static constexpr uint32_t kSlabSize = 1u << kSlabBits;
+
+    // Refers to a node slot. The slot's generation is bumped whenever the slot is freed, so
+    // references held by other nodes go stale instead of pointing at an unrelated node.
+    struct NodeRef {
+        uint32_t index = kNoIndex;
+        uint32_t generation = 0;
+
+        bool operator==(const NodeRef& other) const {
+            return index == other.index && generation == other.generation;
+        }
+        bool operator<(const NodeRef& other) const {
+            return index != other.index ? index < other.index : generation < other.generation;
+        }
+    };
+
+    struct DepNode {
+        // id of this depnode, kInvalidNodeId while the slot is free.
+        // this id comes from boxed handle manager new_xxx
+        // and boxed handle manager use the following format
+        // <tag>-<gen>-<index>, this format does not follow
+        // the id creation order; prevByTime/nextByTime link
+        // the live nodes in creation order instead.
+        NodeId id{kInvalidNodeId};
+        // the api that created this DepNode; 0 is invalid
+        ApiCallId apiCallId{0};
+        uint32_t generation{0};
+        // neighbours in creation order, or the next free slot while free.
+        uint32_t prevByTime{kNoIndex};
+        uint32_t nextByTime{kNoIndex};
+        // sorted and without duplicates, but may hold stale references to removed children,
+        // see addDep().
+        SmallFixedVector<NodeRef, 4> children;
+    };
+
+    DepNode& nodeAt(uint32_t index) {
+        return mSlabs[index >> kSlabBits][index & (kSlabSize - 1)];
+    }
+
+    DepNode* getDepNode(NodeId id);
+    DepNode* getDepNode(NodeRef ref);
+    NodeRef getRef(NodeId id) const;
+
+    uint32_t allocateNode();
+    void freeNode(uint32_t index);
+
     void removeNodeAndDescendants(NodeId id);
-    std::atomic<uint64_t> mTimestamp{DepNode::kInvalidNodeId};
-    std::unordered_map<NodeId, std::unique_ptr<DepNode>> mDepId2DepNode;
-    std::unordered_map<ApiCallId, std::unique_ptr<ApiNode>> mApiId2ApiNode;
+    // Removes every node reachable from the nodes in mRemovalStack.
+    void drainRemovalStack();
+
+    std::vector<std::unique_ptr<DepNode[]>> mSlabs;
+    uint32_t mSlotCount = 0;
+    uint32_t mFreeHead = kNoIndex;
+    uint32_t mOldest = kNoIndex;
+    uint32_t mNewest = kNoIndex;
+
+    std::unordered_map<NodeId, uint32_t> mNodeIndices;
+
+    // this is created by VkDecoderSnapshot, to record
+    // the api trace, such as "vkCreateInstance..."
+    // each of such trace is assigned a unique api call id
+    // and maps to the nodes it created.
+    std::unordered_map<ApiCallId, std::vector<NodeId>> mApiCreatedNodeIds;
+
+    std::vector<NodeRef> mRemovalStack;
 };
 
 }  // namespace vk
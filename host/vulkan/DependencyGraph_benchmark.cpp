@@ -0,0 +1,102 @@
+// Copyright (C) 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include "DependencyGraph.h"
+#include "VulkanBoxedHandles.h"
+
+namespace gfxstream {
+namespace vk {
+namespace {
+
+using NodeId = DependencyGraph::NodeId;
+
+NodeId MakeId(BoxedHandleTypeTag tag, uint64_t index) {
+    return (static_cast<uint64_t>(tag) << 48) | index;
+}
+
+// A device with `state.range(0)` live buffers, each bound to memory, where buffers are
+// continuously destroyed and replaced by new ones as a long running guest would.
+void BM_DependencyGraphChurn(benchmark::State& state) {
+    const uint64_t liveBuffers = state.range(0);
+
+    DependencyGraph graph;
+    uint64_t nextIndex = 1;
+    uint64_t nextApiCall = 1;
+
+    const NodeId device = MakeId(Tag_VkDevice, nextIndex++);
+    graph.addNodes(&device, 1);
+    graph.associateWithApiCall(&device, 1, nextApiCall++);
+
+    std::vector<NodeId> buffers;
+    auto createBuffer = [&]() {
+        const NodeId buffer = MakeId(Tag_VkBuffer, nextIndex++);
+        const NodeId memory = MakeId(Tag_VkDeviceMemory, nextIndex++);
+        const NodeId bind = MakeId(Tag_VkBindMemory, nextIndex++);
+        const NodeId ids[] = {buffer, memory, bind};
+        graph.addNodes(ids, 3);
+        for (NodeId id : ids) {
+            graph.associateWithApiCall(&id, 1, nextApiCall++);
+        }
+        graph.addNodeIdDependencies(&buffer, 1, device);
+        graph.addNodeIdDependencies(&memory, 1, device);
+        graph.addNodeIdDependencies(&bind, 1, memory);
+        graph.addNodeIdDependencies(&bind, 1, buffer);
+        buffers.push_back(buffer);
+        buffers.push_back(memory);
+    };
+    for (uint64_t i = 0; i < liveBuffers; ++i) {
+        createBuffer();
+    }
+
+    std::mt19937 rng(42);
+    for (auto _ : state) {
+        const size_t victim = (rng() % liveBuffers) * 2;
+        graph.removeNodesAndDescendants(&buffers[victim], 2);
+        buffers[victim] = buffers[buffers.size() - 2];
+        buffers[victim + 1] = buffers.back();
+        buffers.resize(buffers.size() - 2);
+        createBuffer();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DependencyGraphChurn)->Arg(1000)->Arg(100000);
+
+void BM_DependencyGraphGetIdsByTimestamp(benchmark::State& state) {
+    DependencyGraph graph;
+    for (int64_t i = 1; i <= state.range(0); ++i) {
+        const NodeId image = MakeId(Tag_VkImage, i);
+        graph.addNodes(&image, 1);
+        graph.associateWithApiCall(&image, 1, i);
+    }
+
+    std::vector<DependencyGraph::ApiCallId> apiCalls;
+    for (auto _ : state) {
+        apiCalls.clear();
+        graph.getIdsByTimestamp(apiCalls);
+        benchmark::DoNotOptimize(apiCalls.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DependencyGraphGetIdsByTimestamp)->Arg(1000)->Arg(100000);
+
+}  // namespace
+}  // namespace vk
+}  // namespace gfxstream
+
+BENCHMARK_MAIN();
@@ -0,0 +1,181 @@
+// Copyright (C) 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "DependencyGraph.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "VulkanBoxedHandles.h"
+
+namespace gfxstream {
+namespace vk {
+namespace {
+
+using ::testing::ElementsAre;
+
+using NodeId = DependencyGraph::NodeId;
+
+NodeId MakeId(BoxedHandleTypeTag tag, uint64_t index) {
+    return (static_cast<uint64_t>(tag) << 48) | index;
+}
+
+void AddNode(DependencyGraph& graph, NodeId id, DependencyGraph::ApiCallId apiCallId) {
+    graph.addNodes(&id, 1);
+    graph.associateWithApiCall(&id, 1, apiCallId);
+}
+
+std::vector<DependencyGraph::ApiCallId> GetApiCalls(DependencyGraph& graph) {
+    std::vector<DependencyGraph::ApiCallId> apiCalls;
+    graph.getIdsByTimestamp(apiCalls);
+    return apiCalls;
+}
+
+TEST(DependencyGraphTest, RemovesDescendants) {
+    DependencyGraph graph;
+    const NodeId instance = MakeId(Tag_VkInstance, 1);
+    const NodeId device = MakeId(Tag_VkDevice, 2);
+    const NodeId image = MakeId(Tag_VkImage, 3);
+    const NodeId view = MakeId(Tag_VkImageView, 4);
+    AddNode(graph, instance, 1);
+    AddNode(graph, device, 2);
+    AddNode(graph, image, 3);
+    AddNode(graph, view, 4);
+    graph.addNodeIdDependencies(&device, 1, instance);
+    graph.addNodeIdDependencies(&image, 1, device);
+    graph.addNodeIdDependencies(&view, 1, image);
+
+    graph.removeNodesAndDescendants(&device, 1);
+
+    EXPECT_EQ(graph.getNodeCount(), 1u);
+    EXPECT_THAT(GetApiCalls(graph), ElementsAre(1));
+}
+
+TEST(DependencyGraphTest, RemovesGrandChildrenOnly) {
+    DependencyGraph graph;
+    const NodeId device = MakeId(Tag_VkDevice, 1);
+    const NodeId pool = MakeId(Tag_VkDescriptorPool, 2);
+    const NodeId set = MakeId(Tag_VkDescriptorSet, 3);
+    const NodeId sampler = MakeId(Tag_VkSampler, 4);
+    AddNode(graph, device, 1);
+    AddNode(graph, pool, 2);
+    AddNode(graph, set, 3);
+    AddNode(graph, sampler, 4);
+    graph.addNodeIdDependencies(&pool, 1, device);
+    graph.addNodeIdDependencies(&set, 1, pool);
+    graph.addNodeIdDependencies(&sampler, 1, set);
+
+    graph.removeGrandChildren(device);
+
+    EXPECT_THAT(GetApiCalls(graph), ElementsAre(1, 2));
+}
+
+TEST(DependencyGraphTest, KeepsShaderModulesAndRenderPasses) {
+    DependencyGraph graph;
+    const NodeId shader = MakeId(Tag_VkShaderModule, 1);
+    const NodeId renderPass = MakeId(Tag_VkRenderPass, 2);
+    AddNode(graph, shader, 1);
+    AddNode(graph, renderPass, 2);
+
+    const NodeId toRemove[] = {shader, renderPass};
+    graph.removeNodesAndDescendants(toRemove, 2);
+
+    EXPECT_EQ(graph.getNodeCount(), 2u);
+}
+
+TEST(DependencyGraphTest, OrdersApiCallsByNodeCreation) {
+    DependencyGraph graph;
+    const NodeId device = MakeId(Tag_VkDevice, 1);
+    const NodeId bufferA = MakeId(Tag_VkBuffer, 2);
+    const NodeId bufferB = MakeId(Tag_VkBuffer, 3);
+    const NodeId bufferC = MakeId(Tag_VkBuffer, 4);
+    AddNode(graph, device, 10);
+    AddNode(graph, bufferA, 11);
+    AddNode(graph, bufferB, 12);
+    graph.removeNodesAndDescendants(&bufferA, 1);
+    // Reuses the slot of bufferA but must still be ordered last.
+    AddNode(graph, bufferC, 13);
+    // The same call creating several nodes is only reported once.
+    AddNode(graph, bufferA, 12);
+
+    EXPECT_THAT(GetApiCalls(graph), ElementsAre(10, 12, 13));
+}
+
+TEST(DependencyGraphTest, RecreatedNodeIsNotAChildOfTheOldParent) {
+    DependencyGraph graph;
+    const NodeId memory = MakeId(Tag_VkDeviceMemory, 1);
+    const NodeId bind = MakeId(Tag_VkBindMemory, 2);
+    AddNode(graph, memory, 1);
+    AddNode(graph, bind, 2);
+    graph.addNodeIdDependencies(&bind, 1, memory);
+
+    graph.removeNodesAndDescendants(&bind, 1);
+    AddNode(graph, bind, 3);
+    graph.removeNodesAndDescendants(&memory, 1);
+
+    EXPECT_THAT(GetApiCalls(graph), ElementsAre(3));
+}
+
+TEST(DependencyGraphTest, RecordsEachDependencyOnce) {
+    DependencyGraph graph;
+    const NodeId device = MakeId(Tag_VkDevice, 1);
+    const NodeId bufferA = MakeId(Tag_VkBuffer, 2);
+    const NodeId bufferB = MakeId(Tag_VkBuffer, 3);
+    const NodeId bufferC = MakeId(Tag_VkBuffer, 4);
+    AddNode(graph, device, 1);
+    AddNode(graph, bufferA, 2);
+    AddNode(graph, bufferB, 3);
+    AddNode(graph, bufferC, 4);
+
+    // Interleaved, so that the repeated dependency is never the last one added.
+    for (int i = 0; i < 100; ++i) {
+        graph.addNodeIdDependencies(&bufferA, 1, device);
+        graph.addNodeIdDependencies(&bufferB, 1, device);
+        graph.addNodeIdDependencies(&bufferC, 1, device);
+    }
+    EXPECT_EQ(graph.getChildReferenceCount(device), 3u);
+
+    // A recreated child is a different child.
+    graph.removeNodesAndDescendants(&bufferB, 1);
+    AddNode(graph, bufferB, 5);
+    graph.addNodeIdDependencies(&bufferB, 1, device);
+    graph.addNodeIdDependencies(&bufferA, 1, device);
+    EXPECT_EQ(graph.getChildReferenceCount(device), 4u);
+
+    graph.removeNodesAndDescendants(&device, 1);
+    EXPECT_EQ(graph.getNodeCount(), 0u);
+}
+
+TEST(DependencyGraphTest, ManyChildrenChurn) {
+    DependencyGraph graph;
+    const NodeId device = MakeId(Tag_VkDevice, 1);
+    AddNode(graph, device, 1);
+    for (uint64_t i = 0; i < 10000; ++i) {
+        const NodeId buffer = MakeId(Tag_VkBuffer, 2 + i);
+        AddNode(graph, buffer, 2 + i);
+        graph.addNodeIdDependencies(&buffer, 1, device);
+        if (i % 2 == 0) {
+            graph.removeNodesAndDescendants(&buffer, 1);
+        }
+    }
+    EXPECT_EQ(graph.getNodeCount(), 5001u);
+
+    graph.removeNodesAndDescendants(&device, 1);
+    EXPECT_EQ(graph.getNodeCount(), 0u);
+    EXPECT_TRUE(GetApiCalls(graph).empty());
+}
+
+}  // namespace
+}  // namespace vk
+}  // namespace gfxstream
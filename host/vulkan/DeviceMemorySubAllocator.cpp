@@ -0,0 +1,230 @@
+// Copyright (C) 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "DeviceMemorySubAllocator.h"
+
+#include <algorithm>
+
+#include "gfxstream/common/logging.h"
+
+namespace gfxstream {
+namespace vk {
+namespace {
+
+VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+VkDeviceSize nextPowerOfTwo(VkDeviceSize value) {
+    VkDeviceSize result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+}  // namespace
+
+DeviceMemorySubAllocator::DeviceMemorySubAllocator(VkDeviceSize bufferImageGranularity,
+                                                   Callbacks callbacks)
+    : mBufferImageGranularity(nextPowerOfTwo(std::max<VkDeviceSize>(bufferImageGranularity, 1))),
+      mCallbacks(std::move(callbacks)) {}
+
+DeviceMemorySubAllocator::~DeviceMemorySubAllocator() { clear(); }
+
+void DeviceMemorySubAllocator::addRequiredAlignment(uint32_t memoryTypeBits,
+                                                    VkDeviceSize alignment) {
+    alignment = nextPowerOfTwo(std::max<VkDeviceSize>(alignment, 1));
+    for (uint32_t i = 0; i < VK_MAX_MEMORY_TYPES; ++i) {
+        if (memoryTypeBits & (1u << i)) {
+            mRequiredAlignments[i] = std::max(mRequiredAlignments[i], alignment);
+        }
+    }
+}
+
+VkDeviceSize DeviceMemorySubAllocator::getAlignment(uint32_t memoryTypeIndex,
+                                                    VkDeviceSize size) const {
+    const VkDeviceSize alignment =
+        std::max(std::clamp(nextPowerOfTwo(size), kMinAlignment, kMaxAlignment),
+                 mRequiredAlignments[memoryTypeIndex]);
+    // Rounding both the start and the size to the granularity keeps linear and optimal
+    // resources of neighbouring sub-allocations from aliasing on the same page.
+    return std::max(alignment, mBufferImageGranularity);
+}
+
+std::optional<VkDeviceSize> DeviceMemorySubAllocator::allocateFromBlock(Block& block,
+                                                                        VkDeviceSize size,
+                                                                        VkDeviceSize alignment) {
+    for (auto it = block.freeRanges.begin(); it != block.freeRanges.end(); ++it) {
+        const VkDeviceSize rangeOffset = it->first;
+        const VkDeviceSize rangeEnd = rangeOffset + it->second;
+        const VkDeviceSize offset = alignUp(rangeOffset, alignment);
+        if (offset + size > rangeEnd) {
+            continue;
+        }
+
+        block.freeRanges.erase(it);
+        if (offset > rangeOffset) {
+            block.freeRanges.emplace(rangeOffset, offset - rangeOffset);
+        }
+        if (offset + size < rangeEnd) {
+            block.freeRanges.emplace(offset + size, rangeEnd - (offset + size));
+        }
+        return offset;
+    }
+    return std::nullopt;
+}
+
+std::optional<DeviceMemorySubAllocator::SubAllocation> DeviceMemorySubAllocator::allocate(
+    uint32_t memoryTypeIndex, VkDeviceSize size) {
+    if (size == 0 || size > kMaxSubAllocationSize || memoryTypeIndex >= VK_MAX_MEMORY_TYPES) {
+        return std::nullopt;
+    }
+
+    if (mRequiredAlignments[memoryTypeIndex] > kMaxAlignment) {
+        return std::nullopt;
+    }
+
+    const VkDeviceSize alignment = getAlignment(memoryTypeIndex, size);
+    const VkDeviceSize alignedSize = alignUp(size, alignment);
+
+    Block* block = nullptr;
+    std::optional<VkDeviceSize> offset;
+    for (auto& candidate : mBlocks[memoryTypeIndex]) {
+        offset = allocateFromBlock(*candidate, alignedSize, alignment);
+        if (offset) {
+            block = candidate.get();
+            break;
+        }
+    }
+
+    if (!block) {
+        VkDeviceMemory memory = mCallbacks.allocateBlock(memoryTypeIndex, kBlockSize);
+        if (memory == VK_NULL_HANDLE) {
+            GFXSTREAM_WARNING("Failed to allocate a %llu byte block for memory type %u.",
+                              static_cast<unsigned long long>(kBlockSize), memoryTypeIndex);
+            return std::nullopt;
+        }
+
+        auto newBlock = std::make_unique<Block>();
+        newBlock->memory = memory;
+        newBlock->memoryTypeIndex = memoryTypeIndex;
+        newBlock->freeRanges.emplace(0, kBlockSize);
+        block = newBlock.get();
+        mBlocks[memoryTypeIndex].push_back(std::move(newBlock));
+        GFXSTREAM_DEBUG("Allocated block %zu for memory type %u with %zu live sub-allocations.",
+                        mBlocks[memoryTypeIndex].size(), memoryTypeIndex, mAllocations.size());
+
+        offset = allocateFromBlock(*block, alignedSize, alignment);
+    }
+
+    auto allocation = std::make_unique<Allocation>();
+    allocation->block = block;
+    allocation->offset = *offset;
+    allocation->size = alignedSize;
+    ++block->subAllocationCount;
+
+    // The address of the bookkeeping is unique among live allocations, which makes it a
+    // convenient handle that can not collide with another sub-allocation.
+    const VkDeviceMemory handle = reinterpret_cast<VkDeviceMemory>(allocation.get());
+    mAllocations.emplace(handle, std::move(allocation));
+
+    return SubAllocation{
+        .handle = handle,
+        .blockMemory = block->memory,
+        .blockOffset = *offset,
+    };
+}
+
+void DeviceMemorySubAllocator::free(VkDeviceMemory handle) {
+    auto it = mAllocations.find(handle);
+    if (it == mAllocations.end()) {
+        GFXSTREAM_ERROR("Unknown sub-allocated VkDeviceMemory:%p", handle);
+        return;
+    }
+    const Allocation allocation = *it->second;
+    mAllocations.erase(it);
+
+    Block* block = allocation.block;
+    VkDeviceSize offset = allocation.offset;
+    VkDeviceSize size = allocation.size;
+
+    // Coalesce with the free neighbours.
+    auto next = block->freeRanges.lower_bound(offset);
+    if (next != block->freeRanges.begin()) {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset) {
+            offset = prev->first;
+            size += prev->second;
+            block->freeRanges.erase(prev);
+        }
+    }
+    if (next != block->freeRanges.end() && offset + size == next->first) {
+        size += next->second;
+        block->freeRanges.erase(next);
+    }
+    block->freeRanges.emplace(offset, size);
+
+    // Keep the last block of each type around so that a guest repeatedly allocating and
+    // freeing a single small allocation does not allocate a block each time.
+    if (--block->subAllocationCount == 0 && mBlocks[block->memoryTypeIndex].size() > 1) {
+        freeBlock(block);
+    }
+}
+
+void DeviceMemorySubAllocator::freeBlock(Block* block) {
+    auto& blocks = mBlocks[block->memoryTypeIndex];
+    auto it = std::find_if(blocks.begin(), blocks.end(),
+                           [block](const std::unique_ptr<Block>& b) { return b.get() == block; });
+    if (it == blocks.end()) {
+        return;
+    }
+    mCallbacks.freeBlock(block->memory);
+    blocks.erase(it);
+}
+
+void DeviceMemorySubAllocator::clear() {
+    if (!mAllocations.empty()) {
+        GFXSTREAM_DEBUG("Freeing %zu outstanding sub-allocations.", mAllocations.size());
+    }
+    mAllocations.clear();
+    for (auto& blocks : mBlocks) {
+        for (auto& block : blocks) {
+            mCallbacks.freeBlock(block->memory);
+        }
+        blocks.clear();
+    }
+}
+
+DeviceMemorySubAllocator::Stats DeviceMemorySubAllocator::getStats() const {
+    Stats stats;
+    for (const auto& blocks : mBlocks) {
+        for (const auto& block : blocks) {
+            ++stats.blockCount;
+            stats.blockBytes += kBlockSize;
+            for (const auto& [offset, size] : block->freeRanges) {
+                stats.freeBytes += size;
+                stats.largestFreeRange = std::max(stats.largestFreeRange, size);
+            }
+        }
+    }
+    stats.subAllocationCount = static_cast<uint32_t>(mAllocations.size());
+    for (const auto& [handle, allocation] : mAllocations) {
+        stats.usedBytes += allocation->size;
+    }
+    return stats;
+}
+
+}  // namespace vk
+}  // namespace gfxstream
@@ -0,0 +1,129 @@
+// Copyright (C) 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace gfxstream {
+namespace vk {
+
+// Places small guest VkDeviceMemory allocations inside larger host VkDeviceMemory blocks so
+// that guests making many small allocations do not run into the driver's
+// maxMemoryAllocationCount or pay the kernel overhead of an allocation each time.
+//
+// Every sub-allocation is identified by a placeholder VkDeviceMemory handle that is only
+// meaningful to the decoder. It must be translated to its block and offset before being
+// passed to the driver. Not thread safe.
+class DeviceMemorySubAllocator {
+   public:
+    // Allocations larger than this go straight to the driver.
+    static constexpr VkDeviceSize kMaxSubAllocationSize = 256 * 1024;
+    static constexpr VkDeviceSize kBlockSize = 16 * 1024 * 1024;
+
+    // The guest binds resources at offsets that are aligned relative to the start of its
+    // allocation, so the start of each sub-allocation must satisfy the alignment of any
+    // resource that fits inside of it. Sub-allocations are aligned to their size within these
+    // bounds, and to the largest alignment reported for a resource of their memory type.
+    static constexpr VkDeviceSize kMinAlignment = 4 * 1024;
+    static constexpr VkDeviceSize kMaxAlignment = 64 * 1024;
+
+    struct Callbacks {
+        // Returns VK_NULL_HANDLE on failure.
+        std::function<VkDeviceMemory(uint32_t memoryTypeIndex, VkDeviceSize size)> allocateBlock;
+        std::function<void(VkDeviceMemory memory)> freeBlock;
+    };
+
+    struct SubAllocation {
+        // Identifies the sub-allocation to the decoder, never passed to the driver.
+        VkDeviceMemory handle = VK_NULL_HANDLE;
+        VkDeviceMemory blockMemory = VK_NULL_HANDLE;
+        VkDeviceSize blockOffset = 0;
+    };
+
+    struct Stats {
+        uint32_t blockCount = 0;
+        VkDeviceSize blockBytes = 0;
+        uint32_t subAllocationCount = 0;
+        VkDeviceSize usedBytes = 0;
+        VkDeviceSize freeBytes = 0;
+        VkDeviceSize largestFreeRange = 0;
+
+        // 0 when all free space is contiguous, approaching 1 as it is split into
+        // ranges that are too small to be useful.
+        float fragmentation() const {
+            return freeBytes ? 1.0f - static_cast<float>(largestFreeRange) / freeBytes : 0.0f;
+        }
+    };
+
+    DeviceMemorySubAllocator(VkDeviceSize bufferImageGranularity, Callbacks callbacks);
+    ~DeviceMemorySubAllocator();
+
+    DeviceMemorySubAllocator(const DeviceMemorySubAllocator&) = delete;
+    DeviceMemorySubAllocator& operator=(const DeviceMemorySubAllocator&) = delete;
+
+    // Returns std::nullopt if the allocation is too large to be sub-allocated or if a new
+    // block could not be allocated, in which case the caller should allocate directly.
+    // Also returns std::nullopt once a resource of the memory type needed an alignment
+    // larger than kMaxAlignment, as padding every sub-allocation to it would waste too much.
+    std::optional<SubAllocation> allocate(uint32_t memoryTypeIndex, VkDeviceSize size);
+
+    // Records the alignment of a resource that may be bound to any of `memoryTypeBits`, from
+    // the host memory requirements. Only applies to later allocations.
+    void addRequiredAlignment(uint32_t memoryTypeBits, VkDeviceSize alignment);
+
+    void free(VkDeviceMemory handle);
+
+    // Frees every block, including those with live sub-allocations.
+    void clear();
+
+    Stats getStats() const;
+
+   private:
+    struct Block {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        uint32_t memoryTypeIndex = 0;
+        uint32_t subAllocationCount = 0;
+        // Offset to size of the unused ranges of the block.
+        std::map<VkDeviceSize, VkDeviceSize> freeRanges;
+    };
+
+    struct Allocation {
+        Block* block = nullptr;
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = 0;
+    };
+
+    VkDeviceSize getAlignment(uint32_t memoryTypeIndex, VkDeviceSize size) const;
+    std::optional<VkDeviceSize> allocateFromBlock(Block& block, VkDeviceSize size,
+                                                  VkDeviceSize alignment);
+    void freeBlock(Block* block);
+
+    const VkDeviceSize mBufferImageGranularity;
+    const Callbacks mCallbacks;
+
+    std::vector<std::unique_ptr<Block>> mBlocks[VK_MAX_MEMORY_TYPES];
+    VkDeviceSize mRequiredAlignments[VK_MAX_MEMORY_TYPES] = {};
+    std::unordered_map<VkDeviceMemory, std::unique_ptr<Allocation>> mAllocations;
+};
+
+}  // namespace vk
+}  // namespace gfxstream
@@ -0,0 +1,234 @@
+// Copyright (C) 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "DeviceMemorySubAllocator.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <set>
+#include <vector>
+
+namespace gfxstream {
+namespace vk {
+namespace {
+
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
+
+class DeviceMemorySubAllocatorTest : public ::testing::Test {
+   protected:
+    DeviceMemorySubAllocator::Callbacks makeCallbacks() {
+        return DeviceMemorySubAllocator::Callbacks{
+            .allocateBlock = [this](uint32_t memoryTypeIndex,
+                                    VkDeviceSize size) -> VkDeviceMemory {
+                if (mFailBlockAllocations) {
+                    return VK_NULL_HANDLE;
+                }
+                VkDeviceMemory memory = reinterpret_cast<VkDeviceMemory>(mNextBlock++);
+                mLiveBlocks.insert(memory);
+                return memory;
+            },
+            .freeBlock = [this](VkDeviceMemory memory) { mLiveBlocks.erase(memory); },
+        };
+    }
+
+    uintptr_t mNextBlock = 0x1000;
+    bool mFailBlockAllocations = false;
+    std::set<VkDeviceMemory> mLiveBlocks;
+};
+
+TEST_F(DeviceMemorySubAllocatorTest, PacksSmallAllocationsIntoOneBlock) {
+    DeviceMemorySubAllocator allocator(1, makeCallbacks());
+
+    std::vector<DeviceMemorySubAllocator::SubAllocation> subAllocations;
+    std::set<VkDeviceMemory> handles;
+    for (int i = 0; i < 100; i++) {
+        auto subAllocation = allocator.allocate(0, 1000);
+        ASSERT_TRUE(subAllocation.has_value());
+        EXPECT_EQ(subAllocation->blockOffset % DeviceMemorySubAllocator::kMinAlignment, 0u);
+        handles.insert(subAllocation->handle);
+        subAllocations.push_back(*subAllocation);
+    }
+
+    EXPECT_THAT(mLiveBlocks, SizeIs(1));
+    EXPECT_THAT(handles, SizeIs(100));
+
+    const auto stats = allocator.getStats();
+    EXPECT_EQ(stats.blockCount, 1u);
+    EXPECT_EQ(stats.subAllocationCount, 100u);
+    EXPECT_EQ(stats.usedBytes, 100u * DeviceMemorySubAllocator::kMinAlignment);
+    EXPECT_EQ(stats.usedBytes + stats.freeBytes, stats.blockBytes);
+
+    for (const auto& subAllocation : subAllocations) {
+        allocator.free(subAllocation.handle);
+    }
+    EXPECT_EQ(allocator.getStats().subAllocationCount, 0u);
+    EXPECT_EQ(allocator.getStats().fragmentation(), 0.0f);
+}
+
+TEST_F(DeviceMemorySubAllocatorTest, DoesNotOverlap) {
+    DeviceMemorySubAllocator allocator(1, makeCallbacks());
+
+    struct Range {
+        VkDeviceMemory block;
+        VkDeviceSize begin;
+        VkDeviceSize end;
+    };
+    std::vector<Range> ranges;
+    for (VkDeviceSize size = 1; size <= DeviceMemorySubAllocator::kMaxSubAllocationSize;
+         size = size * 3 + 1) {
+        auto subAllocation = allocator.allocate(0, size);
+        ASSERT_TRUE(subAllocation.has_value());
+        ranges.push_back(Range{subAllocation->blockMemory, subAllocation->blockOffset,
+                               subAllocation->blockOffset + size});
+    }
+    for (size_t i = 0; i < ranges.size(); i++) {
+        for (size_t j = i + 1; j < ranges.size(); j++) {
+            if (ranges[i].block != ranges[j].block) continue;
+            EXPECT_TRUE(ranges[i].end <= ranges[j].begin || ranges[j].end <= ranges[i].begin);
+        }
+    }
+}
+
+TEST_F(DeviceMemorySubAllocatorTest, HonorsBufferImageGranularity) {
+    constexpr VkDeviceSize kGranularity = 128 * 1024;
+    DeviceMemorySubAllocator allocator(kGranularity, makeCallbacks());
+
+    auto first = allocator.allocate(0, 256);
+    auto second = allocator.allocate(0, 256);
+    ASSERT_TRUE(first.has_value());
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(first->blockOffset % kGranularity, 0u);
+    EXPECT_EQ(second->blockOffset % kGranularity, 0u);
+    EXPECT_NE(first->blockOffset, second->blockOffset);
+}
+
+TEST_F(DeviceMemorySubAllocatorTest, HonorsRequiredAlignment) {
+    constexpr VkDeviceSize kAlignment = 32 * 1024;
+    DeviceMemorySubAllocator allocator(1, makeCallbacks());
+    allocator.addRequiredAlignment(0b101, kAlignment);
+
+    for (uint32_t memoryTypeIndex : {0u, 2u}) {
+        auto first = allocator.allocate(memoryTypeIndex, 256);
+        auto second = allocator.allocate(memoryTypeIndex, 256);
+        ASSERT_TRUE(first.has_value());
+        ASSERT_TRUE(second.has_value());
+        EXPECT_EQ(first->blockOffset % kAlignment, 0u);
+        EXPECT_EQ(second->blockOffset % kAlignment, 0u);
+    }
+
+    // Other memory types keep the alignment based on the size.
+    auto first = allocator.allocate(1, 256);
+    auto second = allocator.allocate(1, 256);
+    ASSERT_TRUE(first.has_value());
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(second->blockOffset - first->blockOffset, DeviceMemorySubAllocator::kMinAlignment);
+}
+
+TEST_F(DeviceMemorySubAllocatorTest, RejectsAlignmentsLargerThanTheMaximum) {
+    DeviceMemorySubAllocator allocator(1, makeCallbacks());
+    allocator.addRequiredAlignment(0b1, DeviceMemorySubAllocator::kMaxAlignment * 2);
+
+    EXPECT_FALSE(allocator.allocate(0, 4096));
+    EXPECT_THAT(mLiveBlocks, IsEmpty());
+    EXPECT_TRUE(allocator.allocate(1, 4096));
+}
+
+TEST_F(DeviceMemorySubAllocatorTest, SeparatesMemoryTypes) {
+    DeviceMemorySubAllocator allocator(1, makeCallbacks());
+
+    auto first = allocator.allocate(0, 4096);
+    auto second = allocator.allocate(3, 4096);
+    ASSERT_TRUE(first.has_value());
+    ASSERT_TRUE(second.has_value());
+    EXPECT_NE(first->blockMemory, second->blockMemory);
+    EXPECT_THAT(mLiveBlocks, SizeIs(2));
+}
+
+TEST_F(DeviceMemorySubAllocatorTest, RejectsLargeAllocations) {
+    DeviceMemorySubAllocator allocator(1, makeCallbacks());
+
+    EXPECT_FALSE(allocator.allocate(0, DeviceMemorySubAllocator::kMaxSubAllocationSize + 1));
+    EXPECT_FALSE(allocator.allocate(0, 0));
+    EXPECT_THAT(mLiveBlocks, IsEmpty());
+}
+
+TEST_F(DeviceMemorySubAllocatorTest, FallsBackWhenBlockAllocationFails) {
+    DeviceMemorySubAllocator allocator(1, makeCallbacks());
+
+    mFailBlockAllocations = true;
+    EXPECT_FALSE(allocator.allocate(0, 4096));
+}
+
+TEST_F(DeviceMemorySubAllocatorTest, ReleasesEmptyBlocksButTheLast) {
+    DeviceMemorySubAllocator allocator(1, makeCallbacks());
+
+    const VkDeviceSize size = DeviceMemorySubAllocator::kMaxSubAllocationSize;
+    const size_t perBlock = DeviceMemorySubAllocator::kBlockSize / size;
+
+    std::vector<VkDeviceMemory> handles;
+    for (size_t i = 0; i < perBlock * 3; i++) {
+        auto subAllocation = allocator.allocate(0, size);
+        ASSERT_TRUE(subAllocation.has_value());
+        handles.push_back(subAllocation->handle);
+    }
+    EXPECT_THAT(mLiveBlocks, SizeIs(3));
+
+    for (VkDeviceMemory handle : handles) {
+        allocator.free(handle);
+    }
+    EXPECT_THAT(mLiveBlocks, SizeIs(1));
+
+    allocator.clear();
+    EXPECT_THAT(mLiveBlocks, IsEmpty());
+}
+
+TEST_F(DeviceMemorySubAllocatorTest, CoalescesFreeRanges) {
+    DeviceMemorySubAllocator allocator(1, makeCallbacks());
+
+    std::vector<VkDeviceMemory> handles;
+    for (int i = 0; i < 64; i++) {
+        auto subAllocation = allocator.allocate(0, 4096);
+        ASSERT_TRUE(subAllocation.has_value());
+        handles.push_back(subAllocation->handle);
+    }
+
+    // Free every other allocation to fragment the block.
+    for (size_t i = 0; i < handles.size(); i += 2) {
+        allocator.free(handles[i]);
+    }
+    EXPECT_GT(allocator.getStats().fragmentation(), 0.0f);
+
+    for (size_t i = 1; i < handles.size(); i += 2) {
+        allocator.free(handles[i]);
+    }
+    const auto stats = allocator.getStats();
+    EXPECT_EQ(stats.largestFreeRange, DeviceMemorySubAllocator::kBlockSize);
+    EXPECT_EQ(stats.fragmentation(), 0.0f);
+}
+
+TEST_F(DeviceMemorySubAllocatorTest, FreesOutstandingBlocksOnDestruction) {
+    {
+        DeviceMemorySubAllocator allocator(1, makeCallbacks());
+        ASSERT_TRUE(allocator.allocate(0, 4096).has_value());
+        ASSERT_TRUE(allocator.allocate(1, 4096).has_value());
+        EXPECT_THAT(mLiveBlocks, SizeIs(2));
+    }
+    EXPECT_THAT(mLiveBlocks, IsEmpty());
+}
+
+}  // namespace
+}  // namespace vk
+}  // namespace gfxstream
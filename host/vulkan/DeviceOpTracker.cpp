@@ -66,6 +66,51 @@ void DeviceOpTracker::AddPendingGarbage(DeviceOpWaitable waitable, VkSemaphore s
     }
 }
 
+void DeviceOpTracker::AddDeferredDestroy(DeferredDestroyObject obj) {
+    std::lock_guard<std::mutex> lock(mPendingGarbageMutex);
+
+    if (mDeferredDestroyBatches.empty() ||
+        mDeferredDestroyBatches.back().submissionSerial != mSubmissionSerial) {
+        DeferredDestroyBatch batch{.submissionSerial = mSubmissionSerial};
+        for (const auto& [queue, waitable] : mLatestSubmissions) {
+            if (!IsDone(waitable)) {
+                batch.waitables.push_back(waitable);
+            }
+        }
+        mDeferredDestroyBatches.push_back(std::move(batch));
+    }
+    mDeferredDestroyBatches.back().objs.push_back(obj);
+}
+
+void DeviceOpTracker::OnQueueSubmitted(VkQueue queue, DeviceOpWaitable waitable) {
+    std::lock_guard<std::mutex> lock(mPendingGarbageMutex);
+    mLatestSubmissions[queue] = std::move(waitable);
+    ++mSubmissionSerial;
+}
+
+void DeviceOpTracker::DestroyDeferredObjects(const std::vector<DeferredDestroyObject>& objs) {
+    for (const auto& obj : objs) {
+        std::visit(
+            [this](auto&& arg) {
+                using T = std::decay_t<decltype(arg)>;
+                if constexpr (std::is_same_v<T, VkDescriptorPool>) {
+                    mDeviceDispatch->vkDestroyDescriptorPool(mDevice, arg, nullptr);
+                } else if constexpr (std::is_same_v<T, VkFramebuffer>) {
+                    mDeviceDispatch->vkDestroyFramebuffer(mDevice, arg, nullptr);
+                } else if constexpr (std::is_same_v<T, VkImageView>) {
+                    mDeviceDispatch->vkDestroyImageView(mDevice, arg, nullptr);
+                } else if constexpr (std::is_same_v<T, VkRenderPass>) {
+                    mDeviceDispatch->vkDestroyRenderPass(mDevice, arg, nullptr);
+                } else if constexpr (std::is_same_v<T, VkSampler>) {
+                    mDeviceDispatch->vkDestroySampler(mDevice, arg, nullptr);
+                } else {
+                    static_assert(always_false_v<T>, "non-exhaustive visitor!");
+                }
+            },
+            obj);
+    }
+}
+
 void DeviceOpTracker::PollAndProcessGarbage() {
     std::lock_guard<std::mutex> pollFunctionsLock(mPollFunctionsMutex);
     mPollFunctions.erase(std::remove_if(mPollFunctions.begin(), mPollFunctions.end(),
@@ -145,6 +190,27 @@ void DeviceOpTracker::PollAndProcessGarbage() {
                               mPendingGarbage.size());
         }
     }
+
+    // Batches are only taken off of the queue under the lock so that the (potentially many)
+    // destroys do not block threads deferring more objects.
+    std::vector<DeferredDestroyObject> deferredObjs;
+    {
+        std::lock_guard<std::mutex> pendingGarbageLock(mPendingGarbageMutex);
+        while (!mDeferredDestroyBatches.empty()) {
+            DeferredDestroyBatch& batch = mDeferredDestroyBatches.front();
+            if (!std::all_of(batch.waitables.begin(), batch.waitables.end(),
+                             [](const DeviceOpWaitable& waitable) { return IsDone(waitable); })) {
+                break;
+            }
+            if (deferredObjs.empty()) {
+                deferredObjs = std::move(batch.objs);
+            } else {
+                deferredObjs.insert(deferredObjs.end(), batch.objs.begin(), batch.objs.end());
+            }
+            mDeferredDestroyBatches.pop_front();
+        }
+    }
+    DestroyDeferredObjects(deferredObjs);
 }
 
 void DeviceOpTracker::OnDestroyDevice() {
@@ -152,12 +218,20 @@ void DeviceOpTracker::OnDestroyDevice() {
 
     PollAndProcessGarbage();
 
+    std::deque<DeferredDestroyBatch> deferredDestroyBatches;
     {
         std::lock_guard<std::mutex> lock(mPendingGarbageMutex);
         if (!mPendingGarbage.empty()) {
             GFXSTREAM_WARNING("VkDevice:%p has %d leaking garbage objects on destruction.", mDevice,
                               mPendingGarbage.size());
         }
+        deferredDestroyBatches = std::move(mDeferredDestroyBatches);
+        mDeferredDestroyBatches.clear();
+    }
+
+    // The device is idle so the remaining objects can not be in use anymore.
+    for (const auto& batch : deferredDestroyBatches) {
+        DestroyDeferredObjects(batch.objs);
     }
 }
 
@@ -195,7 +269,7 @@ VkFence DeviceOpBuilder::CreateFenceForOp() {
     return fence;
 }
 
-DeviceOpWaitable DeviceOpBuilder::OnQueueSubmittedWithFence(VkFence fence) {
+DeviceOpWaitable DeviceOpBuilder::OnQueueSubmittedWithFence(VkQueue queue, VkFence fence) {
     if (mCreatedFence.has_value() && fence != mCreatedFence) {
         GFXSTREAM_FATAL(
             "Invalid usage: failed to call OnQueueSubmittedWithFence() with the fence "
@@ -227,6 +301,7 @@ DeviceOpWaitable DeviceOpBuilder::OnQueueSubmittedWithFence(VkFence fence) {
 
         return result == VK_SUCCESS ? DeviceOpStatus::kDone : DeviceOpStatus::kFailure;
     });
+    mTracker.OnQueueSubmitted(queue, future);
 
     return future;
 }
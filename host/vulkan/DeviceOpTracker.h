@@ -22,7 +22,9 @@
 #include <future>
 #include <mutex>
 #include <optional>
+#include <unordered_map>
 #include <variant>
+#include <vector>
 
 #include "VulkanDispatch.h"
 #include "gfxstream/ThreadAnnotations.h"
@@ -60,6 +62,15 @@ class DeviceOpTracker {
     // semaphore can be destroyed once the waitable has finished.
     void AddPendingGarbage(DeviceOpWaitable waitable, VkSemaphore semaphore);
 
+    using DeferredDestroyObject =
+        std::variant<VkDescriptorPool, VkFramebuffer, VkImageView, VkRenderPass, VkSampler>;
+
+    // Transfers ownership of the object to this helper and marks that the given object
+    // can be destroyed once the host ops submitted so far to each queue of the device have
+    // completed. Objects deferred between two queue submissions are destroyed together in a
+    // single batch.
+    void AddDeferredDestroy(DeferredDestroyObject obj);
+
     // Checks for completion of previously submitted waitables and destroys dependent
     // objects.
     void PollAndProcessGarbage();
@@ -75,6 +86,8 @@ class DeviceOpTracker {
     using OpPollingFunction = std::function<DeviceOpStatus()>;
 
     void AddPendingDeviceOp(OpPollingFunction pollFunction);
+    void OnQueueSubmitted(VkQueue queue, DeviceOpWaitable waitable);
+    void DestroyDeferredObjects(const std::vector<DeferredDestroyObject>& objs);
     struct PollFunction {
         OpPollingFunction func;
         std::chrono::time_point<std::chrono::system_clock> timepoint;
@@ -89,6 +102,19 @@ class DeviceOpTracker {
     };
     std::mutex mPendingGarbageMutex;
     std::deque<PendingGarbage> mPendingGarbage GUARDED_BY(mPendingGarbageMutex);
+
+    struct DeferredDestroyBatch {
+        // The latest pending submission of each queue when the objects were deferred. The
+        // fence of a submission signals after all the earlier submissions to its queue have
+        // completed, so these cover every submission that may use the objects.
+        std::vector<DeviceOpWaitable> waitables;
+        uint64_t submissionSerial = 0;
+        std::vector<DeferredDestroyObject> objs;
+    };
+    std::deque<DeferredDestroyBatch> mDeferredDestroyBatches GUARDED_BY(mPendingGarbageMutex);
+    std::unordered_map<VkQueue, DeviceOpWaitable> mLatestSubmissions
+        GUARDED_BY(mPendingGarbageMutex);
+    uint64_t mSubmissionSerial GUARDED_BY(mPendingGarbageMutex) = 0;
 };
 
 class DeviceOpBuilder {
@@ -111,8 +137,8 @@ class DeviceOpBuilder {
     VkFence CreateFenceForOp();
 
     // Returns a waitable that can be used to check whether a host op
-    // has completed.
-    DeviceOpWaitable OnQueueSubmittedWithFence(VkFence fence);
+    // submitted to |queue| has completed.
+    DeviceOpWaitable OnQueueSubmittedWithFence(VkQueue queue, VkFence fence);
 
    private:
     DeviceOpTracker& mTracker;
@@ -0,0 +1,151 @@
+// Copyright (C) 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "DeviceOpTracker.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <set>
+#include <vector>
+
+namespace gfxstream {
+namespace vk {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+
+// The dispatch only holds function pointers so the fakes record into globals.
+std::set<VkFence> sSignaledFences;
+std::vector<uint64_t> sDestroyedObjects;
+
+VkResult FakeGetFenceStatus(VkDevice, VkFence fence) {
+    return sSignaledFences.count(fence) ? VK_SUCCESS : VK_NOT_READY;
+}
+
+VkResult FakeDeviceWaitIdle(VkDevice) { return VK_SUCCESS; }
+
+template <typename T>
+void FakeDestroy(VkDevice, T handle, const VkAllocationCallbacks*) {
+    sDestroyedObjects.push_back(reinterpret_cast<uint64_t>(handle));
+}
+
+template <typename T>
+T MakeHandle(uint64_t value) {
+    return reinterpret_cast<T>(value);
+}
+
+class DeviceOpTrackerTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        sSignaledFences.clear();
+        sDestroyedObjects.clear();
+
+        mDispatch.vkGetFenceStatus = FakeGetFenceStatus;
+        mDispatch.vkDeviceWaitIdle = FakeDeviceWaitIdle;
+        mDispatch.vkDestroyDescriptorPool = FakeDestroy<VkDescriptorPool>;
+        mDispatch.vkDestroyFramebuffer = FakeDestroy<VkFramebuffer>;
+        mDispatch.vkDestroyImageView = FakeDestroy<VkImageView>;
+        mDispatch.vkDestroyRenderPass = FakeDestroy<VkRenderPass>;
+        mDispatch.vkDestroySampler = FakeDestroy<VkSampler>;
+    }
+
+    DeviceOpWaitable Submit(DeviceOpTracker& tracker, VkFence fence,
+                            VkQueue queue = MakeHandle<VkQueue>(0x1000)) {
+        DeviceOpBuilder builder(tracker);
+        return builder.OnQueueSubmittedWithFence(queue, fence);
+    }
+
+    VulkanDispatch mDispatch = {};
+};
+
+TEST_F(DeviceOpTrackerTest, DeferredDestroyWithoutSubmissionsIsProcessedOnPoll) {
+    DeviceOpTracker tracker(MakeHandle<VkDevice>(1), &mDispatch);
+
+    tracker.AddDeferredDestroy(MakeHandle<VkImageView>(0x10));
+    tracker.AddDeferredDestroy(MakeHandle<VkFramebuffer>(0x11));
+    EXPECT_THAT(sDestroyedObjects, IsEmpty());
+
+    tracker.PollAndProcessGarbage();
+    EXPECT_THAT(sDestroyedObjects, ElementsAre(0x10, 0x11));
+}
+
+TEST_F(DeviceOpTrackerTest, DeferredDestroyWaitsForPreviousSubmissions) {
+    DeviceOpTracker tracker(MakeHandle<VkDevice>(1), &mDispatch);
+
+    const VkFence fence1 = MakeHandle<VkFence>(0x100);
+    const VkFence fence2 = MakeHandle<VkFence>(0x200);
+
+    Submit(tracker, fence1);
+    tracker.AddDeferredDestroy(MakeHandle<VkImageView>(0x10));
+    tracker.AddDeferredDestroy(MakeHandle<VkSampler>(0x11));
+
+    Submit(tracker, fence2);
+    tracker.AddDeferredDestroy(MakeHandle<VkRenderPass>(0x20));
+
+    tracker.PollAndProcessGarbage();
+    EXPECT_THAT(sDestroyedObjects, IsEmpty());
+
+    // Completing the first submission only releases the objects deferred before the second.
+    sSignaledFences.insert(fence1);
+    tracker.PollAndProcessGarbage();
+    EXPECT_THAT(sDestroyedObjects, ElementsAre(0x10, 0x11));
+
+    sSignaledFences.insert(fence2);
+    tracker.PollAndProcessGarbage();
+    EXPECT_THAT(sDestroyedObjects, ElementsAre(0x10, 0x11, 0x20));
+}
+
+TEST_F(DeviceOpTrackerTest, DeferredDestroyWaitsForEveryQueue) {
+    DeviceOpTracker tracker(MakeHandle<VkDevice>(1), &mDispatch);
+
+    const VkQueue queue1 = MakeHandle<VkQueue>(0x1000);
+    const VkQueue queue2 = MakeHandle<VkQueue>(0x2000);
+    const VkFence fence1 = MakeHandle<VkFence>(0x100);
+    const VkFence fence2 = MakeHandle<VkFence>(0x200);
+
+    // The object may be used by the earlier submission to the first queue, even if the later
+    // submission to the second queue completes first.
+    Submit(tracker, fence1, queue1);
+    Submit(tracker, fence2, queue2);
+    tracker.AddDeferredDestroy(MakeHandle<VkImageView>(0x10));
+
+    sSignaledFences.insert(fence2);
+    tracker.PollAndProcessGarbage();
+    EXPECT_THAT(sDestroyedObjects, IsEmpty());
+
+    sSignaledFences.insert(fence1);
+    tracker.PollAndProcessGarbage();
+    EXPECT_THAT(sDestroyedObjects, ElementsAre(0x10));
+}
+
+TEST_F(DeviceOpTrackerTest, DeferredDestroyIsFlushedOnDestroyDevice) {
+    DeviceOpTracker tracker(MakeHandle<VkDevice>(1), &mDispatch);
+
+    Submit(tracker, MakeHandle<VkFence>(0x100));
+    tracker.AddDeferredDestroy(MakeHandle<VkDescriptorPool>(0x10));
+    tracker.AddDeferredDestroy(MakeHandle<VkFramebuffer>(0x11));
+
+    tracker.PollAndProcessGarbage();
+    EXPECT_THAT(sDestroyedObjects, IsEmpty());
+
+    tracker.OnDestroyDevice();
+    EXPECT_THAT(sDestroyedObjects, UnorderedElementsAre(0x10, 0x11));
+}
+
+}  // namespace
+}  // namespace vk
+}  // namespace gfxstream
@@ -0,0 +1,134 @@
+// Copyright (C) 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "SubDecodeWorkerPool.h"
+
+#include <algorithm>
+
+namespace gfxstream {
+namespace vk {
+namespace {
+
+// The command pool whose task is running on the current thread, if any.
+thread_local VkCommandPool tCurrentCommandPool = VK_NULL_HANDLE;
+
+}  // namespace
+
+SubDecodeWorkerPool::SubDecodeWorkerPool(uint32_t threadCount) {
+    threadCount = std::max(threadCount, 1u);
+    mThreads.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++) {
+        mThreads.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+SubDecodeWorkerPool::~SubDecodeWorkerPool() {
+    waitAll();
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mWorkAvailable.notify_all();
+    for (auto& thread : mThreads) {
+        thread.join();
+    }
+}
+
+void SubDecodeWorkerPool::enqueue(VkCommandPool commandPool, Task task) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        PoolQueue& queue = mPoolQueues[commandPool];
+        queue.tasks.push_back(std::move(task));
+        if (queue.running || queue.tasks.size() > 1) {
+            // Already running or already in mReadyPools.
+            return;
+        }
+        mReadyPools.push_back(commandPool);
+    }
+    mWorkAvailable.notify_one();
+}
+
+void SubDecodeWorkerPool::wait(VkCommandPool commandPool) {
+    if (tCurrentCommandPool == commandPool) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (tCurrentCommandPool != VK_NULL_HANDLE) {
+        // Blocking a worker on tasks that are still queued could leave every worker waiting
+        // on work that no worker is left to run, so run them on this thread instead.
+        auto queueIt = mPoolQueues.find(commandPool);
+        if (queueIt != mPoolQueues.end() && !queueIt->second.running) {
+            mReadyPools.erase(std::find(mReadyPools.begin(), mReadyPools.end(), commandPool));
+            while (runNextTaskLocked(lock, commandPool)) {
+            }
+        }
+    }
+    mWorkDone.wait(lock, [this, commandPool]() REQUIRES(mMutex) {
+        return mPoolQueues.find(commandPool) == mPoolQueues.end();
+    });
+}
+
+void SubDecodeWorkerPool::waitAll() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mWorkDone.wait(lock, [this]() REQUIRES(mMutex) { return mPoolQueues.empty(); });
+}
+
+bool SubDecodeWorkerPool::runNextTaskLocked(std::unique_lock<std::mutex>& lock,
+                                            VkCommandPool commandPool) {
+    PoolQueue& queue = mPoolQueues[commandPool];
+    Task task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    queue.running = true;
+
+    lock.unlock();
+    const VkCommandPool previousCommandPool = tCurrentCommandPool;
+    tCurrentCommandPool = commandPool;
+    task();
+    tCurrentCommandPool = previousCommandPool;
+    lock.lock();
+
+    auto queueIt = mPoolQueues.find(commandPool);
+    queueIt->second.running = false;
+    if (queueIt->second.tasks.empty()) {
+        mPoolQueues.erase(queueIt);
+        mWorkDone.notify_all();
+        return false;
+    }
+    return true;
+}
+
+void SubDecodeWorkerPool::workerLoop() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true) {
+        mWorkAvailable.wait(lock, [this]() REQUIRES(mMutex) {
+            return mStopping || !mReadyPools.empty();
+        });
+        if (mReadyPools.empty()) {
+            // Stopping.
+            return;
+        }
+
+        const VkCommandPool commandPool = mReadyPools.front();
+        mReadyPools.pop_front();
+
+        // Requeue instead of draining the pool so that a busy pool does not starve the others.
+        if (runNextTaskLocked(lock, commandPool)) {
+            mReadyPools.push_back(commandPool);
+            mWorkAvailable.notify_one();
+        }
+    }
+}
+
+}  // namespace vk
+}  // namespace gfxstream
@@ -0,0 +1,88 @@
+// Copyright (C) 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "gfxstream/ThreadAnnotations.h"
+
+namespace gfxstream {
+namespace vk {
+
+// Runs the sub-decode of guest command buffer streams (vkQueueFlushCommandsGOOGLE) on a
+// set of worker threads.
+//
+// Command pools are externally synchronized so all of the work for command buffers of the
+// same VkCommandPool runs one at a time in the order it was enqueued. Work for different
+// command pools runs in parallel.
+class SubDecodeWorkerPool {
+   public:
+    using Task = std::function<void()>;
+
+    explicit SubDecodeWorkerPool(uint32_t threadCount);
+    ~SubDecodeWorkerPool();
+
+    SubDecodeWorkerPool(const SubDecodeWorkerPool&) = delete;
+    SubDecodeWorkerPool& operator=(const SubDecodeWorkerPool&) = delete;
+
+    // Queues `task` to run after all of the tasks previously enqueued for `commandPool`.
+    void enqueue(VkCommandPool commandPool, Task task) EXCLUDES(mMutex);
+
+    // Blocks until all of the tasks enqueued for `commandPool` have finished. Returns right
+    // away when called from within a task of `commandPool` as all earlier tasks of the pool
+    // have necessarily finished. When called from within a task of another pool, the queued
+    // tasks of `commandPool` run on the calling thread.
+    void wait(VkCommandPool commandPool) EXCLUDES(mMutex);
+
+    // Blocks until all of the enqueued tasks have finished.
+    void waitAll() EXCLUDES(mMutex);
+
+   private:
+    void workerLoop() EXCLUDES(mMutex);
+
+    // Runs the oldest queued task of `commandPool`, which must have one and must not be
+    // running, with `lock` released. Returns whether the pool has more queued tasks.
+    bool runNextTaskLocked(std::unique_lock<std::mutex>& lock, VkCommandPool commandPool)
+        REQUIRES(mMutex);
+
+    struct PoolQueue {
+        std::deque<Task> tasks;
+        // Whether a worker is currently running a task of this pool.
+        bool running = false;
+    };
+
+    std::mutex mMutex;
+    std::condition_variable mWorkAvailable;
+    std::condition_variable mWorkDone;
+    // Only contains the pools with pending or running tasks.
+    std::unordered_map<VkCommandPool, PoolQueue> mPoolQueues GUARDED_BY(mMutex);
+    // Pools with pending tasks and no running task, in the order they became ready.
+    std::deque<VkCommandPool> mReadyPools GUARDED_BY(mMutex);
+    bool mStopping GUARDED_BY(mMutex) = false;
+
+    std::vector<std::thread> mThreads;
+};
+
+}  // namespace vk
+}  // namespace gfxstream
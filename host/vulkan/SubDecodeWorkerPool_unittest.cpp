@@ -0,0 +1,166 @@
+// Copyright (C) 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "SubDecodeWorkerPool.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gfxstream {
+namespace vk {
+namespace {
+
+using ::testing::ElementsAreArray;
+
+VkCommandPool MakeCommandPool(uint64_t value) { return reinterpret_cast<VkCommandPool>(value); }
+
+TEST(SubDecodeWorkerPoolTest, RunsTasksOfOneCommandPoolInOrder) {
+    SubDecodeWorkerPool workerPool(4);
+    const VkCommandPool commandPool = MakeCommandPool(1);
+
+    std::mutex mutex;
+    std::vector<int> order;
+    std::vector<int> expected;
+    for (int i = 0; i < 1000; i++) {
+        workerPool.enqueue(commandPool, [&, i]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(i);
+        });
+        expected.push_back(i);
+    }
+    workerPool.wait(commandPool);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_THAT(order, ElementsAreArray(expected));
+}
+
+TEST(SubDecodeWorkerPoolTest, RunsTasksOfDifferentCommandPoolsConcurrently) {
+    SubDecodeWorkerPool workerPool(2);
+
+    // The first task only finishes once the second task, which uses a different command pool,
+    // has started.
+    std::promise<void> secondStarted;
+    std::shared_future<void> secondStartedFuture = secondStarted.get_future().share();
+    std::atomic<bool> firstFinished{false};
+    workerPool.enqueue(MakeCommandPool(1), [&]() {
+        EXPECT_EQ(secondStartedFuture.wait_for(std::chrono::seconds(10)),
+                  std::future_status::ready);
+        firstFinished = true;
+    });
+    workerPool.enqueue(MakeCommandPool(2), [&]() { secondStarted.set_value(); });
+
+    workerPool.waitAll();
+    EXPECT_TRUE(firstFinished);
+}
+
+TEST(SubDecodeWorkerPoolTest, WaitOnlyWaitsForTheGivenCommandPool) {
+    SubDecodeWorkerPool workerPool(2);
+
+    std::promise<void> release;
+    std::shared_future<void> releaseFuture = release.get_future().share();
+    workerPool.enqueue(MakeCommandPool(1), [releaseFuture]() { releaseFuture.wait(); });
+
+    std::atomic<int> count{0};
+    for (int i = 0; i < 10; i++) {
+        workerPool.enqueue(MakeCommandPool(2), [&]() { ++count; });
+    }
+    workerPool.wait(MakeCommandPool(2));
+    EXPECT_EQ(count.load(), 10);
+
+    release.set_value();
+    workerPool.waitAll();
+}
+
+TEST(SubDecodeWorkerPoolTest, WaitFromWithinTaskOfSameCommandPoolDoesNotBlock) {
+    SubDecodeWorkerPool workerPool(1);
+    const VkCommandPool commandPool = MakeCommandPool(1);
+
+    std::atomic<bool> finished{false};
+    workerPool.enqueue(commandPool, [&]() {
+        workerPool.wait(commandPool);
+        finished = true;
+    });
+    workerPool.waitAll();
+    EXPECT_TRUE(finished);
+}
+
+TEST(SubDecodeWorkerPoolTest, WaitFromWithinTaskOfOtherCommandPoolRunsQueuedTasks) {
+    // With a single worker, the task of the second pool can only run if the first pool's
+    // task runs it while waiting on it.
+    SubDecodeWorkerPool workerPool(1);
+
+    std::promise<void> secondEnqueued;
+    std::shared_future<void> secondEnqueuedFuture = secondEnqueued.get_future().share();
+    std::atomic<bool> secondFinished{false};
+    std::atomic<bool> secondFinishedBeforeWait{false};
+    workerPool.enqueue(MakeCommandPool(1), [&]() {
+        secondEnqueuedFuture.wait();
+        workerPool.wait(MakeCommandPool(2));
+        secondFinishedBeforeWait = secondFinished.load();
+    });
+    workerPool.enqueue(MakeCommandPool(2), [&]() { secondFinished = true; });
+    secondEnqueued.set_value();
+
+    workerPool.waitAll();
+    EXPECT_TRUE(secondFinishedBeforeWait);
+}
+
+TEST(SubDecodeWorkerPoolTest, DestroyWaitsForInFlightSubDecodes) {
+    // Mirrors on_vkDestroyDescriptorUpdateTemplate(): an object that an in flight sub-decode,
+    // of any command pool, still uses is only destroyed after waitAll().
+    SubDecodeWorkerPool workerPool(2);
+
+    auto object = std::make_unique<std::atomic<int>>(0);
+    std::atomic<int>* objectPtr = object.get();
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> releaseFuture = release.get_future().share();
+    workerPool.enqueue(MakeCommandPool(1), [&, objectPtr, releaseFuture]() {
+        started.set_value();
+        releaseFuture.wait();
+        ++*objectPtr;
+    });
+    for (int i = 0; i < 10; i++) {
+        workerPool.enqueue(MakeCommandPool(2), [objectPtr]() { ++*objectPtr; });
+    }
+    started.get_future().wait();
+
+    std::atomic<bool> destroyed{false};
+    std::thread destroyer([&]() {
+        workerPool.waitAll();
+        EXPECT_EQ(object->load(), 11);
+        object.reset();
+        destroyed = true;
+    });
+
+    // The destroy can not complete while the first sub-decode is still running.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(destroyed);
+
+    release.set_value();
+    destroyer.join();
+    EXPECT_TRUE(destroyed);
+}
+
+}  // namespace
+}  // namespace vk
+}  // namespace gfxstream
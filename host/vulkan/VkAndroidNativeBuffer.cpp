@@ -324,10 +324,12 @@ std::unique_ptr<AndroidNativeBufferInfo> AndroidNativeBufferInfo::create(
         return nullptr;
     }
 
-    // Allocate a staging memory and set up the staging buffer.
+    // Allocate a staging memory and set up the staging buffer. It is only needed to read the
+    // image back on QSRI when the ColorBuffer does not share memory with this image, so skip
+    // the full size host visible allocation when presenting the native image.
     // TODO: Make this shared as well if we can get that to
     // work on Windows with NVIDIA.
-    {
+    if (!out->mUseVulkanNativeImage) {
         VkBufferCreateInfo stagingBufferCreateInfo = {
             VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
             0,
@@ -400,12 +402,12 @@ std::unique_ptr<AndroidNativeBufferInfo> AndroidNativeBufferInfo::create(
             VK_ANB_ERR("VK_ANDROID_native_buffer: could not map staging buffer.");
             return nullptr;
         }
-    }
 
-    emu->getDebugUtilsHelper().addDebugLabel(out->mStagingBuffer, "ANB_StagingBuffer:%d",
-                                             out->mColorBufferHandle);
-    emu->getDebugUtilsHelper().addDebugLabel(out->mStagingBufferMemory, "ANB_StagingMemory:%d",
-                                             out->mColorBufferHandle);
+        emu->getDebugUtilsHelper().addDebugLabel(out->mStagingBuffer, "ANB_StagingBuffer:%d",
+                                                 out->mColorBufferHandle);
+        emu->getDebugUtilsHelper().addDebugLabel(out->mStagingBufferMemory,
+                                                 "ANB_StagingMemory:%d", out->mColorBufferHandle);
+    }
 
     out->mQsriWaitFencePool = std::make_unique<AndroidNativeBufferInfo::QsriWaitFencePool>(
         out->mDeviceDispatch, out->mDevice);
@@ -1717,6 +1717,18 @@ VkEmulation::~VkEmulation() {
 
     mStaging.destroy(mDvk, mDevice);
 
+    for (auto& slot : mReadbackSlots) {
+        if (slot.mStaging.mBuffer != VK_NULL_HANDLE) {
+            slot.mStaging.destroy(mDvk, mDevice);
+        }
+        if (slot.mFence != VK_NULL_HANDLE) {
+            mDvk->vkDestroyFence(mDevice, slot.mFence, nullptr);
+        }
+        if (slot.mCommandBuffer != VK_NULL_HANDLE) {
+            mDvk->vkFreeCommandBuffers(mDevice, mCommandPool, 1, &slot.mCommandBuffer);
+        }
+    }
+
     mDvk->vkDestroyFence(mDevice, mCommandBufferFence, nullptr);
     mDvk->vkFreeCommandBuffers(mDevice, mCommandPool, 1, &mCommandBuffer);
     mDvk->vkDestroyCommandPool(mDevice, mCommandPool, nullptr);
@@ -3037,40 +3049,11 @@ bool VkEmulation::readColorBufferToBytes(uint32_t colorBufferHandle, uint32_t x,
     return readColorBufferToBytesLocked(colorBufferHandle, x, y, w, h, outPixels, outPixelsSize);
 }
 
-bool VkEmulation::readColorBufferToBytesLocked(uint32_t colorBufferHandle, uint32_t x, uint32_t y,
-                                               uint32_t w, uint32_t h, void* outPixels,
-                                               uint64_t outPixelsSize) {
+bool VkEmulation::recordReadColorBufferCommandsLocked(
+    uint32_t colorBufferHandle, ColorBufferInfo* colorBufferInfo, VkCommandBuffer commandBuffer,
+    VkBuffer dstBuffer, const std::vector<VkBufferImageCopy>& copies) {
     auto vk = mDvk;
 
-    auto colorBufferInfo = gfxstream::base::find(mColorBuffers, colorBufferHandle);
-    if (!colorBufferInfo) {
-        GFXSTREAM_ERROR("Failed to read from ColorBuffer:%d, not found.", colorBufferHandle);
-        return false;
-    }
-
-    if (!colorBufferInfo->image) {
-        GFXSTREAM_ERROR("Failed to read from ColorBuffer:%d, no VkImage.", colorBufferHandle);
-        return false;
-    }
-
-    if (x != 0 || y != 0 || w != colorBufferInfo->imageCreateInfoShallow.extent.width ||
-        h != colorBufferInfo->imageCreateInfoShallow.extent.height) {
-        GFXSTREAM_ERROR("Failed to read from ColorBuffer:%d, unhandled subrect.",
-                        colorBufferHandle);
-        return false;
-    }
-
-    VkDeviceSize bufferCopySize = 0;
-    std::vector<VkBufferImageCopy> bufferImageCopies;
-    if (!getFormatTransferInfo(colorBufferInfo->imageCreateInfoShallow.format,
-                               colorBufferInfo->imageCreateInfoShallow.extent.width,
-                               colorBufferInfo->imageCreateInfoShallow.extent.height,
-                               &bufferCopySize, &bufferImageCopies)) {
-        GFXSTREAM_ERROR("Failed to read ColorBuffer:%d, unable to get transfer info.",
-                        colorBufferHandle);
-        return false;
-    }
-
     // Avoid transitioning from VK_IMAGE_LAYOUT_UNDEFINED. Unfortunetly, Android does not
     // yet have a mechanism for sharing the expected VkImageLayout. However, the Vulkan
     // spec's image layout transition sections says "If the old layout is
@@ -3088,9 +3071,9 @@ bool VkEmulation::readColorBufferToBytesLocked(uint32_t colorBufferHandle, uint3
         .pNext = nullptr,
         .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
     };
-    VK_CHECK(vk->vkBeginCommandBuffer(mCommandBuffer, &beginInfo));
+    VK_CHECK(vk->vkBeginCommandBuffer(commandBuffer, &beginInfo));
 
-    mDebugUtilsHelper.cmdBeginDebugLabel(mCommandBuffer, "readColorBufferToBytes(ColorBuffer:%d)",
+    mDebugUtilsHelper.cmdBeginDebugLabel(commandBuffer, "readColorBufferToBytes(ColorBuffer:%d)",
                                          colorBufferHandle);
 
     const VkImageLayout currentLayout = colorBufferInfo->currentLayout;
@@ -3116,13 +3099,12 @@ bool VkEmulation::readColorBufferToBytesLocked(uint32_t colorBufferHandle, uint3
             },
     };
 
-    vk->vkCmdPipelineBarrier(mCommandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+    vk->vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
                              VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1,
                              &toTransferSrcImageBarrier);
 
-    vk->vkCmdCopyImageToBuffer(mCommandBuffer, colorBufferInfo->image,
-                               transferSrcLayout, mStaging.mBuffer,
-                               bufferImageCopies.size(), bufferImageCopies.data());
+    vk->vkCmdCopyImageToBuffer(commandBuffer, colorBufferInfo->image, transferSrcLayout, dstBuffer,
+                               copies.size(), copies.data());
 
     // Change back to original layout
     if (currentLayout != VK_IMAGE_LAYOUT_UNDEFINED) {
@@ -3146,16 +3128,58 @@ bool VkEmulation::readColorBufferToBytesLocked(uint32_t colorBufferHandle, uint3
                     .layerCount = 1,
                 },
         };
-        vk->vkCmdPipelineBarrier(mCommandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+        vk->vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
                                  VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1,
                                  &toCurrentLayoutImageBarrier);
     } else {
         colorBufferInfo->currentLayout = transferSrcLayout;
     }
 
-    mDebugUtilsHelper.cmdEndDebugLabel(mCommandBuffer);
+    mDebugUtilsHelper.cmdEndDebugLabel(commandBuffer);
 
-    VK_CHECK(vk->vkEndCommandBuffer(mCommandBuffer));
+    VK_CHECK(vk->vkEndCommandBuffer(commandBuffer));
+
+    return true;
+}
+
+bool VkEmulation::readColorBufferToBytesLocked(uint32_t colorBufferHandle, uint32_t x, uint32_t y,
+                                               uint32_t w, uint32_t h, void* outPixels,
+                                               uint64_t outPixelsSize) {
+    auto vk = mDvk;
+
+    auto colorBufferInfo = gfxstream::base::find(mColorBuffers, colorBufferHandle);
+    if (!colorBufferInfo) {
+        GFXSTREAM_ERROR("Failed to read from ColorBuffer:%d, not found.", colorBufferHandle);
+        return false;
+    }
+
+    if (!colorBufferInfo->image) {
+        GFXSTREAM_ERROR("Failed to read from ColorBuffer:%d, no VkImage.", colorBufferHandle);
+        return false;
+    }
+
+    if (x != 0 || y != 0 || w != colorBufferInfo->imageCreateInfoShallow.extent.width ||
+        h != colorBufferInfo->imageCreateInfoShallow.extent.height) {
+        GFXSTREAM_ERROR("Failed to read from ColorBuffer:%d, unhandled subrect.",
+                        colorBufferHandle);
+        return false;
+    }
+
+    VkDeviceSize bufferCopySize = 0;
+    std::vector<VkBufferImageCopy> bufferImageCopies;
+    if (!getFormatTransferInfo(colorBufferInfo->imageCreateInfoShallow.format,
+                               colorBufferInfo->imageCreateInfoShallow.extent.width,
+                               colorBufferInfo->imageCreateInfoShallow.extent.height,
+                               &bufferCopySize, &bufferImageCopies)) {
+        GFXSTREAM_ERROR("Failed to read ColorBuffer:%d, unable to get transfer info.",
+                        colorBufferHandle);
+        return false;
+    }
+
+    if (!recordReadColorBufferCommandsLocked(colorBufferHandle, colorBufferInfo, mCommandBuffer,
+                                             mStaging.mBuffer, bufferImageCopies)) {
+        return false;
+    }
 
     const VkSubmitInfo submitInfo = {
         .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
@@ -3217,6 +3241,222 @@ bool VkEmulation::readColorBufferToBytesLocked(uint32_t colorBufferHandle, uint3
     return true;
 }
 
+std::optional<VkEmulation::AsyncReadback> VkEmulation::startReadColorBufferToBytes(
+    uint32_t colorBufferHandle, uint32_t x, uint32_t y, uint32_t w, uint32_t h) {
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto vk = mDvk;
+
+    auto colorBufferInfo = gfxstream::base::find(mColorBuffers, colorBufferHandle);
+    if (!colorBufferInfo || !colorBufferInfo->image) {
+        return std::nullopt;
+    }
+
+    if (x != 0 || y != 0 || w != colorBufferInfo->imageCreateInfoShallow.extent.width ||
+        h != colorBufferInfo->imageCreateInfoShallow.extent.height) {
+        return std::nullopt;
+    }
+
+    VkDeviceSize bufferCopySize = 0;
+    std::vector<VkBufferImageCopy> bufferImageCopies;
+    if (!getFormatTransferInfo(colorBufferInfo->imageCreateInfoShallow.format,
+                               colorBufferInfo->imageCreateInfoShallow.extent.width,
+                               colorBufferInfo->imageCreateInfoShallow.extent.height,
+                               &bufferCopySize, &bufferImageCopies)) {
+        return std::nullopt;
+    }
+
+    uint32_t slotIndex = 0;
+    for (; slotIndex < kNumReadbackSlots; ++slotIndex) {
+        if (!mReadbackSlots[slotIndex].mInUse) {
+            break;
+        }
+    }
+    if (slotIndex == kNumReadbackSlots) {
+        return std::nullopt;
+    }
+    ReadbackSlot& slot = mReadbackSlots[slotIndex];
+
+    if (slot.mCommandBuffer == VK_NULL_HANDLE) {
+        const VkCommandBufferAllocateInfo allocInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .pNext = nullptr,
+            .commandPool = mCommandPool,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1,
+        };
+        if (vk->vkAllocateCommandBuffers(mDevice, &allocInfo, &slot.mCommandBuffer) !=
+            VK_SUCCESS) {
+            slot.mCommandBuffer = VK_NULL_HANDLE;
+            return std::nullopt;
+        }
+
+        const VkFenceCreateInfo fenceInfo = {
+            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+        };
+        if (vk->vkCreateFence(mDevice, &fenceInfo, nullptr, &slot.mFence) != VK_SUCCESS) {
+            vk->vkFreeCommandBuffers(mDevice, mCommandPool, 1, &slot.mCommandBuffer);
+            slot.mCommandBuffer = VK_NULL_HANDLE;
+            slot.mFence = VK_NULL_HANDLE;
+            return std::nullopt;
+        }
+    }
+
+    if (slot.mStaging.mBuffer == VK_NULL_HANDLE ||
+        slot.mStaging.mAllocationSize < bufferCopySize) {
+        if (slot.mStaging.mBuffer != VK_NULL_HANDLE) {
+            slot.mStaging.destroy(vk, mDevice);
+        }
+        if (!slot.mStaging.create(vk, mDevice, &mDeviceInfo.memProps, mDebugUtilsHelper,
+                                  bufferCopySize)) {
+            GFXSTREAM_ERROR("Failed to allocate readback staging buffer of size %llu.",
+                            static_cast<unsigned long long>(bufferCopySize));
+            vk->vkDestroyBuffer(mDevice, slot.mStaging.mBuffer, nullptr);
+            vk->vkFreeMemory(mDevice, slot.mStaging.mMemory, nullptr);
+            slot.mStaging = StagingBuffer();
+            return std::nullopt;
+        }
+    }
+
+    if (!recordReadColorBufferCommandsLocked(colorBufferHandle, colorBufferInfo,
+                                             slot.mCommandBuffer, slot.mStaging.mBuffer,
+                                             bufferImageCopies)) {
+        return std::nullopt;
+    }
+
+    const VkSubmitInfo submitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = nullptr,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = nullptr,
+        .pWaitDstStageMask = nullptr,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &slot.mCommandBuffer,
+        .signalSemaphoreCount = 0,
+        .pSignalSemaphores = nullptr,
+    };
+
+    {
+        gfxstream::base::AutoLock queueLock(*mQueueLock);
+        VK_CHECK(vk->vkQueueSubmit(mQueue, 1, &submitInfo, slot.mFence));
+    }
+
+    slot.mInUse = true;
+
+    return AsyncReadback{
+        .slot = slotIndex,
+        .size = bufferCopySize,
+    };
+}
+
+bool VkEmulation::waitReadColorBufferToBytes(const AsyncReadback& readback) {
+    auto vk = mDvk;
+
+    if (readback.slot >= kNumReadbackSlots) {
+        return false;
+    }
+
+    VkFence fence = VK_NULL_HANDLE;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        const ReadbackSlot& slot = mReadbackSlots[readback.slot];
+        if (!slot.mInUse) {
+            GFXSTREAM_ERROR("Readback slot %u is not in use.", readback.slot);
+            return false;
+        }
+        fence = slot.mFence;
+    }
+
+    // The slot is exclusively owned by this reader until it is released by
+    // finishReadColorBufferToBytes(), so the wait is done without holding mMutex.
+    static constexpr uint64_t kReadbackMaxWaitNs = 5ULL * 1000ULL * 1000ULL * 1000ULL;
+    VkResult waitRes = vk->vkWaitForFences(mDevice, 1, &fence, VK_TRUE, kReadbackMaxWaitNs);
+    if (waitRes == VK_TIMEOUT) {
+        GFXSTREAM_ERROR("waitReadColorBufferToBytes vkWaitForFences timed out, retrying...");
+        waitRes = vk->vkWaitForFences(mDevice, 1, &fence, VK_TRUE, kReadbackMaxWaitNs * 2);
+    }
+    VK_CHECK(waitRes);
+    return true;
+}
+
+bool VkEmulation::finishReadColorBufferToBytes(const AsyncReadback& readback, void* outPixels,
+                                               uint64_t outPixelsSize) {
+    auto vk = mDvk;
+
+    if (!waitReadColorBufferToBytes(readback)) {
+        return false;
+    }
+
+    VkFence fence = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    void* mappedPtr = nullptr;
+    bool isHostCoherent = false;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        const ReadbackSlot& slot = mReadbackSlots[readback.slot];
+        fence = slot.mFence;
+        memory = slot.mStaging.mMemory;
+        mappedPtr = slot.mStaging.mMappedPtr;
+        isHostCoherent = slot.mStaging.mIsHostCoherent;
+    }
+
+    VK_CHECK(vk->vkResetFences(mDevice, 1, &fence));
+
+    if (!isHostCoherent) {
+        const VkMappedMemoryRange toInvalidate = {
+            .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+            .pNext = nullptr,
+            .memory = memory,
+            .offset = 0,
+            .size = VK_WHOLE_SIZE,
+        };
+        VK_CHECK(vk->vkInvalidateMappedMemoryRanges(mDevice, 1, &toInvalidate));
+    }
+
+    VkDeviceSize copySize = readback.size;
+    if (copySize > outPixelsSize) {
+        GFXSTREAM_ERROR(
+            "Invalid buffer size for finishReadColorBufferToBytes operation."
+            "Required: %llu, Actual: %llu",
+            static_cast<unsigned long long>(copySize),
+            static_cast<unsigned long long>(outPixelsSize));
+        copySize = outPixelsSize;
+    }
+    std::memcpy(outPixels, mappedPtr, copySize);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mReadbackSlots[readback.slot].mInUse = false;
+    return true;
+}
+
+void VkEmulation::cancelReadColorBufferToBytes(const AsyncReadback& readback) {
+    auto vk = mDvk;
+
+    if (readback.slot >= kNumReadbackSlots) {
+        return;
+    }
+
+    VkFence fence = VK_NULL_HANDLE;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        const ReadbackSlot& slot = mReadbackSlots[readback.slot];
+        if (!slot.mInUse) {
+            return;
+        }
+        fence = slot.mFence;
+    }
+
+    // The copy may still be writing into the staging buffer, so the slot can only be
+    // handed out again once it landed.
+    VK_CHECK(vk->vkWaitForFences(mDevice, 1, &fence, VK_TRUE, UINT64_MAX));
+    VK_CHECK(vk->vkResetFences(mDevice, 1, &fence));
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mReadbackSlots[readback.slot].mInUse = false;
+}
+
 bool VkEmulation::updateColorBufferFromBytes(uint32_t colorBufferHandle,
                                              const std::vector<uint8_t>& bytes) {
     std::lock_guard<std::mutex> lock(mMutex);
@@ -3280,24 +3520,47 @@ bool VkEmulation::updateColorBufferFromBytesLocked(uint32_t colorBufferHandle, u
         return false;
     }
 
-    if (x != 0 || y != 0 || w != colorBufferInfo->imageCreateInfoShallow.extent.width ||
-        h != colorBufferInfo->imageCreateInfoShallow.extent.height) {
-        GFXSTREAM_ERROR("Failed to update ColorBuffer:%d, unhandled subrect.", colorBufferHandle);
+    const VkExtent3D& extent = colorBufferInfo->imageCreateInfoShallow.extent;
+    if (static_cast<uint64_t>(x) + w > extent.width ||
+        static_cast<uint64_t>(y) + h > extent.height) {
+        GFXSTREAM_ERROR("Failed to update ColorBuffer:%d, subrect out of bounds.",
+                        colorBufferHandle);
         return false;
     }
+    const bool isSubrect = x != 0 || y != 0 || w != extent.width || h != extent.height;
+
+    const bool isSnapshotLoad = VkDecoderGlobalState::get()->isSnapshotCurrentlyLoading();
+    VkImageLayout currentLayout = colorBufferInfo->currentLayout;
+    if (isSnapshotLoad) {
+        currentLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    }
 
     const VkFormat creationFormat = colorBufferInfo->imageCreateInfoShallow.format;
     VkDeviceSize dstBufferSize = 0;
     std::vector<VkBufferImageCopy> bufferImageCopies;
-    if (!getFormatTransferInfo(creationFormat,
-                               colorBufferInfo->imageCreateInfoShallow.extent.width,
-                               colorBufferInfo->imageCreateInfoShallow.extent.height,
-                               &dstBufferSize, &bufferImageCopies)) {
+    if (!getFormatTransferInfo(creationFormat, w, h, &dstBufferSize, &bufferImageCopies)) {
         GFXSTREAM_ERROR("Failed to update ColorBuffer:%d, unable to get transfer info.",
                         colorBufferHandle);
         return false;
     }
 
+    if (isSubrect) {
+        // Subrects are limited to single plane formats without width alignment, and to images
+        // whose current contents are defined so the rest of the image is preserved.
+        if (bufferImageCopies.size() != 1 || bufferImageCopies[0].imageExtent.width != w ||
+            currentLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
+            // Callers are expected to fall back to updating the whole image.
+            GFXSTREAM_DEBUG("Failed to update ColorBuffer:%d, unhandled subrect.",
+                            colorBufferHandle);
+            return false;
+        }
+        bufferImageCopies[0].imageOffset = {
+            .x = static_cast<int32_t>(x),
+            .y = static_cast<int32_t>(y),
+            .z = 0,
+        };
+    }
+
     const VkDeviceSize stagingBufferSize = mStaging.mAllocationSize;
     if (dstBufferSize > stagingBufferSize) {
         GFXSTREAM_ERROR("Failed to update ColorBuffer:%d, transfer size %" PRIu64
@@ -3348,9 +3611,10 @@ bool VkEmulation::updateColorBufferFromBytesLocked(uint32_t colorBufferHandle, u
     // VK_IMAGE_LAYOUT_UNDEFINED as Vulkan spec allows the contents to be
     // discarded (and some drivers have been observed doing it). You can
     // check go/ahb-vkimagelayout for more information. But since this
-    // function does not allow subrects (see above), it will write the
-    // provided contents onto the entirety of the target buffer, meaning this
-    // risk of discarding data should not impact anything.
+    // function only allows subrects of images in a defined layout (see above),
+    // it either writes the provided contents onto the entirety of the target
+    // buffer or preserves the rest of it, meaning this risk of discarding data
+    // should not impact anything.
 
     // Record our synchronization commands.
     const VkCommandBufferBeginInfo beginInfo = {
@@ -3363,11 +3627,6 @@ bool VkEmulation::updateColorBufferFromBytesLocked(uint32_t colorBufferHandle, u
     mDebugUtilsHelper.cmdBeginDebugLabel(
         mCommandBuffer, "updateColorBufferFromBytes(ColorBuffer:%d)", colorBufferHandle);
 
-    const bool isSnapshotLoad = VkDecoderGlobalState::get()->isSnapshotCurrentlyLoading();
-    VkImageLayout currentLayout = colorBufferInfo->currentLayout;
-    if (isSnapshotLoad) {
-        currentLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    }
     const VkImageMemoryBarrier toTransferDstImageBarrier = {
         .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
         .pNext = nullptr,
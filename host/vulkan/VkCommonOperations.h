@@ -16,6 +16,7 @@
 #include <GLES2/gl2.h>
 #include <vulkan/vulkan.h>
 
+#include <array>
 #include <atomic>
 #include <functional>
 #include <memory>
@@ -348,6 +349,26 @@ class VkEmulation {
     bool readColorBufferToBytes(uint32_t colorBufferHandle, uint32_t x, uint32_t y, uint32_t w,
                                 uint32_t h, void* outPixels, uint64_t outPixelsSize);
 
+    // Asynchronous ColorBuffer readback. startReadColorBufferToBytes() records and
+    // submits a copy into one of a small ring of staging buffers and returns without
+    // waiting for the GPU. waitReadColorBufferToBytes() blocks until the copy has
+    // landed and finishReadColorBufferToBytes() writes the result to |outPixels| and
+    // releases the slot. Returns std::nullopt if all readback slots are busy, in
+    // which case callers should use readColorBufferToBytes().
+    // cancelReadColorBufferToBytes() releases the slot without copying, e.g. if
+    // waiting for the readback failed.
+    struct AsyncReadback {
+        uint32_t slot = 0;
+        VkDeviceSize size = 0;
+    };
+    std::optional<AsyncReadback> startReadColorBufferToBytes(uint32_t colorBufferHandle,
+                                                             uint32_t x, uint32_t y, uint32_t w,
+                                                             uint32_t h);
+    bool waitReadColorBufferToBytes(const AsyncReadback& readback);
+    bool finishReadColorBufferToBytes(const AsyncReadback& readback, void* outPixels,
+                                      uint64_t outPixelsSize);
+    void cancelReadColorBufferToBytes(const AsyncReadback& readback);
+
     bool updateColorBufferFromBytes(uint32_t colorBufferHandle, const std::vector<uint8_t>& bytes);
     bool updateColorBufferFromBytes(uint32_t colorBufferHandle, uint32_t x, uint32_t y, uint32_t w,
                                     uint32_t h, const void* pixels);
@@ -499,6 +520,14 @@ class VkEmulation {
                                       uint32_t w, uint32_t h, void* outPixels,
                                       uint64_t outPixelsSize) REQUIRES(mMutex);
 
+    // Records the commands to copy the given ColorBuffer into |dstBuffer| into
+    // |commandBuffer|, including the begin and end of the command buffer.
+    bool recordReadColorBufferCommandsLocked(uint32_t colorBufferHandle,
+                                             ColorBufferInfo* colorBufferInfo,
+                                             VkCommandBuffer commandBuffer, VkBuffer dstBuffer,
+                                             const std::vector<VkBufferImageCopy>& copies)
+        REQUIRES(mMutex);
+
     bool updateColorBufferFromBytesLocked(uint32_t colorBufferHandle, uint32_t x, uint32_t y,
                                           uint32_t w, uint32_t h, const void* pixels,
                                           size_t inputPixelsSize) REQUIRES(mMutex);
@@ -601,7 +630,7 @@ class VkEmulation {
     struct StagingBuffer {
         VkDeviceMemory mMemory = VK_NULL_HANDLE;
         VkBuffer mBuffer = VK_NULL_HANDLE;
-        VkDeviceSize mAllocationSize;
+        VkDeviceSize mAllocationSize = 0;
         void* mMappedPtr = nullptr;
         bool mIsHostCoherent = false;
 
@@ -618,6 +647,19 @@ class VkEmulation {
     // Staging buffer to perform reads and updates on color buffers.
     StagingBuffer mStaging GUARDED_BY(mMutex);
 
+    // Command buffers, fences and lazily sized staging buffers used for
+    // asynchronous ColorBuffer readbacks. A slot is owned by a single reader
+    // from startReadColorBufferToBytes() until finishReadColorBufferToBytes() or
+    // cancelReadColorBufferToBytes().
+    struct ReadbackSlot {
+        VkCommandBuffer mCommandBuffer = VK_NULL_HANDLE;
+        VkFence mFence = VK_NULL_HANDLE;
+        StagingBuffer mStaging;
+        bool mInUse = false;
+    };
+    static constexpr uint32_t kNumReadbackSlots = 4;
+    std::array<ReadbackSlot, kNumReadbackSlots> mReadbackSlots GUARDED_BY(mMutex);
+
     // ColorBuffers are intended to back the guest's shareable images.
     // For example:
     // Android: gralloc
@@ -19,11 +19,13 @@
 #include <list>
 #include <memory>
 #include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
 #include "FrameBuffer.h"
 #include "RenderThreadInfoVk.h"
+#include "SubDecodeWorkerPool.h"
 #include "TrivialStream.h"
 #include "VkAndroidNativeBuffer.h"
 #include "VkCommonOperations.h"
@@ -175,6 +177,84 @@ static constexpr uint64_t kPageMaskForBlob = ~(0xfff);
 
 static std::atomic<uint64_t> sNextHostBlobId{1};
 
+// Lays out DescriptorSetInfo::allWrites and bindingStarts for the set layout bindings in
+// `setInfo.bindings`. Bindings missing from the layout take no entries.
+static void initDescriptorSetWrites(DescriptorSetInfo& setInfo) {
+    uint32_t bindingCount = 0;
+    for (const auto& dslBinding : setInfo.bindings) {
+        bindingCount = std::max(bindingCount, dslBinding.binding + 1);
+    }
+    std::vector<uint32_t> descriptorCounts(bindingCount, 0);
+    std::vector<VkDescriptorType> descriptorTypes(bindingCount);
+    for (const auto& dslBinding : setInfo.bindings) {
+        descriptorCounts[dslBinding.binding] =
+            dslBinding.descriptorType == VK_DESCRIPTOR_TYPE_INLINE_UNIFORM_BLOCK
+                ? std::min(dslBinding.descriptorCount, 1u)
+                : dslBinding.descriptorCount;
+        descriptorTypes[dslBinding.binding] = dslBinding.descriptorType;
+    }
+    setInfo.bindingStarts.resize(bindingCount + 1);
+    uint32_t descriptorCount = 0;
+    for (uint32_t binding = 0; binding < bindingCount; binding++) {
+        setInfo.bindingStarts[binding] = descriptorCount;
+        descriptorCount += descriptorCounts[binding];
+    }
+    setInfo.bindingStarts[bindingCount] = descriptorCount;
+    setInfo.allWrites.resize(descriptorCount);
+    for (uint32_t binding = 0; binding < bindingCount; binding++) {
+        for (uint32_t i = 0; i < descriptorCounts[binding]; i++) {
+            auto& write = setInfo.allWrites[setInfo.bindingStarts[binding] + i];
+            write.descriptorType = descriptorTypes[binding];
+            write.dstArrayElement = 0;
+        }
+    }
+}
+
+// Finds the DescriptorSetInfo::allWrites entries that `write` updates: `*count` entries from
+// `*tableOffset`. Descriptor writes wrap to the next binding, see
+// https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkWriteDescriptorSet.html
+// As the descriptors of consecutive bindings are consecutive in the table, this is simply a
+// walk over the table. Returns false if the write updates no entry.
+static bool getDescriptorWriteTableRange(const DescriptorSetInfo& setInfo,
+                                         const VkWriteDescriptorSet& write,
+                                         uint32_t* tableOffset, uint32_t* count) {
+    if (write.dstBinding >= setInfo.getBindingCount()) {
+        return false;
+    }
+    const bool inlineUniformBlock =
+        write.descriptorType == VK_DESCRIPTOR_TYPE_INLINE_UNIFORM_BLOCK;
+    // The dstArrayElement of an inline uniform block is a byte offset into its single entry.
+    const uint64_t offset = uint64_t(setInfo.bindingStarts[write.dstBinding]) +
+                            (inlineUniformBlock ? 0 : write.dstArrayElement);
+    if (offset >= setInfo.allWrites.size()) {
+        return false;
+    }
+    *tableOffset = static_cast<uint32_t>(offset);
+    *count = std::min<uint32_t>(inlineUniformBlock ? 1 : write.descriptorCount,
+                                setInfo.allWrites.size() - offset);
+    return true;
+}
+
+// Whether the per set starting indices of vkQueueCommitDescriptorSetUpdatesGOOGLE() split
+// the pending writes into one range per set, with every write in exactly one range.
+static bool descriptorWriteRangesCoverAllWrites(uint32_t descriptorSetCount,
+                                                const uint32_t* pDescriptorWriteStartingIndices,
+                                                uint32_t pendingDescriptorWriteCount) {
+    if (descriptorSetCount == 0) {
+        return pendingDescriptorWriteCount == 0;
+    }
+    if (pDescriptorWriteStartingIndices[0] != 0) {
+        return false;
+    }
+    for (uint32_t i = 1; i < descriptorSetCount; ++i) {
+        if (pDescriptorWriteStartingIndices[i] < pDescriptorWriteStartingIndices[i - 1] ||
+            pDescriptorWriteStartingIndices[i] > pendingDescriptorWriteCount) {
+            return false;
+        }
+    }
+    return true;
+}
+
 class VkDecoderGlobalState::Impl {
    public:
     Impl(VkEmulation* emulation)
@@ -187,6 +267,14 @@ class VkDecoderGlobalState::Impl {
         mSnapshotsEnabled = m_vkEmulation->getFeatures().VulkanSnapshots.enabled;
         mBatchedDescriptorSetUpdateEnabled =
             m_vkEmulation->getFeatures().VulkanBatchedDescriptorSetUpdate.enabled;
+        mDeferredDestroyEnabled = m_vkEmulation->getFeatures().VulkanDeferredDestroy.enabled;
+        // The snapshot recording of the sub-decoded commands expects them in guest order.
+        if (m_vkEmulation->getFeatures().VulkanParallelSubDecode.enabled && !mSnapshotsEnabled) {
+            const uint32_t threadCount =
+                std::clamp(std::thread::hardware_concurrency() / 2, 1u, 8u);
+            GFXSTREAM_INFO("Using %u threads for Vulkan command buffer sub-decode.", threadCount);
+            mSubDecodeWorkerPool = std::make_unique<SubDecodeWorkerPool>(threadCount);
+        }
         mDisableSparseBindingSupport = false;
 #ifdef CONFIG_AEMU
         if (!m_vkEmulation->getFeatures().BypassVulkanDeviceFeatureOverrides.enabled) {
@@ -473,13 +561,16 @@ class VkDecoderGlobalState::Impl {
                 // example), and think the binding is still valid. And if we bind the new image
                 // regardless, we might hit a Vulkan validation error because the new image might
                 // have the "usage" flag that is unsuitable to bind to descriptors.
-                std::vector<std::pair<int, int>> validWriteIndices;
-                for (int bindingIdx = 0; bindingIdx < (int)descriptorSetInfo.allWrites.size();
+                std::vector<std::pair<uint32_t, uint32_t>> validWriteIndices;
+                for (uint32_t bindingIdx = 0; bindingIdx < descriptorSetInfo.getBindingCount();
                      bindingIdx++) {
-                    for (int bindingElemIdx = 0;
-                         bindingElemIdx < (int)descriptorSetInfo.allWrites[bindingIdx].size();
+                    for (uint32_t bindingElemIdx = 0;
+                         bindingElemIdx < descriptorSetInfo.getDescriptorCount(bindingIdx);
                          bindingElemIdx++) {
-                        const auto& entry = descriptorSetInfo.allWrites[bindingIdx][bindingElemIdx];
+                        const auto& entry =
+                            descriptorSetInfo
+                                .allWrites[descriptorSetInfo.bindingStarts[bindingIdx] +
+                                           bindingElemIdx];
                         if (entry.writeType == DescriptorSetInfo::DescriptorWriteType::Empty) {
                             continue;
                         }
@@ -504,7 +595,9 @@ class VkDecoderGlobalState::Impl {
                 stream->putBe64(validWriteIndices.size());
                 // Save all valid descriptors
                 for (const auto& idx : validWriteIndices) {
-                    const auto& entry = descriptorSetInfo.allWrites[idx.first][idx.second];
+                    const auto& entry =
+                        descriptorSetInfo
+                            .allWrites[descriptorSetInfo.bindingStarts[idx.first] + idx.second];
                     stream->putBe32(idx.first);
                     stream->putBe32(idx.second);
                     stream->putBe32(entry.writeType);
@@ -1003,6 +1096,8 @@ class VkDecoderGlobalState::Impl {
     }
 
     void vkDestroyInstanceImpl(VkInstance instance, const VkAllocationCallbacks* pAllocator) {
+        waitForAllSubDecodes();
+
         std::vector<VkDevice> devicesToDestroy;
 
         // Get the list of devices to destroy inside the lock ...
@@ -2097,6 +2192,36 @@ class VkDecoderGlobalState::Impl {
 
         deviceInfo.deviceOpTracker = std::make_shared<DeviceOpTracker>(*pDevice, dispatch);
 
+        // Pageable device local memory lets the guest set per allocation priorities which
+        // can not be applied to a part of a host allocation.
+        if (m_vkEmulation->getFeatures().VulkanSubAllocateMemory.enabled &&
+            !hasDeviceExtension(*pDevice, VK_EXT_PAGEABLE_DEVICE_LOCAL_MEMORY_EXTENSION_NAME)) {
+            const VkDevice hostDevice = *pDevice;
+            deviceInfo.memorySubAllocator = std::make_unique<DeviceMemorySubAllocator>(
+                physicalDeviceInfo.props.limits.bufferImageGranularity,
+                DeviceMemorySubAllocator::Callbacks{
+                    .allocateBlock = [dispatch, hostDevice](uint32_t memoryTypeIndex,
+                                                            VkDeviceSize size) {
+                        const VkMemoryAllocateInfo allocInfo = {
+                            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+                            .pNext = nullptr,
+                            .allocationSize = size,
+                            .memoryTypeIndex = memoryTypeIndex,
+                        };
+                        VkDeviceMemory memory = VK_NULL_HANDLE;
+                        if (dispatch->vkAllocateMemory(hostDevice, &allocInfo, nullptr,
+                                                       &memory) != VK_SUCCESS) {
+                            return static_cast<VkDeviceMemory>(VK_NULL_HANDLE);
+                        }
+                        return memory;
+                    },
+                    .freeBlock =
+                        [dispatch, hostDevice](VkDeviceMemory memory) {
+                            dispatch->vkFreeMemory(hostDevice, memory, nullptr);
+                        },
+                });
+        }
+
         if (mLogging) {
             GFXSTREAM_INFO("%s: init vulkan dispatch from device (end)", __func__);
         }
@@ -2339,13 +2464,6 @@ class VkDecoderGlobalState::Impl {
             GFXSTREAM_FATAL("%s: function implementation cannot be found!");
         }
 
-        const VkFormat format = pInfo->pCreateInfo->format;
-        bool needDecompression = gfxstream::vk::isEtc2(format) || gfxstream::vk::isAstc(format);
-        if (!needDecompression) {
-            // No modifications needed
-            return;
-        }
-
         std::lock_guard<std::mutex> lock(mMutex);
 
         auto* deviceInfo = gfxstream::base::find(mDeviceInfo, device);
@@ -2354,8 +2472,12 @@ class VkDecoderGlobalState::Impl {
             return;
         }
 
-        needDecompression = deviceInfo->needEmulatedDecompression(format);
+        const VkFormat format = pInfo->pCreateInfo->format;
+        const bool needDecompression = (gfxstream::vk::isEtc2(format) ||
+                                        gfxstream::vk::isAstc(format)) &&
+                                       deviceInfo->needEmulatedDecompression(format);
         if (!needDecompression) {
+            addSubAllocationAlignmentLocked(*deviceInfo, pMemoryRequirements->memoryRequirements);
             // No modifications needed
             return;
         }
@@ -2386,6 +2508,8 @@ class VkDecoderGlobalState::Impl {
             return;
         }
 
+        addSubAllocationAlignmentLocked(*deviceInfo, pMemoryRequirements->memoryRequirements);
+
         auto& physicalDeviceMemHelper = physicalDeviceInfo->memoryPropertiesHelper;
         physicalDeviceMemHelper->transformToGuestMemoryRequirements(
             &pMemoryRequirements->memoryRequirements);
@@ -2436,6 +2560,17 @@ class VkDecoderGlobalState::Impl {
         }
         deviceInfo.externalFencePool.reset();
 
+        if (deviceInfo.memorySubAllocator) {
+            const auto stats = deviceInfo.memorySubAllocator->getStats();
+            GFXSTREAM_INFO(
+                "VkDevice:%p sub-allocated memory: %u blocks (%llu bytes), %u live "
+                "sub-allocations (%llu bytes), %.2f fragmentation.",
+                device, stats.blockCount, static_cast<unsigned long long>(stats.blockBytes),
+                stats.subAllocationCount, static_cast<unsigned long long>(stats.usedBytes),
+                stats.fragmentation());
+            deviceInfo.memorySubAllocator.reset();
+        }
+
         // Run the underlying API call.
         {
             AutoLock lock(*graphicsDriverLock());
@@ -2460,6 +2595,8 @@ class VkDecoderGlobalState::Impl {
 
     void on_vkDestroyDevice(gfxstream::base::BumpPool* pool, VkSnapshotApiCallHandle,
                             VkDevice boxed_device, const VkAllocationCallbacks* pAllocator) {
+        waitForAllSubDecodes();
+
         auto device = unbox_VkDevice(boxed_device);
 
         processDelayedRemovesForDevice(device);
@@ -2543,6 +2680,8 @@ class VkDecoderGlobalState::Impl {
     void on_vkDestroyBuffer(gfxstream::base::BumpPool* pool, VkSnapshotApiCallHandle,
                             VkDevice boxed_device, VkBuffer buffer,
                             const VkAllocationCallbacks* pAllocator) {
+        waitForAllSubDecodes();
+
         auto device = unbox_VkDevice(boxed_device);
         auto deviceDispatch = dispatch_VkDevice(boxed_device);
 
@@ -2578,7 +2717,18 @@ class VkDecoderGlobalState::Impl {
         auto vk = dispatch_VkDevice(boxed_device);
 
         VALIDATE_REQUIRED_HANDLE(memory);
-        VkResult result = vk->vkBindBufferMemory(device, buffer, memory, memoryOffset);
+        const VkBindBufferMemoryInfo bindInfo = {
+            .sType = VK_STRUCTURE_TYPE_BIND_BUFFER_MEMORY_INFO,
+            .pNext = nullptr,
+            .buffer = buffer,
+            .memory = memory,
+            .memoryOffset = memoryOffset,
+        };
+        std::vector<VkBindBufferMemoryInfo> hostBindInfoStorage;
+        const VkBindBufferMemoryInfo* hostBindInfo =
+            getHostBindInfos(1, &bindInfo, hostBindInfoStorage);
+        VkResult result = vk->vkBindBufferMemory(device, buffer, hostBindInfo->memory,
+                                                 hostBindInfo->memoryOffset);
         if (result != VK_SUCCESS) {
             return result;
         }
@@ -2596,7 +2746,9 @@ class VkDecoderGlobalState::Impl {
         for (uint32_t i = 0; i < bindInfoCount; ++i) {
             VALIDATE_REQUIRED_HANDLE(pBindInfos[i].memory);
         }
-        VkResult result = vk->vkBindBufferMemory2(device, bindInfoCount, pBindInfos);
+        std::vector<VkBindBufferMemoryInfo> hostBindInfoStorage;
+        VkResult result = vk->vkBindBufferMemory2(
+            device, bindInfoCount, getHostBindInfos(bindInfoCount, pBindInfos, hostBindInfoStorage));
         if (result != VK_SUCCESS) {
             return result;
         }
@@ -2622,7 +2774,9 @@ class VkDecoderGlobalState::Impl {
         for (uint32_t i = 0; i < bindInfoCount; ++i) {
             VALIDATE_REQUIRED_HANDLE(pBindInfos[i].memory);
         }
-        VkResult result = vk->vkBindBufferMemory2KHR(device, bindInfoCount, pBindInfos);
+        std::vector<VkBindBufferMemoryInfo> hostBindInfoStorage;
+        VkResult result = vk->vkBindBufferMemory2KHR(
+            device, bindInfoCount, getHostBindInfos(bindInfoCount, pBindInfos, hostBindInfoStorage));
 
         if (result == VK_SUCCESS) {
             std::lock_guard<std::mutex> lock(mMutex);
@@ -2764,6 +2918,8 @@ class VkDecoderGlobalState::Impl {
     void on_vkDestroyImage(gfxstream::base::BumpPool* pool, VkSnapshotApiCallHandle,
                            VkDevice boxed_device, VkImage image,
                            const VkAllocationCallbacks* pAllocator) {
+        waitForAllSubDecodes();
+
         auto device = unbox_VkDevice(boxed_device);
         auto deviceDispatch = dispatch_VkDevice(boxed_device);
 
@@ -2822,7 +2978,6 @@ class VkDecoderGlobalState::Impl {
                                     const VkBindImageMemoryInfo* bimi) EXCLUDES(mMutex) {
         auto image = bimi->image;
         auto memory = bimi->memory;
-        auto memoryOffset = bimi->memoryOffset;
 
         const auto* anb = vk_find_struct<VkNativeBufferANDROID>(bimi);
         if (memory == VK_NULL_HANDLE && anb != nullptr) {
@@ -2833,7 +2988,10 @@ class VkDecoderGlobalState::Impl {
         auto vk = dispatch_VkDevice(boxed_device);
 
         VALIDATE_REQUIRED_HANDLE(memory);
-        VkResult result = vk->vkBindImageMemory(device, image, memory, memoryOffset);
+        std::vector<VkBindImageMemoryInfo> hostBindInfoStorage;
+        const VkBindImageMemoryInfo* hostBindInfo = getHostBindInfos(1, bimi, hostBindInfoStorage);
+        VkResult result =
+            vk->vkBindImageMemory(device, image, hostBindInfo->memory, hostBindInfo->memoryOffset);
         if (result != VK_SUCCESS) {
             return result;
         }
@@ -2859,7 +3017,8 @@ class VkDecoderGlobalState::Impl {
             return VK_SUCCESS;
         }
 
-        return imageInfo->compressInfo->bindCompressedMipmapsMemory(vk, memory, memoryOffset);
+        return imageInfo->compressInfo->bindCompressedMipmapsMemory(vk, hostBindInfo->memory,
+                                                                    hostBindInfo->memoryOffset);
     }
 
     VkResult on_vkBindImageMemory(gfxstream::base::BumpPool* pool,
@@ -2930,7 +3089,9 @@ class VkDecoderGlobalState::Impl {
             return VK_SUCCESS;
         }
 
-        VkResult result = vk->vkBindImageMemory2(device, bindInfoCount, pBindInfos);
+        std::vector<VkBindImageMemoryInfo> hostBindInfoStorage;
+        VkResult result = vk->vkBindImageMemory2(
+            device, bindInfoCount, getHostBindInfos(bindInfoCount, pBindInfos, hostBindInfoStorage));
         if (result != VK_SUCCESS) {
             return result;
         }
@@ -3019,6 +3180,40 @@ class VkDecoderGlobalState::Impl {
         return result;
     }
 
+    // Hands the object over to the DeviceOpTracker of the device which destroys it, batched
+    // with the other deferred objects, once the host work submitted so far has completed.
+    // This keeps the driver's destroy calls out of mMutex. Returns false if the object must
+    // be destroyed right away instead.
+    bool deferDestroyLocked(VkDevice device, DeviceOpTracker::DeferredDestroyObject obj,
+                            const VkAllocationCallbacks* pAllocator) REQUIRES(mMutex) {
+        if (!mDeferredDestroyEnabled || pAllocator) {
+            return false;
+        }
+        auto* deviceInfo = gfxstream::base::find(mDeviceInfo, device);
+        if (!deviceInfo || !deviceInfo->deviceOpTracker) {
+            return false;
+        }
+        deviceInfo->deviceOpTracker->AddDeferredDestroy(obj);
+        return true;
+    }
+
+    // Destroys the deferred objects, and the other garbage of the device, that a wait of the
+    // guest may have released.
+    void pollAndProcessGarbage(VkDevice device) {
+        DeviceOpTrackerPtr deviceOpTracker;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            auto* deviceInfo = gfxstream::base::find(mDeviceInfo, device);
+            if (!deviceInfo) {
+                return;
+            }
+            deviceOpTracker = deviceInfo->deviceOpTracker;
+        }
+        if (deviceOpTracker) {
+            deviceOpTracker->PollAndProcessGarbage();
+        }
+    }
+
     void destroyImageViewWithExclusiveInfo(VkDevice device, VulkanDispatch* deviceDispatch,
                                            VkImageView imageView, ImageViewInfo& imageViewInfo,
                                            const VkAllocationCallbacks* pAllocator) {
@@ -3032,8 +3227,10 @@ class VkDecoderGlobalState::Impl {
         if (imageViewInfoIt == mImageViewInfo.end()) return;
         auto& imageViewInfo = imageViewInfoIt->second;
 
-        destroyImageViewWithExclusiveInfo(device, deviceDispatch, imageView, imageViewInfo,
-                                          pAllocator);
+        if (!deferDestroyLocked(device, imageView, pAllocator)) {
+            destroyImageViewWithExclusiveInfo(device, deviceDispatch, imageView, imageViewInfo,
+                                              pAllocator);
+        }
 
         mImageViewInfo.erase(imageView);
     }
@@ -3041,6 +3238,8 @@ class VkDecoderGlobalState::Impl {
     void on_vkDestroyImageView(gfxstream::base::BumpPool* pool, VkSnapshotApiCallHandle,
                                VkDevice boxed_device, VkImageView imageView,
                                const VkAllocationCallbacks* pAllocator) {
+        waitForAllSubDecodes();
+
         auto device = unbox_VkDevice(boxed_device);
         auto deviceDispatch = dispatch_VkDevice(boxed_device);
 
@@ -3096,7 +3295,14 @@ class VkDecoderGlobalState::Impl {
         if (samplerInfoIt == mSamplerInfo.end()) return;
         auto& samplerInfo = samplerInfoIt->second;
 
-        destroySamplerWithExclusiveInfo(device, deviceDispatch, sampler, samplerInfo, pAllocator);
+        if (deferDestroyLocked(device, sampler, pAllocator)) {
+            if (samplerInfo.emulatedborderSampler != VK_NULL_HANDLE) {
+                deferDestroyLocked(device, samplerInfo.emulatedborderSampler, nullptr);
+            }
+        } else {
+            destroySamplerWithExclusiveInfo(device, deviceDispatch, sampler, samplerInfo,
+                                            pAllocator);
+        }
 
         mSamplerInfo.erase(samplerInfoIt);
     }
@@ -3104,6 +3310,8 @@ class VkDecoderGlobalState::Impl {
     void on_vkDestroySampler(gfxstream::base::BumpPool* pool, VkSnapshotApiCallHandle,
                              VkDevice boxed_device, VkSampler sampler,
                              const VkAllocationCallbacks* pAllocator) {
+        waitForAllSubDecodes();
+
         auto device = unbox_VkDevice(boxed_device);
         auto deviceDispatch = dispatch_VkDevice(boxed_device);
 
@@ -3333,7 +3541,11 @@ class VkDecoderGlobalState::Impl {
         auto vk = dispatch_VkDevice(boxed_device);
 
         // TODO(b/397501277): wait state checks cause test failures on old API levels
-        return waitForFences(device, vk, fenceCount, pFences, waitAll, timeout, false);
+        VkResult result = waitForFences(device, vk, fenceCount, pFences, waitAll, timeout, false);
+        if (result == VK_SUCCESS) {
+            pollAndProcessGarbage(device);
+        }
+        return result;
     }
 
     VkResult on_vkResetFences(gfxstream::base::BumpPool* pool, VkSnapshotApiCallHandle,
@@ -3887,6 +4099,11 @@ class VkDecoderGlobalState::Impl {
     void destroyDescriptorSetLayoutWithExclusiveInfo(
         VkDevice device, VulkanDispatch* deviceDispatch, VkDescriptorSetLayout descriptorSetLayout,
         DescriptorSetLayoutInfo& descriptorSetLayoutInfo, const VkAllocationCallbacks* pAllocator) {
+        for (auto& [key, descriptorUpdateTemplate] : descriptorSetLayoutInfo.batchedWriteTemplates) {
+            deviceDispatch->vkDestroyDescriptorUpdateTemplate(device, descriptorUpdateTemplate,
+                                                              nullptr);
+        }
+        descriptorSetLayoutInfo.batchedWriteTemplates.clear();
         deviceDispatch->vkDestroyDescriptorSetLayout(device, descriptorSetLayout, pAllocator);
     }
 
@@ -3908,6 +4125,8 @@ class VkDecoderGlobalState::Impl {
                                          VkDevice boxed_device,
                                          VkDescriptorSetLayout descriptorSetLayout,
                                          const VkAllocationCallbacks* pAllocator) {
+        waitForAllSubDecodes();
+
         auto device = unbox_VkDevice(boxed_device);
         auto deviceDispatch = dispatch_VkDevice(boxed_device);
 
@@ -4013,8 +4232,14 @@ class VkDecoderGlobalState::Impl {
         if (descriptorPoolInfoIt == mDescriptorPoolInfo.end()) return;
         auto& descriptorPoolInfo = descriptorPoolInfoIt->second;
 
-        destroyDescriptorPoolWithExclusiveInfo(device, deviceDispatch, descriptorPool,
-                                               descriptorPoolInfo, mDescriptorSetInfo, pAllocator);
+        if (deferDestroyLocked(device, descriptorPool, pAllocator)) {
+            cleanupDescriptorPoolAllocedSetsLocked(descriptorPoolInfo, mDescriptorSetInfo,
+                                                   true /* destroy */);
+        } else {
+            destroyDescriptorPoolWithExclusiveInfo(device, deviceDispatch, descriptorPool,
+                                                   descriptorPoolInfo, mDescriptorSetInfo,
+                                                   pAllocator);
+        }
 
         mDescriptorPoolInfo.erase(descriptorPoolInfoIt);
     }
@@ -4022,6 +4247,8 @@ class VkDecoderGlobalState::Impl {
     void on_vkDestroyDescriptorPool(gfxstream::base::BumpPool* pool, VkSnapshotApiCallHandle,
                                     VkDevice boxed_device, VkDescriptorPool descriptorPool,
                                     const VkAllocationCallbacks* pAllocator) {
+        waitForAllSubDecodes();
+
         auto device = unbox_VkDevice(boxed_device);
         auto deviceDispatch = dispatch_VkDevice(boxed_device);
 
@@ -4041,6 +4268,8 @@ class VkDecoderGlobalState::Impl {
     VkResult on_vkResetDescriptorPool(gfxstream::base::BumpPool* pool, VkSnapshotApiCallHandle,
                                       VkDevice boxed_device, VkDescriptorPool descriptorPool,
                                       VkDescriptorPoolResetFlags flags) {
+        waitForAllSubDecodes();
+
         auto device = unbox_VkDevice(boxed_device);
         auto deviceDispatch = dispatch_VkDevice(boxed_device);
 
@@ -4073,18 +4302,7 @@ class VkDecoderGlobalState::Impl {
         setInfo.pool = pool;
         setInfo.unboxedLayout = setLayout;
         setInfo.bindings = setLayoutInfo->bindings;
-        for (size_t i = 0; i < setInfo.bindings.size(); i++) {
-            VkDescriptorSetLayoutBinding dslBinding = setInfo.bindings[i];
-            int bindingIdx = dslBinding.binding;
-            if ((int)setInfo.allWrites.size() <= bindingIdx) {
-                setInfo.allWrites.resize(bindingIdx + 1);
-            }
-            setInfo.allWrites[bindingIdx].resize(dslBinding.descriptorCount);
-            for (auto& write : setInfo.allWrites[bindingIdx]) {
-                write.descriptorType = dslBinding.descriptorType;
-                write.dstArrayElement = 0;
-            }
-        }
+        initDescriptorSetWrites(setInfo);
 
         poolInfo->allocedSetsToBoxed[descriptorSet] = (VkDescriptorSet)boxedDescriptorSet;
         applyDescriptorSetAllocationLocked(*poolInfo, setInfo.bindings);
@@ -4127,6 +4345,8 @@ class VkDecoderGlobalState::Impl {
                                      VkDevice boxed_device, VkDescriptorPool descriptorPool,
                                      uint32_t descriptorSetCount,
                                      const VkDescriptorSet* pDescriptorSets) {
+        waitForAllSubDecodes();
+
         auto device = unbox_VkDevice(boxed_device);
         auto vk = dispatch_VkDevice(boxed_device);
 
@@ -4186,6 +4406,20 @@ class VkDecoderGlobalState::Impl {
                                        const VkWriteDescriptorSet* pDescriptorWrites,
                                        uint32_t descriptorCopyCount,
                                        const VkCopyDescriptorSet* pDescriptorCopies) REQUIRES(mMutex) {
+        recordDescriptorWritesLocked(descriptorWriteCount, pDescriptorWrites);
+        // TODO: bookkeep pDescriptorCopies
+        // Our primary use case vkQueueCommitDescriptorSetUpdatesGOOGLE does not use
+        // pDescriptorCopies. Thus skip its implementation for now.
+        if (descriptorCopyCount && snapshotsEnabled()) {
+            GFXSTREAM_ERROR("%s: Snapshot does not support descriptor copy yet\n");
+        }
+        applyDescriptorWritesLocked(pool, vk, device, descriptorWriteCount, pDescriptorWrites,
+                                    descriptorCopyCount, pDescriptorCopies);
+    }
+
+    void recordDescriptorWritesLocked(uint32_t descriptorWriteCount,
+                                      const VkWriteDescriptorSet* pDescriptorWrites)
+        REQUIRES(mMutex) {
         for (uint32_t writeIdx = 0; writeIdx < descriptorWriteCount; writeIdx++) {
             const VkWriteDescriptorSet& descriptorWrite = pDescriptorWrites[writeIdx];
             auto ite = mDescriptorSetInfo.find(descriptorWrite.dstSet);
@@ -4195,35 +4429,31 @@ class VkDecoderGlobalState::Impl {
             DescriptorSetInfo& descriptorSetInfo = ite->second;
             auto& table = descriptorSetInfo.allWrites;
             VkDescriptorType descType = descriptorWrite.descriptorType;
-            uint32_t dstBinding = descriptorWrite.dstBinding;
             uint32_t dstArrayElement = descriptorWrite.dstArrayElement;
-            uint32_t descriptorCount = descriptorWrite.descriptorCount;
-
-            uint32_t arrOffset = dstArrayElement;
+            uint32_t tableOffset = 0;
+            uint32_t descriptorCount = 0;
+            if (!getDescriptorWriteTableRange(descriptorSetInfo, descriptorWrite, &tableOffset,
+                                              &descriptorCount)) {
+                continue;
+            }
 
             if (isDescriptorTypeImageInfo(descType)) {
-                for (uint32_t writeElemIdx = 0; writeElemIdx < descriptorCount;
-                     ++writeElemIdx, ++arrOffset) {
-                    // Descriptor writes wrap to the next binding. See
-                    // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkWriteDescriptorSet.html
-                    if (arrOffset >= table[dstBinding].size()) {
-                        ++dstBinding;
-                        arrOffset = 0;
-                    }
-                    auto& entry = table[dstBinding][arrOffset];
+                for (uint32_t writeElemIdx = 0; writeElemIdx < descriptorCount; ++writeElemIdx) {
+                    auto& entry = table[tableOffset + writeElemIdx];
                     entry.imageInfo = descriptorWrite.pImageInfo[writeElemIdx];
                     entry.writeType = DescriptorSetInfo::DescriptorWriteType::ImageInfo;
                     entry.descriptorType = descType;
                     entry.alives.clear();
-                    entry.boundColorBuffer.reset();
+                    std::optional<HandleType> boundColorBuffer;
                     if (descriptorTypeContainsImage(descType)) {
                         auto* imageViewInfo =
                             gfxstream::base::find(mImageViewInfo, entry.imageInfo.imageView);
                         if (imageViewInfo) {
                             entry.alives.push_back(imageViewInfo->alive);
-                            entry.boundColorBuffer = imageViewInfo->boundColorBuffer;
+                            boundColorBuffer = imageViewInfo->boundColorBuffer;
                         }
                     }
+                    descriptorSetInfo.setBoundColorBuffer(entry, boundColorBuffer);
                     if (descriptorTypeContainsSampler(descType)) {
                         auto* samplerInfo =
                             gfxstream::base::find(mSamplerInfo, entry.imageInfo.sampler);
@@ -4233,33 +4463,25 @@ class VkDecoderGlobalState::Impl {
                     }
                 }
             } else if (isDescriptorTypeBufferInfo(descType)) {
-                for (uint32_t writeElemIdx = 0; writeElemIdx < descriptorCount;
-                     ++writeElemIdx, ++arrOffset) {
-                    if (arrOffset >= table[dstBinding].size()) {
-                        ++dstBinding;
-                        arrOffset = 0;
-                    }
-                    auto& entry = table[dstBinding][arrOffset];
+                for (uint32_t writeElemIdx = 0; writeElemIdx < descriptorCount; ++writeElemIdx) {
+                    auto& entry = table[tableOffset + writeElemIdx];
                     entry.bufferInfo = descriptorWrite.pBufferInfo[writeElemIdx];
                     entry.writeType = DescriptorSetInfo::DescriptorWriteType::BufferInfo;
                     entry.descriptorType = descType;
                     entry.alives.clear();
+                    descriptorSetInfo.setBoundColorBuffer(entry, std::nullopt);
                     auto* bufferInfo = gfxstream::base::find(mBufferInfo, entry.bufferInfo.buffer);
                     if (bufferInfo) {
                         entry.alives.push_back(bufferInfo->alive);
                     }
                 }
             } else if (isDescriptorTypeBufferView(descType)) {
-                for (uint32_t writeElemIdx = 0; writeElemIdx < descriptorCount;
-                     ++writeElemIdx, ++arrOffset) {
-                    if (arrOffset >= table[dstBinding].size()) {
-                        ++dstBinding;
-                        arrOffset = 0;
-                    }
-                    auto& entry = table[dstBinding][arrOffset];
+                for (uint32_t writeElemIdx = 0; writeElemIdx < descriptorCount; ++writeElemIdx) {
+                    auto& entry = table[tableOffset + writeElemIdx];
                     entry.bufferView = descriptorWrite.pTexelBufferView[writeElemIdx];
                     entry.writeType = DescriptorSetInfo::DescriptorWriteType::BufferView;
                     entry.descriptorType = descType;
+                    descriptorSetInfo.setBoundColorBuffer(entry, std::nullopt);
                     if (snapshotsEnabled()) {
                         // TODO: check alive
                         GFXSTREAM_ERROR("%s: Snapshot for texel buffer view is incomplete.\n",
@@ -4281,7 +4503,7 @@ class VkDecoderGlobalState::Impl {
                     GFXSTREAM_FATAL("Did not find inline uniform block");
                     return;
                 }
-                auto& entry = table[dstBinding][0];
+                auto& entry = table[tableOffset];
                 entry.inlineUniformBlock = *descInlineUniformBlock;
                 entry.inlineUniformBlockBuffer.assign(
                     static_cast<const uint8_t*>(descInlineUniformBlock->pData),
@@ -4301,38 +4523,40 @@ class VkDecoderGlobalState::Impl {
                 }
             }
         }
-        // TODO: bookkeep pDescriptorCopies
-        // Our primary use case vkQueueCommitDescriptorSetUpdatesGOOGLE does not use
-        // pDescriptorCopies. Thus skip its implementation for now.
-        if (descriptorCopyCount && snapshotsEnabled()) {
-            GFXSTREAM_ERROR("%s: Snapshot does not support descriptor copy yet\n");
+    }
+
+    bool descriptorWriteNeedsEmulatedAlphaLocked(const VkWriteDescriptorSet& descriptorWrite)
+        REQUIRES(mMutex) {
+        if (descriptorWrite.descriptorType != VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) {
+            return false;
+        }
+        for (uint32_t j = 0; j < descriptorWrite.descriptorCount; j++) {
+            const VkDescriptorImageInfo& imageInfo = descriptorWrite.pImageInfo[j];
+            const auto* imgViewInfo = gfxstream::base::find(mImageViewInfo, imageInfo.imageView);
+            if (!imgViewInfo) {
+                continue;
+            }
+            const auto* samplerInfo = gfxstream::base::find(mSamplerInfo, imageInfo.sampler);
+            if (samplerInfo && imgViewInfo->needEmulatedAlpha && samplerInfo->needEmulatedAlpha) {
+                return true;
+            }
         }
+        return false;
+    }
+
+    void applyDescriptorWritesLocked(gfxstream::base::BumpPool* pool, VulkanDispatch* vk,
+                                     VkDevice device, uint32_t descriptorWriteCount,
+                                     const VkWriteDescriptorSet* pDescriptorWrites,
+                                     uint32_t descriptorCopyCount,
+                                     const VkCopyDescriptorSet* pDescriptorCopies)
+        REQUIRES(mMutex) {
         bool needEmulateWriteDescriptor = false;
         // c++ seems to allow for 0-size array allocation
         std::unique_ptr<bool[]> descriptorWritesNeedDeepCopy(new bool[descriptorWriteCount]);
         for (uint32_t i = 0; i < descriptorWriteCount; i++) {
-            const VkWriteDescriptorSet& descriptorWrite = pDescriptorWrites[i];
-            descriptorWritesNeedDeepCopy[i] = false;
-            if (!vk_util::vk_descriptor_type_has_image_view(descriptorWrite.descriptorType)) {
-                continue;
-            }
-            for (uint32_t j = 0; j < descriptorWrite.descriptorCount; j++) {
-                const VkDescriptorImageInfo& imageInfo = descriptorWrite.pImageInfo[j];
-                const auto* imgViewInfo = gfxstream::base::find(mImageViewInfo, imageInfo.imageView);
-                if (!imgViewInfo) {
-                    continue;
-                }
-                if (descriptorWrite.descriptorType != VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) {
-                    continue;
-                }
-                const auto* samplerInfo = gfxstream::base::find(mSamplerInfo, imageInfo.sampler);
-                if (samplerInfo && imgViewInfo->needEmulatedAlpha &&
-                    samplerInfo->needEmulatedAlpha) {
-                    needEmulateWriteDescriptor = true;
-                    descriptorWritesNeedDeepCopy[i] = true;
-                    break;
-                }
-            }
+            descriptorWritesNeedDeepCopy[i] =
+                descriptorWriteNeedsEmulatedAlphaLocked(pDescriptorWrites[i]);
+            needEmulateWriteDescriptor |= descriptorWritesNeedDeepCopy[i];
         }
         if (!needEmulateWriteDescriptor) {
             vk->vkUpdateDescriptorSets(device, descriptorWriteCount, pDescriptorWrites,
@@ -4571,6 +4795,8 @@ class VkDecoderGlobalState::Impl {
     void on_vkDestroyPipelineLayout(gfxstream::base::BumpPool*, VkSnapshotApiCallHandle,
                                     VkDevice boxed_device, VkPipelineLayout pipelineLayout,
                                     const VkAllocationCallbacks* pAllocator) {
+        waitForAllSubDecodes();
+
         auto device = unbox_VkDevice(boxed_device);
         auto deviceDispatch = dispatch_VkDevice(boxed_device);
 
@@ -4661,6 +4887,8 @@ class VkDecoderGlobalState::Impl {
     void on_vkDestroyPipeline(gfxstream::base::BumpPool* pool, VkSnapshotApiCallHandle,
                               VkDevice boxed_device, VkPipeline pipeline,
                               const VkAllocationCallbacks* pAllocator) {
+        waitForAllSubDecodes();
+
         auto device = unbox_VkDevice(boxed_device);
         auto deviceDispatch = dispatch_VkDevice(boxed_device);
 
@@ -4900,6 +5128,8 @@ class VkDecoderGlobalState::Impl {
             return;
         }
 
+        addSubAllocationAlignmentLocked(*deviceInfo, *pMemoryRequirements);
+
         auto& physicalDeviceMemHelper = physicalDeviceInfo->memoryPropertiesHelper;
         physicalDeviceMemHelper->transformToGuestMemoryRequirements(pMemoryRequirements);
     }
@@ -4944,6 +5174,8 @@ class VkDecoderGlobalState::Impl {
 
         updateImageMemorySizeLocked(device, pInfo->image, &pMemoryRequirements->memoryRequirements);
 
+        addSubAllocationAlignmentLocked(*deviceInfo, pMemoryRequirements->memoryRequirements);
+
         auto& physicalDeviceMemHelper = physicalDeviceInfo->memoryPropertiesHelper;
         physicalDeviceMemHelper->transformToGuestMemoryRequirements(
             &pMemoryRequirements->memoryRequirements);
@@ -4969,6 +5201,8 @@ class VkDecoderGlobalState::Impl {
                             deviceInfo->physicalDevice);
         }
 
+        addSubAllocationAlignmentLocked(*deviceInfo, *pMemoryRequirements);
+
         auto& physicalDeviceMemHelper = physicalDeviceInfo->memoryPropertiesHelper;
         physicalDeviceMemHelper->transformToGuestMemoryRequirements(pMemoryRequirements);
     }
@@ -5009,6 +5243,8 @@ class VkDecoderGlobalState::Impl {
                                               &pMemoryRequirements->memoryRequirements);
         }
 
+        addSubAllocationAlignmentLocked(*deviceInfo, pMemoryRequirements->memoryRequirements);
+
         auto& physicalDeviceMemHelper = physicalDeviceInfo->memoryPropertiesHelper;
         physicalDeviceMemHelper->transformToGuestMemoryRequirements(
             &pMemoryRequirements->memoryRequirements);
@@ -5955,6 +6191,18 @@ class VkDecoderGlobalState::Impl {
             }
         }
 
+        // Only plain allocations are sub-allocated: anything with a pNext chain may be
+        // dedicated, imported, exported or need allocation flags that apply to the whole
+        // host allocation.
+        if (!hostVisible && !pAllocateInfo->pNext && !localAllocInfo.pNext && !pAllocator) {
+            std::lock_guard<std::mutex> lock(mMutex);
+            auto subAllocatedMemory = trySubAllocateMemoryLocked(device, localAllocInfo);
+            if (subAllocatedMemory) {
+                *pMemory = new_boxed_non_dispatchable_VkDeviceMemory(*subAllocatedMemory);
+                return VK_SUCCESS;
+            }
+        }
+
         VkResult result = vk->vkAllocateMemory(device, &localAllocInfo, pAllocator, pMemory);
         if (result != VK_SUCCESS) {
             return result;
@@ -6030,9 +6278,160 @@ class VkDecoderGlobalState::Impl {
         return result;
     }
 
+    // Keeps the sub-allocations a resource may be bound to aligned for it.
+    void addSubAllocationAlignmentLocked(const DeviceInfo& deviceInfo,
+                                         const VkMemoryRequirements& requirements)
+        REQUIRES(mMutex) {
+        if (deviceInfo.memorySubAllocator) {
+            deviceInfo.memorySubAllocator->addRequiredAlignment(requirements.memoryTypeBits,
+                                                                requirements.alignment);
+        }
+    }
+
+    std::optional<VkDeviceMemory> trySubAllocateMemoryLocked(
+        VkDevice device, const VkMemoryAllocateInfo& allocInfo) REQUIRES(mMutex) {
+        auto* deviceInfo = gfxstream::base::find(mDeviceInfo, device);
+        if (!deviceInfo || !deviceInfo->memorySubAllocator) return std::nullopt;
+
+        auto* physicalDeviceInfo = gfxstream::base::find(mPhysdevInfo, deviceInfo->physicalDevice);
+        if (!physicalDeviceInfo ||
+            !physicalDeviceInfo->memoryPropertiesHelper->supportsSubAllocation(
+                allocInfo.memoryTypeIndex)) {
+            return std::nullopt;
+        }
+
+        auto subAllocation = deviceInfo->memorySubAllocator->allocate(allocInfo.memoryTypeIndex,
+                                                                      allocInfo.allocationSize);
+        if (!subAllocation) return std::nullopt;
+
+        VALIDATE_NEW_HANDLE_INFO_ENTRY(mMemoryInfo, subAllocation->handle);
+        auto& memoryInfo = mMemoryInfo[subAllocation->handle];
+        memoryInfo.size = allocInfo.allocationSize;
+        memoryInfo.device = device;
+        memoryInfo.memoryIndex = allocInfo.memoryTypeIndex;
+        memoryInfo.subAllocation = subAllocation;
+        return subAllocation->handle;
+    }
+
+    // Returns the host memory and offset to pass to the driver for a guest memory and offset.
+    std::pair<VkDeviceMemory, VkDeviceSize> getHostMemoryAndOffsetLocked(
+        VkDeviceMemory memory, VkDeviceSize offset) REQUIRES(mMutex) {
+        const auto* memoryInfo = gfxstream::base::find(mMemoryInfo, memory);
+        if (!memoryInfo || !memoryInfo->subAllocation) {
+            return {memory, offset};
+        }
+        return {memoryInfo->subAllocation->blockMemory,
+                memoryInfo->subAllocation->blockOffset + offset};
+    }
+
+    // Returns pBindInfos, or a copy referring to the host memory if any of the bound memory is
+    // sub-allocated.
+    template <typename BindInfo>
+    const BindInfo* getHostBindInfos(uint32_t bindInfoCount, const BindInfo* pBindInfos,
+                                     std::vector<BindInfo>& storage) EXCLUDES(mMutex) {
+        if (!m_vkEmulation->getFeatures().VulkanSubAllocateMemory.enabled) {
+            return pBindInfos;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (uint32_t i = 0; i < bindInfoCount; ++i) {
+            auto [hostMemory, hostOffset] =
+                getHostMemoryAndOffsetLocked(pBindInfos[i].memory, pBindInfos[i].memoryOffset);
+            if (hostMemory == pBindInfos[i].memory) continue;
+
+            if (storage.empty()) {
+                storage.assign(pBindInfos, pBindInfos + bindInfoCount);
+            }
+            storage[i].memory = hostMemory;
+            storage[i].memoryOffset = hostOffset;
+        }
+        return storage.empty() ? pBindInfos : storage.data();
+    }
+
+    // Same as getHostBindInfos() but for the binds nested in sparse bind infos, copied into
+    // the pool.
+    const VkBindSparseInfo* getHostBindSparseInfos(gfxstream::base::BumpPool* pool,
+                                                   uint32_t bindInfoCount,
+                                                   const VkBindSparseInfo* pBindInfo)
+        EXCLUDES(mMutex) {
+        if (!m_vkEmulation->getFeatures().VulkanSubAllocateMemory.enabled) {
+            return pBindInfo;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        bool anySubAllocated = false;
+        for (uint32_t i = 0; i < bindInfoCount && !anySubAllocated; ++i) {
+            const VkBindSparseInfo& info = pBindInfo[i];
+            for (uint32_t j = 0; j < info.bufferBindCount; ++j) {
+                for (uint32_t k = 0; k < info.pBufferBinds[j].bindCount; ++k) {
+                    anySubAllocated |= isSubAllocatedLocked(info.pBufferBinds[j].pBinds[k].memory);
+                }
+            }
+            for (uint32_t j = 0; j < info.imageOpaqueBindCount; ++j) {
+                for (uint32_t k = 0; k < info.pImageOpaqueBinds[j].bindCount; ++k) {
+                    anySubAllocated |= isSubAllocatedLocked(info.pImageOpaqueBinds[j].pBinds[k].memory);
+                }
+            }
+            for (uint32_t j = 0; j < info.imageBindCount; ++j) {
+                for (uint32_t k = 0; k < info.pImageBinds[j].bindCount; ++k) {
+                    anySubAllocated |= isSubAllocatedLocked(info.pImageBinds[j].pBinds[k].memory);
+                }
+            }
+        }
+        if (!anySubAllocated) {
+            return pBindInfo;
+        }
+
+        VkBindSparseInfo* hostBindInfos = copyToPool(pool, pBindInfo, bindInfoCount);
+        for (uint32_t i = 0; i < bindInfoCount; ++i) {
+            VkBindSparseInfo& info = hostBindInfos[i];
+            info.pBufferBinds =
+                getHostSparseBindsLocked(pool, info.pBufferBinds, info.bufferBindCount);
+            info.pImageOpaqueBinds =
+                getHostSparseBindsLocked(pool, info.pImageOpaqueBinds, info.imageOpaqueBindCount);
+            info.pImageBinds = getHostSparseBindsLocked(pool, info.pImageBinds, info.imageBindCount);
+        }
+        return hostBindInfos;
+    }
+
+    bool isSubAllocatedLocked(VkDeviceMemory memory) REQUIRES(mMutex) {
+        const auto* memoryInfo = gfxstream::base::find(mMemoryInfo, memory);
+        return memoryInfo && memoryInfo->subAllocation;
+    }
+
+    template <typename T>
+    static T* copyToPool(gfxstream::base::BumpPool* pool, const T* src, uint32_t count) {
+        T* dst = static_cast<T*>(pool->alloc(sizeof(T) * count));
+        std::copy(src, src + count, dst);
+        return dst;
+    }
+
+    template <typename SparseBindInfo>
+    const SparseBindInfo* getHostSparseBindsLocked(gfxstream::base::BumpPool* pool,
+                                                   const SparseBindInfo* bindInfos,
+                                                   uint32_t bindInfoCount) REQUIRES(mMutex) {
+        SparseBindInfo* hostBindInfos = copyToPool(pool, bindInfos, bindInfoCount);
+        for (uint32_t i = 0; i < bindInfoCount; ++i) {
+            auto* binds = copyToPool(pool, bindInfos[i].pBinds, bindInfos[i].bindCount);
+            for (uint32_t j = 0; j < bindInfos[i].bindCount; ++j) {
+                std::tie(binds[j].memory, binds[j].memoryOffset) =
+                    getHostMemoryAndOffsetLocked(binds[j].memory, binds[j].memoryOffset);
+            }
+            hostBindInfos[i].pBinds = binds;
+        }
+        return hostBindInfos;
+    }
+
     void destroyMemoryWithExclusiveInfo(VkDevice device, VulkanDispatch* deviceDispatch,
                                         VkDeviceMemory memory, MemoryInfo& memoryInfo,
                                         const VkAllocationCallbacks* pAllocator) {
+        // Returned to the sub-allocator by freeMemoryLocked() or released along with the
+        // device's sub-allocator.
+        if (memoryInfo.subAllocation) {
+            return;
+        }
+
         if (memoryInfo.directMapped) {
             // if direct mapped, we leave it up to the guest address space driver
             // to control the unmapping of kvm slot on the host side
@@ -6061,6 +6460,13 @@ class VkDecoderGlobalState::Impl {
         if (memoryInfoIt == mMemoryInfo.end()) return;
         auto& memoryInfo = memoryInfoIt->second;
 
+        if (memoryInfo.subAllocation) {
+            auto* deviceInfo = gfxstream::base::find(mDeviceInfo, device);
+            if (deviceInfo && deviceInfo->memorySubAllocator) {
+                deviceInfo->memorySubAllocator->free(memory);
+            }
+        }
+
         destroyMemoryWithExclusiveInfo(device, deviceDispatch, memory, memoryInfo, pAllocator);
 
         mMemoryInfo.erase(memoryInfoIt);
@@ -6069,6 +6475,8 @@ class VkDecoderGlobalState::Impl {
     void on_vkFreeMemory(gfxstream::base::BumpPool* pool, VkSnapshotApiCallHandle,
                          VkDevice boxed_device, VkDeviceMemory memory,
                          const VkAllocationCallbacks* pAllocator) {
+        waitForAllSubDecodes();
+
         auto device = unbox_VkDevice(boxed_device);
         auto deviceDispatch = dispatch_VkDevice(boxed_device);
         if (!device || !deviceDispatch) return;
@@ -6247,7 +6655,8 @@ class VkDecoderGlobalState::Impl {
             return result;
         }
 
-        DeviceOpWaitable aniCompletedWaitable = builder.OnQueueSubmittedWithFence(usedFence);
+        DeviceOpWaitable aniCompletedWaitable =
+            builder.OnQueueSubmittedWithFence(defaultQueue, usedFence);
 
         if (semaphore != VK_NULL_HANDLE) {
             auto semaphoreInfo = gfxstream::base::find(mSemaphoreInfo, semaphore);
@@ -6569,6 +6978,8 @@ class VkDecoderGlobalState::Impl {
     void on_vkDestroyCommandPool(gfxstream::base::BumpPool* pool, VkSnapshotApiCallHandle,
                                  VkDevice boxed_device, VkCommandPool commandPool,
                                  const VkAllocationCallbacks* pAllocator) {
+        waitForSubDecodes(commandPool);
+
         auto device = unbox_VkDevice(boxed_device);
         auto deviceDispatch = dispatch_VkDevice(boxed_device);
 
@@ -6579,6 +6990,8 @@ class VkDecoderGlobalState::Impl {
     VkResult on_vkResetCommandPool(gfxstream::base::BumpPool* pool, VkSnapshotApiCallHandle,
                                    VkDevice boxed_device, VkCommandPool commandPool,
                                    VkCommandPoolResetFlags flags) {
+        waitForSubDecodes(commandPool);
+
         auto device = unbox_VkDevice(boxed_device);
         auto vk = dispatch_VkDevice(boxed_device);
 
@@ -6595,6 +7008,9 @@ class VkDecoderGlobalState::Impl {
         auto commandBuffer = unbox_VkCommandBuffer(boxed_commandBuffer);
         auto vk = dispatch_VkCommandBuffer(boxed_commandBuffer);
 
+        // The secondary command buffers have to be fully recorded before they are executed.
+        waitForSubDecodes(commandBufferCount, pCommandBuffers);
+
         vk->vkCmdExecuteCommands(commandBuffer, commandBufferCount, pCommandBuffers);
         std::lock_guard<std::mutex> lock(mMutex);
         CommandBufferInfo& cmdBuffer = mCommandBufferInfo[commandBuffer];
@@ -6817,6 +7233,16 @@ class VkDecoderGlobalState::Impl {
         auto queue = unbox_VkQueue(boxed_queue);
         auto vk = dispatch_VkQueue(boxed_queue);
 
+        if (mSubDecodeWorkerPool) {
+            std::vector<VkCommandBuffer> commandBuffers;
+            for (uint32_t i = 0; i < submitCount; i++) {
+                for (int j = 0; j < getCommandBufferCount(pSubmits[i]); j++) {
+                    commandBuffers.push_back(getCommandBuffer(pSubmits[i], j));
+                }
+            }
+            waitForSubDecodes(static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
+        }
+
         std::unordered_set<HandleType> acquiredColorBuffers;
         std::unordered_set<HandleType> releasedColorBuffers;
         VkDevice device = VK_NULL_HANDLE;
@@ -6843,15 +7269,19 @@ class VkDecoderGlobalState::Impl {
                             if (!descriptorSetInfo) {
                                 continue;
                             }
-                            for (auto& writes : descriptorSetInfo->allWrites) {
-                                for (const auto& write : writes) {
-                                    bool isValid = true;
-                                    for (const auto& alive : write.alives) {
-                                        isValid &= !alive.expired();
-                                    }
-                                    if (isValid && write.boundColorBuffer.has_value()) {
-                                        acquiredColorBuffers.insert(write.boundColorBuffer.value());
-                                    }
+                            if (!descriptorSetInfo->colorBufferWriteCount) {
+                                continue;
+                            }
+                            for (const auto& write : descriptorSetInfo->allWrites) {
+                                if (!write.boundColorBuffer.has_value()) {
+                                    continue;
+                                }
+                                bool isValid = true;
+                                for (const auto& alive : write.alives) {
+                                    isValid &= !alive.expired();
+                                }
+                                if (isValid) {
+                                    acquiredColorBuffers.insert(write.boundColorBuffer.value());
                                 }
                             }
                         }
@@ -6949,7 +7379,8 @@ class VkDecoderGlobalState::Impl {
             }
         }
 
-        DeviceOpWaitable queueCompletedWaitable = builder.OnQueueSubmittedWithFence(usedFence);
+        DeviceOpWaitable queueCompletedWaitable =
+            builder.OnQueueSubmittedWithFence(queue, usedFence);
 
         {
             std::lock_guard<std::mutex> lock(mMutex);
@@ -7048,11 +7479,13 @@ class VkDecoderGlobalState::Impl {
 
         if (!queue) return VK_SUCCESS;
 
+        VkDevice device;
         std::mutex* queueMutex;
         {
             std::lock_guard<std::mutex> lock(mMutex);
             auto* queueInfo = gfxstream::base::find(mQueueInfo, queue);
             if (!queueInfo) return VK_SUCCESS;
+            device = queueInfo->device;
             queueMutex = queueInfo->queueMutex.get();
         }
 
@@ -7061,8 +7494,15 @@ class VkDecoderGlobalState::Impl {
         // other fences/work. It should not hold the queue lock/ql while waiting to allow
         // submissions and other operations on the virtualized queue
 
-        std::lock_guard<std::mutex> queueLock(*queueMutex);
-        return vk->vkQueueWaitIdle(queue);
+        VkResult result;
+        {
+            std::lock_guard<std::mutex> queueLock(*queueMutex);
+            result = vk->vkQueueWaitIdle(queue);
+        }
+        if (result == VK_SUCCESS) {
+            pollAndProcessGarbage(device);
+        }
+        return result;
     }
 
     VkResult on_vkResetCommandBuffer(gfxstream::base::BumpPool* pool, VkSnapshotApiCallHandle,
@@ -7071,6 +7511,8 @@ class VkDecoderGlobalState::Impl {
         auto commandBuffer = unbox_VkCommandBuffer(boxed_commandBuffer);
         auto vk = dispatch_VkCommandBuffer(boxed_commandBuffer);
 
+        waitForSubDecodes(1, &commandBuffer);
+
         m_vkEmulation->getDeviceLostHelper().onResetCommandBuffer(commandBuffer);
 
         VkResult result = vk->vkResetCommandBuffer(commandBuffer, flags);
@@ -7125,6 +7567,8 @@ class VkDecoderGlobalState::Impl {
                                  VkDevice boxed_device, VkCommandPool commandPool,
                                  uint32_t commandBufferCount,
                                  const VkCommandBuffer* pCommandBuffers) {
+        waitForSubDecodes(commandPool);
+
         auto device = unbox_VkDevice(boxed_device);
         auto deviceDispatch = dispatch_VkDevice(boxed_device);
         if (!device || !deviceDispatch) return;
@@ -7233,6 +7677,9 @@ class VkDecoderGlobalState::Impl {
                                               VkDevice boxed_device,
                                               VkDescriptorUpdateTemplate descriptorUpdateTemplate,
                                               const VkAllocationCallbacks* pAllocator) {
+        // Pending sub-decodes may push descriptors with the template.
+        waitForAllSubDecodes();
+
         auto device = unbox_VkDevice(boxed_device);
         auto vk = dispatch_VkDevice(boxed_device);
 
@@ -7245,6 +7692,8 @@ class VkDecoderGlobalState::Impl {
         gfxstream::base::BumpPool* pool, VkSnapshotApiCallHandle, VkDevice boxed_device,
         VkDescriptorUpdateTemplate descriptorUpdateTemplate,
         const VkAllocationCallbacks* pAllocator) {
+        waitForAllSubDecodes();
+
         auto device = unbox_VkDevice(boxed_device);
         auto vk = dispatch_VkDevice(boxed_device);
 
@@ -7425,6 +7874,9 @@ class VkDecoderGlobalState::Impl {
                                      const VkDecoderContext& context) {
         auto commandBuffer = unbox_VkCommandBuffer(boxed_commandBuffer);
         auto vk = dispatch_VkCommandBuffer(boxed_commandBuffer);
+
+        waitForSubDecodes(1, &commandBuffer);
+
         VkResult result = vk->vkBeginCommandBuffer(commandBuffer, pBeginInfo);
 
         if (result != VK_SUCCESS) {
@@ -7462,6 +7914,8 @@ class VkDecoderGlobalState::Impl {
         auto commandBuffer = unbox_VkCommandBuffer(boxed_commandBuffer);
         auto vk = dispatch_VkCommandBuffer(boxed_commandBuffer);
 
+        waitForSubDecodes(1, &commandBuffer);
+
         m_vkEmulation->getDeviceLostHelper().onEndCommandBuffer(commandBuffer, vk);
 
         std::lock_guard<std::mutex> lock(mMutex);
@@ -7614,8 +8068,10 @@ class VkDecoderGlobalState::Impl {
         if (renderPassInfoIt == mRenderPassInfo.end()) return;
         auto& renderPassInfo = renderPassInfoIt->second;
 
-        destroyRenderPassWithExclusiveInfo(device, deviceDispatch, renderPass, renderPassInfo,
-                                           pAllocator);
+        if (!deferDestroyLocked(device, renderPass, pAllocator)) {
+            destroyRenderPassWithExclusiveInfo(device, deviceDispatch, renderPass, renderPassInfo,
+                                               pAllocator);
+        }
 
         mRenderPassInfo.erase(renderPass);
     }
@@ -7623,6 +8079,8 @@ class VkDecoderGlobalState::Impl {
     void on_vkDestroyRenderPass(gfxstream::base::BumpPool* pool, VkSnapshotApiCallHandle,
                                 VkDevice boxed_device, VkRenderPass renderPass,
                                 const VkAllocationCallbacks* pAllocator) {
+        waitForAllSubDecodes();
+
         auto device = unbox_VkDevice(boxed_device);
         auto deviceDispatch = dispatch_VkDevice(boxed_device);
 
@@ -7764,8 +8222,10 @@ class VkDecoderGlobalState::Impl {
         if (framebufferInfoIt == mFramebufferInfo.end()) return;
         auto& framebufferInfo = framebufferInfoIt->second;
 
-        destroyFramebufferWithExclusiveInfo(device, deviceDispatch, framebuffer, framebufferInfo,
-                                            pAllocator);
+        if (!deferDestroyLocked(device, framebuffer, pAllocator)) {
+            destroyFramebufferWithExclusiveInfo(device, deviceDispatch, framebuffer,
+                                                framebufferInfo, pAllocator);
+        }
 
         mFramebufferInfo.erase(framebuffer);
     }
@@ -7773,6 +8233,8 @@ class VkDecoderGlobalState::Impl {
     void on_vkDestroyFramebuffer(gfxstream::base::BumpPool* pool, VkSnapshotApiCallHandle,
                                  VkDevice boxed_device, VkFramebuffer framebuffer,
                                  const VkAllocationCallbacks* pAllocator) {
+        waitForAllSubDecodes();
+
         auto device = unbox_VkDevice(boxed_device);
         auto deviceDispatch = dispatch_VkDevice(boxed_device);
 
@@ -7809,6 +8271,8 @@ class VkDecoderGlobalState::Impl {
         auto queue = unbox_VkQueue(boxed_queue);
         auto vk = dispatch_VkQueue(boxed_queue);
 
+        pBindInfo = getHostBindSparseInfos(pool, bindInfoCount, pBindInfo);
+
         if (!hasTimelineSemaphoreSubmitInfo) {
             (void)pool;
             return vk->vkQueueBindSparse(queue, bindInfoCount, pBindInfo, fence);
@@ -8046,8 +8510,77 @@ class VkDecoderGlobalState::Impl {
         VkCommandBuffer commandBuffer = unbox_VkCommandBuffer(boxed_commandBuffer);
         VulkanDispatch* vk = dispatch_VkCommandBuffer(boxed_commandBuffer);
         VulkanMemReadingStream* readStream = readstream_VkCommandBuffer(boxed_commandBuffer);
-        subDecode(readStream, vk, apiCallHandle, boxed_commandBuffer, commandBuffer, dataSize,
-                  pData, context);
+
+        VkCommandPool commandPool = VK_NULL_HANDLE;
+        if (mSubDecodeWorkerPool) {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (auto* commandBufferInfo = gfxstream::base::find(mCommandBufferInfo, commandBuffer)) {
+                commandPool = commandBufferInfo->cmdPool;
+            }
+        }
+        if (commandPool == VK_NULL_HANDLE) {
+            subDecode(readStream, vk, apiCallHandle, boxed_commandBuffer, commandBuffer, dataSize,
+                      pData, context);
+            return;
+        }
+
+        // `pData` and parts of `context` are owned by the decoder thread and do not outlive
+        // this call.
+        std::vector<uint8_t> data(static_cast<const uint8_t*>(pData),
+                                  static_cast<const uint8_t*>(pData) + dataSize);
+        std::optional<std::string> processName;
+        if (context.processName) {
+            processName = context.processName;
+        }
+        mSubDecodeWorkerPool->enqueue(
+            commandPool, [this, readStream, vk, apiCallHandle, boxed_commandBuffer, commandBuffer,
+                          data = std::move(data), processName = std::move(processName),
+                          healthMonitor = context.healthMonitor,
+                          metricsLogger = context.metricsLogger]() {
+                const VkDecoderContext workerContext = {
+                    .processName = processName ? processName->c_str() : nullptr,
+                    .healthMonitor = healthMonitor,
+                    .metricsLogger = metricsLogger,
+                };
+                subDecode(readStream, vk, apiCallHandle, boxed_commandBuffer, commandBuffer,
+                          data.size(), data.data(), workerContext);
+            });
+    }
+
+    // Waits for the pending sub-decodes of the command pools of `commandBuffers`.
+    void waitForSubDecodes(uint32_t commandBufferCount, const VkCommandBuffer* commandBuffers)
+        EXCLUDES(mMutex) {
+        if (!mSubDecodeWorkerPool) {
+            return;
+        }
+        std::vector<VkCommandPool> commandPools;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            for (uint32_t i = 0; i < commandBufferCount; i++) {
+                auto* commandBufferInfo = gfxstream::base::find(mCommandBufferInfo, commandBuffers[i]);
+                if (commandBufferInfo && commandBufferInfo->cmdPool != VK_NULL_HANDLE) {
+                    commandPools.push_back(commandBufferInfo->cmdPool);
+                }
+            }
+        }
+        for (VkCommandPool commandPool : commandPools) {
+            mSubDecodeWorkerPool->wait(commandPool);
+        }
+    }
+
+    // Waits for the pending sub-decodes of the command buffers of `commandPool`.
+    void waitForSubDecodes(VkCommandPool commandPool) EXCLUDES(mMutex) {
+        if (mSubDecodeWorkerPool) {
+            mSubDecodeWorkerPool->wait(commandPool);
+        }
+    }
+
+    // Waits for all of the pending sub-decodes. Used before destroying objects that a pending
+    // sub-decode may still reference.
+    void waitForAllSubDecodes() EXCLUDES(mMutex) {
+        if (mSubDecodeWorkerPool) {
+            mSubDecodeWorkerPool->waitAll();
+        }
     }
 
     void on_vkQueueFlushCommandsFromAuxMemoryGOOGLE(gfxstream::base::BumpPool* pool,
@@ -8111,6 +8644,18 @@ class VkDecoderGlobalState::Impl {
         const uint32_t* pDescriptorSetPendingAllocation,
         const uint32_t* pDescriptorWriteStartingIndices, uint32_t pendingDescriptorWriteCount,
         const VkWriteDescriptorSet* pPendingDescriptorWrites) {
+        // Reallocating a set frees the host set, which pending sub-decodes may bind.
+        for (uint32_t i = 0; i < descriptorSetCount; ++i) {
+            if (!pDescriptorSetPendingAllocation[i]) {
+                continue;
+            }
+            BoxedHandleInfo* setHandleInfo = sBoxedHandleManager.get(pDescriptorSetPoolIds[i]);
+            if (setHandleInfo && setHandleInfo->underlying) {
+                waitForAllSubDecodes();
+                break;
+            }
+        }
+
         std::lock_guard<std::mutex> lock(mMutex);
 
         VkDevice device = VK_NULL_HANDLE;
@@ -8156,32 +8701,181 @@ class VkDecoderGlobalState::Impl {
             if (didAllocThisTime) didAlloc = true;
         }
 
+        // The writes of set i are the ones from pDescriptorWriteStartingIndices[i] up to the
+        // starting index of set i + 1.
+        const bool writeRangesValid = descriptorWriteRangesCoverAllWrites(
+            descriptorSetCount, pDescriptorWriteStartingIndices, pendingDescriptorWriteCount);
+        auto getWriteEndIndex = [&](uint32_t i) {
+            return i == descriptorSetCount - 1 ? pendingDescriptorWriteCount
+                                               : pDescriptorWriteStartingIndices[i + 1];
+        };
+
+        const VkWriteDescriptorSet* writes = pPendingDescriptorWrites;
+        std::vector<VkWriteDescriptorSet> writeDescriptorSetsForHostDriver;
         if (didAlloc) {
-            std::vector<VkWriteDescriptorSet> writeDescriptorSetsForHostDriver(
-                pendingDescriptorWriteCount);
-            memcpy(writeDescriptorSetsForHostDriver.data(), pPendingDescriptorWrites,
-                   pendingDescriptorWriteCount * sizeof(VkWriteDescriptorSet));
+            if (!writeRangesValid) {
+                // Which set a write targets is only known from its range.
+                GFXSTREAM_ERROR(
+                    "%s: invalid descriptor write ranges for %u sets and %u writes, dropping "
+                    "the writes.",
+                    __func__, descriptorSetCount, pendingDescriptorWriteCount);
+                return;
+            }
+            writeDescriptorSetsForHostDriver.assign(
+                pPendingDescriptorWrites, pPendingDescriptorWrites + pendingDescriptorWriteCount);
 
             for (uint32_t i = 0; i < descriptorSetCount; ++i) {
-                uint32_t writeStartIndex = pDescriptorWriteStartingIndices[i];
-                uint32_t writeEndIndex;
-                if (i == descriptorSetCount - 1) {
-                    writeEndIndex = pendingDescriptorWriteCount;
-                } else {
-                    writeEndIndex = pDescriptorWriteStartingIndices[i + 1];
-                }
-                for (uint32_t j = writeStartIndex; j < writeEndIndex; ++j) {
+                for (uint32_t j = pDescriptorWriteStartingIndices[i]; j < getWriteEndIndex(i);
+                     ++j) {
                     writeDescriptorSetsForHostDriver[j].dstSet = setsToUpdate[i];
                 }
             }
-            this->on_vkUpdateDescriptorSetsImpl(
-                pool, apiCallHandle, vk, device, (uint32_t)writeDescriptorSetsForHostDriver.size(),
-                writeDescriptorSetsForHostDriver.data(), 0, nullptr);
+            writes = writeDescriptorSetsForHostDriver.data();
+        }
+
+        recordDescriptorWritesLocked(pendingDescriptorWriteCount, writes);
+
+        // Writes needing the emulated alpha samplers are rare, let the common path handle
+        // the whole batch then.
+        for (uint32_t i = 0; i < pendingDescriptorWriteCount; ++i) {
+            if (descriptorWriteNeedsEmulatedAlphaLocked(writes[i])) {
+                applyDescriptorWritesLocked(pool, vk, device, pendingDescriptorWriteCount, writes,
+                                            0, nullptr);
+                return;
+            }
+        }
+
+        // Every write names its set, so writes that can not be split per set are still
+        // applied, just without templates.
+        if (!writeRangesValid) {
+            GFXSTREAM_WARNING(
+                "%s: invalid descriptor write ranges for %u sets and %u writes, applying the "
+                "writes without templates.",
+                __func__, descriptorSetCount, pendingDescriptorWriteCount);
+            vk->vkUpdateDescriptorSets(device, pendingDescriptorWriteCount, writes, 0, nullptr);
+            return;
+        }
+
+        // Otherwise, apply the writes of each set with a single templated update.
+        for (uint32_t i = 0; i < descriptorSetCount; ++i) {
+            const uint32_t writeStartIndex = pDescriptorWriteStartingIndices[i];
+            const uint32_t writeEndIndex = getWriteEndIndex(i);
+            if (writeStartIndex == writeEndIndex) {
+                continue;
+            }
+            const uint32_t writeCount = writeEndIndex - writeStartIndex;
+            if (!applyDescriptorWritesWithTemplateLocked(vk, device, setsToUpdate[i],
+                                                         pDescriptorSetLayouts[i], writeCount,
+                                                         writes + writeStartIndex)) {
+                vk->vkUpdateDescriptorSets(device, writeCount, writes + writeStartIndex, 0,
+                                           nullptr);
+            }
+        }
+    }
+
+    // Applies `descriptorWriteCount` writes, all targeting `descriptorSet`, with a host
+    // descriptor update template cached on the set layout. Returns false if the writes can
+    // not be expressed with a template and must be applied with vkUpdateDescriptorSets().
+    bool applyDescriptorWritesWithTemplateLocked(VulkanDispatch* vk, VkDevice device,
+                                                 VkDescriptorSet descriptorSet,
+                                                 VkDescriptorSetLayout descriptorSetLayout,
+                                                 uint32_t descriptorWriteCount,
+                                                 const VkWriteDescriptorSet* pDescriptorWrites)
+        REQUIRES(mMutex) {
+        static constexpr const size_t kMaxBatchedWriteTemplatesPerLayout = 32;
+
+        if (descriptorSet == VK_NULL_HANDLE || !vk->vkCreateDescriptorUpdateTemplate ||
+            !vk->vkUpdateDescriptorSetWithTemplate || !vk->vkDestroyDescriptorUpdateTemplate) {
+            return false;
+        }
+        auto* layoutInfo = gfxstream::base::find(mDescriptorSetLayoutInfo, descriptorSetLayout);
+        if (!layoutInfo) {
+            return false;
+        }
+
+        mBatchedWriteTemplateKey.clear();
+        mBatchedWriteTemplateData.clear();
+        mBatchedWriteTemplateEntries.clear();
+        for (uint32_t i = 0; i < descriptorWriteCount; ++i) {
+            const VkWriteDescriptorSet& write = pDescriptorWrites[i];
+            if (write.pNext || write.dstSet != descriptorSet || write.descriptorCount == 0) {
+                return false;
+            }
+
+            const void* data = nullptr;
+            size_t stride = 0;
+            if (isDescriptorTypeImageInfo(write.descriptorType)) {
+                data = write.pImageInfo;
+                stride = sizeof(VkDescriptorImageInfo);
+            } else if (isDescriptorTypeBufferInfo(write.descriptorType)) {
+                data = write.pBufferInfo;
+                stride = sizeof(VkDescriptorBufferInfo);
+            } else if (isDescriptorTypeBufferView(write.descriptorType)) {
+                data = write.pTexelBufferView;
+                stride = sizeof(VkBufferView);
+            }
+            if (!data) {
+                return false;
+            }
+
+            const uint32_t keyFields[] = {write.dstBinding, write.dstArrayElement,
+                                          write.descriptorCount,
+                                          static_cast<uint32_t>(write.descriptorType)};
+            mBatchedWriteTemplateKey.append(reinterpret_cast<const char*>(keyFields),
+                                            sizeof(keyFields));
+
+            const size_t offset = mBatchedWriteTemplateData.size();
+            mBatchedWriteTemplateData.insert(mBatchedWriteTemplateData.end(),
+                                             static_cast<const uint8_t*>(data),
+                                             static_cast<const uint8_t*>(data) +
+                                                 stride * write.descriptorCount);
+            mBatchedWriteTemplateEntries.push_back(VkDescriptorUpdateTemplateEntry{
+                .dstBinding = write.dstBinding,
+                .dstArrayElement = write.dstArrayElement,
+                .descriptorCount = write.descriptorCount,
+                .descriptorType = write.descriptorType,
+                .offset = offset,
+                .stride = stride,
+            });
+        }
+
+        VkDescriptorUpdateTemplate descriptorUpdateTemplate = VK_NULL_HANDLE;
+        auto templateIt = layoutInfo->batchedWriteTemplates.find(mBatchedWriteTemplateKey);
+        if (templateIt != layoutInfo->batchedWriteTemplates.end()) {
+            descriptorUpdateTemplate = templateIt->second;
         } else {
-            this->on_vkUpdateDescriptorSetsImpl(pool, apiCallHandle, vk, device,
-                                                pendingDescriptorWriteCount,
-                                                pPendingDescriptorWrites, 0, nullptr);
+            // Guests that update sets with ever changing combinations of bindings gain nothing
+            // from caching, so only a bounded number of templates is kept per layout.
+            if (layoutInfo->batchedWriteTemplates.size() >= kMaxBatchedWriteTemplatesPerLayout) {
+                return false;
+            }
+            const VkDescriptorUpdateTemplateCreateInfo createInfo = {
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .descriptorUpdateEntryCount =
+                    static_cast<uint32_t>(mBatchedWriteTemplateEntries.size()),
+                .pDescriptorUpdateEntries = mBatchedWriteTemplateEntries.data(),
+                .templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET,
+                .descriptorSetLayout = descriptorSetLayout,
+                .pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+                .pipelineLayout = VK_NULL_HANDLE,
+                .set = 0,
+            };
+            VkResult result = vk->vkCreateDescriptorUpdateTemplate(device, &createInfo, nullptr,
+                                                                   &descriptorUpdateTemplate);
+            if (result != VK_SUCCESS) {
+                GFXSTREAM_WARNING("Failed to create batched descriptor write template: %d",
+                                  result);
+                return false;
+            }
+            layoutInfo->batchedWriteTemplates.emplace(mBatchedWriteTemplateKey,
+                                                      descriptorUpdateTemplate);
         }
+
+        vk->vkUpdateDescriptorSetWithTemplate(device, descriptorSet, descriptorUpdateTemplate,
+                                              mBatchedWriteTemplateData.data());
+        return true;
     }
 
     void on_vkCollectDescriptorPoolIdsGOOGLE(gfxstream::base::BumpPool* pool, VkSnapshotApiCallHandle,
@@ -9484,6 +10178,7 @@ class VkDecoderGlobalState::Impl {
     gfxstream::host::RenderDocWithMultipleVkInstances* mRenderDocWithMultipleVkInstances = nullptr;
     bool mSnapshotsEnabled = false;
     bool mBatchedDescriptorSetUpdateEnabled = false;
+    bool mDeferredDestroyEnabled = false;
     bool mDisableSparseBindingSupport = false;
     bool mVkCleanupEnabled = true;
     bool mLogging = false;
@@ -9702,6 +10397,16 @@ class VkDecoderGlobalState::Impl {
 
     std::unordered_map<LinearImageCreateInfo, LinearImageProperties, LinearImageCreateInfo::Hash>
         mLinearImageProperties GUARDED_BY(mMutex);
+
+    // Scratch space for applyDescriptorWritesWithTemplateLocked(), kept around to avoid
+    // allocating for every batch of descriptor writes.
+    std::string mBatchedWriteTemplateKey GUARDED_BY(mMutex);
+    std::vector<uint8_t> mBatchedWriteTemplateData GUARDED_BY(mMutex);
+    std::vector<VkDescriptorUpdateTemplateEntry> mBatchedWriteTemplateEntries GUARDED_BY(mMutex);
+
+    // Declared last so that the pending sub-decodes, which use the state above, finish before
+    // any of it is destroyed.
+    std::unique_ptr<SubDecodeWorkerPool> mSubDecodeWorkerPool;
 };
 
 VkDecoderGlobalState::VkDecoderGlobalState(VkEmulation* emulation)
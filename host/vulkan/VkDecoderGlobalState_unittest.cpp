@@ -23,6 +23,7 @@ namespace gfxstream {
 namespace vk {
 namespace {
 using ::testing::_;
+using ::testing::ElementsAre;
 using ::testing::InSequence;
 using ::testing::MockFunction;
 using ::testing::Return;
@@ -143,6 +144,112 @@ TEST_F(VkDecoderGlobalStateExternalFenceDeathTest, undestroyedFences) {
             "fences still not destroyed."));
 }
 
+DescriptorSetInfo MakeDescriptorSetInfo(std::vector<VkDescriptorSetLayoutBinding> bindings) {
+    DescriptorSetInfo setInfo;
+    setInfo.bindings = std::move(bindings);
+    initDescriptorSetWrites(setInfo);
+    return setInfo;
+}
+
+VkWriteDescriptorSet MakeWrite(uint32_t dstBinding, uint32_t dstArrayElement,
+                               uint32_t descriptorCount, VkDescriptorType descriptorType) {
+    return VkWriteDescriptorSet{
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstBinding = dstBinding,
+        .dstArrayElement = dstArrayElement,
+        .descriptorCount = descriptorCount,
+        .descriptorType = descriptorType,
+    };
+}
+
+TEST(VkDecoderGlobalStateDescriptorSetTest, laysOutBindingsConsecutively) {
+    // Binding 1 is not in the layout and binding 4 is an inline uniform block of 16 bytes.
+    const DescriptorSetInfo setInfo = MakeDescriptorSetInfo({
+        {3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2, VK_SHADER_STAGE_ALL, nullptr},
+        {0, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 3, VK_SHADER_STAGE_ALL, nullptr},
+        {2, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1, VK_SHADER_STAGE_ALL, nullptr},
+        {4, VK_DESCRIPTOR_TYPE_INLINE_UNIFORM_BLOCK, 16, VK_SHADER_STAGE_ALL, nullptr},
+    });
+
+    EXPECT_EQ(setInfo.getBindingCount(), 5u);
+    EXPECT_THAT(setInfo.bindingStarts, ElementsAre(0, 3, 3, 4, 6, 7));
+    EXPECT_EQ(setInfo.getDescriptorCount(1), 0u);
+    ASSERT_EQ(setInfo.allWrites.size(), 7u);
+    EXPECT_EQ(setInfo.allWrites[2].descriptorType, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
+    EXPECT_EQ(setInfo.allWrites[3].descriptorType, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
+    EXPECT_EQ(setInfo.allWrites[4].descriptorType, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+    EXPECT_EQ(setInfo.allWrites[6].descriptorType, VK_DESCRIPTOR_TYPE_INLINE_UNIFORM_BLOCK);
+}
+
+TEST(VkDecoderGlobalStateDescriptorSetTest, findsWrittenEntries) {
+    const DescriptorSetInfo setInfo = MakeDescriptorSetInfo({
+        {0, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 3, VK_SHADER_STAGE_ALL, nullptr},
+        {2, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 2, VK_SHADER_STAGE_ALL, nullptr},
+        {3, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1, VK_SHADER_STAGE_ALL, nullptr},
+        {4, VK_DESCRIPTOR_TYPE_INLINE_UNIFORM_BLOCK, 16, VK_SHADER_STAGE_ALL, nullptr},
+    });
+    uint32_t tableOffset = 0;
+    uint32_t count = 0;
+
+    // Within an array binding.
+    ASSERT_TRUE(getDescriptorWriteTableRange(
+        setInfo, MakeWrite(0, 1, 2, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE), &tableOffset, &count));
+    EXPECT_EQ(tableOffset, 1u);
+    EXPECT_EQ(count, 2u);
+
+    // Past the end of binding 0, skipping the missing binding 1, and through binding 2 into
+    // binding 3.
+    ASSERT_TRUE(getDescriptorWriteTableRange(
+        setInfo, MakeWrite(0, 2, 4, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE), &tableOffset, &count));
+    EXPECT_EQ(tableOffset, 2u);
+    EXPECT_EQ(count, 4u);
+    EXPECT_EQ(tableOffset + count, setInfo.bindingStarts[3] + 1);
+
+    // An array element past the end of its binding lands in the next binding.
+    ASSERT_TRUE(getDescriptorWriteTableRange(
+        setInfo, MakeWrite(2, 2, 1, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE), &tableOffset, &count));
+    EXPECT_EQ(tableOffset, setInfo.bindingStarts[3]);
+    EXPECT_EQ(count, 1u);
+
+    // Clamped to the end of the set.
+    ASSERT_TRUE(getDescriptorWriteTableRange(
+        setInfo, MakeWrite(2, 1, 8, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE), &tableOffset, &count));
+    EXPECT_EQ(tableOffset, 4u);
+    EXPECT_EQ(count, 3u);
+
+    // The array element of an inline uniform block is a byte offset into its only entry.
+    ASSERT_TRUE(getDescriptorWriteTableRange(
+        setInfo, MakeWrite(4, 8, 8, VK_DESCRIPTOR_TYPE_INLINE_UNIFORM_BLOCK), &tableOffset,
+        &count));
+    EXPECT_EQ(tableOffset, 6u);
+    EXPECT_EQ(count, 1u);
+
+    // Nothing to update.
+    EXPECT_FALSE(getDescriptorWriteTableRange(
+        setInfo, MakeWrite(5, 0, 1, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE), &tableOffset, &count));
+    EXPECT_FALSE(getDescriptorWriteTableRange(
+        setInfo, MakeWrite(3, 2, 1, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE), &tableOffset, &count));
+    EXPECT_FALSE(getDescriptorWriteTableRange(
+        setInfo, MakeWrite(0, UINT32_MAX, 1, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE), &tableOffset,
+        &count));
+}
+
+TEST(VkDecoderGlobalStateDescriptorSetTest, validatesPendingWriteRanges) {
+    const uint32_t valid[] = {0, 2, 2, 5};
+    EXPECT_TRUE(descriptorWriteRangesCoverAllWrites(4, valid, 5));
+    EXPECT_TRUE(descriptorWriteRangesCoverAllWrites(4, valid, 6));
+    EXPECT_TRUE(descriptorWriteRangesCoverAllWrites(0, nullptr, 0));
+
+    // Drops the writes before the first set.
+    const uint32_t lateStart[] = {1, 2};
+    EXPECT_FALSE(descriptorWriteRangesCoverAllWrites(2, lateStart, 3));
+    // Decreasing, or past the end of the writes.
+    const uint32_t decreasing[] = {0, 3, 2};
+    EXPECT_FALSE(descriptorWriteRangesCoverAllWrites(3, decreasing, 4));
+    EXPECT_FALSE(descriptorWriteRangesCoverAllWrites(4, valid, 4));
+    EXPECT_FALSE(descriptorWriteRangesCoverAllWrites(0, nullptr, 1));
+}
+
 }  // namespace
 }  // namespace vk
 }  // namespace gfxstream
@@ -30,10 +30,12 @@
 #include <unordered_map>
 
 #include "DebugUtilsHelper.h"
+#include "DeviceMemorySubAllocator.h"
 #include "DeviceOpTracker.h"
 #include "Handle.h"
 #include "VkEmulatedPhysicalDeviceMemory.h"
 #include "VkEmulatedPhysicalDeviceQueue.h"
+#include "render-utils/small_vector.h"
 #include "render-utils/stream.h"
 #include "gfxstream/common/logging.h"
 #include "gfxstream/memory/SharedMemory.h"
@@ -176,6 +178,10 @@ struct MemoryInfo {
     std::optional<HandleType> boundBuffer;
     // ColorBuffer, provided via vkAllocateMemory().
     std::optional<HandleType> boundColorBuffer;
+
+    // Set when the memory lives inside of a larger host allocation, in which case the
+    // VkDeviceMemory is a placeholder that must not be passed to the driver.
+    std::optional<DeviceMemorySubAllocator::SubAllocation> subAllocation;
 };
 
 struct InstanceInfo {
@@ -216,6 +222,7 @@ struct DeviceInfo {
     std::set<VkFormat> imageFormats = {};  // image formats used on this device
     std::unique_ptr<GpuDecompressionPipelineManager> decompPipelines = nullptr;
     DeviceOpTrackerPtr deviceOpTracker = nullptr;
+    std::unique_ptr<DeviceMemorySubAllocator> memorySubAllocator = nullptr;
     std::optional<uint32_t> virtioGpuContextId;
 
     bool needEmulatedDecompression(VkFormat format) {
@@ -410,6 +417,9 @@ struct DescriptorSetLayoutInfo {
     VkDescriptorSetLayout boxed = 0;
     VkDescriptorSetLayoutCreateInfo createInfo;
     std::vector<VkDescriptorSetLayoutBinding> bindings;
+    // Host descriptor update templates used to apply batched descriptor writes to sets of
+    // this layout, keyed by the bindings, array elements, counts and types of the writes.
+    std::unordered_map<std::string, VkDescriptorUpdateTemplate> batchedWriteTemplates;
 };
 
 struct DescriptorPoolInfo {
@@ -454,16 +464,36 @@ struct DescriptorSetInfo {
         };
 
         std::vector<uint8_t> inlineUniformBlockBuffer;
-        // Weak pointer(s) to detect if all objects on dependency chain are alive.
-        std::vector<std::weak_ptr<bool>> alives;
+        // Weak pointer(s) to detect if all objects on dependency chain are alive. A
+        // descriptor depends on at most an image view and a sampler.
+        SmallFixedVector<std::weak_ptr<bool>, 2> alives;
         std::optional<HandleType> boundColorBuffer;
     };
 
     VkDevice device;
     VkDescriptorPool pool;
     VkDescriptorSetLayout unboxedLayout = 0;
-    std::vector<std::vector<DescriptorWrite>> allWrites;
+    // Every descriptor of the set, binding after binding. The descriptors of binding `b`
+    // are allWrites[bindingStarts[b]] up to allWrites[bindingStarts[b + 1]]. Inline uniform
+    // blocks take a single entry.
+    std::vector<DescriptorWrite> allWrites;
+    std::vector<uint32_t> bindingStarts;
+    // Number of allWrites entries with a boundColorBuffer, so that queue submissions only
+    // need to look through the sets that reference ColorBuffers.
+    uint32_t colorBufferWriteCount = 0;
     std::vector<VkDescriptorSetLayoutBinding> bindings;
+
+    uint32_t getBindingCount() const {
+        return bindingStarts.empty() ? 0 : static_cast<uint32_t>(bindingStarts.size() - 1);
+    }
+    uint32_t getDescriptorCount(uint32_t binding) const {
+        return bindingStarts[binding + 1] - bindingStarts[binding];
+    }
+    void setBoundColorBuffer(DescriptorWrite& write, std::optional<HandleType> colorBuffer) {
+        colorBufferWriteCount -= write.boundColorBuffer.has_value();
+        write.boundColorBuffer = colorBuffer;
+        colorBufferWriteCount += write.boundColorBuffer.has_value();
+    }
 };
 
 struct ShaderModuleInfo {
@@ -62,12 +62,12 @@ class VkDecoderSnapshot::Impl {
         VkReconstruction::loadReplayBuffers(stream, outHandleBuffer, outDecoderBuffer);
     }
 
-    VkSnapshotApiCallHandle createApiCallInfo() {
-        std::lock_guard<std::mutex> lock(mReconstructionMutex);
-        return mReconstruction.createApiCallInfo();
-    }
+    // Called around every decoded command, so neither takes mReconstructionMutex unless a hook
+    // recorded something for the call.
+    VkSnapshotApiCallHandle createApiCallInfo() { return mReconstruction.createApiCallInfo(); }
 
     void destroyApiCallInfoIfUnused(VkSnapshotApiCallHandle apiCallHandle) {
+        if (!mReconstruction.hasApiCallInfo(apiCallHandle)) return;
         std::lock_guard<std::mutex> lock(mReconstructionMutex);
         return mReconstruction.destroyApiCallInfoIfUnused(apiCallHandle);
     }
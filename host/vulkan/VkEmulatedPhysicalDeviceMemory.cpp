@@ -92,6 +92,18 @@ EmulatedPhysicalDeviceMemoryProperties::EmulatedPhysicalDeviceMemoryProperties(
 
         mGuestColorBufferMemoryTypeIndex = ahbMemoryTypeIndex;
     }
+
+    if (features.VulkanSubAllocateMemory.enabled) {
+        static constexpr const VkMemoryPropertyFlags kNotSubAllocatable =
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT |
+            VK_MEMORY_PROPERTY_PROTECTED_BIT;
+        for (uint32_t i = 0; i < mHostMemoryProperties.memoryTypeCount; i++) {
+            const auto flags = mHostMemoryProperties.memoryTypes[i].propertyFlags;
+            if ((flags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) && !(flags & kNotSubAllocatable)) {
+                mSubAllocatableHostMemoryTypeBits |= (1u << i);
+            }
+        }
+    }
 }
 
 std::optional<EmulatedPhysicalDeviceMemoryProperties::HostMemoryInfo>
@@ -55,6 +55,14 @@ class EmulatedPhysicalDeviceMemoryProperties {
 
     void transformToGuestMemoryRequirements(VkMemoryRequirements* hostMemoryRequirements) const;
 
+    // Whether allocations of the given host memory type may be placed inside of a larger
+    // host allocation (see DeviceMemorySubAllocator). Memory the guest could map is never
+    // sub-allocated.
+    bool supportsSubAllocation(uint32_t hostMemoryTypeIndex) const {
+        return hostMemoryTypeIndex < VK_MAX_MEMORY_TYPES &&
+               (mSubAllocatableHostMemoryTypeBits & (1u << hostMemoryTypeIndex));
+    }
+
    private:
     VkPhysicalDeviceMemoryProperties mGuestMemoryProperties;
     VkPhysicalDeviceMemoryProperties mHostMemoryProperties;
@@ -65,6 +73,8 @@ class EmulatedPhysicalDeviceMemoryProperties {
     // try to import host ColorBuffer allocations
     // (e.g. vkGetAndroidHardwareBufferPropertiesANDROID()).
     uint32_t mGuestColorBufferMemoryTypeIndex;
+
+    uint32_t mSubAllocatableHostMemoryTypeBits = 0;
 };
 
 }  // namespace vk
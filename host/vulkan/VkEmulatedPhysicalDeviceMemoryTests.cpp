@@ -259,6 +259,63 @@ TEST(VkGuestMemoryUtilsTest, VulkanAllocateDeviceMemoryOnly) {
                 EqsVkPhysicalDeviceMemoryProperties(expectedGuestMemoryProperties));
 }
 
+TEST(VkGuestMemoryUtilsTest, VulkanSubAllocateMemory) {
+    const VkPhysicalDeviceMemoryProperties hostMemoryProperties = {
+        .memoryTypeCount = 4,
+        .memoryTypes =
+            {
+                {
+                    .propertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                    .heapIndex = 0,
+                },
+                {
+                    .propertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+                                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                    .heapIndex = 0,
+                },
+                {
+                    .propertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+                                     VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT,
+                    .heapIndex = 0,
+                },
+                {
+                    .propertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                    .heapIndex = 1,
+                },
+            },
+        .memoryHeapCount = 2,
+        .memoryHeaps =
+            {
+                {
+                    .size = 0x10000000,
+                    .flags = VK_MEMORY_HEAP_DEVICE_LOCAL_BIT,
+                },
+                {
+                    .size = 0x10000000,
+                    .flags = 0,
+                },
+            },
+    };
+
+    gfxstream::host::FeatureSet features;
+    {
+        EmulatedPhysicalDeviceMemoryProperties helper(hostMemoryProperties, 0, features);
+        EXPECT_FALSE(helper.supportsSubAllocation(0));
+    }
+
+    features.VulkanSubAllocateMemory.enabled = true;
+    EmulatedPhysicalDeviceMemoryProperties helper(hostMemoryProperties, 0, features);
+    EXPECT_TRUE(helper.supportsSubAllocation(0));
+    EXPECT_FALSE(helper.supportsSubAllocation(1));
+    EXPECT_FALSE(helper.supportsSubAllocation(2));
+    EXPECT_FALSE(helper.supportsSubAllocation(3));
+    EXPECT_FALSE(helper.supportsSubAllocation(4));
+
+    // Sub-allocation is invisible to the guest.
+    EXPECT_THAT(helper.getGuestMemoryProperties(),
+                EqsVkPhysicalDeviceMemoryProperties(hostMemoryProperties));
+}
+
 }  // namespace
 }  // namespace vk
 }  // namespace gfxstream
\ No newline at end of file
@@ -16,11 +16,11 @@
 
 #include <string.h>
 
+#include <algorithm>
 #include <unordered_map>
 
 #include "VkDecoder.h"
 #include "VulkanBoxedHandles.h"
-#include "gfxstream/containers/EntityManager.h"
 
 #define DEBUG_RECONSTRUCTION 0
 
@@ -40,19 +40,231 @@ namespace {
 
 #if DEBUG_RECONSTRUCTION
 uint32_t GetOpcode(const VkSnapshotApiCallInfo& info) {
-    if (info.packet.size() <= 4) return -1;
+    if (info.packetSize <= 4) return -1;
 
-    return *(reinterpret_cast<const uint32_t*>(info.packet.data()));
+    return *(reinterpret_cast<const uint32_t*>(info.packet));
 }
 #endif
 
+std::atomic<uint64_t> sNextReconstructionId{1};
+
+// The packet logs are not compacted while they are smaller than this.
+constexpr size_t kMinApiCallLogCompactionBytes = 4 * 1024 * 1024;
+
 }  // namespace
 
-VkReconstruction::VkReconstruction() = default;
+const uint8_t* VkReconstruction::ApiCallLog::append(const uint8_t* bytes, size_t size,
+                                                    ApiCallLogChunk** outChunk) {
+    ApiCallLogChunk* chunk;
+    uint8_t* dst;
+    if (size > kChunkSize / 4) {
+        // Do not waste the rest of the current chunk on the occasional large packet.
+        mChunks.push_back(std::make_unique<ApiCallLogChunk>());
+        chunk = mChunks.back().get();
+        chunk->data.reset(new uint8_t[size]);
+        chunk->size = size;
+        mAllocatedBytes += size;
+        dst = chunk->data.get();
+    } else {
+        chunk = mCurrentChunk;
+        if (!chunk || chunk->size - chunk->liveBytes < size) {
+            // Start a new chunk; the previous one is freed once its packets are released.
+            if (chunk && chunk->liveBytes == 0) {
+                freeChunk(chunk);
+            }
+            mChunks.push_back(std::make_unique<ApiCallLogChunk>());
+            chunk = mChunks.back().get();
+            chunk->data.reset(new uint8_t[kChunkSize]);
+            chunk->size = kChunkSize;
+            mAllocatedBytes += kChunkSize;
+            mCurrentChunk = chunk;
+            mCurrentOffset = 0;
+        }
+        dst = chunk->data.get() + mCurrentOffset;
+        mCurrentOffset += size;
+    }
+    chunk->liveBytes += size;
+    memcpy(dst, bytes, size);
+    *outChunk = chunk;
+    return dst;
+}
+
+void VkReconstruction::ApiCallLog::release(ApiCallLogChunk* chunk, size_t size) {
+    chunk->liveBytes -= size;
+    if (chunk->liveBytes == 0 && chunk != mCurrentChunk) {
+        freeChunk(chunk);
+    }
+}
+
+void VkReconstruction::ApiCallLog::freeChunk(ApiCallLogChunk* chunk) {
+    if (chunk == mCurrentChunk) {
+        mCurrentChunk = nullptr;
+        mCurrentOffset = 0;
+    }
+    auto it = std::find_if(mChunks.begin(), mChunks.end(),
+                           [chunk](const auto& c) { return c.get() == chunk; });
+    mAllocatedBytes -= chunk->size;
+    mChunks.erase(it);
+}
+
+void VkReconstruction::ApiCallLog::reset() {
+    mChunks.clear();
+    mCurrentChunk = nullptr;
+    mCurrentOffset = 0;
+    mAllocatedBytes = 0;
+}
+
+VkReconstruction::VkReconstruction()
+    : mId(sNextReconstructionId++), mApiCallLogs(std::make_shared<ApiCallLogs>()) {}
 
 void VkReconstruction::clear() {
     mGraph.clear();
-    mApiCallManager.clear();
+    mApiCalls.clear();
+
+    std::lock_guard<std::mutex> lock(mApiCallLogs->mutex);
+    auto& logs = mApiCallLogs->logs;
+    logs.erase(std::remove_if(logs.begin(), logs.end(),
+                              [](const std::unique_ptr<ApiCallLog>& log) { return log->detached; }),
+               logs.end());
+    for (auto& log : logs) {
+        log->reset();
+    }
+    mApiCallLogBytes = 0;
+    mApiCallLogBytesAfterCompaction = 0;
+}
+
+VkReconstruction::ApiCallLog* VkReconstruction::getThreadApiCallLog() const {
+    // Hands the log over to the next compaction when the thread exits.
+    struct ThreadApiCallLog {
+        ~ThreadApiCallLog() { detach(); }
+
+        void detach() {
+            if (auto logs = owner.lock()) {
+                std::lock_guard<std::mutex> lock(logs->mutex);
+                log->detached = true;
+            }
+            owner.reset();
+            log = nullptr;
+        }
+
+        uint64_t reconstructionId = 0;
+        std::weak_ptr<ApiCallLogs> owner;
+        ApiCallLog* log = nullptr;
+    };
+    static thread_local ThreadApiCallLog tLog;
+
+    if (tLog.reconstructionId != mId) {
+        tLog.detach();
+        std::lock_guard<std::mutex> lock(mApiCallLogs->mutex);
+        mApiCallLogs->logs.push_back(std::make_unique<ApiCallLog>());
+        tLog.reconstructionId = mId;
+        tLog.owner = mApiCallLogs;
+        tLog.log = mApiCallLogs->logs.back().get();
+    }
+    return tLog.log;
+}
+
+size_t VkReconstruction::getApiCallLogBytes() const {
+    std::lock_guard<std::mutex> lock(mApiCallLogs->mutex);
+    size_t bytes = 0;
+    for (const auto& log : mApiCallLogs->logs) {
+        bytes += log->allocatedBytes();
+    }
+    return bytes;
+}
+
+size_t VkReconstruction::getApiCallLogCount() const {
+    std::lock_guard<std::mutex> lock(mApiCallLogs->mutex);
+    return mApiCallLogs->logs.size();
+}
+
+void VkReconstruction::releasePacket(VkSnapshotApiCallInfo* info) {
+    if (!info->packetChunk) return;
+    const size_t allocatedBytes = info->packetLog->allocatedBytes();
+    info->packetLog->release(info->packetChunk, info->packetSize);
+    mApiCallLogBytes -= allocatedBytes - info->packetLog->allocatedBytes();
+    info->packet = nullptr;
+    info->packetSize = 0;
+    info->packetLog = nullptr;
+    info->packetChunk = nullptr;
+}
+
+void VkReconstruction::eraseApiCallInfo(VkSnapshotApiCallHandle handle) {
+    auto it = mApiCalls.find(handle);
+    if (it == mApiCalls.end()) return;
+    releasePacket(&it->second);
+    mApiCalls.erase(it);
+    mGraph.removeApiNode(handle);
+}
+
+void VkReconstruction::compactApiCallLogs() {
+    std::vector<uint64_t> liveApiCalls;
+    mGraph.getIdsByTimestamp(liveApiCalls);
+    std::sort(liveApiCalls.begin(), liveApiCalls.end());
+
+    std::vector<VkSnapshotApiCallHandle> deadApiCalls;
+    for (const auto& [handle, info] : mApiCalls) {
+        if (info.finished &&
+            !std::binary_search(liveApiCalls.begin(), liveApiCalls.end(), handle)) {
+            deadApiCalls.push_back(handle);
+        }
+    }
+    for (VkSnapshotApiCallHandle handle : deadApiCalls) {
+        eraseApiCallInfo(handle);
+    }
+
+    ApiCallLog* target = getThreadApiCallLog();
+
+    std::lock_guard<std::mutex> lock(mApiCallLogs->mutex);
+    // Packets left in mostly empty chunks pin the whole chunk, so they are moved together.
+    for (auto& [handle, info] : mApiCalls) {
+        if (!info.packetChunk || info.packetLog == target) continue;
+        if (!info.packetLog->detached && info.packetChunk->liveBytes * 4 >= info.packetChunk->size) {
+            continue;
+        }
+        ApiCallLogChunk* chunk = nullptr;
+        const uint8_t* packet = target->append(info.packet, info.packetSize, &chunk);
+        const size_t packetSize = info.packetSize;
+        releasePacket(&info);
+        info.packet = packet;
+        info.packetSize = packetSize;
+        info.packetLog = target;
+        info.packetChunk = chunk;
+    }
+
+    auto& logs = mApiCallLogs->logs;
+    logs.erase(std::remove_if(logs.begin(), logs.end(),
+                              [](const std::unique_ptr<ApiCallLog>& log) { return log->detached; }),
+               logs.end());
+
+    mApiCallLogBytes = 0;
+    for (const auto& log : logs) {
+        mApiCallLogBytes += log->allocatedBytes();
+    }
+    mApiCallLogBytesAfterCompaction = mApiCallLogBytes;
+}
+
+VkReconstruction::VkSnapshotApiCallInfo* VkReconstruction::getApiCallInfo(
+    VkSnapshotApiCallHandle handle) {
+    auto it = mApiCalls.find(handle);
+    if (it == mApiCalls.end()) return nullptr;
+    return &it->second;
+}
+
+VkReconstruction::VkSnapshotApiCallInfo* VkReconstruction::getOrCreateApiCallInfo(
+    VkSnapshotApiCallHandle handle) {
+    if (handle == kInvalidSnapshotApiCallHandle) return nullptr;
+
+    auto [it, inserted] = mApiCalls.try_emplace(handle);
+    if (inserted) {
+        it->second.handle = handle;
+
+        ApiCallLog* log = getThreadApiCallLog();
+        if (log->currentApiCall == handle) {
+            log->currentApiCallHasInfo = true;
+        }
+    }
+    return &it->second;
 }
 
 void VkReconstruction::saveReplayBuffers(gfxstream::Stream* stream) {
@@ -68,9 +280,15 @@ void VkReconstruction::saveReplayBuffers(gfxstream::Stream* stream) {
 
     size_t totalApiTraceSize = 0;
 
+    // Nodes whose creating call was never recorded have no trace to replay.
+    uniqApiRefsByTopoOrder.erase(
+        std::remove_if(uniqApiRefsByTopoOrder.begin(), uniqApiRefsByTopoOrder.end(),
+                       [this](uint64_t apiHandle) { return !getApiCallInfo(apiHandle); }),
+        uniqApiRefsByTopoOrder.end());
+
     for (auto apiHandle : uniqApiRefsByTopoOrder) {
-        const VkSnapshotApiCallInfo* info = mApiCallManager.get(apiHandle);
-        totalApiTraceSize += info->packet.size();
+        const VkSnapshotApiCallInfo* info = getApiCallInfo(apiHandle);
+        totalApiTraceSize += info->packetSize;
     }
 
     DEBUG_RECON("total api trace size: %zu", totalApiTraceSize);
@@ -78,7 +296,7 @@ void VkReconstruction::saveReplayBuffers(gfxstream::Stream* stream) {
     std::vector<uint64_t> createdHandleBuffer;
 
     for (auto apiHandle : uniqApiRefsByTopoOrder) {
-        auto item = mApiCallManager.get(apiHandle);
+        auto item = getApiCallInfo(apiHandle);
         for (auto createdHandle : item->createdHandles) {
             DEBUG_RECON("save handle: 0x%lx", createdHandle);
             createdHandleBuffer.push_back(createdHandle);
@@ -91,12 +309,14 @@ void VkReconstruction::saveReplayBuffers(gfxstream::Stream* stream) {
     uint8_t* apiTracePtr = apiTraceBuffer.data();
 
     for (auto apiHandle : uniqApiRefsByTopoOrder) {
-        auto item = mApiCallManager.get(apiHandle);
+        auto item = getApiCallInfo(apiHandle);
         // 4 bytes for opcode, and 4 bytes for saveBufferRaw's size field
         DEBUG_RECON("saving api handle 0x%lx op code %d name %s", apiHandle, GetOpcode(*item),
                 api_opcode_to_string(GetOpcode(*item)));
-        memcpy(apiTracePtr, item->packet.data(), item->packet.size());
-        apiTracePtr += item->packet.size();
+        if (item->packetSize > 0) {
+            memcpy(apiTracePtr, item->packet, item->packetSize);
+        }
+        apiTracePtr += item->packetSize;
     }
 
     DEBUG_RECON("created handle buffer size: %zu trace: %zu", createdHandleBuffer.size(),
@@ -119,25 +339,32 @@ void VkReconstruction::loadReplayBuffers(gfxstream::Stream* stream,
 }
 
 VkSnapshotApiCallHandle VkReconstruction::createApiCallInfo() {
-    VkSnapshotApiCallHandle handle = mApiCallManager.add(VkSnapshotApiCallInfo(), 1);
+    VkSnapshotApiCallHandle handle = mNextApiCallHandle.fetch_add(1, std::memory_order_relaxed);
 
-    auto* info = mApiCallManager.get(handle);
-    info->handle = handle;
+    ApiCallLog* log = getThreadApiCallLog();
+    log->currentApiCall = handle;
+    log->currentApiCallHasInfo = false;
 
     return handle;
 }
 
+bool VkReconstruction::hasApiCallInfo(VkSnapshotApiCallHandle handle) const {
+    const ApiCallLog* log = getThreadApiCallLog();
+    // Be conservative about calls that did not start on this thread.
+    return log->currentApiCall != handle || log->currentApiCallHasInfo;
+}
+
 void VkReconstruction::removeHandleFromApiInfo(VkSnapshotApiCallHandle h, uint64_t toRemove) {}
 
 void VkReconstruction::destroyApiCallInfoIfUnused(VkSnapshotApiCallHandle handle) {
-    VkSnapshotApiCallInfo* info = mApiCallManager.get(handle);
+    VkSnapshotApiCallInfo* info = getApiCallInfo(handle);
     if (!info) return;
 
-    if (info->packet.empty()) {
-        mApiCallManager.remove(handle);
-        mGraph.removeApiNode(handle);
+    if (info->packetSize == 0) {
+        eraseApiCallInfo(handle);
         return;
     }
+    info->finished = true;
 
     if (!info->extraCreatedHandles.empty()) {
         info->createdHandles.insert(info->createdHandles.end(),
@@ -149,9 +376,22 @@ void VkReconstruction::destroyApiCallInfoIfUnused(VkSnapshotApiCallHandle handle
 
 void VkReconstruction::setApiTrace(VkSnapshotApiCallHandle apiCallHandle, const uint8_t* packet,
                                    size_t packetLenBytes) {
-    VkSnapshotApiCallInfo* info = mApiCallManager.get(apiCallHandle);
-    if (info && packet && packetLenBytes > 0) {
-        info->packet.assign(packet, packet + packetLenBytes);
+    if (!packet || packetLenBytes == 0) return;
+
+    VkSnapshotApiCallInfo* info = getOrCreateApiCallInfo(apiCallHandle);
+    if (!info) return;
+
+    releasePacket(info);
+    ApiCallLog* log = getThreadApiCallLog();
+    const size_t allocatedBytes = log->allocatedBytes();
+    info->packet = log->append(packet, packetLenBytes, &info->packetChunk);
+    info->packetSize = packetLenBytes;
+    info->packetLog = log;
+    mApiCallLogBytes += log->allocatedBytes() - allocatedBytes;
+
+    if (mApiCallLogBytes >= std::max(kMinApiCallLogCompactionBytes,
+                                     2 * mApiCallLogBytesAfterCompaction)) {
+        compactApiCallLogs();
     }
 }
 
@@ -187,7 +427,7 @@ void VkReconstruction::removeGrandChildren(const uint64_t handle) {
 
 void VkReconstruction::addApiCallDependencyOnVkObject(VkSnapshotApiCallHandle handle,
                                                       VkObjectHandle object) {
-    VkSnapshotApiCallInfo* info = mApiCallManager.get(handle);
+    VkSnapshotApiCallInfo* info = getOrCreateApiCallInfo(handle);
     if (!info) return;
 
     info->depends.push_back(object);
@@ -195,7 +435,7 @@ void VkReconstruction::addApiCallDependencyOnVkObject(VkSnapshotApiCallHandle ha
 
 void VkReconstruction::addHandleDependenciesForApiCallDependencies(VkSnapshotApiCallHandle apiCallHandle,
                                                                    VkObjectHandle child) {
-    VkSnapshotApiCallInfo* apiCallInfo = mApiCallManager.get(apiCallHandle);
+    VkSnapshotApiCallInfo* apiCallInfo = getApiCallInfo(apiCallHandle);
     if (!apiCallInfo) return;
 
     for (const VkObjectHandle parent : apiCallInfo->depends) {
@@ -218,7 +458,7 @@ void VkReconstruction::setCreatedHandlesForApi(uint64_t apiHandle, const uint64_
     if (!created) return;
 
     mGraph.setCreatedNodeIdsForApi(apiHandle, created, count);
-    auto item = mApiCallManager.get(apiHandle);
+    auto item = getOrCreateApiCallInfo(apiHandle);
 
     if (!item) return;
 
@@ -229,7 +469,7 @@ void VkReconstruction::setCreatedHandlesForApi(uint64_t apiHandle, const uint64_
 void VkReconstruction::addOrderedBoxedHandlesCreatedByCall(VkSnapshotApiCallHandle handle,
                                             const VkObjectHandle* boxedHandles,
                                             uint32_t boxedHandlesCount) {
-    VkSnapshotApiCallInfo* info = mApiCallManager.get(handle);
+    VkSnapshotApiCallInfo* info = getOrCreateApiCallInfo(handle);
     if (!info) return;
 
     info->extraCreatedHandles.insert(info->extraCreatedHandles.end(),
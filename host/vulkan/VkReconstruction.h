@@ -19,6 +19,8 @@
 #include <memory>
 #include <mutex>
 #include <set>
+#include <unordered_map>
+#include <vector>
 
 #include "DependencyGraph.h"
 #include "VkSnapshotHandles.h"
@@ -26,7 +28,6 @@
 #include "VulkanHandles.h"
 #include "common/goldfish_vk_marshaling.h"
 #include "gfxstream/HealthMonitor.h"
-#include "gfxstream/containers/EntityManager.h"
 #include "gfxstream/host/GfxApiLogger.h"
 #include "render-utils/stream.h"
 
@@ -46,9 +47,16 @@ class VkReconstruction {
 
     enum HandleState { CREATED = 0 };
 
+    // Does not need the caller to hold the snapshot lock: the handle comes from an atomic
+    // counter and the bookkeeping for it is only created once a hook records something.
     VkSnapshotApiCallHandle createApiCallInfo();
     void destroyApiCallInfoIfUnused(VkSnapshotApiCallHandle apiCallHandle);
 
+    // Returns false if nothing was recorded for `apiCallHandle` yet, in which case
+    // destroyApiCallInfoIfUnused() would be a no-op. Does not need the snapshot lock but must
+    // be called on the thread that created `apiCallHandle`, like all the hooks for that call.
+    bool hasApiCallInfo(VkSnapshotApiCallHandle apiCallHandle) const;
+
     void removeHandleFromApiInfo(VkSnapshotApiCallHandle apiCallHandle, uint64_t toRemove);
 
     void setApiTrace(VkSnapshotApiCallHandle apiCallHandle, const uint8_t* traceBegin, size_t traceBytes);
@@ -102,12 +110,69 @@ class VkReconstruction {
                                              const VkObjectHandle* boxedHandles,
                                              uint32_t boxedHandlesCount);
 
+    // Bytes held by the per thread packet logs, for tests.
+    size_t getApiCallLogBytes() const;
+    // Number of per thread packet logs, for tests.
+    size_t getApiCallLogCount() const;
+
    private:
+    // A block of recorded packets. Freed once none of the calls it holds packets for is left.
+    struct ApiCallLogChunk {
+        std::unique_ptr<uint8_t[]> data;
+        size_t size = 0;
+        size_t liveBytes = 0;
+    };
+
+    // Storage for the raw packets recorded on one decoder thread, so that recording a call does
+    // not need its own allocation. Only accessed with the snapshot lock held, apart from the
+    // current call fields.
+    class ApiCallLog {
+       public:
+        const uint8_t* append(const uint8_t* bytes, size_t size, ApiCallLogChunk** outChunk);
+        // Frees `chunk` once it holds no live packet and is not being appended to.
+        void release(ApiCallLogChunk* chunk, size_t size);
+        void reset();
+
+        size_t allocatedBytes() const { return mAllocatedBytes; }
+
+        // The call most recently started on the owning thread and whether any bookkeeping was
+        // created for it. Only accessed by the owning thread.
+        VkSnapshotApiCallHandle currentApiCall = kInvalidSnapshotApiCallHandle;
+        bool currentApiCallHasInfo = false;
+
+        // Set with ApiCallLogs::mutex held when the owning thread exits. The packets that are
+        // still live are moved to another log by the next compaction, which deletes the log.
+        bool detached = false;
+
+       private:
+        static constexpr size_t kChunkSize = 64 * 1024;
+
+        void freeChunk(ApiCallLogChunk* chunk);
+
+        std::vector<std::unique_ptr<ApiCallLogChunk>> mChunks;
+        ApiCallLogChunk* mCurrentChunk = nullptr;
+        size_t mCurrentOffset = 0;
+        size_t mAllocatedBytes = 0;
+    };
+
+    // Outlives the VkReconstruction for threads that still refer to one of its logs.
+    struct ApiCallLogs {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ApiCallLog>> logs;
+    };
+
     struct VkSnapshotApiCallInfo {
         VkSnapshotApiCallHandle handle = kInvalidSnapshotApiCallHandle;
 
-        // Raw packet from VkDecoder.
-        std::vector<uint8_t> packet;
+        // Raw packet from VkDecoder, stored in `packetChunk` of one of the ApiCallLogs.
+        const uint8_t* packet = nullptr;
+        size_t packetSize = 0;
+        ApiCallLog* packetLog = nullptr;
+        ApiCallLogChunk* packetChunk = nullptr;
+
+        // Set once the decoder is done with the call, after which it can be dropped if none of
+        // the objects it created is left.
+        bool finished = false;
 
         // Book-keeping for which handles were created by this API
         std::vector<uint64_t> createdHandles;
@@ -127,8 +192,35 @@ class VkReconstruction {
 
     std::vector<uint64_t> getOrderedUniqueModifyApis() const;
 
-    using VkSnapshotApiCallManager = gfxstream::base::EntityManager<32, 16, 16, VkSnapshotApiCallInfo>;
-    VkSnapshotApiCallManager mApiCallManager;
+    ApiCallLog* getThreadApiCallLog() const;
+    VkSnapshotApiCallInfo* getApiCallInfo(VkSnapshotApiCallHandle handle);
+    VkSnapshotApiCallInfo* getOrCreateApiCallInfo(VkSnapshotApiCallHandle handle);
+    void releasePacket(VkSnapshotApiCallInfo* info);
+    void eraseApiCallInfo(VkSnapshotApiCallHandle handle);
+
+    // Drops the finished calls that created no live object, moves the packets out of mostly
+    // empty chunks and out of the logs of exited threads, and deletes those logs.
+    void compactApiCallLogs();
+
+    // Distinguishes instances in the thread local ApiCallLog cache.
+    const uint64_t mId;
+
+    // Handles are handed out in increasing order, starting at 1 as 0 is the invalid api call id
+    // of the dependency graph.
+    std::atomic<VkSnapshotApiCallHandle> mNextApiCallHandle{1};
+
+    // Only contains the calls for which something was recorded.
+    std::unordered_map<VkSnapshotApiCallHandle, VkSnapshotApiCallInfo> mApiCalls;
+
+    // One per live thread that recorded a call, plus the logs of exited threads until their
+    // packets are moved out.
+    std::shared_ptr<ApiCallLogs> mApiCallLogs;
+
+    // Bytes held by all the logs, and what was left after the last compaction. The logs are
+    // compacted whenever they grow to twice that, so they stay within a small multiple of the
+    // packets of the calls that would be saved.
+    size_t mApiCallLogBytes = 0;
+    size_t mApiCallLogBytesAfterCompaction = 0;
 
     std::vector<uint8_t> mLoadedTrace;
 
@@ -0,0 +1,102 @@
+// Copyright (C) 2025 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "VkReconstruction.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "VulkanBoxedHandles.h"
+#include "gfxstream/host/mem_stream.h"
+
+namespace gfxstream {
+namespace vk {
+namespace {
+
+constexpr size_t kPacketSize = 1024;
+
+uint64_t MakeBuffer(uint64_t index) {
+    return (static_cast<uint64_t>(Tag_VkBuffer) << 48) | index;
+}
+
+// Records a call creating `handle` with a packet filled with `fill`, like the decoder does.
+void RecordCreate(VkReconstruction& reconstruction, uint64_t handle, uint8_t fill) {
+    const std::vector<uint8_t> packet(kPacketSize, fill);
+    VkSnapshotApiCallHandle apiCall = reconstruction.createApiCallInfo();
+    reconstruction.setApiTrace(apiCall, packet.data(), packet.size());
+    reconstruction.addHandles(&handle, 1);
+    reconstruction.forEachHandleAddApi(&handle, 1, apiCall);
+    reconstruction.setCreatedHandlesForApi(apiCall, &handle, 1);
+    reconstruction.destroyApiCallInfoIfUnused(apiCall);
+}
+
+std::vector<uint8_t> SaveTrace(VkReconstruction& reconstruction) {
+    MemStream stream;
+    reconstruction.saveReplayBuffers(&stream);
+    stream.rewind();
+    std::vector<uint64_t> handles;
+    std::vector<uint8_t> trace;
+    VkReconstruction::loadReplayBuffers(&stream, &handles, &trace);
+    return trace;
+}
+
+TEST(VkReconstructionTest, DestroyedObjectsDoNotGrowTheLog) {
+    VkReconstruction reconstruction;
+    const uint64_t kept = MakeBuffer(1);
+    RecordCreate(reconstruction, kept, 1);
+
+    // 64 MiB of packets for objects that are destroyed right away.
+    for (uint64_t i = 0; i < 64 * 1024; i++) {
+        const uint64_t handle = MakeBuffer(2 + i);
+        RecordCreate(reconstruction, handle, 2);
+        reconstruction.removeHandles(&handle, 1);
+    }
+    EXPECT_LE(reconstruction.getApiCallLogBytes(), 16u * 1024 * 1024);
+
+    EXPECT_EQ(std::vector<uint8_t>(kPacketSize, 1), SaveTrace(reconstruction));
+}
+
+TEST(VkReconstructionTest, ExitedThreadLogsAreReleased) {
+    VkReconstruction reconstruction;
+    constexpr size_t kThreads = 8;
+    for (size_t i = 0; i < kThreads; i++) {
+        std::thread([&reconstruction, i] {
+            RecordCreate(reconstruction, MakeBuffer(1 + i), static_cast<uint8_t>(1 + i));
+        }).join();
+    }
+    EXPECT_EQ(kThreads, reconstruction.getApiCallLogCount());
+
+    // Enough to trigger a compaction, which moves the live packets to this thread's log.
+    for (uint64_t i = 0; i < 16 * 1024; i++) {
+        const uint64_t handle = MakeBuffer(kThreads + 1 + i);
+        RecordCreate(reconstruction, handle, 0);
+        reconstruction.removeHandles(&handle, 1);
+    }
+    EXPECT_EQ(1u, reconstruction.getApiCallLogCount());
+
+    std::vector<uint8_t> expected;
+    for (size_t i = 0; i < kThreads; i++) {
+        expected.insert(expected.end(), kPacketSize, static_cast<uint8_t>(1 + i));
+    }
+    EXPECT_EQ(expected, SaveTrace(reconstruction));
+
+    reconstruction.clear();
+    EXPECT_EQ(0u, reconstruction.getApiCallLogBytes());
+}
+
+}  // namespace
+}  // namespace vk
+}  // namespace gfxstream
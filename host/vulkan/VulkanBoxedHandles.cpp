@@ -57,54 +57,111 @@ void BoxedHandleManager::replayHandles(std::vector<BoxedHandle> handles) {
     mHandleReplay = !mHandleReplayQueue.empty();
 }
 
-void BoxedHandleManager::clear() {
+BoxedHandleManager::~BoxedHandleManager() {
+    for (auto& tables : mTables) {
+        delete tables.load(std::memory_order_relaxed);
+    }
+}
+
+BoxedHandleManager::TypeTables* BoxedHandleManager::getTables(uint16_t type) const {
+    if (type >= kMaxTypes) {
+        return nullptr;
+    }
+    return mTables[type].load(std::memory_order_acquire);
+}
+
+BoxedHandleManager::TypeTables* BoxedHandleManager::getOrCreateTables(uint16_t type) {
+    if (type >= kMaxTypes) {
+        GFXSTREAM_FATAL("Invalid boxed handle type %u.", type);
+    }
+    TypeTables* tables = mTables[type].load(std::memory_order_acquire);
+    if (tables) {
+        return tables;
+    }
+
     std::lock_guard<std::mutex> lock(mMutex);
-    mReverseMap.clear();
-    mStore.clear();
+    tables = mTables[type].load(std::memory_order_relaxed);
+    if (!tables) {
+        tables = new TypeTables(type);
+        mTables[type].store(tables, std::memory_order_release);
+    }
+    return tables;
+}
+
+void BoxedHandleManager::clear() {
+    for (auto& entry : mTables) {
+        TypeTables* tables = entry.load(std::memory_order_acquire);
+        if (tables) {
+            tables->handles.clear();
+            tables->reverseMap.clear();
+        }
+    }
 }
 
 uint64_t BoxedHandleManager::getHandlesCount() const {
-    std::lock_guard<std::mutex> lock(mMutex);
-    return mReverseMap.size();
+    uint64_t count = 0;
+    for (const auto& entry : mTables) {
+        const TypeTables* tables = entry.load(std::memory_order_acquire);
+        if (tables) {
+            count += tables->handles.size();
+        }
+    }
+    return count;
 }
 
 BoxedHandle BoxedHandleManager::add(const BoxedHandleInfo& item, BoxedHandleTypeTag tag) {
     BoxedHandle handle;
+    TypeTables* tables = nullptr;
 
     if (mHandleReplay) {
         handle = mHandleReplayQueue.front();
         mHandleReplayQueue.pop_front();
         mHandleReplay = !mHandleReplayQueue.empty();
 
-        handle = (BoxedHandle)mStore.addFixed(handle, item, (size_t)tag);
+        tables = getOrCreateTables(BoxedHandleTable<BoxedHandleInfo>::getType(handle));
+        const BoxedHandle replayed = tables->handles.addFixed(handle, item);
+        if (replayed != handle) {
+            GFXSTREAM_FATAL("Failed to replay boxed handle 0x%llx.",
+                            static_cast<unsigned long long>(handle));
+        }
     } else {
-        handle = (BoxedHandle)mStore.add(item, (size_t)tag);
+        tables = getOrCreateTables(static_cast<uint16_t>(tag));
+        handle = tables->handles.add(item);
+        if (handle == 0) {
+            GFXSTREAM_FATAL("Ran out of boxed handles for type %d.", tag);
+        }
     }
 
-    std::lock_guard<std::mutex> lock(mMutex);
-    mReverseMap[(BoxedHandle)(item.underlying)] = handle;
+    tables->reverseMap.set(item.underlying, handle);
     return handle;
 }
 
 void BoxedHandleManager::update(BoxedHandle handle, const BoxedHandleInfo& item,
                                 BoxedHandleTypeTag tag) {
-    auto storedItem = mStore.get(handle);
-    UnboxedHandle oldHandle = (UnboxedHandle)storedItem->underlying;
+    TypeTables* tables = getTables(BoxedHandleTable<BoxedHandleInfo>::getType(handle));
+    BoxedHandleInfo* storedItem = tables ? tables->handles.get(handle) : nullptr;
+    if (!storedItem) {
+        GFXSTREAM_ERROR("Failed to update unknown boxed handle 0x%llx.",
+                        static_cast<unsigned long long>(handle));
+        return;
+    }
+    const UnboxedHandle oldHandle = storedItem->underlying;
     *storedItem = item;
-    std::lock_guard<std::mutex> lock(mMutex);
     if (oldHandle) {
-        mReverseMap.erase(oldHandle);
+        tables->reverseMap.remove(oldHandle, handle);
     }
-    mReverseMap[(UnboxedHandle)(item.underlying)] = handle;
+    tables->reverseMap.set(item.underlying, handle);
 }
 
 void BoxedHandleManager::remove(BoxedHandle h) {
-    auto item = get(h);
-    if (item) {
-        std::lock_guard<std::mutex> lock(mMutex);
-        mReverseMap.erase((UnboxedHandle)(item->underlying));
+    TypeTables* tables = getTables(BoxedHandleTable<BoxedHandleInfo>::getType(h));
+    if (!tables) {
+        return;
+    }
+    BoxedHandleInfo removed;
+    if (tables->handles.remove(h, &removed)) {
+        tables->reverseMap.remove(removed.underlying, h);
     }
-    mStore.remove(h);
 }
 
 void BoxedHandleManager::removeDelayed(uint64_t h, VkDevice device,
@@ -134,23 +191,25 @@ void BoxedHandleManager::processDelayedRemoves(VkDevice device) {
             r.callback();
         }
 
-        mStore.remove(h);
+        remove(h);
     }
 }
 
 BoxedHandleInfo* BoxedHandleManager::get(BoxedHandle handle) {
-    return (BoxedHandleInfo*)mStore.get_const(handle);
+    TypeTables* tables = getTables(BoxedHandleTable<BoxedHandleInfo>::getType(handle));
+    if (!tables) {
+        return nullptr;
+    }
+    return tables->handles.get(handle);
 }
 
-BoxedHandle BoxedHandleManager::getBoxedFromUnboxed(UnboxedHandle unboxed) {
-    std::lock_guard<std::mutex> lock(mMutex);
-
-    auto it = mReverseMap.find(unboxed);
-    if (it == mReverseMap.end()) {
+BoxedHandle BoxedHandleManager::getBoxedFromUnboxed(UnboxedHandle unboxed,
+                                                    BoxedHandleTypeTag tag) {
+    TypeTables* tables = getTables(static_cast<uint16_t>(tag));
+    if (!tables) {
         return 0;
     }
-
-    return it->second;
+    return tables->reverseMap.get(unboxed);
 }
 
 BoxedHandleManager sBoxedHandleManager;
@@ -464,7 +523,8 @@ VkObjectT unboxed_to_boxed_non_dispatchable_VkType(VkObjectT unboxed) {
         return VK_NULL_HANDLE;
     }
 
-    return (VkObjectT)sBoxedHandleManager.getBoxedFromUnboxed((uint64_t)(uintptr_t)unboxed);
+    return (VkObjectT)sBoxedHandleManager.getBoxedFromUnboxed((uint64_t)(uintptr_t)unboxed,
+                                                              GetTag<VkObjectT>());
 }
 
 template <typename VkObjectT>
@@ -14,14 +14,17 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <deque>
+#include <memory>
 #include <mutex>
 
+#include "BoxedHandleTable.h"
 #include "VulkanDispatch.h"
 #include "VulkanHandles.h"
 #include "VulkanStream.h"
 #include "gfxstream/ThreadAnnotations.h"
-#include "gfxstream/containers/HybridEntityManager.h"
 #include "gfxstream/containers/Lookup.h"
 #include "gfxstream/synchronization/ConditionVariable.h"
 #include "gfxstream/synchronization/Lock.h"
@@ -79,17 +82,12 @@ class BoxedHandleInfo {
     VulkanMemReadingStream* readStream = nullptr;
 };
 
+// Boxed handles are kept in a separate table per type tag, stored in the handles themselves,
+// so that unboxing any handle is a lock free lookup in a dense table.
 class BoxedHandleManager {
    public:
-    // The hybrid entity manager uses a sequence lock to protect access to
-    // a working set of 16000 handles, allowing us to avoid using a regular
-    // lock for those. Performance is degraded when going over this number,
-    // as it will then fall back to a std::map.
-    //
-    // We use 16000 as the max number of live handles to track; we don't
-    // expect the system to go over 16000 total live handles, outside some
-    // dEQP object management tests.
-    using Store = gfxstream::base::HybridEntityManager<16000, BoxedHandle, BoxedHandleInfo>;
+    BoxedHandleManager() = default;
+    ~BoxedHandleManager();
 
     BoxedHandle add(const BoxedHandleInfo& item, BoxedHandleTypeTag tag);
 
@@ -103,7 +101,7 @@ class BoxedHandleManager {
     void processDelayedRemoves(VkDevice device);
 
     BoxedHandleInfo* get(BoxedHandle handle);
-    BoxedHandle getBoxedFromUnboxed(UnboxedHandle unboxed);
+    BoxedHandle getBoxedFromUnboxed(UnboxedHandle unboxed, BoxedHandleTypeTag tag);
 
     void replayHandles(std::vector<BoxedHandle> handles);
 
@@ -112,10 +110,23 @@ class BoxedHandleManager {
     uint64_t getHandlesCount() const;
 
    private:
-    Store mStore;
+    struct TypeTables {
+        explicit TypeTables(uint16_t type) : handles(type) {}
+
+        BoxedHandleTable<BoxedHandleInfo> handles;
+        BoxedHandleReverseMap reverseMap;
+    };
+
+    // All of the type tags fit in 8 bits.
+    static constexpr size_t kMaxTypes = 256;
+
+    // Lock free. Returns nullptr if no handle of `type` was ever added.
+    TypeTables* getTables(uint16_t type) const;
+    TypeTables* getOrCreateTables(uint16_t type) EXCLUDES(mMutex);
 
     mutable std::mutex mMutex;
-    std::unordered_map<UnboxedHandle, BoxedHandle> mReverseMap GUARDED_BY(mMutex);
+    // Created on first use and only destroyed with the manager.
+    std::array<std::atomic<TypeTables*>, kMaxTypes> mTables = {};
 
     struct DelayedRemove {
         BoxedHandle handle;